@@ -0,0 +1,9 @@
+// Sampling of textures packed by atlaspack (see TextureAtlas).
+// rect : offset in xy, scale in zw. UVs outside [0, 1] repeat inside the entry : the gradients are taken
+// before wrapping so that mip selection doesn't jump at the seams.
+#pragma once
+
+vec4 sampleAtlas(sampler2DArray atlas, vec2 uv, vec4 rect, float layer) {
+    vec2 scaled = uv * rect.zw;
+    return textureGrad(atlas, vec3(rect.xy + fract(uv) * rect.zw, layer), dFdx(scaled), dFdy(scaled));
+}
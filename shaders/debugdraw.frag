@@ -0,0 +1,11 @@
+#version 330 core
+in vec2 fontTexel;
+in vec4 outColor;
+
+out vec4 FragColor;
+
+uniform sampler2D font; // Coverage in red. Shapes point at a texel that is always covered.
+
+void main() {
+    FragColor = vec4(outColor.rgb, outColor.a * texelFetch(font, ivec2(fontTexel), 0).r);
+}
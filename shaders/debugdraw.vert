@@ -0,0 +1,17 @@
+#version 330 core
+// Text, rectangles and lines queued by DebugDraw, positioned in pixels from the top left corner
+
+layout (location = 0) in vec2 Pos;
+layout (location = 1) in vec2 Texel; // In the font texture
+layout (location = 2) in vec4 Color;
+
+out vec2 fontTexel;
+out vec4 outColor;
+
+uniform vec2 screenSize;
+
+void main() {
+    gl_Position = vec4(Pos / screenSize * vec2(2.0, -2.0) + vec2(-1.0, 1.0), 0.0, 1.0);
+    fontTexel = Texel;
+    outColor = Color;
+}
@@ -0,0 +1,17 @@
+#version 330 core
+// Vertex shader of the draws issued by GpuScene. The model matrix is a per-instance attribute read from
+// the instance buffer : each draw command's baseInstance points it at the right instance.
+
+layout (location = 0) in vec3 Pos;
+layout (location = 1) in vec3 Normal;
+layout (location = 3) in mat4 Model; // Locations 3 to 6
+
+out vec3 outColor;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+void main() {
+    gl_Position = projection * view * Model * vec4(Pos, 1.0);
+    outColor = normalize(mat3(Model) * Normal) * 0.5 + 0.5;
+}
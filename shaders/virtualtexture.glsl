@@ -0,0 +1,35 @@
+// Virtual texturing (see VirtualTexture). VirtualTexture::bind() sets the uniforms.
+#pragma once
+
+uniform sampler2D vtPageTable;
+uniform sampler2D vtCache;
+uniform vec4 vtParams; // x : texels on a side of level 0, y : page size, z : page border, w : level count
+uniform vec2 vtCacheParams; // x : texels on a side of the cache, y : level bias of the feedback pass
+
+float vtLevel(vec2 uv, float bias) {
+    vec2 dx = dFdx(uv) * vtParams.x, dy = dFdy(uv) * vtParams.x;
+    float lod = 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) + bias;
+    return clamp(floor(lod), 0.0, vtParams.w - 1.0);
+}
+
+float vtPagesPerSide(float level) {
+    return vtParams.x / vtParams.y / exp2(level);
+}
+
+// Bilinear sample of the finest resident page. UVs repeat.
+vec4 sampleVirtual(vec2 uv) {
+    float level = vtLevel(uv, 0.0);
+    uv = fract(uv);
+    // xy : tile of the page in the cache, z : level of the page, coarser than requested while it streams in
+    vec4 entry = floor(texelFetch(vtPageTable, ivec2(uv * vtPagesPerSide(level)), int(level)) * 255.0 + 0.5);
+    vec2 inPage = fract(uv * vtPagesPerSide(entry.z));
+    vec2 texel = entry.xy * (vtParams.y + 2.0 * vtParams.z) + vtParams.z + inPage * vtParams.y;
+    return textureLod(vtCache, texel / vtCacheParams.x, 0.0);
+}
+
+// Output of the feedback pass : the page needed by the fragment
+vec4 virtualFeedback(vec2 uv) {
+    float level = vtLevel(uv, vtCacheParams.y);
+    ivec2 page = ivec2(fract(uv) * vtPagesPerSide(level));
+    return vec4(page.x & 255, page.y & 255, (page.x >> 8) | ((page.y >> 8) << 4), level) / 255.0;
+}
@@ -22,7 +22,16 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "application.h"
+#include "framearena.h"
+#include "gpudeletionqueue.h"
+#include "gltfmodel.h"
+#include "glextensions.h"
+#include "profiler.h"
+#include "programcache.h"
+#include "renderstats.h"
+#include "shaderwatcher.h"
 #include <glad/glad.h>
+#include <iostream>
 #define GLM_FORCE_RADIANS
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -43,24 +52,39 @@ inline static void getProjection(glm::mat4& target, float width, float height, b
             }
 }
 
+inline static bool hasExtension(const std::string& path, const std::string& extension)
+{
+    return path.size() > extension.size()
+        && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
 void Application::updateProjection() {
     getProjection(projection, window->getSize().x, window->getSize().y);
 }
 
 
-Application::Application() : projection(1.0)
+Application::Application(const std::string &modelPath) : modelPath(modelPath), projection(1.0)
 {
 }
 
 bool Application::init() {
-    window = std::make_unique<sf::Window>(sf::VideoMode(200, 200), "SFML works!");
+    Profiler::global().setThreadName("Main");
+    //A depth buffer for the occlusion pyramid, which copies it, and 4.3 for compute (SFML falls back to what exists)
+    sf::ContextSettings settings(24, 0, 0, 4, 3);
+    window = std::make_unique<sf::Window>(sf::VideoMode(200, 200), "SFML works!", sf::Style::Default, settings);
     if (!gladLoadGL()) {
         return false;
     }
+    loadGLExtensions([](const char* name) { return reinterpret_cast<void*>(sf::Context::getFunction(name)); });
+    ProgramCache::global().setDirectory("shadercache");
+    gpuProfiler = std::make_unique<GpuProfiler>();
 
     glClearColor(0, 0.5, 1.0, 1.0);
     glDisable(GL_CULL_FACE);
 
+    //Compiled by the driver while the rest is set up
+    ShaderFuture pendingShader = makeShaderFromFileAsync("shaders/default.vert", "shaders/default.frag");
+
     VertexBuffer VBO[2];
 
     //Vertices
@@ -95,9 +119,22 @@ bool Application::init() {
     VAO.takeVBO(std::move(VBO[0]));
     VAO.takeVBO(std::move(VBO[1]));
 
+    assets = std::make_unique<AssetManager>();
+
+    if (!modelPath.empty()) {
+        if (hasExtension(modelPath, ".gltf") || hasExtension(modelPath, ".glb"))
+            scene = loadGltfModel(modelPath);
+        else //Streamed in, a placeholder is drawn meanwhile
+            mesh = assets->loadMesh(modelPath);
+        glEnable(GL_DEPTH_TEST);
+    }
+
     //Shader
-    shader = makeShaderFromFile("shaders/default.vert", "shaders/default.frag");
+    shader = pendingShader.get();
     glUseProgram(shader->getProgramId());
+    std::string layoutErrors = validateVertexLayout(shader->getReflection(), defaultVertexLayout());
+    if (!layoutErrors.empty())
+        std::cerr << "Shader doesn't match the mesh layout :\n" << layoutErrors;
 
     //Init projection
     updateProjection();
@@ -109,7 +146,11 @@ bool Application::init() {
 }
 
 void Application::draw() {
-    glClear(GL_COLOR_BUFFER_BIT);
+    PROFILE_SCOPE("Application::draw");
+    RenderStats::frame() = RenderStats();
+    gpuProfiler->beginFrame();
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glUseProgram(shader->getProgramId()); //The program changes when reloaded
 
     unsigned int projectionLocation = glGetUniformLocation(shader->getProgramId(), "projection");
     glUniformMatrix4fv(projectionLocation, 1, GL_FALSE, glm::value_ptr(projection));
@@ -120,10 +161,54 @@ void Application::draw() {
     unsigned int cameraLocation = glGetUniformLocation(shader->getProgramId(), "view");
     glUniformMatrix4fv(cameraLocation, 1, GL_FALSE, glm::value_ptr(cam.getView()));
 
-    VAO.bind();
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    if (useGpuScene) {
+        {
+            GPU_PROFILE_SCOPE(*gpuProfiler, "Culling");
+            gpuScene->cull(projection * cam.getView());
+        }
+        {
+            GPU_PROFILE_SCOPE(*gpuProfiler, "Scene");
+            unsigned int program = gpuSceneShader->getProgramId();
+            glUseProgram(program);
+            glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(cam.getView()));
+            gpuScene->draw();
+        }
+        GPU_PROFILE_SCOPE(*gpuProfiler, "Occlusion pyramid");
+        gpuScene->updateOcclusion(window->getSize().x, window->getSize().y);
+    }
+    else if (scene) {
+        GPU_PROFILE_SCOPE(*gpuProfiler, "Scene");
+        scene->draw(modelLocation);
+    }
+    else if (useClusters) {
+        GPU_PROFILE_SCOPE(*gpuProfiler, "Scene");
+        clusteredMesh->draw(projection * cam.getView(), model, cam.getPos());
+    }
+    else if (mesh.valid()) {
+        GPU_PROFILE_SCOPE(*gpuProfiler, "Scene");
+        Mesh& current = assets->getMesh(mesh);
+        lodSelector.setView(cam, projection, static_cast<float>(window->getSize().y));
+        meshLod = lodSelector.select(current, model, meshLod);
+        current.draw(meshLod);
+    }
+    else {
+        VAO.bind();
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+
+    if (showOverlay) {
+        PROFILE_SCOPE("Overlay");
+        GPU_PROFILE_SCOPE(*gpuProfiler, "Overlay");
+        //The clock was restarted at the beginning of the frame
+        overlay->addFrame(frameTime * 1000.0f, time.getElapsedTime().asSeconds() * 1000.0f, RenderStats::frame(), *gpuProfiler);
+        overlay->draw(window->getSize().x, window->getSize().y);
+    }
 
+    gpuProfiler->endFrame();
+    PROFILE_SCOPE("Present");
     window->display();
+    GpuDeletionQueue::global().endFrame();
 }
 
 int Application::run() {
@@ -131,8 +216,10 @@ int Application::run() {
     if (init() == false)
         return -1;
 
-    while (window->isOpen())
+    while (!quit)
     {
+        PROFILE_SCOPE("Frame");
+        FrameArena::global().beginFrame();
         sf::Event event;
         this->update(time.restart().asSeconds());
         while (window->pollEvent(event))
@@ -143,7 +230,9 @@ int Application::run() {
         this->draw();
     }
 
+    //Before closing the window : VAOs and framebuffers only exist in its context
     cleanup();
+    window->close();
 }
 
 void Application::processEvent(const sf::Event &event) {
@@ -151,11 +240,20 @@ void Application::processEvent(const sf::Event &event) {
     switch (event.type) {
 
     case sf::Event::Closed:
-        window->close();
+        quit = true;
         break;
     case sf::Event::KeyPressed:
         if (event.key.code == sf::Keyboard::Escape)
-            window->close();
+            quit = true;
+        else if (event.key.code == sf::Keyboard::C)
+            toggleClusters();
+        else if (event.key.code == sf::Keyboard::G)
+            toggleGpuScene();
+        else if (event.key.code == sf::Keyboard::P)
+            writeTrace();
+        else if (event.key.code == sf::Keyboard::F3)
+            toggleOverlay();
+        break;
     case sf::Event::Resized:
     {
         updateProjection();
@@ -167,10 +265,101 @@ void Application::processEvent(const sf::Event &event) {
     }
 }
 
+//Switches between the plain mesh and the meshlet culled one
+void Application::toggleClusters() {
+    if (scene || modelPath.empty())
+        return;
+    if (!clusteredMesh) {
+        try {
+            clusteredMesh = loadClusteredMesh(modelPath);
+        } catch (const std::exception& e) {
+            std::cerr << "Can't build the meshlets of " << modelPath << " : " << e.what() << '\n';
+            return;
+        }
+    }
+    useClusters = !useClusters;
+    std::cout << "Meshlet culling " << (useClusters ? "on, " : "off, ") << clusteredMesh->meshlets().meshlets.size() << " meshlets\n";
+}
+
+//Switches to a grid of instances of the model, culled by a compute pass and drawn with one indirect call
+void Application::toggleGpuScene() {
+    if (scene || modelPath.empty())
+        return;
+    if (!GLEXT_compute) {
+        std::cerr << "GPU-driven rendering needs OpenGL 4.3\n";
+        return;
+    }
+    if (!gpuScene) {
+        const int gridSize = 32;
+        try {
+            MeshData data = loadMeshData(modelPath);
+            data.computeBounds();
+            auto instanced = std::make_unique<GpuScene>();
+            unsigned int meshIndex = instanced->addMesh(data);
+            const float spacing = glm::length(data.boundsMax - data.boundsMin) * 1.5f;
+            for (int z = 0; z < gridSize; ++z)
+                for (int x = 0; x < gridSize; ++x) {
+                    glm::vec3 offset((x - gridSize / 2) * spacing, 0.0f, (z - gridSize / 2) * spacing);
+                    instanced->addInstance(meshIndex, glm::translate(glm::mat4(1.0f), offset));
+                }
+            //The pyramid is built from the depth of the default framebuffer
+            if (window->getSettings().depthBits < 24) {
+                std::cerr << "No 24 bit depth buffer, occlusion culling disabled\n";
+                instanced->setOcclusionCulling(false);
+            }
+            gpuSceneShader = makeShaderFromFile("shaders/gpudriven.vert", "shaders/default.frag");
+            gpuScene = std::move(instanced);
+        } catch (const std::exception& e) {
+            std::cerr << "Can't set up the GPU-driven scene : " << e.what() << '\n';
+            return;
+        }
+    }
+    useGpuScene = !useGpuScene;
+    std::cout << "GPU-driven rendering " << (useGpuScene ? "on, " : "off, ") << gpuScene->instanceCount() << " instances\n";
+}
+
+//Dumps the zones of the last frames, open the file in chrome://tracing or ui.perfetto.dev
+void Application::writeTrace() {
+    const std::string path = "trace.json";
+    try {
+        Profiler::global().writeTrace(path);
+        std::cout << "Profile written to " << path << '\n';
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+    }
+}
+
+void Application::toggleOverlay() {
+    if (!overlay) {
+        try {
+            overlay = std::make_unique<DebugOverlay>();
+        } catch (const std::exception& e) {
+            std::cerr << "Can't create the debug overlay : " << e.what() << '\n';
+            return;
+        }
+    }
+    showOverlay = !showOverlay;
+}
+
 void Application::cleanup() {
+    //The context of the window is still current
+    overlay.reset();
+    gpuScene.reset();
+    gpuSceneShader.reset();
+    clusteredMesh.reset();
+    scene.reset();
+    assets.reset();
+    shader.reset();
+    gpuProfiler.reset();
+    VAO.clear();
+    GpuDeletionQueue::global().flush();
 }
 
 void Application::update(float dt) {
+    PROFILE_SCOPE("Application::update");
+    frameTime = dt;
+    assets->update();
+    ShaderWatcher::global().update();
     //model = glm::rotate(model, glm::radians(60.f * dt), {0,1, 0});
     cam.rotateTheta(glm::radians(60.f * dt));
     cam.rotatePhi(glm::radians(60.f * dt));
@@ -31,12 +31,24 @@ SOFTWARE.
 #include "vertexbuffer.h"
 #include "vertexarray.h"
 #include "camera.h"
+#include "mesh.h"
+#include "assetmanager.h"
+#include "clusteredmesh.h"
+#include "debugoverlay.h"
+#include "gltfmodel.h"
+#include "gpuprofiler.h"
+#include "gpuscene.h"
+#include "lodselector.h"
 
 class Application
 {
 
 public:
-    Application();
+    /**
+     * @brief Application
+     * @param modelPath : OBJ, glTF (.gltf / .glb) or engine mesh (.e3dmesh) file to display. When empty, a single triangle is drawn.
+     */
+    Application(const std::string& modelPath = "");
     int run();
 
 private:
@@ -46,10 +58,30 @@ private:
     void cleanup();
     void update(float dt); //seconds
     void updateProjection();
+    void toggleClusters();
+    void toggleGpuScene();
+    void writeTrace();
+    void toggleOverlay();
 
     std::unique_ptr<sf::Window> window;
+    bool quit = false; //The window stays open until the GL objects are deleted
     std::unique_ptr<Shader> shader;
     VertexArray VAO;
+    std::unique_ptr<AssetManager> assets;
+    MeshHandle mesh;
+    unsigned int meshLod = 0;
+    LodSelector lodSelector;
+    std::unique_ptr<ClusteredMesh> clusteredMesh; //Loaded the first time clusters are turned on
+    bool useClusters = false;
+    std::unique_ptr<GpuScene> gpuScene; //Grid of instances of the model, culled and drawn by the GPU
+    std::unique_ptr<Shader> gpuSceneShader;
+    bool useGpuScene = false;
+    std::unique_ptr<GltfModel> scene;
+    std::unique_ptr<GpuProfiler> gpuProfiler;
+    std::unique_ptr<DebugOverlay> overlay; //Created the first time it is shown
+    bool showOverlay = false;
+    float frameTime = 0; //seconds
+    std::string modelPath;
     glm::mat4 projection;
     glm::mat4 model;
     sf::Clock time;
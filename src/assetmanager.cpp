@@ -0,0 +1,393 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "assetmanager.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+#include "jobsystem.h"
+#include "meshoptimize.h"
+#include "objloader.h"
+#include "profiler.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <exception>
+
+namespace {
+
+//Largest copy done at once, so that the time budget is checked often enough
+const std::size_t maxSliceBytes = 1 << 20;
+
+bool hasExtension(const std::string& path, const std::string& extension) {
+    return path.size() > extension.size()
+        && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+MeshData makeCube() {
+    MeshData cube;
+    for (int face = 0; face < 6; ++face) {
+        int axis = face / 2;
+        float sign = face % 2 ? -1.0f : 1.0f;
+        glm::vec3 normal(0.0f), u(0.0f), v(0.0f);
+        normal[axis] = sign;
+        u[(axis + 1) % 3] = 1.0f;
+        v[(axis + 2) % 3] = sign;
+        unsigned int first = static_cast<unsigned int>(cube.vertices.size());
+        for (int corner = 0; corner < 4; ++corner) {
+            glm::vec2 uv(corner & 1, corner >> 1);
+            glm::vec3 position = 0.5f * (normal + (uv.x * 2 - 1) * u + (uv.y * 2 - 1) * v);
+            cube.vertices.push_back({position, normal, uv});
+        }
+        for (unsigned int i : {0u, 1u, 3u, 0u, 3u, 2u})
+            cube.indices.push_back(first + i);
+    }
+    cube.computeBounds();
+    return cube;
+}
+
+} // namespace
+
+AssetManager::AssetManager(JobSystem &jobs) : jobs(jobs), placeholderMesh(makeMesh(makeCube()))
+{
+    const unsigned char white[4] = {255, 255, 255, 255};
+    placeholderTexture = std::make_unique<Texture2D>(1, 1, TextureFormat{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}, 1);
+    placeholderTexture->uploadImage(0, 0, white, sizeof(white));
+}
+
+AssetManager::AssetManager() : AssetManager(JobSystem::global())
+{
+}
+
+AssetManager::~AssetManager() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]{ return inFlight == 0; });
+    }
+    GpuDeletionQueue::global().release(GpuResourceType::Buffer, stagingBuffer);
+}
+
+void AssetManager::jobStarted() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++inFlight;
+}
+
+//Called with the mutex locked
+void AssetManager::jobFinished() {
+    --inFlight;
+    idle.notify_all();
+}
+
+MeshHandle AssetManager::loadMesh(const std::string &path) {
+    auto found = meshByPath.find(path);
+    if (found != meshByPath.end())
+        return found->second;
+
+    MeshHandle handle = meshes.create(path);
+    meshByPath[path] = handle;
+    jobStarted();
+    jobs.submit([this, handle, path]{ decodeMesh(handle, path); });
+    return handle;
+}
+
+//Worker thread
+void AssetManager::decodeMesh(MeshHandle handle, const std::string &path) {
+    PROFILE_SCOPE("AssetManager::decodeMesh");
+    auto result = std::make_unique<DecodedMesh>();
+    result->handle = handle;
+    try {
+        if (hasExtension(path, ".e3dmesh")) {
+            result->file = std::make_unique<MeshFile>(path);
+            const MeshFileHeader& header = result->file->header();
+            result->layout = MeshLayout::fromMeshFile(*result->file);
+            result->vertexData = static_cast<const char*>(result->file->vertexData());
+            result->vertexBytes = header.vertexDataSize;
+            result->indexData = static_cast<const char*>(result->file->indexData());
+            result->indexBytes = header.indexDataSize;
+        } else {
+            result->data = loadObj(path, jobs);
+            std::vector<MeshLodData> noLods;
+            optimizeMesh(result->data, noLods); //Mesh files are optimized by meshconv already
+            result->layout = MeshLayout::fromMeshData(result->data);
+            result->vertexData = reinterpret_cast<const char*>(result->data.vertices.data());
+            result->vertexBytes = result->data.vertices.size() * sizeof(Vertex);
+            result->indexData = reinterpret_cast<const char*>(result->data.indices.data());
+            result->indexBytes = result->data.indices.size() * sizeof(unsigned int);
+        }
+    } catch (const std::exception& e) {
+        result->error = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decoded.push_back(std::move(result));
+    jobFinished();
+}
+
+TextureHandle AssetManager::loadTexture(const std::string &path) {
+    auto found = textureByPath.find(path);
+    if (found != textureByPath.end())
+        return found->second;
+
+    TextureHandle handle = textures.create(path);
+    textureByPath[path] = handle;
+    jobStarted();
+    jobs.submit([this, handle, path]{ decodeTexture(handle, path); });
+    return handle;
+}
+
+//Worker thread : only maps and validates the file, the images are read straight from the mapping when uploaded
+void AssetManager::decodeTexture(TextureHandle handle, const std::string &path) {
+    PROFILE_SCOPE("AssetManager::decodeTexture");
+    auto result = std::make_unique<DecodedTexture>();
+    result->handle = handle;
+    try {
+        result->file = std::make_unique<TextureFile>(path);
+    } catch (const std::exception& e) {
+        result->error = e.what();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    decodedTextures.push_back(std::move(result));
+    jobFinished();
+}
+
+Mesh& AssetManager::getMesh(MeshHandle handle) {
+    MeshEntry* entry = meshes.get(handle);
+    return entry && entry->mesh ? *entry->mesh : *placeholderMesh;
+}
+
+AssetState AssetManager::getState(MeshHandle handle) const {
+    const MeshEntry* entry = meshes.get(handle);
+    return entry ? entry->state : AssetState::Failed;
+}
+
+const std::string& AssetManager::getError(MeshHandle handle) const {
+    static const std::string invalid = "Invalid or unloaded handle";
+    const MeshEntry* entry = meshes.get(handle);
+    return entry ? entry->error : invalid;
+}
+
+void AssetManager::unloadMesh(MeshHandle handle) {
+    const MeshEntry* entry = meshes.get(handle);
+    if (!entry)
+        return;
+    meshByPath.erase(entry->path);
+    meshes.release(handle); //A load or upload in flight is dropped when it sees the stale handle
+}
+
+void AssetManager::setUploadBudget(double milliseconds, std::size_t bytes) {
+    budgetMilliseconds = milliseconds;
+    budgetBytes = bytes;
+}
+
+Texture& AssetManager::getTexture(TextureHandle handle) {
+    TextureEntry* entry = textures.get(handle);
+    return entry && entry->texture ? *entry->texture : *placeholderTexture;
+}
+
+AssetState AssetManager::getState(TextureHandle handle) const {
+    const TextureEntry* entry = textures.get(handle);
+    return entry ? entry->state : AssetState::Failed;
+}
+
+const std::string& AssetManager::getError(TextureHandle handle) const {
+    static const std::string invalid = "Invalid or unloaded handle";
+    const TextureEntry* entry = textures.get(handle);
+    return entry ? entry->error : invalid;
+}
+
+void AssetManager::unloadTexture(TextureHandle handle) {
+    const TextureEntry* entry = textures.get(handle);
+    if (!entry)
+        return;
+    textureByPath.erase(entry->path);
+    textures.release(handle);
+}
+
+std::size_t AssetManager::pendingCount() const {
+    auto pending = [](AssetState state) { return state == AssetState::Loading || state == AssetState::Uploading; };
+    std::size_t result = 0;
+    meshes.forEach([&](MeshHandle, const MeshEntry& entry) { result += pending(entry.state); });
+    textures.forEach([&](TextureHandle, const TextureEntry& entry) { result += pending(entry.state); });
+    return result;
+}
+
+/* Copies the next part of an upload, returns true once the mesh is complete. The buffers are mapped
+ * with INVALIDATE_RANGE | UNSYNCHRONIZED : they are new and not used by the GPU yet, so the driver can
+ * hand out its staging memory directly without any synchronization. */
+bool AssetManager::uploadSlice(PendingUpload &upload, std::size_t &bytesLeft) {
+    DecodedMesh& mesh = *upload.mesh;
+    if (upload.vertices.id() == 0) {
+        unsigned int ids[2];
+        glGenBuffers(2, ids);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ids[0]);
+        trackedBufferData(GL_COPY_WRITE_BUFFER, ids[0], mesh.vertexBytes, nullptr, GL_STATIC_DRAW, "Mesh");
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ids[1]);
+        trackedBufferData(GL_COPY_WRITE_BUFFER, ids[1], mesh.indexBytes, nullptr, GL_STATIC_DRAW, "Mesh");
+        upload.vertices = VertexBuffer(ids[0]);
+        upload.indices = VertexBuffer(ids[1]);
+    }
+
+    bool vertexPart = upload.vertexDone < mesh.vertexBytes;
+    const char* source = vertexPart ? mesh.vertexData : mesh.indexData;
+    std::size_t& done = vertexPart ? upload.vertexDone : upload.indexDone;
+    std::size_t total = vertexPart ? mesh.vertexBytes : mesh.indexBytes;
+    std::size_t slice = std::min(std::min(total - done, maxSliceBytes), bytesLeft ? bytesLeft : maxSliceBytes);
+
+    if (slice > 0) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vertexPart ? upload.vertices.id() : upload.indices.id());
+        void* target = glMapBufferRange(GL_COPY_WRITE_BUFFER, done, slice,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (target) {
+            std::memcpy(target, source + done, slice);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        } else {
+            glBufferSubData(GL_COPY_WRITE_BUFFER, done, slice, source + done);
+        }
+        done += slice;
+        bytesLeft -= std::min(bytesLeft, slice);
+    }
+    return upload.vertexDone >= mesh.vertexBytes && upload.indexDone >= mesh.indexBytes;
+}
+
+/* Uploads the next image of a texture, returns true once the texture is complete. The pixels go through a
+ * pixel buffer orphaned for each image, so the copy returns immediately and the driver transfers them when
+ * it fits. */
+bool AssetManager::uploadImage(PendingTextureUpload &upload, std::size_t &bytesLeft) {
+    const TextureFile& file = *upload.file;
+    if (!upload.texture) {
+        upload.texture = makeTextureStorage(file);
+        upload.texture->setMemoryTag("Texture asset");
+        if (!stagingBuffer)
+            glGenBuffers(1, &stagingBuffer);
+    }
+
+    unsigned int layer = upload.image / file.faces(), face = upload.image % file.faces();
+    std::size_t size = file.imageSize(upload.level);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, stagingBuffer);
+    trackedBufferData(GL_PIXEL_UNPACK_BUFFER, stagingBuffer, size, nullptr, GL_STREAM_DRAW, "Texture staging");
+    void* target = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (target) {
+        std::memcpy(target, file.imageData(upload.level, layer, face), size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        upload.texture->uploadImage(upload.level, upload.image, nullptr, size);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        upload.texture->uploadImage(upload.level, upload.image, file.imageData(upload.level, layer, face), size);
+    }
+    bytesLeft -= std::min(bytesLeft, size);
+
+    if (++upload.image == file.layers() * file.faces()) {
+        upload.image = 0;
+        ++upload.level;
+    }
+    if (upload.level < file.levels())
+        return false;
+    if (file.needsMipmaps())
+        upload.texture->generateMipmaps();
+    return true;
+}
+
+void AssetManager::update() {
+    PROFILE_SCOPE("AssetManager::update");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& mesh : decoded) {
+            MeshEntry* entry = meshes.get(mesh->handle);
+            if (!entry) //Unloaded meanwhile
+                continue;
+            if (!mesh->error.empty()) {
+                entry->state = AssetState::Failed;
+                entry->error = mesh->error;
+                continue;
+            }
+            entry->state = AssetState::Uploading;
+            PendingUpload upload;
+            upload.mesh = std::move(mesh);
+            uploads.push_back(std::move(upload));
+        }
+        decoded.clear();
+
+        for (auto& texture : decodedTextures) {
+            TextureEntry* entry = textures.get(texture->handle);
+            if (!entry)
+                continue;
+            if (!texture->error.empty()) {
+                entry->state = AssetState::Failed;
+                entry->error = texture->error;
+                continue;
+            }
+            entry->state = AssetState::Uploading;
+            textureUploads.push_back({std::move(texture->file), nullptr, texture->handle});
+        }
+        decodedTextures.clear();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t bytesLeft = budgetBytes;
+    bool first = true;
+    while (!uploads.empty() || !textureUploads.empty()) {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (!first && (bytesLeft == 0 || elapsed.count() >= budgetMilliseconds))
+            break;
+        first = false;
+
+        const bool texturesNext = !textureUploads.empty() && (textureTurn || uploads.empty());
+        textureTurn = !texturesNext;
+        if (!texturesNext) {
+            PendingUpload& upload = uploads.front();
+            MeshEntry* entry = meshes.get(upload.mesh->handle);
+            if (!entry)
+                uploads.pop_front();
+            else if (uploadSlice(upload, bytesLeft)) {
+                entry->mesh = std::make_unique<Mesh>(std::move(upload.vertices), std::move(upload.indices), upload.mesh->layout);
+                entry->state = AssetState::Ready;
+                uploads.pop_front();
+            }
+            continue;
+        }
+
+        PendingTextureUpload& upload = textureUploads.front();
+        TextureEntry* entry = textures.get(upload.handle);
+        if (!entry) {
+            textureUploads.pop_front();
+            continue;
+        }
+        try {
+            if (uploadImage(upload, bytesLeft)) {
+                entry->texture = std::move(upload.texture);
+                entry->state = AssetState::Ready;
+                textureUploads.pop_front();
+            }
+        } catch (const std::exception& e) { //Typically a format the driver doesn't support
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            entry->state = AssetState::Failed;
+            entry->error = e.what();
+            textureUploads.pop_front();
+        }
+    }
+
+    meshes.collect();
+    textures.collect();
+}
@@ -0,0 +1,222 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef ASSETMANAGER_H
+#define ASSETMANAGER_H
+
+#include "mesh.h"
+#include "resourcepool.h"
+#include "texture.h"
+#include "texturefile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class JobSystem;
+
+/**
+ * @brief Reference to a mesh owned by an AssetManager. Becomes stale when the mesh is unloaded.
+ */
+typedef Handle<Mesh> MeshHandle;
+
+/**
+ * @brief Reference to a texture owned by an AssetManager
+ */
+typedef Handle<Texture> TextureHandle;
+
+enum class AssetState {
+    Loading, ///< Being read / decoded on a worker thread
+    Uploading, ///< Decoded, waiting for or in the middle of its GPU upload
+    Ready,
+    Failed ///< The placeholder is used forever, see getError()
+};
+
+/**
+ * @brief Loads assets asynchronously and uploads them progressively.
+ *
+ * Files are read and decoded on the job system (meshes : .obj and .e3dmesh, textures : .ktx2 and .dds). The GPU upload happens on the GL thread in update(), which
+ * copies at most a given number of bytes and spends at most a given time per call, spreading big assets over
+ * several frames. Until an asset is ready, and once it is unloaded, its handle resolves to a placeholder.
+ *
+ * \code
+ * //Typical usage
+ * AssetManager assets;
+ * MeshHandle handle = assets.loadMesh("models/city.e3dmesh"); //returns immediately
+ * //Each frame, on the GL thread
+ * assets.update();
+ * assets.getMesh(handle).draw(); //a placeholder cube until loaded
+ * assets.getTexture(albedo).bind(0); //a white texel until loaded
+ * \endcode
+ */
+class AssetManager
+{
+public:
+    /**
+     * @pre a GL context is current : the placeholders are created here
+     */
+    explicit AssetManager(JobSystem& jobs);
+    AssetManager();
+    /**
+     * @brief Waits for the loads in flight
+     */
+    ~AssetManager();
+
+    /**
+     * @brief Starts loading a mesh (.obj or .e3dmesh). Loading the same path twice returns the same handle.
+     */
+    MeshHandle loadMesh(const std::string& path);
+
+    /**
+     * @brief Returns the mesh, or the placeholder when it's not ready
+     */
+    Mesh& getMesh(MeshHandle handle);
+    AssetState getState(MeshHandle handle) const; ///< Failed for a stale handle
+    const std::string& getError(MeshHandle handle) const;
+
+    /**
+     * @brief Makes the handle stale. The mesh is destroyed a few frames later, when the GPU is done with it.
+     * Loading the same path again starts a new load.
+     */
+    void unloadMesh(MeshHandle handle);
+
+    /**
+     * @brief Starts loading a texture (.ktx2 or .dds). Its images are uploaded one by one through a pixel buffer.
+     */
+    TextureHandle loadTexture(const std::string& path);
+
+    /**
+     * @brief Returns the texture, or a white 1x1 placeholder when it's not ready
+     */
+    Texture& getTexture(TextureHandle handle);
+    AssetState getState(TextureHandle handle) const;
+    const std::string& getError(TextureHandle handle) const;
+    void unloadTexture(TextureHandle handle);
+
+    /**
+     * @brief Sets how much update() may upload per call
+     * @param milliseconds : time budget. One slice is always uploaded, so progress is guaranteed.
+     * @param bytes : byte budget
+     */
+    void setUploadBudget(double milliseconds, std::size_t bytes);
+
+    /**
+     * @brief Moves decoded assets to the GPU within the budget and destroys the ones unloaded long enough ago.
+     * Meshes and textures alternate, so a long mesh queue doesn't hold textures back. Call once per frame on the GL thread.
+     */
+    void update();
+
+    /**
+     * @brief Number of assets not yet Ready nor Failed
+     */
+    std::size_t pendingCount() const;
+
+private:
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    //Output of the worker threads
+    struct DecodedMesh {
+        MeshHandle handle;
+        std::unique_ptr<MeshFile> file; //Keeps the mapping alive for .e3dmesh
+        MeshData data; //Decoded .obj
+        MeshLayout layout;
+        const char* vertexData = nullptr;
+        std::size_t vertexBytes = 0;
+        const char* indexData = nullptr;
+        std::size_t indexBytes = 0;
+        std::string error;
+    };
+
+    struct DecodedTexture {
+        TextureHandle handle;
+        std::unique_ptr<TextureFile> file;
+        std::string error;
+    };
+
+    //Upload in progress on the GL thread
+    struct PendingUpload {
+        std::unique_ptr<DecodedMesh> mesh;
+        VertexBuffer vertices, indices;
+        std::size_t vertexDone = 0, indexDone = 0;
+    };
+
+    struct PendingTextureUpload {
+        std::unique_ptr<TextureFile> file;
+        std::unique_ptr<Texture> texture;
+        TextureHandle handle;
+        unsigned int level = 0, image = 0; //Next image to upload, image = layer * faces + face
+    };
+
+    struct MeshEntry {
+        explicit MeshEntry(const std::string& path) : path(path) {}
+        std::string path;
+        AssetState state = AssetState::Loading;
+        std::unique_ptr<Mesh> mesh;
+        std::string error;
+    };
+
+    struct TextureEntry {
+        explicit TextureEntry(const std::string& path) : path(path) {}
+        std::string path;
+        AssetState state = AssetState::Loading;
+        std::unique_ptr<Texture> texture;
+        std::string error;
+    };
+
+    void decodeMesh(MeshHandle handle, const std::string& path);
+    void decodeTexture(TextureHandle handle, const std::string& path);
+    bool uploadSlice(PendingUpload& upload, std::size_t& bytesLeft);
+    bool uploadImage(PendingTextureUpload& upload, std::size_t& bytesLeft);
+    void jobStarted();
+    void jobFinished();
+
+    JobSystem& jobs;
+    std::unique_ptr<Mesh> placeholderMesh;
+    std::unique_ptr<Texture> placeholderTexture;
+
+    //GL thread only
+    ResourcePool<MeshEntry, Mesh> meshes;
+    std::unordered_map<std::string, MeshHandle> meshByPath;
+    std::deque<PendingUpload> uploads;
+    ResourcePool<TextureEntry, Texture> textures;
+    std::unordered_map<std::string, TextureHandle> textureByPath;
+    std::deque<PendingTextureUpload> textureUploads;
+    bool textureTurn = false; //The queues take turns, across frames too, so neither starves the other
+    unsigned int stagingBuffer = 0; //GL_PIXEL_UNPACK_BUFFER, orphaned for every image
+    double budgetMilliseconds = 2.0;
+    std::size_t budgetBytes = 8 << 20;
+
+    //Shared with the workers
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<std::unique_ptr<DecodedMesh>> decoded;
+    std::vector<std::unique_ptr<DecodedTexture>> decodedTextures;
+    unsigned int inFlight = 0;
+};
+
+#endif // ASSETMANAGER_H
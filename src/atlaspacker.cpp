@@ -0,0 +1,129 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "atlaspacker.h"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+SkylinePacker::SkylinePacker(unsigned int width, unsigned int height)
+    : pageWidth(width), pageHeight(height), skyline{{0, 0, width}} {}
+
+bool SkylinePacker::fit(std::size_t index, unsigned int width, unsigned int height, unsigned int &y) const {
+    if (skyline[index].x + width > pageWidth)
+        return false;
+    y = 0;
+    unsigned int remaining = width;
+    for (std::size_t i = index; remaining > 0; ++i) {
+        y = std::max(y, skyline[i].y);
+        if (y + height > pageHeight)
+            return false;
+        remaining -= std::min(remaining, skyline[i].width);
+    }
+    return true;
+}
+
+bool SkylinePacker::insert(unsigned int width, unsigned int height, unsigned int &x, unsigned int &y) {
+    std::size_t best = skyline.size();
+    unsigned int bestTop = pageHeight + 1, bestWidth = 0;
+    for (std::size_t i = 0; i < skyline.size(); ++i) {
+        unsigned int top;
+        if (!fit(i, width, height, top))
+            continue;
+        //Lowest top edge first, then the narrowest segment to keep wide ones for wide rectangles
+        if (top + height < bestTop || (top + height == bestTop && skyline[i].width < bestWidth)) {
+            best = i;
+            bestTop = top + height;
+            bestWidth = skyline[i].width;
+        }
+    }
+    if (best == skyline.size())
+        return false;
+
+    x = skyline[best].x;
+    y = bestTop - height;
+    skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(best), Segment{x, bestTop, width});
+
+    //Cut the segments now under the rectangle
+    for (std::size_t i = best + 1; i < skyline.size(); ) {
+        const unsigned int end = x + width;
+        if (skyline[i].x >= end)
+            break;
+        const unsigned int segmentEnd = skyline[i].x + skyline[i].width;
+        if (segmentEnd <= end) {
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+        } else {
+            skyline[i].width = segmentEnd - end;
+            skyline[i].x = end;
+            break;
+        }
+    }
+    //Merge neighbors at the same height
+    for (std::size_t i = 0; i + 1 < skyline.size(); ) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i) + 1);
+        } else {
+            ++i;
+        }
+    }
+    usedArea += static_cast<unsigned long long>(width) * height;
+    return true;
+}
+
+float SkylinePacker::occupancy() const {
+    return static_cast<float>(static_cast<double>(usedArea) / (static_cast<double>(pageWidth) * pageHeight));
+}
+
+std::vector<PackedRect> packRects(const std::vector<PackedRect> &sizes, unsigned int pageWidth, unsigned int pageHeight,
+                                  unsigned int &pageCount) {
+    //Tallest first, then widest : the skyline stays flat longer
+    std::vector<std::size_t> order(sizes.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        if (sizes[a].height != sizes[b].height)
+            return sizes[a].height > sizes[b].height;
+        return sizes[a].width > sizes[b].width;
+    });
+
+    std::vector<PackedRect> result(sizes.size());
+    std::vector<std::unique_ptr<SkylinePacker>> pages;
+    for (std::size_t index : order) {
+        PackedRect rect = sizes[index];
+        if (rect.width > pageWidth || rect.height > pageHeight)
+            throw std::runtime_error("packRects : " + std::to_string(rect.width) + "x" + std::to_string(rect.height)
+                                     + " doesn't fit in a " + std::to_string(pageWidth) + "x" + std::to_string(pageHeight) + " page");
+        rect.page = 0;
+        while (rect.page < pages.size() && !pages[rect.page]->insert(rect.width, rect.height, rect.x, rect.y))
+            ++rect.page;
+        if (rect.page == pages.size()) {
+            pages.push_back(std::make_unique<SkylinePacker>(pageWidth, pageHeight));
+            pages.back()->insert(rect.width, rect.height, rect.x, rect.y);
+        }
+        result[index] = rect;
+    }
+    pageCount = static_cast<unsigned int>(pages.size());
+    return result;
+}
@@ -0,0 +1,83 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef ATLASPACKER_H
+#define ATLASPACKER_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Rectangle placed in an atlas page, in texels
+ */
+struct PackedRect
+{
+    unsigned int x, y, width, height;
+    unsigned int page;
+};
+
+/**
+ * @brief Skyline bin packer for one page : the top edge of the packed rectangles is kept as a list of
+ * horizontal segments, and each rectangle goes where its top edge ends up the lowest (bottom-left rule).
+ *
+ * Less dense than maxrects on random sizes, but much cheaper, and close on the mostly square textures of atlases.
+ */
+class SkylinePacker
+{
+public:
+    SkylinePacker(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Finds room for a rectangle
+     * @return false if it doesn't fit anymore, the page being left unchanged
+     */
+    bool insert(unsigned int width, unsigned int height, unsigned int& x, unsigned int& y);
+
+    /**
+     * @brief Fraction of the page covered by rectangles, in [0, 1]
+     */
+    float occupancy() const;
+
+private:
+    struct Segment {
+        unsigned int x, y, width;
+    };
+
+    /** Lowest y at which a rectangle starting at segment index fits, or false */
+    bool fit(std::size_t index, unsigned int width, unsigned int height, unsigned int& y) const;
+
+    unsigned int pageWidth, pageHeight;
+    unsigned long long usedArea = 0;
+    std::vector<Segment> skyline;
+};
+
+/**
+ * @brief packRects : places rectangles over as many pages as needed, largest first, each one going in the first page
+ * with room for it
+ * @return one placement per size, in the same order
+ * @throw std::runtime_error if a rectangle is larger than a page
+ */
+std::vector<PackedRect> packRects(const std::vector<PackedRect>& sizes, unsigned int pageWidth, unsigned int pageHeight,
+                                  unsigned int& pageCount);
+
+#endif // ATLASPACKER_H
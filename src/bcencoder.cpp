@@ -0,0 +1,421 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "bcencoder.h"
+#include "jobsystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BCENCODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/** Texels of a block, one array per channel. Unused channels are left at 0 so that they don't count in errors. */
+struct BlockTexels {
+    alignas(16) float c[4][16];
+};
+
+struct Endpoints {
+    float e[2][4];
+};
+
+BlockTexels loadTexels(const unsigned char* rgba, int channels) {
+    BlockTexels texels = {};
+    for (int i = 0; i < 16; ++i)
+        for (int c = 0; c < channels; ++c)
+            texels.c[c][i] = rgba[i * 4 + c];
+    return texels;
+}
+
+/**
+ * Picks the closest palette entry for every texel and returns the total squared error.
+ * The SSE2 path handles 4 texels at once and keeps the best index with compare masks.
+ */
+float fitIndices(const BlockTexels& texels, const float (*palette)[4], int count, unsigned char indices[16]) {
+#ifdef BCENCODER_SSE2
+    __m128 total = _mm_setzero_ps();
+    for (int t = 0; t < 16; t += 4) {
+        const __m128 r = _mm_load_ps(texels.c[0] + t), g = _mm_load_ps(texels.c[1] + t);
+        const __m128 b = _mm_load_ps(texels.c[2] + t), a = _mm_load_ps(texels.c[3] + t);
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128i bestIndex = _mm_setzero_si128();
+        for (int p = 0; p < count; ++p) {
+            __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette[p][0])), dg = _mm_sub_ps(g, _mm_set1_ps(palette[p][1]));
+            __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette[p][2])), da = _mm_sub_ps(a, _mm_set1_ps(palette[p][3]));
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dr, dr), _mm_mul_ps(dg, dg)),
+                                  _mm_add_ps(_mm_mul_ps(db, db), _mm_mul_ps(da, da)));
+            __m128i closer = _mm_castps_si128(_mm_cmplt_ps(d, best));
+            bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(p)), _mm_andnot_si128(closer, bestIndex));
+            best = _mm_min_ps(best, d);
+        }
+        total = _mm_add_ps(total, best);
+        alignas(16) std::int32_t chosen[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(chosen), bestIndex);
+        for (int i = 0; i < 4; ++i)
+            indices[t + i] = static_cast<unsigned char>(chosen[i]);
+    }
+    alignas(16) float sums[4];
+    _mm_store_ps(sums, total);
+    return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+    float total = 0;
+    for (int t = 0; t < 16; ++t) {
+        float best = std::numeric_limits<float>::max();
+        for (int p = 0; p < count; ++p) {
+            float d = 0;
+            for (int c = 0; c < 4; ++c) {
+                float diff = texels.c[c][t] - palette[p][c];
+                d += diff * diff;
+            }
+            if (d < best) {
+                best = d;
+                indices[t] = static_cast<unsigned char>(p);
+            }
+        }
+        total += best;
+    }
+    return total;
+#endif
+}
+
+/** Endpoints at both ends of the principal axis of the texels, found by power iteration on the covariance. */
+Endpoints principalEndpoints(const BlockTexels& texels, int channels) {
+    float mean[4] = {};
+    for (int c = 0; c < channels; ++c) {
+        for (int i = 0; i < 16; ++i)
+            mean[c] += texels.c[c][i];
+        mean[c] /= 16;
+    }
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; ++i)
+        for (int a = 0; a < channels; ++a)
+            for (int b = a; b < channels; ++b)
+                covariance[a][b] += (texels.c[a][i] - mean[a]) * (texels.c[b][i] - mean[b]);
+    for (int a = 0; a < channels; ++a)
+        for (int b = 0; b < a; ++b)
+            covariance[a][b] = covariance[b][a];
+
+    float axis[4] = {1, 1, 1, 1};
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {}, length = 0;
+        for (int a = 0; a < channels; ++a) {
+            for (int b = 0; b < channels; ++b)
+                next[a] += covariance[a][b] * axis[b];
+            length = std::max(length, std::abs(next[a]));
+        }
+        if (length < 1e-6f)
+            break; //Uniform block : any axis works
+        for (int a = 0; a < channels; ++a)
+            axis[a] = next[a] / length;
+    }
+
+    float minT = std::numeric_limits<float>::max(), maxT = -minT, axisLength = 0;
+    for (int c = 0; c < channels; ++c)
+        axisLength += axis[c] * axis[c];
+    for (int i = 0; i < 16; ++i) {
+        float t = 0;
+        for (int c = 0; c < channels; ++c)
+            t += (texels.c[c][i] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    Endpoints endpoints = {};
+    for (int c = 0; c < channels; ++c) {
+        endpoints.e[0][c] = std::min(255.f, std::max(0.f, mean[c] + axis[c] * minT / axisLength));
+        endpoints.e[1][c] = std::min(255.f, std::max(0.f, mean[c] + axis[c] * maxT / axisLength));
+    }
+    return endpoints;
+}
+
+/**
+ * Least squares endpoints for fixed indices, each palette entry k being (1 - weights[k]) * e0 + weights[k] * e1.
+ * @return false if the system is singular (all texels on the same entry), endpoints being left untouched
+ */
+bool refineEndpoints(const BlockTexels& texels, int channels, const unsigned char indices[16], const float* weights,
+                     Endpoints& endpoints) {
+    float aa = 0, ab = 0, bb = 0, ax[4] = {}, bx[4] = {};
+    for (int i = 0; i < 16; ++i) {
+        float b = weights[indices[i]], a = 1 - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int c = 0; c < channels; ++c) {
+            ax[c] += a * texels.c[c][i];
+            bx[c] += b * texels.c[c][i];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f)
+        return false;
+    for (int c = 0; c < channels; ++c) {
+        endpoints.e[0][c] = std::min(255.f, std::max(0.f, (bb * ax[c] - ab * bx[c]) / determinant));
+        endpoints.e[1][c] = std::min(255.f, std::max(0.f, (aa * bx[c] - ab * ax[c]) / determinant));
+    }
+    return true;
+}
+
+void writeBits(unsigned char* block, unsigned int& position, std::uint32_t value, unsigned int bits) {
+    for (unsigned int i = 0; i < bits; ++i, ++position)
+        if (value >> i & 1)
+            block[position / 8] |= static_cast<unsigned char>(1u << (position % 8));
+}
+
+//BC1 / color part of BC3
+
+//Weight of the second endpoint for each index, in 4-color mode
+const float bc1Weights[4] = {0, 1, 1 / 3.f, 2 / 3.f};
+
+std::uint16_t packRgb565(const float* color) {
+    auto quantize = [](float v, int maxValue) {return std::min(maxValue, std::max(0, static_cast<int>(v * maxValue / 255 + 0.5f)));};
+    return static_cast<std::uint16_t>(quantize(color[0], 31) << 11 | quantize(color[1], 63) << 5 | quantize(color[2], 31));
+}
+
+void unpackRgb565(std::uint16_t color, float* out) {
+    int r = color >> 11, g = color >> 5 & 63, b = color & 31;
+    out[0] = static_cast<float>(r << 3 | r >> 2);
+    out[1] = static_cast<float>(g << 2 | g >> 4);
+    out[2] = static_cast<float>(b << 3 | b >> 2);
+    out[3] = 0;
+}
+
+void encodeColorBlock(const unsigned char* rgba, unsigned char* block) {
+    const BlockTexels texels = loadTexels(rgba, 3);
+    Endpoints endpoints = principalEndpoints(texels, 3);
+
+    float bestError = std::numeric_limits<float>::max();
+    std::uint16_t bestColors[2] = {};
+    unsigned char bestIndices[16] = {};
+    for (int iteration = 0; iteration < 2; ++iteration) {
+        //The first endpoint is the brightest one so that the 4-color mode (color0 > color1) is used
+        std::uint16_t colors[2] = {packRgb565(endpoints.e[1]), packRgb565(endpoints.e[0])};
+        float palette[4][4];
+        unpackRgb565(colors[0], palette[0]);
+        unpackRgb565(colors[1], palette[1]);
+        for (int c = 0; c < 4; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        unsigned char indices[16];
+        float error = fitIndices(texels, palette, 4, indices);
+        if (error < bestError) {
+            bestError = error;
+            std::copy(colors, colors + 2, bestColors);
+            std::copy(indices, indices + 16, bestIndices);
+        }
+        if (error == 0 || !refineEndpoints(texels, 3, indices, bc1Weights, endpoints))
+            break;
+        std::swap(endpoints.e[0], endpoints.e[1]); //Refined endpoints are in palette order
+    }
+
+    if (bestColors[0] < bestColors[1]) {
+        std::swap(bestColors[0], bestColors[1]);
+        for (unsigned char& index : bestIndices)
+            index ^= 1;
+    } else if (bestColors[0] == bestColors[1]) {
+        std::fill(bestIndices, bestIndices + 16, 0);
+    }
+    std::memset(block, 0, 8);
+    std::memcpy(block, bestColors, 4); //Little endian, like the format
+    unsigned int position = 32;
+    for (unsigned char index : bestIndices)
+        writeBits(block, position, index, 2);
+}
+
+//BC4 / alpha part of BC3
+
+//Weight of the second endpoint for each index, in 8-value mode (a0 > a1)
+const float bc4Weights[8] = {0, 1, 1 / 7.f, 2 / 7.f, 3 / 7.f, 4 / 7.f, 5 / 7.f, 6 / 7.f};
+
+void encodeSingleChannel(const unsigned char* rgba, int channel, unsigned char* block) {
+    BlockTexels texels = {};
+    float minValue = 255, maxValue = 0;
+    for (int i = 0; i < 16; ++i) {
+        texels.c[0][i] = rgba[i * 4 + channel];
+        minValue = std::min(minValue, texels.c[0][i]);
+        maxValue = std::max(maxValue, texels.c[0][i]);
+    }
+    std::memset(block, 0, 8);
+    if (minValue == maxValue) {
+        block[0] = block[1] = static_cast<unsigned char>(minValue);
+        return;
+    }
+
+    Endpoints endpoints = {{{maxValue}, {minValue}}};
+    float bestError = std::numeric_limits<float>::max();
+    unsigned char bestValues[2] = {}, bestIndices[16] = {};
+    for (int iteration = 0; iteration < 2; ++iteration) {
+        unsigned char values[2] = {static_cast<unsigned char>(endpoints.e[0][0] + 0.5f),
+                                   static_cast<unsigned char>(endpoints.e[1][0] + 0.5f)};
+        if (values[0] <= values[1])
+            break; //8-value mode needs a0 > a1
+        float palette[8][4] = {};
+        for (int k = 0; k < 8; ++k)
+            palette[k][0] = std::round((1 - bc4Weights[k]) * values[0] + bc4Weights[k] * values[1]);
+        unsigned char indices[16];
+        float error = fitIndices(texels, palette, 8, indices);
+        if (error < bestError) {
+            bestError = error;
+            std::copy(values, values + 2, bestValues);
+            std::copy(indices, indices + 16, bestIndices);
+        }
+        if (error == 0 || !refineEndpoints(texels, 1, indices, bc4Weights, endpoints))
+            break;
+    }
+    block[0] = bestValues[0];
+    block[1] = bestValues[1];
+    unsigned int position = 16;
+    for (unsigned char index : bestIndices)
+        writeBits(block, position, index, 3);
+}
+
+//BC7 mode 6
+
+const float bc7Weights[16] = {0, 4 / 64.f, 9 / 64.f, 13 / 64.f, 17 / 64.f, 21 / 64.f, 26 / 64.f, 30 / 64.f,
+                              34 / 64.f, 38 / 64.f, 43 / 64.f, 47 / 64.f, 51 / 64.f, 55 / 64.f, 60 / 64.f, 1};
+const int bc7IntegerWeights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct Mode6Block {
+    int endpoints[2][4]; //7 bits
+    int pBits[2];
+    unsigned char indices[16];
+    float error;
+};
+
+/** Quantizes the endpoints with every p-bit combination and keeps the best one */
+Mode6Block fitMode6(const BlockTexels& texels, const Endpoints& endpoints) {
+    Mode6Block best = {};
+    best.error = std::numeric_limits<float>::max();
+    for (int p = 0; p < 4; ++p) {
+        Mode6Block candidate = {};
+        candidate.pBits[0] = p & 1;
+        candidate.pBits[1] = p >> 1;
+        int expanded[2][4];
+        for (int e = 0; e < 2; ++e)
+            for (int c = 0; c < 4; ++c) {
+                int v = static_cast<int>((endpoints.e[e][c] - candidate.pBits[e]) / 2 + 0.5f);
+                candidate.endpoints[e][c] = std::min(127, std::max(0, v));
+                expanded[e][c] = candidate.endpoints[e][c] << 1 | candidate.pBits[e];
+            }
+        float palette[16][4];
+        for (int k = 0; k < 16; ++k)
+            for (int c = 0; c < 4; ++c)
+                palette[k][c] = static_cast<float>(((64 - bc7IntegerWeights[k]) * expanded[0][c]
+                                                    + bc7IntegerWeights[k] * expanded[1][c] + 32) >> 6);
+        candidate.error = fitIndices(texels, palette, 16, candidate.indices);
+        if (candidate.error < best.error)
+            best = candidate;
+    }
+    return best;
+}
+
+} // namespace
+
+std::size_t blockBytes(BlockFormat format) {
+    return format == BlockFormat::BC1 || format == BlockFormat::BC4 ? 8 : 16;
+}
+
+void encodeBC1(const unsigned char *rgba, unsigned char *block) {
+    encodeColorBlock(rgba, block);
+}
+
+void encodeBC3(const unsigned char *rgba, unsigned char *block) {
+    encodeSingleChannel(rgba, 3, block);
+    encodeColorBlock(rgba, block + 8);
+}
+
+void encodeBC4(const unsigned char *rgba, int channel, unsigned char *block) {
+    encodeSingleChannel(rgba, channel, block);
+}
+
+void encodeBC5(const unsigned char *rgba, unsigned char *block) {
+    encodeSingleChannel(rgba, 0, block);
+    encodeSingleChannel(rgba, 1, block + 8);
+}
+
+void encodeBC7(const unsigned char *rgba, unsigned char *block) {
+    const BlockTexels texels = loadTexels(rgba, 4);
+    Endpoints endpoints = principalEndpoints(texels, 4);
+    Mode6Block best = fitMode6(texels, endpoints);
+    if (best.error > 0 && refineEndpoints(texels, 4, best.indices, bc7Weights, endpoints)) {
+        Mode6Block refined = fitMode6(texels, endpoints);
+        if (refined.error < best.error)
+            best = refined;
+    }
+
+    //The anchor index is stored without its most significant bit : swap the endpoints if it is set
+    if (best.indices[0] & 8) {
+        for (int c = 0; c < 4; ++c)
+            std::swap(best.endpoints[0][c], best.endpoints[1][c]);
+        std::swap(best.pBits[0], best.pBits[1]);
+        for (unsigned char& index : best.indices)
+            index = static_cast<unsigned char>(15 - index);
+    }
+
+    std::memset(block, 0, 16);
+    unsigned int position = 0;
+    writeBits(block, position, 1 << 6, 7);
+    for (int c = 0; c < 4; ++c)
+        for (int e = 0; e < 2; ++e)
+            writeBits(block, position, static_cast<std::uint32_t>(best.endpoints[e][c]), 7);
+    writeBits(block, position, static_cast<std::uint32_t>(best.pBits[0]), 1);
+    writeBits(block, position, static_cast<std::uint32_t>(best.pBits[1]), 1);
+    writeBits(block, position, best.indices[0], 3);
+    for (int i = 1; i < 16; ++i)
+        writeBits(block, position, best.indices[i], 4);
+}
+
+std::vector<unsigned char> compressImage(const unsigned char *rgba, unsigned int width, unsigned int height,
+                                         BlockFormat format, JobSystem &jobs) {
+    if (width == 0 || height == 0)
+        throw std::runtime_error("compressImage : empty image");
+    const unsigned int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const std::size_t bytes = blockBytes(format);
+    std::vector<unsigned char> result(static_cast<std::size_t>(blocksX) * blocksY * bytes);
+
+    jobs.parallelFor(blocksY, [&](std::size_t by) {
+        unsigned char texels[64];
+        for (unsigned int bx = 0; bx < blocksX; ++bx) {
+            for (unsigned int y = 0; y < 4; ++y)
+                for (unsigned int x = 0; x < 4; ++x) {
+                    std::size_t sx = std::min(bx * 4 + x, width - 1), sy = std::min<std::size_t>(by * 4 + y, height - 1);
+                    std::memcpy(texels + (y * 4 + x) * 4, rgba + (sy * width + sx) * 4, 4);
+                }
+            unsigned char* block = &result[(by * blocksX + bx) * bytes];
+            switch (format) {
+            case BlockFormat::BC1: encodeBC1(texels, block); break;
+            case BlockFormat::BC3: encodeBC3(texels, block); break;
+            case BlockFormat::BC4: encodeBC4(texels, 0, block); break;
+            case BlockFormat::BC5: encodeBC5(texels, block); break;
+            case BlockFormat::BC7: encodeBC7(texels, block); break;
+            }
+        }
+    });
+    return result;
+}
@@ -0,0 +1,71 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef BCENCODER_H
+#define BCENCODER_H
+
+#include <cstddef>
+#include <vector>
+
+class JobSystem;
+
+/**
+ * @brief Block compressed formats produced by the offline encoders
+ */
+enum class BlockFormat {
+    BC1, ///< Opaque RGB, 8 bytes per block
+    BC3, ///< RGBA with interpolated alpha, 16 bytes per block
+    BC4, ///< Single channel (red), 8 bytes per block
+    BC5, ///< Two channels (red, green), typically normal maps, 16 bytes per block
+    BC7  ///< RGBA, high quality, 16 bytes per block
+};
+
+/** @defgroup BCEncoder
+ * CPU encoders for 4x4 blocks. Every encoder reads 16 RGBA8 texels, row by row (64 bytes), and writes
+ * one compressed block. Endpoints come from the principal axis of the texels, then are refined with a least
+ * squares fit on the chosen indices. Index selection uses SSE2 when the compiler targets it.
+ * BC7 only uses mode 6 (one subset, RGBA endpoints with p-bits, 4-bit indices), which is fast and good
+ * enough for most textures, though it can't match a full mode search on blocks with several distinct colors.
+ * @{ */
+
+std::size_t blockBytes(BlockFormat format);
+
+void encodeBC1(const unsigned char* rgba, unsigned char* block);
+void encodeBC3(const unsigned char* rgba, unsigned char* block);
+/** @param channel : 0 to 3, component of the texels to encode */
+void encodeBC4(const unsigned char* rgba, int channel, unsigned char* block);
+void encodeBC5(const unsigned char* rgba, unsigned char* block);
+void encodeBC7(const unsigned char* rgba, unsigned char* block);
+
+/**
+ * @brief compressImage : encodes a whole RGBA8 image, rows of blocks being spread over the jobs
+ * @return blocks row by row, ceil(width / 4) * ceil(height / 4) * blockBytes(format) bytes
+ *
+ * Borders of images whose size isn't a multiple of 4 are filled by repeating the last row and column.
+ */
+std::vector<unsigned char> compressImage(const unsigned char* rgba, unsigned int width, unsigned int height,
+                                         BlockFormat format, JobSystem& jobs);
+
+/** @} */
+
+#endif // BCENCODER_H
@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "clusteredmesh.h"
+#include "frustum.h"
+#include "gpumemory.h"
+#include "mesh.h"
+#include "meshformat.h"
+#include "renderstats.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_inverse.hpp>
+
+ClusteredMesh::ClusteredMesh(const MeshData &data)
+    : clusters(buildMeshlets(data, data.indices)), indexCapacity(data.indices.size())
+{
+    unsigned int buffers[2];
+    glGenBuffers(2, buffers);
+    VertexBuffer vertices(buffers[0]), elements(buffers[1]);
+    indexBuffer = buffers[1];
+
+    vao.initEmpty();
+    vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.id());
+    trackedBufferData(GL_ARRAY_BUFFER, vertices.id(), data.vertices.size() * sizeof(Vertex), data.vertices.data(), GL_STATIC_DRAW, "Clustered mesh");
+    for (const MeshFileAttribute& attribute : defaultVertexLayout()) {
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                              sizeof(Vertex), (void*)(std::size_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+    //Sized for the worst case, everything visible, so that each frame only orphans it
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elements.id());
+    trackedBufferData(GL_ELEMENT_ARRAY_BUFFER, elements.id(), indexCapacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW, "Clustered mesh");
+    glBindVertexArray(0);
+
+    vao.takeVBO(std::move(vertices));
+    vao.takeVBO(std::move(elements));
+}
+
+void ClusteredMesh::draw(const glm::mat4 &viewProjection, const glm::mat4 &model, const glm::vec3 &eye) {
+    //Culled in the space of the mesh, so the meshlet bounds are used as they are
+    const Frustum frustum(viewProjection * model);
+    const glm::vec3 localEye(glm::affineInverse(model) * glm::vec4(eye, 1.0f));
+    FrameVector<unsigned int> indices;
+    indices.reserve(indexCapacity);
+    visible = cullMeshlets(clusters, frustum, localEye, indices);
+    triangles = indices.size() / 3;
+    if (indices.empty())
+        return;
+
+    //GL_COPY_WRITE_BUFFER leaves the VAO bindings alone
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(unsigned int), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0, indices.size() * sizeof(unsigned int), indices.data());
+    vao.bind();
+    RenderStats::frame().countDraw(GL_TRIANGLES, indices.size());
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, nullptr);
+}
+
+std::unique_ptr<ClusteredMesh> loadClusteredMesh(const std::string &path) {
+    //Meshlets are built in index order, which the vertex cache optimization of OBJ files makes spatially coherent
+    return std::make_unique<ClusteredMesh>(loadMeshData(path));
+}
@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef CLUSTEREDMESH_H
+#define CLUSTEREDMESH_H
+
+#include "meshdata.h"
+#include "meshlet.h"
+#include "vertexarray.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <glm/mat4x4.hpp>
+
+/**
+ * @brief GPU mesh drawn through its meshlets : the visible ones are culled on the CPU each frame and their
+ * triangles compacted in a streamed index buffer, so a large mesh only partially in view costs its visible part.
+ * Uses the engine Vertex layout, like Mesh.
+ */
+class ClusteredMesh
+{
+public:
+    /**
+     * @brief Builds the meshlets and uploads the vertices
+     * @pre a GL context is current
+     */
+    explicit ClusteredMesh(const MeshData& data);
+
+    /**
+     * @brief Culls the meshlets, uploads the surviving triangles and draws them with one glDrawElements call
+     * @param viewProjection : projection * view
+     * @param eye : camera position in world space
+     */
+    void draw(const glm::mat4& viewProjection, const glm::mat4& model, const glm::vec3& eye);
+
+    const MeshletData& meshlets() const {return clusters;}
+
+    //Statistics of the last draw()
+    std::size_t visibleMeshlets() const {return visible;}
+    std::size_t visibleTriangles() const {return triangles;}
+
+private:
+    ClusteredMesh(const ClusteredMesh&) = delete;
+    ClusteredMesh& operator=(const ClusteredMesh&) = delete;
+
+    MeshletData clusters;
+    VertexArray vao;
+    unsigned int indexBuffer; //Owned by vao
+    std::size_t indexCapacity; //In indices
+    std::size_t visible = 0;
+    std::size_t triangles = 0;
+};
+
+/**
+ * @brief loadClusteredMesh : loads an OBJ or engine mesh file and splits it in meshlets
+ * @throw std::runtime_error
+ */
+std::unique_ptr<ClusteredMesh> loadClusteredMesh(const std::string& path);
+
+#endif // CLUSTEREDMESH_H
@@ -0,0 +1,67 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "computeshader.h"
+#include "glextensions.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+#include "profiler.h"
+#include "renderstats.h"
+#include "shader.h"
+#include <stdexcept>
+
+ComputeShader::ComputeShader(const std::string &source) {
+    PROFILE_SCOPE("ComputeShader::ComputeShader");
+    unsigned int shader = compileShader(GL_COMPUTE_SHADER, source);
+    program = glCreateProgram();
+    glAttachShader(program, shader);
+    glLinkProgram(program);
+    glDetachShader(program, shader);
+    glDeleteShader(shader);
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char infolog[512];
+        glGetProgramInfoLog(program, 512, nullptr, infolog);
+        glDeleteProgram(program);
+        throw std::runtime_error(std::string("Error linking compute shader : ") + infolog);
+    }
+    GpuMemory::global().allocate(GpuMemoryCategory::Program, program, GpuMemory::programSize(program), "Compute shader");
+}
+
+ComputeShader::~ComputeShader() {
+    GpuDeletionQueue::global().release(GpuResourceType::Program, program);
+}
+
+void ComputeShader::dispatch(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ) {
+    RenderStats& stats = RenderStats::frame();
+    ++stats.programBinds;
+    ++stats.dispatches;
+    glUseProgram(program);
+    glDispatchCompute(groupsX, groupsY, groupsZ);
+}
+
+std::unique_ptr<ComputeShader> makeComputeShaderFromFile(const std::string &path, const std::vector<ShaderDefine> &defines) {
+    return std::make_unique<ComputeShader>(preprocessShader(path, defines).source);
+}
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef COMPUTESHADER_H
+#define COMPUTESHADER_H
+
+#include "shaderpreprocessor.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief OpenGL program made of a single compute shader
+ * @invariant getProgramId() is a valid, linked program
+ * @pre GLEXT_compute
+ */
+class ComputeShader
+{
+public:
+    /**
+     * @brief Compiles and links the source
+     * @throw std::runtime_error on compile or link errors
+     */
+    explicit ComputeShader(const std::string& source);
+    ~ComputeShader();
+
+    unsigned int getProgramId() const {return program;}
+
+    /**
+     * @brief Binds the program and launches groupsX * groupsY * groupsZ work groups.
+     * Memory barriers are left to the caller, who knows how the results are consumed.
+     */
+    void dispatch(unsigned int groupsX, unsigned int groupsY = 1, unsigned int groupsZ = 1);
+
+private:
+    ComputeShader(const ComputeShader&) = delete;
+    ComputeShader& operator=(const ComputeShader&) = delete;
+    unsigned int program;
+};
+
+/**
+ * @brief makeComputeShaderFromFile : reads a compute shader, expanding its #include directives
+ * @param defines : injected right after #version
+ * @throw std::runtime_error
+ */
+std::unique_ptr<ComputeShader> makeComputeShaderFromFile(const std::string& path, const std::vector<ShaderDefine>& defines = {});
+
+#endif // COMPUTESHADER_H
@@ -0,0 +1,202 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "debugdraw.h"
+#include "gpumemory.h"
+#include "renderstats.h"
+#include <glad/glad.h>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const unsigned int glyphWidth = 3, glyphHeight = 5;
+const unsigned int glyphAdvance = glyphWidth + 1;
+
+struct Glyph
+{
+    char character;
+    unsigned char rows[glyphHeight]; //Top row first, 4 is the left column and 1 the right one
+};
+
+//The first glyph is fully covered, shapes are drawn with it
+const Glyph glyphTable[] = {
+    {'\0', {7, 7, 7, 7, 7}}, {' ', {0, 0, 0, 0, 0}},
+    {'0', {7, 5, 5, 5, 7}}, {'1', {2, 6, 2, 2, 7}}, {'2', {7, 1, 7, 4, 7}}, {'3', {7, 1, 3, 1, 7}},
+    {'4', {5, 5, 7, 1, 1}}, {'5', {7, 4, 7, 1, 7}}, {'6', {7, 4, 7, 5, 7}}, {'7', {7, 1, 1, 2, 2}},
+    {'8', {7, 5, 7, 5, 7}}, {'9', {7, 5, 7, 1, 7}},
+    {'A', {2, 5, 7, 5, 5}}, {'B', {6, 5, 6, 5, 6}}, {'C', {3, 4, 4, 4, 3}}, {'D', {6, 5, 5, 5, 6}},
+    {'E', {7, 4, 6, 4, 7}}, {'F', {7, 4, 6, 4, 4}}, {'G', {3, 4, 5, 5, 3}}, {'H', {5, 5, 7, 5, 5}},
+    {'I', {7, 2, 2, 2, 7}}, {'J', {1, 1, 1, 5, 2}}, {'K', {5, 5, 6, 5, 5}}, {'L', {4, 4, 4, 4, 7}},
+    {'M', {5, 7, 7, 5, 5}}, {'N', {6, 5, 5, 5, 5}}, {'O', {2, 5, 5, 5, 2}}, {'P', {6, 5, 6, 4, 4}},
+    {'Q', {2, 5, 5, 6, 3}}, {'R', {6, 5, 6, 5, 5}}, {'S', {3, 4, 2, 1, 6}}, {'T', {7, 2, 2, 2, 2}},
+    {'U', {5, 5, 5, 5, 7}}, {'V', {5, 5, 5, 5, 2}}, {'W', {5, 5, 7, 7, 5}}, {'X', {5, 5, 2, 5, 5}},
+    {'Y', {5, 5, 2, 2, 2}}, {'Z', {7, 1, 2, 4, 7}},
+    {'.', {0, 0, 0, 0, 2}}, {',', {0, 0, 0, 2, 4}}, {':', {0, 2, 0, 2, 0}}, {';', {0, 2, 0, 2, 4}},
+    {'/', {1, 1, 2, 4, 4}}, {'%', {5, 1, 2, 4, 5}}, {'(', {1, 2, 2, 2, 1}}, {')', {4, 2, 2, 2, 4}},
+    {'[', {3, 2, 2, 2, 3}}, {']', {6, 2, 2, 2, 6}}, {'-', {0, 0, 7, 0, 0}}, {'+', {0, 2, 7, 2, 0}},
+    {'=', {0, 7, 0, 7, 0}}, {'_', {0, 0, 0, 0, 7}}, {'*', {0, 5, 2, 5, 0}}, {'#', {5, 7, 5, 7, 5}},
+    {'!', {2, 2, 2, 0, 2}}, {'?', {7, 1, 2, 0, 2}}, {'<', {1, 2, 4, 2, 1}}, {'>', {4, 2, 1, 2, 4}},
+    {'|', {2, 2, 2, 2, 2}}, {'\'', {2, 2, 0, 0, 0}}, {'"', {5, 5, 0, 0, 0}}
+};
+const unsigned int glyphCount = sizeof(glyphTable) / sizeof(glyphTable[0]);
+
+} // namespace
+
+DebugDraw::DebugDraw(unsigned int textScale) : scale(textScale ? textScale : 1)
+{
+    //Glyphs side by side, one column apart
+    const unsigned int width = glyphCount * glyphAdvance;
+    std::vector<unsigned char> pixels(width * glyphHeight, 0);
+    for (unsigned int i = 0; i < glyphCount; ++i)
+        if (glyphTable[i].character == '?')
+            std::memset(glyphs, static_cast<int>(i), sizeof(glyphs));
+    for (unsigned int i = 0; i < glyphCount; ++i) {
+        const Glyph& glyph = glyphTable[i];
+        glyphs[static_cast<unsigned char>(glyph.character)] = static_cast<unsigned char>(i);
+        for (unsigned int y = 0; y < glyphHeight; ++y)
+            for (unsigned int x = 0; x < glyphWidth; ++x)
+                if (glyph.rows[y] & (4 >> x))
+                    pixels[y * width + i * glyphAdvance + x] = 255;
+    }
+    for (char c = 'a'; c <= 'z'; ++c)
+        glyphs[static_cast<unsigned char>(c)] = glyphs[static_cast<unsigned char>(std::toupper(c))];
+    font = std::make_unique<Texture2D>(width, glyphHeight, TextureFormat{GL_R8, GL_RED, GL_UNSIGNED_BYTE}, 1);
+    font->uploadImage(0, 0, pixels.data(), pixels.size());
+    font->setMemoryTag("Debug draw");
+
+    shader = makeShaderFromFile("shaders/debugdraw.vert", "shaders/debugdraw.frag");
+
+    vao.initEmpty();
+    vao.bind();
+    glGenBuffers(1, &vertexBuffer);
+    vao.takeVBO(VertexBuffer(vertexBuffer));
+    glGenBuffers(1, &indexBuffer);
+    vao.takeVBO(VertexBuffer(indexBuffer));
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)offsetof(Point, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Point), (void*)offsetof(Point, texel));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Point), (void*)offsetof(Point, color));
+    glBindVertexArray(0);
+}
+
+void DebugDraw::quad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, glm::vec2 texelMin, glm::vec2 texelMax, DebugColor color) {
+    if (points.capacity() == 0) {
+        //First quad of the batch : from the arena of this frame, sized for the largest batch so far
+        points = FrameVector<Point>();
+        points.reserve(std::max<std::size_t>(capacity, 64) * 4);
+    }
+    //a b
+    //d c
+    points.push_back({a, texelMin, color});
+    points.push_back({b, {texelMax.x, texelMin.y}, color});
+    points.push_back({c, texelMax, color});
+    points.push_back({d, {texelMin.x, texelMax.y}, color});
+}
+
+void DebugDraw::rect(float x, float y, float width, float height, DebugColor color) {
+    const glm::vec2 covered(0.5f); //Center of the first glyph's top left texel
+    quad({x, y}, {x + width, y}, {x + width, y + height}, {x, y + height}, covered, covered, color);
+}
+
+void DebugDraw::line(glm::vec2 from, glm::vec2 to, DebugColor color, float width) {
+    const glm::vec2 direction = to - from;
+    const float length = glm::length(direction);
+    if (length == 0.0f)
+        return;
+    const glm::vec2 side = glm::vec2(-direction.y, direction.x) * (0.5f * width / length);
+    const glm::vec2 covered(0.5f);
+    quad(from - side, to - side, to + side, from + side, covered, covered, color);
+}
+
+float DebugDraw::text(float x, float y, const char *text, DebugColor color) {
+    const float size = static_cast<float>(scale);
+    for (; *text; ++text) {
+        const unsigned char character = static_cast<unsigned char>(*text);
+        if (character != ' ') {
+            const unsigned int glyph = glyphs[character < 128 ? character : '?'];
+            const glm::vec2 texelMin(static_cast<float>(glyph * glyphAdvance), 0.0f);
+            const glm::vec2 texelMax = texelMin + glm::vec2(glyphWidth, glyphHeight);
+            const float right = x + glyphWidth * size, bottom = y + glyphHeight * size;
+            quad({x, y}, {right, y}, {right, bottom}, {x, bottom}, texelMin, texelMax, color);
+        }
+        x += glyphAdvance * size;
+    }
+    return x;
+}
+
+float DebugDraw::textWidth(const char *text) const {
+    return static_cast<float>(std::strlen(text) * glyphAdvance * scale);
+}
+
+void DebugDraw::flush(unsigned int screenWidth, unsigned int screenHeight) {
+    if (points.empty())
+        return;
+
+    const bool depthTest = glIsEnabled(GL_DEPTH_TEST), blend = glIsEnabled(GL_BLEND), cullFace = glIsEnabled(GL_CULL_FACE);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    const unsigned int program = shader->getProgramId(); //Changes when reloaded
+    ++RenderStats::frame().programBinds;
+    glUseProgram(program);
+    glUniform2f(glGetUniformLocation(program, "screenSize"), static_cast<float>(screenWidth), static_cast<float>(screenHeight));
+    glUniform1i(glGetUniformLocation(program, "font"), 0);
+    font->bind(0);
+
+    vao.bind();
+    const std::size_t quads = points.size() / 4;
+    if (quads > capacity) {
+        //The same two triangles for every quad, only rebuilt when the batch grows
+        capacity = std::max(quads, 2 * capacity);
+        std::vector<unsigned int> indices;
+        indices.reserve(capacity * 6);
+        for (unsigned int i = 0; i < capacity * 4; i += 4)
+            for (unsigned int corner : {0u, 3u, 1u, 1u, 3u, 2u})
+                indices.push_back(i + corner);
+        trackedBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBuffer, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW, "Debug draw");
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    //Orphaned every frame so that the driver never waits for the previous draw
+    trackedBufferData(GL_ARRAY_BUFFER, vertexBuffer, capacity * 4 * sizeof(Point), nullptr, GL_STREAM_DRAW, "Debug draw");
+    glBufferSubData(GL_ARRAY_BUFFER, 0, points.size() * sizeof(Point), points.data());
+    RenderStats::frame().countDraw(GL_TRIANGLES, quads * 6);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(quads * 6), GL_UNSIGNED_INT, nullptr);
+    glBindVertexArray(0);
+    points = FrameVector<Point>();
+
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+    if (cullFace)
+        glEnable(GL_CULL_FACE);
+    if (!blend)
+        glDisable(GL_BLEND);
+}
@@ -0,0 +1,106 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef DEBUGDRAW_H
+#define DEBUGDRAW_H
+
+#include "framearena.h"
+#include "shader.h"
+#include "texture.h"
+#include "vertexarray.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <glm/vec2.hpp>
+
+struct DebugColor
+{
+    unsigned char r, g, b, a;
+};
+
+/**
+ * @brief Immediate mode 2D drawing for debug displays : text, rectangles and lines, positioned in pixels from the
+ * top left corner of the window. Everything queued during a frame is drawn by flush(), in a single draw call.
+ *
+ * Text uses a built-in 3x5 pixel font scaled by an integer factor. It has digits, upper case letters and the usual
+ * punctuation; lower case letters are drawn upper case, and other characters as '?'.
+ *
+ * \code
+ * debugDraw.rect(8, 8, 200, 40, {0, 0, 0, 160});
+ * debugDraw.text(12, 12, "FRAME 16.6 MS", {255, 255, 255, 255});
+ * debugDraw.flush(window.getSize().x, window.getSize().y);
+ * \endcode
+ */
+class DebugDraw
+{
+public:
+    /**
+     * @param textScale : size in pixels of a pixel of the font
+     * @pre an OpenGL context is current
+     */
+    explicit DebugDraw(unsigned int textScale = 2);
+
+    void rect(float x, float y, float width, float height, DebugColor color);
+    void line(glm::vec2 from, glm::vec2 to, DebugColor color, float width = 1.0f);
+
+    /**
+     * @brief Queues a line of text, its top left corner at (x, y)
+     * @return the x coordinate following the last character
+     */
+    float text(float x, float y, const char* text, DebugColor color);
+
+    float textWidth(const char* text) const;
+    float lineHeight() const {return 7.0f * scale;}
+
+    /**
+     * @brief Draws everything queued since the last flush, over the current framebuffer
+     *
+     * Leaves depth testing, blending and face culling as they were. The program, VAO and texture unit 0 bindings
+     * are changed.
+     */
+    void flush(unsigned int screenWidth, unsigned int screenHeight);
+
+private:
+    DebugDraw(const DebugDraw&) = delete;
+    DebugDraw& operator=(const DebugDraw&) = delete;
+
+    struct Point
+    {
+        glm::vec2 position;
+        glm::vec2 texel;
+        DebugColor color;
+    };
+
+    void quad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, glm::vec2 texelMin, glm::vec2 texelMax, DebugColor color);
+
+    std::unique_ptr<Shader> shader;
+    std::unique_ptr<Texture2D> font;
+    VertexArray vao;
+    unsigned int vertexBuffer = 0, indexBuffer = 0; //Owned by vao
+    std::size_t capacity = 0; //In quads
+    FrameVector<Point> points; //Corners of the quads queued for the next flush, 4 each
+    unsigned char glyphs[128]; //Glyph index of each ASCII character
+    unsigned int scale;
+};
+
+#endif // DEBUGDRAW_H
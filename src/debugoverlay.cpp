@@ -0,0 +1,201 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "debugoverlay.h"
+#include "framearena.h"
+#include "gpudeletionqueue.h"
+#include "glextensions.h"
+#include "gpumemory.h"
+#include "jobsystem.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+const float refreshMilliseconds = 250.0f;
+const float graphMilliseconds = 50.0f; //Top of the graph
+const float graphHeight = 60.0f, barWidth = 2.0f;
+const float margin = 8.0f, padding = 6.0f;
+
+const DebugColor white = {255, 255, 255, 255};
+const DebugColor grey = {170, 170, 170, 255};
+const DebugColor cpuColor = {255, 170, 60, 255};
+const DebugColor gpuColor = {80, 200, 255, 255};
+const DebugColor background = {0, 0, 0, 170};
+
+//Green within a 60 Hz frame, yellow within two, red beyond
+DebugColor budgetColor(float milliseconds) {
+    if (milliseconds <= 1000.0f / 60.0f)
+        return {70, 190, 70, 200};
+    if (milliseconds <= 2000.0f / 60.0f)
+        return {220, 200, 60, 200};
+    return {220, 60, 50, 200};
+}
+
+std::string formatBytes(double bytes) {
+    const char* units[] = {"B", "KB", "MB", "GB"};
+    unsigned int unit = 0;
+    while (bytes >= 1024.0 && unit < 3) {
+        bytes /= 1024.0;
+        ++unit;
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), unit ? "%.1f %s" : "%.0f %s", bytes, units[unit]);
+    return text;
+}
+
+std::string formatCount(std::uint64_t count) {
+    char text[32];
+    if (count >= 1000000)
+        std::snprintf(text, sizeof(text), "%.2fM", count / 1e6);
+    else if (count >= 10000)
+        std::snprintf(text, sizeof(text), "%.1fK", count / 1e3);
+    else
+        std::snprintf(text, sizeof(text), "%u", static_cast<unsigned int>(count));
+    return text;
+}
+
+//As reported by the driver, other processes included
+std::string videoMemoryText() {
+    if (GLEXT_gpu_memory_info) {
+        int totalKiB = 0, availableKiB = 0;
+        glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &totalKiB);
+        glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &availableKiB);
+        return "VIDEO MEMORY " + formatBytes(1024.0 * (totalKiB - availableKiB)) + " USED OF " + formatBytes(1024.0 * totalKiB);
+    }
+    if (GLEXT_meminfo) {
+        int freeKiB[4] = {0, 0, 0, 0};
+        glGetIntegerv(GL_VBO_FREE_MEMORY_ATI, freeKiB);
+        return "BUFFER MEMORY " + formatBytes(1024.0 * freeKiB[0]) + " FREE";
+    }
+    return "VIDEO MEMORY N/A";
+}
+
+} // namespace
+
+DebugOverlay::DebugOverlay() : history(overlayHistory, FrameTimes{0, 0, 0}) {}
+
+void DebugOverlay::addFrame(float frameMilliseconds, float cpuMilliseconds, const RenderStats &stats, const GpuProfiler &gpu) {
+    const float gpuMilliseconds = gpu.results().empty() ? 0.0f : static_cast<float>(gpu.results().front().milliseconds);
+    history[next] = {frameMilliseconds, cpuMilliseconds, gpuMilliseconds};
+    next = (next + 1) % overlayHistory;
+
+    sum.frame += frameMilliseconds;
+    sum.cpu += cpuMilliseconds;
+    sum.gpu += gpuMilliseconds;
+    ++summedFrames;
+    if (sum.frame >= refreshMilliseconds || lines.empty()) {
+        refreshText(stats, gpu);
+        sum = {0, 0, 0};
+        summedFrames = 0;
+    }
+}
+
+void DebugOverlay::refreshText(const RenderStats &stats, const GpuProfiler &gpu) {
+    const float frames = static_cast<float>(std::max(summedFrames, 1u));
+    const float frame = sum.frame / frames;
+    char text[128];
+    lines.clear();
+
+    std::snprintf(text, sizeof(text), "FRAME %.2f MS (%.0f FPS)", frame, frame > 0.0f ? 1000.0f / frame : 0.0f);
+    lines.push_back({text, white});
+    std::snprintf(text, sizeof(text), "CPU %.2f MS", sum.cpu / frames);
+    lines.push_back({text, cpuColor});
+    if (gpu.supported())
+        std::snprintf(text, sizeof(text), "GPU %.2f MS", sum.gpu / frames);
+    else
+        std::snprintf(text, sizeof(text), "GPU N/A");
+    lines.push_back({text, gpuColor});
+    for (const GpuProfiler::Timing& pass : gpu.results()) {
+        if (pass.depth == 0)
+            continue;
+        std::snprintf(text, sizeof(text), "%*s%s %.2f MS", static_cast<int>(2 * pass.depth), "", pass.name, pass.milliseconds);
+        lines.push_back({text, gpuColor});
+    }
+
+    lines.push_back({"DRAWS " + std::to_string(stats.drawCalls) + "  TRIANGLES " + formatCount(stats.triangles)
+                     + "  DISPATCHES " + std::to_string(stats.dispatches), white});
+    std::snprintf(text, sizeof(text), "STATE CHANGES %u : PROGRAMS %u, VAOS %u, TEXTURES %u", stats.stateChanges(),
+                  stats.programBinds, stats.vertexArrayBinds, stats.textureBinds);
+    lines.push_back({text, white});
+    const GpuMemory& memory = GpuMemory::global();
+    const GpuMemory::Usage total = memory.total();
+    lines.push_back({"GPU MEMORY " + formatBytes(total.bytes) + " (PEAK " + formatBytes(total.peak) + "), "
+                     + std::to_string(GpuDeletionQueue::global().pendingCount()) + " OBJECTS AWAITING DELETION", white});
+    lines.push_back({"  BUFFERS " + formatBytes(memory.usage(GpuMemoryCategory::Buffer).bytes)
+                     + "  TEXTURES " + formatBytes(memory.usage(GpuMemoryCategory::Texture).bytes
+                                                   + memory.usage(GpuMemoryCategory::Renderbuffer).bytes)
+                     + "  PROGRAMS " + formatBytes(memory.usage(GpuMemoryCategory::Program).bytes), white});
+    lines.push_back({videoMemoryText(), grey});
+    const ArenaStats arena = FrameArena::global().lastFrame();
+    std::snprintf(text, sizeof(text), "FRAME ARENA %s / %s, %u ALLOCATIONS, %u OVERFLOWS", formatBytes(arena.used).c_str(),
+                  formatBytes(arena.capacity).c_str(), arena.allocations, arena.overflows);
+    lines.push_back({text, arena.overflows > 0 ? cpuColor : grey});
+    JobSystem& jobs = JobSystem::global();
+    std::snprintf(text, sizeof(text), "JOBS %.0f%% OF %u WORKERS", 100.0f * jobs.utilization(), jobs.threadCount());
+    lines.push_back({text, grey});
+}
+
+void DebugOverlay::draw(unsigned int screenWidth, unsigned int screenHeight) {
+    const float lineHeight = debugDraw.lineHeight();
+    const float graphWidth = overlayHistory * barWidth;
+    float width = graphWidth;
+    for (const Line& line : lines)
+        width = std::max(width, debugDraw.textWidth(line.text.c_str()));
+    const float height = lines.size() * lineHeight + padding + graphHeight;
+    debugDraw.rect(margin, margin, width + 2 * padding, height + 2 * padding, background);
+
+    float y = margin + padding;
+    for (const Line& line : lines) {
+        debugDraw.text(margin + padding, y, line.text.c_str(), line.color);
+        y += lineHeight;
+    }
+
+    //Frame times as bars, oldest on the left, CPU and GPU times as curves over them
+    y += padding;
+    const float left = margin + padding, bottom = y + graphHeight;
+    const float pixelsPerMillisecond = graphHeight / graphMilliseconds;
+    glm::vec2 previousCpu, previousGpu;
+    for (unsigned int i = 0; i < overlayHistory; ++i) {
+        const FrameTimes& times = history[(next + i) % overlayHistory];
+        const float x = left + i * barWidth;
+        const float barHeight = std::min(times.frame, graphMilliseconds) * pixelsPerMillisecond;
+        debugDraw.rect(x, bottom - barHeight, barWidth, barHeight, budgetColor(times.frame));
+
+        const glm::vec2 cpu(x + 0.5f * barWidth, bottom - std::min(times.cpu, graphMilliseconds) * pixelsPerMillisecond);
+        const glm::vec2 gpu(x + 0.5f * barWidth, bottom - std::min(times.gpu, graphMilliseconds) * pixelsPerMillisecond);
+        if (i > 0) {
+            debugDraw.line(previousCpu, cpu, cpuColor);
+            debugDraw.line(previousGpu, gpu, gpuColor);
+        }
+        previousCpu = cpu;
+        previousGpu = gpu;
+    }
+    for (float budget : {1000.0f / 60.0f, 2000.0f / 60.0f}) {
+        const float lineY = bottom - budget * pixelsPerMillisecond;
+        debugDraw.line({left, lineY}, {left + graphWidth, lineY}, {255, 255, 255, 90});
+    }
+
+    debugDraw.flush(screenWidth, screenHeight);
+}
@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef DEBUGOVERLAY_H
+#define DEBUGOVERLAY_H
+
+#include "debugdraw.h"
+#include "gpuprofiler.h"
+#include "renderstats.h"
+#include <string>
+#include <vector>
+
+const unsigned int overlayHistory = 120; ///< Frames shown by the frame time graph
+
+/**
+ * @brief On-screen statistics : frame time graph, CPU and GPU times per pass, draw calls, triangles and state
+ * changes, video memory and job system load.
+ *
+ * The graph is updated every frame, the figures a few times per second (averaged in between) so that they can be
+ * read. Feed it and draw it only while it is shown, it then costs one draw call.
+ */
+class DebugOverlay
+{
+public:
+    /**
+     * @pre an OpenGL context is current
+     */
+    DebugOverlay();
+
+    /**
+     * @brief Adds the frame being drawn
+     * @param frameMilliseconds : time since the previous frame
+     * @param cpuMilliseconds : time the main thread spent on this frame, presentation excluded
+     * @param stats : counters of this frame
+     * @param gpu : its latest results, a few frames old
+     */
+    void addFrame(float frameMilliseconds, float cpuMilliseconds, const RenderStats& stats, const GpuProfiler& gpu);
+
+    void draw(unsigned int screenWidth, unsigned int screenHeight);
+
+private:
+    struct FrameTimes
+    {
+        float frame, cpu, gpu;
+    };
+    struct Line
+    {
+        std::string text;
+        DebugColor color;
+    };
+
+    void refreshText(const RenderStats& stats, const GpuProfiler& gpu);
+
+    DebugDraw debugDraw;
+    std::vector<FrameTimes> history; //Ring of overlayHistory frames
+    unsigned int next = 0; //Oldest frame of history
+    std::vector<Line> lines;
+    FrameTimes sum = {0, 0, 0}; //Since the last refresh
+    unsigned int summedFrames = 0;
+};
+
+#endif // DEBUGOVERLAY_H
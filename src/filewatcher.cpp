@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "filewatcher.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+
+FileWatcher::FileWatcher() : fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+}
+
+FileWatcher::~FileWatcher() {
+    if (fd >= 0)
+        close(fd);
+}
+
+void FileWatcher::watch(const std::string &path) {
+    if (!files.insert(path).second || fd < 0)
+        return;
+    std::size_t slash = path.find_last_of('/');
+    std::string prefix = slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    if (directories.count(prefix))
+        return;
+    int wd = inotify_add_watch(fd, prefix.empty() ? "." : prefix.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+    if (wd < 0)
+        return;
+    directories[prefix] = wd;
+    prefixes[wd] = prefix;
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::unordered_set<std::string> changed;
+    alignas(inotify_event) char buffer[4096];
+    while (fd >= 0) {
+        ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0) //EAGAIN : nothing more for now
+            break;
+        for (char* p = buffer; p < buffer + length; ) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            auto prefix = prefixes.find(event->wd);
+            if (prefix == prefixes.end() || event->len == 0)
+                continue;
+            std::string path = prefix->second + event->name;
+            if (files.count(path))
+                changed.insert(path);
+        }
+    }
+    return std::vector<std::string>(changed.begin(), changed.end());
+}
+
+#else
+
+namespace {
+
+long long modificationTime(const std::string& path) {
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? static_cast<long long>(info.st_mtime) : -1;
+}
+
+} // namespace
+
+FileWatcher::FileWatcher() {}
+
+FileWatcher::~FileWatcher() {}
+
+void FileWatcher::watch(const std::string &path) {
+    if (files.insert(path).second)
+        modificationTimes[path] = modificationTime(path);
+}
+
+std::vector<std::string> FileWatcher::poll() {
+    std::vector<std::string> changed;
+    for (auto& file : modificationTimes) {
+        long long time = modificationTime(file.first);
+        if (time != file.second) {
+            file.second = time;
+            changed.push_back(file.first);
+        }
+    }
+    return changed;
+}
+
+#endif
@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Reports modifications of a set of files, without blocking.
+ *
+ * Uses inotify on Linux, watching the parent directories so that editors saving through a rename are caught.
+ * Elsewhere, modification times are compared on each poll().
+ */
+class FileWatcher
+{
+public:
+    FileWatcher();
+    ~FileWatcher();
+
+    /**
+     * @brief Adds a file to the watch list. Watching a file twice has no effect.
+     */
+    void watch(const std::string& path);
+
+    /**
+     * @brief Returns the watched files modified since the previous call, each at most once
+     */
+    std::vector<std::string> poll();
+
+private:
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    std::unordered_set<std::string> files;
+#ifdef __linux__
+    int fd = -1;
+    std::unordered_map<std::string, int> directories; //Prefix ("" or ending with '/') to watch descriptor
+    std::unordered_map<int, std::string> prefixes;
+#else
+    std::unordered_map<std::string, long long> modificationTimes;
+#endif
+};
+
+#endif // FILEWATCHER_H
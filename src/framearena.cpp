@@ -0,0 +1,150 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "framearena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+#ifndef NDEBUG
+const unsigned char releasedPattern = 0xDD;
+#endif
+
+char* alignUp(char* pointer, std::size_t alignment) {
+    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(pointer);
+    return pointer + ((alignment - address % alignment) % alignment);
+}
+
+} // namespace
+
+LinearArena::LinearArena(std::size_t capacity) : block(new char[capacity]), capacity(capacity), offset(0), highWater(0), allocations(0)
+{
+    overflow.reserve(16);
+#ifndef NDEBUG
+    std::memset(block, releasedPattern, capacity);
+#endif
+}
+
+LinearArena::~LinearArena() {
+    releaseOverflow();
+    delete[] block;
+}
+
+void* LinearArena::allocate(std::size_t bytes, std::size_t alignment) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t top = offset.load(std::memory_order_relaxed);
+    for (;;) {
+        const std::size_t start = alignUp(block + top, alignment) - block;
+        if (start > capacity || bytes > capacity - start)
+            return allocateOverflow(bytes, alignment);
+        if (offset.compare_exchange_weak(top, start + bytes, std::memory_order_relaxed))
+            return block + start;
+    }
+}
+
+void* LinearArena::allocateOverflow(std::size_t bytes, std::size_t alignment) {
+    char* memory = static_cast<char*>(::operator new(bytes + alignment));
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    try {
+        overflow.push_back(memory);
+    } catch (...) {
+        ::operator delete(memory);
+        throw;
+    }
+    overflowBytes += bytes + alignment - 1; //What it takes in the block in the worst case
+    ++overflowCount;
+    return alignUp(memory, alignment);
+}
+
+void LinearArena::deallocate(void* pointer, std::size_t bytes) {
+    char* memory = static_cast<char*>(pointer);
+    if (memory < block || memory >= block + capacity)
+        return;
+    const std::size_t top = static_cast<std::size_t>(memory - block) + bytes;
+    std::size_t mark = highWater.load(std::memory_order_relaxed);
+    while (mark < top && !highWater.compare_exchange_weak(mark, top, std::memory_order_relaxed)) {}
+    std::size_t expected = top;
+    offset.compare_exchange_strong(expected, static_cast<std::size_t>(memory - block), std::memory_order_relaxed);
+}
+
+void LinearArena::releaseOverflow() {
+    for (void* memory : overflow)
+        ::operator delete(memory);
+    overflow.clear();
+}
+
+void LinearArena::reset() {
+    const std::size_t used = std::max(offset.load(std::memory_order_relaxed), highWater.load(std::memory_order_relaxed));
+    peak = std::max(peak, used + overflowBytes);
+    if (overflowCount > 0) {
+        //Sized for the whole workload of this frame
+        std::size_t grown = capacity;
+        while (grown < used + overflowBytes)
+            grown *= 2;
+        releaseOverflow();
+        char* larger = new char[grown];
+        delete[] block;
+        block = larger;
+        capacity = grown;
+#ifndef NDEBUG
+        std::memset(block, releasedPattern, capacity);
+#endif
+    }
+#ifndef NDEBUG
+    else
+        std::memset(block, releasedPattern, used);
+#endif
+    offset.store(0, std::memory_order_relaxed);
+    highWater.store(0, std::memory_order_relaxed);
+    allocations.store(0, std::memory_order_relaxed);
+    overflowBytes = 0;
+    overflowCount = 0;
+}
+
+ArenaStats LinearArena::stats() const {
+    ArenaStats result;
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    result.used = std::max(offset.load(std::memory_order_relaxed), highWater.load(std::memory_order_relaxed)) + overflowBytes;
+    result.capacity = capacity;
+    result.peak = std::max(peak, result.used);
+    result.allocations = allocations.load(std::memory_order_relaxed);
+    result.overflows = overflowCount;
+    return result;
+}
+
+FrameArena::FrameArena(std::size_t capacity) : first(capacity), second(capacity), arenas{&first, &second}
+{
+}
+
+void FrameArena::beginFrame() {
+    last = current().stats();
+    index = 1 - index;
+    current().reset();
+}
+
+FrameArena& FrameArena::global() {
+    static FrameArena arena;
+    return arena;
+}
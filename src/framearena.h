@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+const std::size_t frameArenaCapacity = 1 << 20; ///< Initial size of each frame block, grown when a frame overflows it
+
+struct ArenaStats
+{
+    std::size_t used = 0;        ///< Most bytes in use at once, alignment padding included
+    std::size_t capacity = 0;
+    std::size_t peak = 0;        ///< Highest used so far
+    unsigned int allocations = 0;
+    unsigned int overflows = 0;  ///< Allocations that didn't fit in the block and went to the heap
+};
+
+/**
+ * @brief Bump allocator : allocations are carved out of one block and all freed at once by reset().
+ *
+ * allocate() is lock free and can be called from any thread. Allocations that don't fit go to the heap, and the
+ * block is grown at the next reset so that the same workload fits afterwards. Debug builds fill released memory
+ * with 0xDD, which makes reads of stale or uninitialized data stand out.
+ */
+class LinearArena
+{
+public:
+    explicit LinearArena(std::size_t capacity);
+    ~LinearArena();
+
+    /**
+     * @param alignment : power of two
+     * @throw std::bad_alloc if the heap fallback fails
+     */
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    template <class T>
+    T* allocate(std::size_t count) {return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));}
+
+    /**
+     * @brief Gives the memory back if it is the last allocation, so that a growing container can reuse it.
+     * Does nothing otherwise, everything is freed by reset().
+     */
+    void deallocate(void* pointer, std::size_t bytes);
+
+    /**
+     * @brief Frees every allocation
+     * @pre no other thread is using the arena
+     */
+    void reset();
+
+    ArenaStats stats() const;
+
+private:
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* allocateOverflow(std::size_t bytes, std::size_t alignment);
+    void releaseOverflow();
+
+    char* block;
+    std::size_t capacity;
+    std::atomic<std::size_t> offset;
+    std::atomic<std::size_t> highWater; //Of offset, updated when deallocate() lowers it
+    std::atomic<unsigned int> allocations;
+    std::size_t peak = 0;
+
+    mutable std::mutex overflowMutex;
+    std::vector<void*> overflow;
+    std::size_t overflowBytes = 0;
+    unsigned int overflowCount = 0;
+};
+
+/**
+ * @brief Scratch memory for data that lives one frame : draw lists, culling results, readbacks...
+ *
+ * Two arenas are used in turn. beginFrame() resets the older one, so memory allocated during a frame stays valid
+ * during the next one too (e.g. for jobs or uploads that finish late), and is reclaimed after that.
+ *
+ * \code
+ * FrameVector<unsigned int> visible; //Allocates from the current frame
+ * visible.reserve(count);
+ * \endcode
+ */
+class FrameArena
+{
+public:
+    explicit FrameArena(std::size_t capacity = frameArenaCapacity);
+
+    /**
+     * @brief Called once per frame by the main loop, before anything is allocated for the frame
+     * @pre nothing allocated two frames ago is still in use
+     */
+    void beginFrame();
+
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+        return current().allocate(bytes, alignment);
+    }
+
+    LinearArena& current() {return *arenas[index];}
+
+    /**
+     * @brief Usage of the last completed frame
+     */
+    const ArenaStats& lastFrame() const {return last;}
+
+    static FrameArena& global();
+
+private:
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    LinearArena first, second;
+    LinearArena* arenas[2];
+    unsigned int index = 0;
+    ArenaStats last;
+};
+
+/**
+ * @brief STL allocator drawing from a LinearArena, by default the one of the current frame.
+ * Deallocation is deferred to the reset of the arena : the containers must not outlive it, and should reserve
+ * their size up front since each growth leaves the previous storage unused. Assigning a new container moves it
+ * to the arena of the new one, e.g. `points = FrameVector<Point>();` for a member reused every frame.
+ */
+template <class T>
+class ArenaAllocator
+{
+public:
+    typedef T value_type;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    ArenaAllocator() : arena(&FrameArena::global().current()) {}
+    explicit ArenaAllocator(LinearArena& arena) : arena(&arena) {}
+    template <class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(std::size_t count) {
+        if (count > static_cast<std::size_t>(-1) / sizeof(T))
+            throw std::bad_alloc();
+        return arena->allocate<T>(count);
+    }
+    void deallocate(T* pointer, std::size_t count) {arena->deallocate(pointer, count * sizeof(T));}
+
+    template <class U>
+    bool operator==(const ArenaAllocator<U>& other) const {return arena == other.arena;}
+    template <class U>
+    bool operator!=(const ArenaAllocator<U>& other) const {return arena != other.arena;}
+
+private:
+    template <class U> friend class ArenaAllocator;
+
+    LinearArena* arena;
+};
+
+template <class T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // FRAMEARENA_H
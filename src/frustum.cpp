@@ -0,0 +1,56 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "frustum.h"
+#include <glm/geometric.hpp>
+
+Frustum::Frustum(const glm::mat4 &matrix) {
+    //Rows of the matrix, glm being column-major
+    glm::vec4 rows[4];
+    for (int r = 0; r < 4; ++r)
+        rows[r] = glm::vec4(matrix[0][r], matrix[1][r], matrix[2][r], matrix[3][r]);
+    for (int axis = 0; axis < 3; ++axis) {
+        planes[2 * axis] = rows[3] + rows[axis];
+        planes[2 * axis + 1] = rows[3] - rows[axis];
+    }
+    //Normalized so that plane distances are actual distances, as the sphere test needs
+    for (glm::vec4& p : planes)
+        p /= glm::length(glm::vec3(p));
+}
+
+bool Frustum::intersectsSphere(const glm::vec3 &center, float radius) const {
+    for (const glm::vec4& p : planes)
+        if (glm::dot(glm::vec3(p), center) + p.w < -radius)
+            return false;
+    return true;
+}
+
+bool Frustum::intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const {
+    for (const glm::vec4& p : planes) {
+        //Corner furthest along the normal
+        glm::vec3 corner(p.x >= 0 ? max.x : min.x, p.y >= 0 ? max.y : min.y, p.z >= 0 ? max.z : min.z);
+        if (glm::dot(glm::vec3(p), corner) + p.w < 0)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+/**
+ * @brief Six clipping planes extracted from a projection matrix (Gribb & Hartmann).
+ *
+ * The planes live in the space the matrix transforms from : built from projection * view they are in world space,
+ * from projection * view * model in the local space of the object, which spares transforming its bounds.
+ */
+class Frustum
+{
+public:
+    /**
+     * @param matrix : clip-space transform, OpenGL depth convention ([-w, w])
+     */
+    explicit Frustum(const glm::mat4& matrix);
+
+    /**
+     * @brief intersectsSphere : false only if the sphere is entirely outside one of the planes
+     */
+    bool intersectsSphere(const glm::vec3& center, float radius) const;
+
+    /**
+     * @brief intersectsBox : false only if the box is entirely outside one of the planes
+     */
+    bool intersectsBox(const glm::vec3& min, const glm::vec3& max) const;
+
+    /**
+     * @brief Plane i as (normal, distance), normal pointing inside and of unit length.
+     * Order : left, right, bottom, top, near, far.
+     */
+    const glm::vec4& plane(int i) const {return planes[i];}
+
+private:
+    glm::vec4 planes[6];
+};
+
+#endif // FRUSTUM_H
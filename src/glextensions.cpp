@@ -0,0 +1,118 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "glextensions.h"
+#include <cstring>
+
+bool GLEXT_program_binary = false;
+PFNGLGETPROGRAMBINARYPROC glext_glGetProgramBinary = nullptr;
+PFNGLPROGRAMBINARYPROC glext_glProgramBinary = nullptr;
+PFNGLPROGRAMPARAMETERIPROC glext_glProgramParameteri = nullptr;
+bool GLEXT_parallel_shader_compile = false;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glext_glMaxShaderCompilerThreadsKHR = nullptr;
+bool GLEXT_texture_storage = false;
+PFNGLTEXSTORAGE2DPROC glext_glTexStorage2D = nullptr;
+PFNGLTEXSTORAGE3DPROC glext_glTexStorage3D = nullptr;
+bool GLEXT_compute = false;
+PFNGLDISPATCHCOMPUTEPROC glext_glDispatchCompute = nullptr;
+PFNGLMEMORYBARRIERPROC glext_glMemoryBarrier = nullptr;
+PFNGLBINDIMAGETEXTUREPROC glext_glBindImageTexture = nullptr;
+PFNGLCLEARBUFFERDATAPROC glext_glClearBufferData = nullptr;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC glext_glMultiDrawElementsIndirect = nullptr;
+bool GLEXT_indirect_parameters = false;
+PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC glext_glMultiDrawElementsIndirectCount = nullptr;
+bool GLEXT_texture_compression_s3tc = false;
+bool GLEXT_texture_compression_bptc = false;
+bool GLEXT_texture_compression_etc2 = false;
+bool GLEXT_texture_filter_anisotropic = false;
+bool GLEXT_gpu_memory_info = false;
+bool GLEXT_meminfo = false;
+
+bool hasGLExtension(const char *name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (int i = 0; i < count; ++i) {
+        const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+bool hasGLVersion(int major, int minor) {
+    int contextMajor = 0, contextMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+void loadGLExtensions(GLADloadproc load) {
+    glext_glGetProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(load("glGetProgramBinary"));
+    glext_glProgramBinary = reinterpret_cast<PFNGLPROGRAMBINARYPROC>(load("glProgramBinary"));
+    glext_glProgramParameteri = reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+    int binaryFormats = 0;
+    if (hasGLVersion(4, 1) || hasGLExtension("GL_ARB_get_program_binary"))
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binaryFormats);
+    GLEXT_program_binary = binaryFormats > 0 && glext_glGetProgramBinary && glext_glProgramBinary && glext_glProgramParameteri;
+
+    //Same tokens and semantics in both versions of the extension
+    if (hasGLExtension("GL_KHR_parallel_shader_compile"))
+        glext_glMaxShaderCompilerThreadsKHR = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load("glMaxShaderCompilerThreadsKHR"));
+    else if (hasGLExtension("GL_ARB_parallel_shader_compile"))
+        glext_glMaxShaderCompilerThreadsKHR = reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load("glMaxShaderCompilerThreadsARB"));
+    GLEXT_parallel_shader_compile = glext_glMaxShaderCompilerThreadsKHR != nullptr;
+    if (GLEXT_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); //Implementation-defined maximum
+
+    if (hasGLVersion(4, 2) || hasGLExtension("GL_ARB_texture_storage")) {
+        glext_glTexStorage2D = reinterpret_cast<PFNGLTEXSTORAGE2DPROC>(load("glTexStorage2D"));
+        glext_glTexStorage3D = reinterpret_cast<PFNGLTEXSTORAGE3DPROC>(load("glTexStorage3D"));
+    }
+    GLEXT_texture_storage = glext_glTexStorage2D && glext_glTexStorage3D;
+
+    if (hasGLVersion(4, 3)) {
+        glext_glDispatchCompute = reinterpret_cast<PFNGLDISPATCHCOMPUTEPROC>(load("glDispatchCompute"));
+        glext_glMemoryBarrier = reinterpret_cast<PFNGLMEMORYBARRIERPROC>(load("glMemoryBarrier"));
+        glext_glBindImageTexture = reinterpret_cast<PFNGLBINDIMAGETEXTUREPROC>(load("glBindImageTexture"));
+        glext_glClearBufferData = reinterpret_cast<PFNGLCLEARBUFFERDATAPROC>(load("glClearBufferData"));
+        glext_glMultiDrawElementsIndirect = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTPROC>(load("glMultiDrawElementsIndirect"));
+    }
+    GLEXT_compute = glext_glDispatchCompute && glext_glMemoryBarrier && glext_glBindImageTexture
+                 && glext_glClearBufferData && glext_glMultiDrawElementsIndirect;
+
+    //Same signature for the core function and the ARB one
+    if (hasGLVersion(4, 6))
+        glext_glMultiDrawElementsIndirectCount = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC>(load("glMultiDrawElementsIndirectCount"));
+    else if (hasGLExtension("GL_ARB_indirect_parameters"))
+        glext_glMultiDrawElementsIndirectCount = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC>(load("glMultiDrawElementsIndirectCountARB"));
+    GLEXT_indirect_parameters = GLEXT_compute && glext_glMultiDrawElementsIndirectCount;
+
+    GLEXT_texture_compression_s3tc = hasGLExtension("GL_EXT_texture_compression_s3tc");
+    GLEXT_texture_compression_bptc = hasGLVersion(4, 2) || hasGLExtension("GL_ARB_texture_compression_bptc");
+    GLEXT_texture_compression_etc2 = hasGLVersion(4, 3) || hasGLExtension("GL_ARB_ES3_compatibility");
+    GLEXT_texture_filter_anisotropic = hasGLVersion(4, 6) || hasGLExtension("GL_EXT_texture_filter_anisotropic")
+                                    || hasGLExtension("GL_ARB_texture_filter_anisotropic");
+
+    GLEXT_gpu_memory_info = hasGLExtension("GL_NVX_gpu_memory_info");
+    GLEXT_meminfo = hasGLExtension("GL_ATI_meminfo");
+}
@@ -0,0 +1,246 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GLEXTENSIONS_H
+#define GLEXTENSIONS_H
+
+#include <glad/glad.h>
+
+/** @defgroup GLExtensions
+ * Entry points and constants newer than the OpenGL 3.3 core profile covered by glad.
+ * They are loaded by loadGLExtensions(), each group comes with a flag telling whether it is usable.
+ * Code using them must check the flag first and keep a 3.3 fallback.
+ * @{ */
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_MAX_SHADER_COMPILER_THREADS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT3_EXT 0x83F2
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT 0x8C4D
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT 0x8C4E
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+#ifndef GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT
+#define GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT 0x8E8E
+#endif
+#ifndef GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT
+#define GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT 0x8E8F
+#endif
+#ifndef GL_COMPRESSED_R11_EAC
+#define GL_COMPRESSED_R11_EAC 0x9270
+#endif
+#ifndef GL_COMPRESSED_SIGNED_R11_EAC
+#define GL_COMPRESSED_SIGNED_R11_EAC 0x9271
+#endif
+#ifndef GL_COMPRESSED_RG11_EAC
+#define GL_COMPRESSED_RG11_EAC 0x9272
+#endif
+#ifndef GL_COMPRESSED_SIGNED_RG11_EAC
+#define GL_COMPRESSED_SIGNED_RG11_EAC 0x9273
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ETC2
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#endif
+#ifndef GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+#endif
+#ifndef GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2
+#define GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9277
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#endif
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+#ifndef GL_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_TEXTURE_MAX_ANISOTROPY_EXT 0x84FE
+#endif
+#ifndef GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT 0x84FF
+#endif
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+#ifndef GL_SHADER_STORAGE_BUFFER
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+#ifndef GL_PARAMETER_BUFFER_ARB
+#define GL_PARAMETER_BUFFER_ARB 0x80EE
+#endif
+#ifndef GL_COMMAND_BARRIER_BIT
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+#ifndef GL_SHADER_STORAGE_BARRIER_BIT
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+#ifndef GL_TEXTURE_FETCH_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#endif
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#endif
+
+#ifndef GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX
+#define GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX 0x9048
+#endif
+#ifndef GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX
+#define GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX 0x9049
+#endif
+#ifndef GL_VBO_FREE_MEMORY_ATI
+#define GL_VBO_FREE_MEMORY_ATI 0x87FB
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(GLuint program, GLenum pname, GLint value);
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+typedef void (APIENTRYP PFNGLTEXSTORAGE3DPROC)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth);
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (APIENTRYP PFNGLCLEARBUFFERDATAPROC)(GLenum target, GLenum internalformat, GLenum format, GLenum type, const void *data);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void *indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+/// GL 4.1 or GL_ARB_get_program_binary, with at least one binary format
+extern bool GLEXT_program_binary;
+extern PFNGLGETPROGRAMBINARYPROC glext_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glext_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glext_glProgramParameteri;
+#define glGetProgramBinary glext_glGetProgramBinary
+#define glProgramBinary glext_glProgramBinary
+#define glProgramParameteri glext_glProgramParameteri
+
+/// GL_KHR_parallel_shader_compile or GL_ARB_parallel_shader_compile : GL_COMPLETION_STATUS_KHR can be queried
+/// without blocking. loadGLExtensions() lets the driver pick its number of compiler threads.
+extern bool GLEXT_parallel_shader_compile;
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glext_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR glext_glMaxShaderCompilerThreadsKHR
+
+/// GL 4.2 or GL_ARB_texture_storage : immutable texture storage
+extern bool GLEXT_texture_storage;
+extern PFNGLTEXSTORAGE2DPROC glext_glTexStorage2D;
+extern PFNGLTEXSTORAGE3DPROC glext_glTexStorage3D;
+#define glTexStorage2D glext_glTexStorage2D
+#define glTexStorage3D glext_glTexStorage3D
+
+/// GL 4.3 : compute shaders, shader storage buffers, image load / store and multi draw indirect,
+/// everything GPU-driven rendering needs
+extern bool GLEXT_compute;
+extern PFNGLDISPATCHCOMPUTEPROC glext_glDispatchCompute;
+extern PFNGLMEMORYBARRIERPROC glext_glMemoryBarrier;
+extern PFNGLBINDIMAGETEXTUREPROC glext_glBindImageTexture;
+extern PFNGLCLEARBUFFERDATAPROC glext_glClearBufferData;
+extern PFNGLMULTIDRAWELEMENTSINDIRECTPROC glext_glMultiDrawElementsIndirect;
+#define glDispatchCompute glext_glDispatchCompute
+#define glMemoryBarrier glext_glMemoryBarrier
+#define glBindImageTexture glext_glBindImageTexture
+#define glClearBufferData glext_glClearBufferData
+#define glMultiDrawElementsIndirect glext_glMultiDrawElementsIndirect
+
+/// GL 4.6 or GL_ARB_indirect_parameters : the draw count of a multi draw is read from GL_PARAMETER_BUFFER_ARB
+extern bool GLEXT_indirect_parameters;
+extern PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC glext_glMultiDrawElementsIndirectCount;
+#define glMultiDrawElementsIndirectCount glext_glMultiDrawElementsIndirectCount
+
+/// Compressed formats beyond the core RGTC (BC4 / BC5) : S3TC is BC1 to BC3, BPTC is BC6H and BC7
+extern bool GLEXT_texture_compression_s3tc;
+extern bool GLEXT_texture_compression_bptc; ///< GL 4.2 or GL_ARB_texture_compression_bptc
+extern bool GLEXT_texture_compression_etc2; ///< GL 4.3 or GL_ARB_ES3_compatibility
+extern bool GLEXT_texture_filter_anisotropic;
+
+/// Free video memory as seen by the driver, in KiB : GL_NVX_gpu_memory_info (GL_GPU_MEMORY_INFO_*_NVX)
+/// and GL_ATI_meminfo (GL_VBO_FREE_MEMORY_ATI, the free memory of the buffer pool)
+extern bool GLEXT_gpu_memory_info;
+extern bool GLEXT_meminfo;
+
+/**
+ * @brief loadGLExtensions : loads the entry points above and sets the availability flags
+ * @param load : returns the address of a GL function, or nullptr
+ * @pre gladLoadGL() succeeded on the current context
+ */
+void loadGLExtensions(GLADloadproc load);
+
+/**
+ * @brief hasGLExtension : tells whether the current context advertises an extension (e.g. "GL_ARB_get_program_binary")
+ */
+bool hasGLExtension(const char* name);
+
+/**
+ * @brief hasGLVersion : tells whether the current context version is at least major.minor
+ */
+bool hasGLVersion(int major, int minor);
+
+/** @} */
+
+#endif // GLEXTENSIONS_H
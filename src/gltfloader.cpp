@@ -0,0 +1,475 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "gltfloader.h"
+#include "json.h"
+#include "profiler.h"
+#include "simdmath.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const std::uint32_t glbMagic = 0x46546C67; //"glTF"
+const std::uint32_t glbChunkJson = 0x4E4F534A;
+const std::uint32_t glbChunkBin = 0x004E4942;
+
+std::size_t componentSize(unsigned int componentType) {
+    switch (componentType) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return 1;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+        return 2;
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return 4;
+    default:
+        throw std::runtime_error("Invalid glTF component type : " + std::to_string(componentType));
+    }
+}
+
+unsigned int componentCount(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    if (type == "MAT2") return 4;
+    if (type == "MAT3") return 9;
+    if (type == "MAT4") return 16;
+    throw std::runtime_error("Invalid glTF accessor type : " + type);
+}
+
+std::string directoryOf(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::vector<char> decodeBase64(const char* p, const char* end) {
+    static signed char table[256];
+    static bool initialized = false;
+    if (!initialized) {
+        std::memset(table, -1, sizeof(table));
+        const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        for (int i = 0; i < 64; ++i)
+            table[static_cast<unsigned char>(alphabet[i])] = static_cast<signed char>(i);
+        initialized = true;
+    }
+    std::vector<char> result;
+    result.reserve((end - p) * 3 / 4);
+    unsigned int accumulator = 0;
+    int bits = 0;
+    for (; p < end && *p != '='; ++p) {
+        signed char value = table[static_cast<unsigned char>(*p)];
+        if (value < 0)
+            throw std::runtime_error("Invalid base64 data in glTF URI");
+        accumulator = (accumulator << 6) | value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            result.push_back(static_cast<char>((accumulator >> bits) & 0xFF));
+        }
+    }
+    return result;
+}
+
+/** True if count elements of elementSize bytes, stride apart from offset, fit in size bytes. Can't overflow. */
+bool elementsFit(std::size_t offset, std::size_t count, std::size_t stride, std::size_t elementSize, std::size_t size) {
+    if (count == 0)
+        return true;
+    if (elementSize > size || offset > size - elementSize)
+        return false;
+    return stride == 0 || count - 1 <= (size - elementSize - offset) / stride;
+}
+
+int checkedIndex(const JsonValue& value, std::size_t count, const char* what) {
+    if (value.isNull())
+        return -1;
+    int index = value.asInt(-1);
+    if (index < 0 || static_cast<std::size_t>(index) >= count)
+        throw std::runtime_error(std::string("glTF ") + what + " index out of range");
+    return index;
+}
+
+int textureIndex(const JsonValue& textureInfo, std::size_t textureCount) {
+    return checkedIndex(textureInfo["index"], textureCount, "texture");
+}
+
+glm::mat4 nodeTransform(const JsonValue& node) {
+    const JsonValue& matrix = node["matrix"];
+    if (matrix.isArray() && matrix.size() == 16) {
+        glm::mat4 result;
+        float* data = glm::value_ptr(result);
+        for (int i = 0; i < 16; ++i)
+            data[i] = static_cast<float>(matrix.at(i).asNumber());
+        return result;
+    }
+    glm::mat4 result(1.0f);
+    const JsonValue& t = node["translation"];
+    if (t.isArray())
+        result = glm::translate(result, glm::vec3(t.at(0).asNumber(), t.at(1).asNumber(), t.at(2).asNumber()));
+    const JsonValue& r = node["rotation"];
+    if (r.isArray()) //glTF stores x, y, z, w
+        result *= glm::mat4_cast(glm::quat(static_cast<float>(r.at(3).asNumber(1)), static_cast<float>(r.at(0).asNumber()),
+                                           static_cast<float>(r.at(1).asNumber()), static_cast<float>(r.at(2).asNumber())));
+    const JsonValue& s = node["scale"];
+    if (s.isArray())
+        result = glm::scale(result, glm::vec3(s.at(0).asNumber(1), s.at(1).asNumber(1), s.at(2).asNumber(1)));
+    return result;
+}
+
+} // namespace
+
+std::size_t GltfAccessor::elementSize() const {
+    return componentSize(componentType) * components;
+}
+
+const char* GltfDocument::accessorData(const GltfAccessor &accessor) const {
+    if (!accessor.materialized.empty())
+        return accessor.materialized.data();
+    return viewData(bufferViews[accessor.bufferView]) + accessor.byteOffset;
+}
+
+std::size_t GltfDocument::accessorStride(const GltfAccessor &accessor) const {
+    if (!accessor.materialized.empty() || bufferViews[accessor.bufferView].byteStride == 0)
+        return accessor.elementSize();
+    return bufferViews[accessor.bufferView].byteStride;
+}
+
+GltfDocument loadGltf(const std::string &path) {
+    PROFILE_FUNCTION();
+    GltfDocument doc;
+    doc.files.emplace_back(path);
+    const MappedFile& file = doc.files.front();
+    const std::string directory = directoryOf(path);
+
+    //Binary container : JSON chunk, then an optional BIN chunk used as buffer 0
+    const char* json = file.data();
+    std::size_t jsonSize = file.size();
+    const char* binChunk = nullptr;
+    std::size_t binSize = 0;
+    std::uint32_t magic = 0;
+    if (file.size() >= 4)
+        std::memcpy(&magic, file.data(), 4);
+    if (magic == glbMagic) {
+        std::uint32_t header[3], chunk[2];
+        if (file.size() < 20)
+            throw std::runtime_error("Truncated GLB file : " + path);
+        std::memcpy(header, file.data(), 12);
+        if (header[1] != 2)
+            throw std::runtime_error("Unsupported GLB version : " + path);
+        std::size_t length = std::min<std::size_t>(header[2], file.size());
+        std::size_t offset = 12;
+        json = nullptr;
+        while (offset + 8 <= length) {
+            std::memcpy(chunk, file.data() + offset, 8);
+            offset += 8;
+            if (offset + chunk[0] > length)
+                throw std::runtime_error("Truncated GLB chunk : " + path);
+            if (chunk[1] == glbChunkJson && !json) {
+                json = file.data() + offset;
+                jsonSize = chunk[0];
+            } else if (chunk[1] == glbChunkBin && !binChunk) {
+                binChunk = file.data() + offset;
+                binSize = chunk[0];
+            }
+            offset += (chunk[0] + 3) & ~3u;
+        }
+        if (!json)
+            throw std::runtime_error("GLB file without JSON chunk : " + path);
+    }
+
+    JsonValue root = parseJson(json, jsonSize);
+    if (root["asset"]["version"].asString().compare(0, 1, "2") != 0)
+        throw std::runtime_error("Only glTF 2.0 is supported : " + path);
+
+    //Buffers
+    for (const JsonValue& buffer : root["buffers"].items()) {
+        GltfDocument::Buffer entry{nullptr, 0, {}};
+        std::size_t byteLength = buffer["byteLength"].asSize();
+        const std::string& uri = buffer["uri"].asString();
+        if (uri.empty()) {
+            if (!binChunk || !doc.buffers.empty())
+                throw std::runtime_error("glTF buffer without URI : " + path);
+            entry.data = binChunk;
+            entry.size = binSize;
+        } else if (uri.compare(0, 5, "data:") == 0) {
+            std::size_t comma = uri.find(";base64,");
+            if (comma == std::string::npos)
+                throw std::runtime_error("Unsupported glTF data URI : " + path);
+            entry.owned = decodeBase64(uri.data() + comma + 8, uri.data() + uri.size());
+            entry.data = entry.owned.data();
+            entry.size = entry.owned.size();
+        } else {
+            doc.files.emplace_back(directory + uri);
+            entry.data = doc.files.back().data();
+            entry.size = doc.files.back().size();
+        }
+        if (entry.size < byteLength)
+            throw std::runtime_error("glTF buffer shorter than its byteLength : " + path);
+        doc.buffers.push_back(std::move(entry));
+    }
+
+    //Buffer views
+    for (const JsonValue& view : root["bufferViews"].items()) {
+        GltfBufferView entry;
+        entry.buffer = checkedIndex(view["buffer"], doc.buffers.size(), "buffer");
+        entry.byteOffset = view["byteOffset"].asSize();
+        entry.byteLength = view["byteLength"].asSize();
+        entry.byteStride = view["byteStride"].asSize();
+        if (!elementsFit(entry.byteOffset, 1, 0, entry.byteLength, doc.buffers[entry.buffer].size))
+            throw std::runtime_error("glTF buffer view out of its buffer : " + path);
+        doc.bufferViews.push_back(entry);
+    }
+
+    //Accessors
+    for (const JsonValue& accessor : root["accessors"].items()) {
+        GltfAccessor entry;
+        entry.bufferView = checkedIndex(accessor["bufferView"], doc.bufferViews.size(), "bufferView");
+        entry.byteOffset = accessor["byteOffset"].asSize();
+        entry.componentType = accessor["componentType"].asInt();
+        entry.components = componentCount(accessor["type"].asString());
+        entry.normalized = accessor["normalized"].asBool();
+        entry.count = accessor["count"].asSize(std::numeric_limits<std::size_t>::max()); //Missing or invalid : rejected below
+        if (entry.count == 0) //Empty accessors would have neither view nor copy to read
+            throw std::runtime_error("glTF accessor without elements : " + path);
+        const JsonValue& min = accessor["min"];
+        const JsonValue& max = accessor["max"];
+        if (min.isArray() && max.isArray()) {
+            entry.hasBounds = true;
+            for (unsigned int c = 0; c < 3 && c < min.size() && c < max.size(); ++c) {
+                entry.min[c] = static_cast<float>(min.at(c).asNumber());
+                entry.max[c] = static_cast<float>(max.at(c).asNumber());
+            }
+        }
+        std::size_t elementSize = entry.elementSize();
+        if (entry.bufferView >= 0) {
+            const GltfBufferView& view = doc.bufferViews[entry.bufferView];
+            std::size_t stride = view.byteStride ? view.byteStride : elementSize;
+            if (!elementsFit(entry.byteOffset, entry.count, stride, elementSize, view.byteLength))
+                throw std::runtime_error("glTF accessor out of its buffer view : " + path);
+        }
+
+        const JsonValue& sparse = accessor["sparse"];
+        if (entry.bufferView < 0 || sparse.isObject()) {
+            //Can't be used in place : build a packed copy, zero-initialized as the spec requires
+            if (entry.count > std::numeric_limits<std::size_t>::max() / elementSize)
+                throw std::runtime_error("glTF accessor too large : " + path);
+            entry.materialized.assign(elementSize * entry.count, 0);
+            if (entry.bufferView >= 0) {
+                const GltfBufferView& view = doc.bufferViews[entry.bufferView];
+                std::size_t stride = view.byteStride ? view.byteStride : elementSize;
+                const char* source = doc.viewData(view) + entry.byteOffset;
+                for (std::size_t i = 0; i < entry.count; ++i)
+                    std::memcpy(&entry.materialized[i * elementSize], source + i * stride, elementSize);
+            }
+            if (sparse.isObject()) {
+                std::size_t sparseCount = sparse["count"].asSize();
+                const JsonValue& indices = sparse["indices"];
+                const JsonValue& values = sparse["values"];
+                int indexView = checkedIndex(indices["bufferView"], doc.bufferViews.size(), "bufferView");
+                int valueView = checkedIndex(values["bufferView"], doc.bufferViews.size(), "bufferView");
+                if (indexView < 0 || valueView < 0)
+                    throw std::runtime_error("glTF sparse accessor without buffer view : " + path);
+                unsigned int indexType = indices["componentType"].asInt();
+                std::size_t indexSize = componentSize(indexType);
+                const std::size_t indexOffset = indices["byteOffset"].asSize(), valueOffset = values["byteOffset"].asSize();
+                if (!elementsFit(indexOffset, sparseCount, indexSize, indexSize, doc.bufferViews[indexView].byteLength)
+                        || !elementsFit(valueOffset, sparseCount, elementSize, elementSize, doc.bufferViews[valueView].byteLength))
+                    throw std::runtime_error("glTF sparse accessor out of its buffer view : " + path);
+                const char* indexData = doc.viewData(doc.bufferViews[indexView]) + indexOffset;
+                const char* valueData = doc.viewData(doc.bufferViews[valueView]) + valueOffset;
+                for (std::size_t i = 0; i < sparseCount; ++i) {
+                    std::uint32_t target = 0;
+                    if (indexSize == 1) target = static_cast<unsigned char>(indexData[i]);
+                    else if (indexSize == 2) { std::uint16_t v; std::memcpy(&v, indexData + 2 * i, 2); target = v; }
+                    else std::memcpy(&target, indexData + 4 * i, 4);
+                    if (target >= entry.count)
+                        throw std::runtime_error("glTF sparse index out of range : " + path);
+                    std::memcpy(&entry.materialized[target * elementSize], valueData + i * elementSize, elementSize);
+                }
+            }
+        }
+        doc.accessors.push_back(std::move(entry));
+    }
+
+    //Images and textures
+    for (const JsonValue& image : root["images"].items()) {
+        GltfImage entry;
+        const std::string& uri = image["uri"].asString();
+        if (!uri.empty() && uri.compare(0, 5, "data:") != 0)
+            entry.uri = directory + uri;
+        entry.mimeType = image["mimeType"].asString();
+        entry.bufferView = checkedIndex(image["bufferView"], doc.bufferViews.size(), "bufferView");
+        doc.images.push_back(entry);
+    }
+    for (const JsonValue& texture : root["textures"].items()) {
+        GltfTexture entry;
+        entry.image = checkedIndex(texture["source"], doc.images.size(), "image");
+        entry.sampler = checkedIndex(texture["sampler"], root["samplers"].size(), "sampler");
+        doc.textures.push_back(entry);
+    }
+
+    //Materials
+    for (const JsonValue& material : root["materials"].items()) {
+        GltfMaterial entry;
+        entry.name = material["name"].asString();
+        const JsonValue& pbr = material["pbrMetallicRoughness"];
+        const JsonValue& baseColor = pbr["baseColorFactor"];
+        if (baseColor.isArray())
+            entry.baseColorFactor = glm::vec4(baseColor.at(0).asNumber(1), baseColor.at(1).asNumber(1),
+                                              baseColor.at(2).asNumber(1), baseColor.at(3).asNumber(1));
+        entry.metallicFactor = static_cast<float>(pbr["metallicFactor"].asNumber(1));
+        entry.roughnessFactor = static_cast<float>(pbr["roughnessFactor"].asNumber(1));
+        entry.baseColorTexture = textureIndex(pbr["baseColorTexture"], doc.textures.size());
+        entry.metallicRoughnessTexture = textureIndex(pbr["metallicRoughnessTexture"], doc.textures.size());
+        entry.normalTexture = textureIndex(material["normalTexture"], doc.textures.size());
+        entry.occlusionTexture = textureIndex(material["occlusionTexture"], doc.textures.size());
+        entry.emissiveTexture = textureIndex(material["emissiveTexture"], doc.textures.size());
+        const JsonValue& emissive = material["emissiveFactor"];
+        if (emissive.isArray())
+            entry.emissiveFactor = glm::vec3(emissive.at(0).asNumber(), emissive.at(1).asNumber(), emissive.at(2).asNumber());
+        const std::string& alphaMode = material["alphaMode"].asString();
+        entry.alphaMode = alphaMode == "MASK" ? GltfMaterial::AlphaMode::Mask
+                        : alphaMode == "BLEND" ? GltfMaterial::AlphaMode::Blend : GltfMaterial::AlphaMode::Opaque;
+        entry.alphaCutoff = static_cast<float>(material["alphaCutoff"].asNumber(0.5));
+        entry.doubleSided = material["doubleSided"].asBool();
+        doc.materials.push_back(entry);
+    }
+
+    //Meshes
+    for (const JsonValue& mesh : root["meshes"].items()) {
+        GltfMesh entry;
+        entry.name = mesh["name"].asString();
+        for (const JsonValue& primitive : mesh["primitives"].items()) {
+            GltfPrimitive p;
+            const JsonValue& attributes = primitive["attributes"];
+            p.position = checkedIndex(attributes["POSITION"], doc.accessors.size(), "accessor");
+            p.normal = checkedIndex(attributes["NORMAL"], doc.accessors.size(), "accessor");
+            p.texcoord = checkedIndex(attributes["TEXCOORD_0"], doc.accessors.size(), "accessor");
+            p.color = checkedIndex(attributes["COLOR_0"], doc.accessors.size(), "accessor");
+            p.indices = checkedIndex(primitive["indices"], doc.accessors.size(), "accessor");
+            p.material = checkedIndex(primitive["material"], doc.materials.size(), "material");
+            const int mode = primitive["mode"].asInt(4);
+            if (mode < 0 || mode > 6) //GL_POINTS to GL_TRIANGLE_FAN, which have the same values
+                throw std::runtime_error("Invalid glTF primitive mode : " + path);
+            p.mode = static_cast<unsigned int>(mode);
+            if (p.position < 0)
+                throw std::runtime_error("glTF primitive without POSITION : " + path);
+            entry.primitives.push_back(p);
+        }
+        doc.meshes.push_back(std::move(entry));
+    }
+
+    //Node hierarchy
+    const JsonValue& nodes = root["nodes"];
+    doc.nodes.resize(nodes.size());
+    for (std::size_t n = 0; n < nodes.size(); ++n) {
+        const JsonValue& node = nodes.at(n);
+        GltfNode& entry = doc.nodes[n];
+        entry.name = node["name"].asString();
+        entry.mesh = checkedIndex(node["mesh"], doc.meshes.size(), "mesh");
+        entry.local = nodeTransform(node);
+        for (const JsonValue& child : node["children"].items()) {
+            int c = checkedIndex(child, nodes.size(), "node");
+            if (c < 0 || doc.nodes[c].parent >= 0 || c == static_cast<int>(n))
+                throw std::runtime_error("glTF node hierarchy is not a tree : " + path);
+            doc.nodes[c].parent = static_cast<int>(n);
+            entry.children.push_back(c);
+        }
+    }
+
+    //Nodes have one parent at most : the hierarchy is a forest if every node is reached once from the parentless
+    //ones. Nodes of a cycle all have a parent, so they are never reached.
+    enum Colour : unsigned char {White, Grey, Black};
+    std::vector<Colour> colours(doc.nodes.size(), White);
+    std::vector<int> pending;
+    for (std::size_t n = 0; n < doc.nodes.size(); ++n) {
+        if (doc.nodes[n].parent >= 0)
+            continue;
+        colours[n] = Grey;
+        pending.push_back(static_cast<int>(n));
+        while (!pending.empty()) {
+            int current = pending.back();
+            pending.pop_back();
+            for (int child : doc.nodes[current].children) {
+                if (colours[child] != White)
+                    throw std::runtime_error("glTF node hierarchy has a cycle : " + path);
+                colours[child] = Grey;
+                pending.push_back(child);
+            }
+            colours[current] = Black;
+        }
+    }
+    if (std::find(colours.begin(), colours.end(), White) != colours.end())
+        throw std::runtime_error("glTF node hierarchy has a cycle : " + path);
+
+    const JsonValue& scenes = root["scenes"];
+    if (scenes.size() > 0) {
+        const JsonValue& scene = scenes.at(root["scene"].asSize(0));
+        for (const JsonValue& node : scene["nodes"].items()) {
+            int r = checkedIndex(node, doc.nodes.size(), "node");
+            if (r < 0 || doc.nodes[r].parent >= 0
+                || std::find(doc.sceneRoots.begin(), doc.sceneRoots.end(), r) != doc.sceneRoots.end())
+                throw std::runtime_error("glTF scene nodes must be distinct root nodes : " + path);
+            doc.sceneRoots.push_back(r);
+        }
+    } else {
+        for (std::size_t n = 0; n < doc.nodes.size(); ++n)
+            if (doc.nodes[n].parent < 0)
+                doc.sceneRoots.push_back(static_cast<int>(n));
+    }
+
+    //World matrices, one depth of the hierarchy at a time so that each depth is a single batched multiply
+    std::vector<int> level(doc.sceneRoots), next;
+    std::vector<glm::mat4> parents, locals, worlds;
+    for (int r : doc.sceneRoots)
+        doc.nodes[r].world = doc.nodes[r].local;
+    while (!level.empty()) {
+        next.clear();
+        parents.clear();
+        locals.clear();
+        for (int n : level) {
+            doc.nodes[n].inScene = true;
+            for (int child : doc.nodes[n].children) {
+                next.push_back(child);
+                parents.push_back(doc.nodes[n].world);
+                locals.push_back(doc.nodes[child].local);
+            }
+        }
+        worlds.resize(next.size());
+        batchMultiply(parents.data(), locals.data(), worlds.data(), next.size());
+        for (std::size_t i = 0; i < next.size(); ++i)
+            doc.nodes[next[i]].world = worlds[i];
+        level.swap(next);
+    }
+    return doc;
+}
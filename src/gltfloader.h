@@ -0,0 +1,179 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GLTFLOADER_H
+#define GLTFLOADER_H
+
+#include "mappedfile.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+struct GltfBufferView
+{
+    unsigned int buffer = 0;
+    std::size_t byteOffset = 0;
+    std::size_t byteLength = 0;
+    std::size_t byteStride = 0; //0 means tightly packed
+};
+
+struct GltfAccessor
+{
+    int bufferView = -1;
+    std::size_t byteOffset = 0; //Relative to the buffer view
+    unsigned int componentType = 0; //GL enum (GL_FLOAT, GL_UNSIGNED_SHORT, ...)
+    unsigned int components = 1; //1 (SCALAR) to 16 (MAT4)
+    bool normalized = false;
+    std::size_t count = 0; //At least 1 once loaded, so materialized is empty only for accessors read in place
+    bool hasBounds = false;
+    glm::vec3 min{0.0f}, max{0.0f}; //First 3 components of min / max when present
+    /**
+     * Tightly packed copy, only for accessors that can't be read in place (sparse, or without buffer view)
+     */
+    std::vector<char> materialized;
+
+    std::size_t elementSize() const;
+};
+
+struct GltfPrimitive
+{
+    //Accessor indices, -1 when absent
+    int position = -1;
+    int normal = -1;
+    int texcoord = -1; //TEXCOORD_0
+    int color = -1; //COLOR_0
+    int indices = -1;
+    int material = -1;
+    unsigned int mode = 4; //GL_TRIANGLES
+};
+
+struct GltfMesh
+{
+    std::string name;
+    std::vector<GltfPrimitive> primitives;
+};
+
+struct GltfMaterial
+{
+    enum class AlphaMode {Opaque, Mask, Blend};
+
+    std::string name;
+    glm::vec4 baseColorFactor{1.0f};
+    float metallicFactor = 1.0f;
+    float roughnessFactor = 1.0f;
+    glm::vec3 emissiveFactor{0.0f};
+    //Texture indices, -1 when absent
+    int baseColorTexture = -1;
+    int metallicRoughnessTexture = -1;
+    int normalTexture = -1;
+    int occlusionTexture = -1;
+    int emissiveTexture = -1;
+    AlphaMode alphaMode = AlphaMode::Opaque;
+    float alphaCutoff = 0.5f;
+    bool doubleSided = false;
+};
+
+struct GltfTexture
+{
+    int image = -1;
+    int sampler = -1;
+};
+
+struct GltfImage
+{
+    std::string uri; //Resolved against the document's directory, empty for embedded images
+    std::string mimeType;
+    int bufferView = -1;
+};
+
+struct GltfNode
+{
+    std::string name;
+    int mesh = -1;
+    int parent = -1;
+    std::vector<int> children;
+    glm::mat4 local{1.0f};
+    glm::mat4 world{1.0f}; //Computed at load time from the hierarchy
+    bool inScene = false; //Reached from the roots of the default scene
+};
+
+/**
+ * @brief Parsed glTF 2.0 asset (.gltf with external or embedded buffers, or binary .glb)
+ *
+ * Binary data stays in the memory-mapped files : buffer views and accessors are only offsets into them,
+ * so geometry can go to the GPU without being copied or converted.
+ * @see loadGltf(), GltfModel
+ */
+class GltfDocument
+{
+public:
+    std::vector<GltfBufferView> bufferViews;
+    std::vector<GltfAccessor> accessors;
+    std::vector<GltfMesh> meshes;
+    std::vector<GltfMaterial> materials;
+    std::vector<GltfTexture> textures;
+    std::vector<GltfImage> images;
+    std::vector<GltfNode> nodes;
+    std::vector<int> sceneRoots; //Root nodes of the default scene
+
+    std::size_t bufferCount() const {return buffers.size();}
+    std::size_t bufferSize(unsigned int buffer) const {return buffers[buffer].size;}
+    const char* bufferData(unsigned int buffer) const {return buffers[buffer].data;}
+    const char* viewData(const GltfBufferView& view) const {return buffers[view.buffer].data + view.byteOffset;}
+
+    /**
+     * @brief Address of the first element of an accessor (in place, or its materialized copy)
+     */
+    const char* accessorData(const GltfAccessor& accessor) const;
+
+    /**
+     * @brief Stride between two elements of an accessor, in bytes
+     */
+    std::size_t accessorStride(const GltfAccessor& accessor) const;
+
+private:
+    friend GltfDocument loadGltf(const std::string& path);
+
+    struct Buffer {
+        const char* data;
+        std::size_t size;
+        std::vector<char> owned; //Decoded data URI
+    };
+
+    std::vector<MappedFile> files; //Keeps the mappings alive
+    std::vector<Buffer> buffers;
+};
+
+/**
+ * @brief loadGltf : parses a .gltf or .glb file, mapping its binary buffers in memory
+ * @throw std::runtime_error on I/O errors, malformed JSON or out of range references
+ *
+ * Supported : meshes (POSITION, NORMAL, TEXCOORD_0, COLOR_0, indices), sparse accessors, PBR metallic-roughness
+ * materials, textures / images references, node hierarchy of the default scene. Animations and skins are ignored.
+ */
+GltfDocument loadGltf(const std::string& path);
+
+#endif // GLTFLOADER_H
@@ -0,0 +1,128 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "gltfmodel.h"
+#include "gpumemory.h"
+#include "profiler.h"
+#include "renderstats.h"
+#include <glad/glad.h>
+#include <glm/gtc/type_ptr.hpp>
+
+unsigned int GltfModel::bufferForAccessor(const GltfDocument &doc, const GltfAccessor &accessor, std::size_t &offset) {
+    if (!accessor.materialized.empty()) {
+        unsigned int id;
+        glGenBuffers(1, &id);
+        glBindBuffer(GL_ARRAY_BUFFER, id);
+        trackedBufferData(GL_ARRAY_BUFFER, id, accessor.materialized.size(), accessor.materialized.data(), GL_STATIC_DRAW, "glTF");
+        extraBuffers.emplace_back(id);
+        offset = 0;
+        return id;
+    }
+    VertexBuffer& buffer = viewBuffers[accessor.bufferView];
+    if (buffer.id() == 0) {
+        //First use of this view : the whole view is uploaded once and shared by every accessor into it
+        const GltfBufferView& view = doc.bufferViews[accessor.bufferView];
+        unsigned int id;
+        glGenBuffers(1, &id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+        trackedBufferData(GL_COPY_WRITE_BUFFER, id, view.byteLength, doc.viewData(view), GL_STATIC_DRAW, "glTF");
+        buffer = VertexBuffer(id);
+        ++viewBufferCount;
+    }
+    offset = accessor.byteOffset;
+    return buffer.id();
+}
+
+GltfModel::GltfModel(const GltfDocument &doc) : viewBuffers(doc.bufferViews.size()), materials(doc.materials)
+{
+    //Primitives, grouped by mesh
+    std::vector<unsigned int> meshFirstPrimitive;
+    for (const GltfMesh& mesh : doc.meshes) {
+        meshFirstPrimitive.push_back(static_cast<unsigned int>(primitives.size()));
+        for (const GltfPrimitive& source : mesh.primitives) {
+            Primitive primitive;
+            primitive.vao = std::make_unique<VertexArray>();
+            primitive.vao->initEmpty();
+            primitive.vao->bind();
+            primitive.mode = source.mode;
+            primitive.material = source.material;
+
+            const int attributes[] = {source.position, source.normal, source.texcoord, source.color};
+            for (unsigned int location = 0; location < 4; ++location) {
+                if (attributes[location] < 0)
+                    continue;
+                const GltfAccessor& accessor = doc.accessors[attributes[location]];
+                std::size_t offset;
+                unsigned int id = bufferForAccessor(doc, accessor, offset);
+                std::size_t stride = accessor.materialized.empty() ? doc.bufferViews[accessor.bufferView].byteStride : 0;
+                glBindBuffer(GL_ARRAY_BUFFER, id);
+                glVertexAttribPointer(location, accessor.components, accessor.componentType,
+                                      accessor.normalized ? GL_TRUE : GL_FALSE, static_cast<GLsizei>(stride), (void*)offset);
+                glEnableVertexAttribArray(location);
+            }
+
+            if (source.indices >= 0) {
+                const GltfAccessor& accessor = doc.accessors[source.indices];
+                unsigned int id = bufferForAccessor(doc, accessor, primitive.indexOffset);
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+                primitive.indexType = accessor.componentType;
+                primitive.count = static_cast<unsigned int>(accessor.count);
+            } else {
+                primitive.indexType = 0;
+                primitive.indexOffset = 0;
+                primitive.count = static_cast<unsigned int>(doc.accessors[source.position].count);
+            }
+            glBindVertexArray(0);
+            primitives.push_back(std::move(primitive));
+        }
+    }
+    meshFirstPrimitive.push_back(static_cast<unsigned int>(primitives.size()));
+
+    for (const GltfNode& node : doc.nodes) {
+        if (node.mesh < 0 || !node.inScene) //Nodes outside the default scene have no world matrix
+            continue;
+        unsigned int first = meshFirstPrimitive[node.mesh];
+        instances.push_back({node.world, first, meshFirstPrimitive[node.mesh + 1] - first});
+    }
+}
+
+void GltfModel::draw(int modelLocation) {
+    for (const Instance& instance : instances) {
+        glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(instance.world));
+        for (unsigned int p = instance.firstPrimitive; p < instance.firstPrimitive + instance.primitiveCount; ++p) {
+            Primitive& primitive = primitives[p];
+            primitive.vao->bind();
+            RenderStats::frame().countDraw(primitive.mode, primitive.count);
+            if (primitive.indexType)
+                glDrawElements(primitive.mode, primitive.count, primitive.indexType, (void*)primitive.indexOffset);
+            else
+                glDrawArrays(primitive.mode, 0, primitive.count);
+        }
+    }
+}
+
+std::unique_ptr<GltfModel> loadGltfModel(const std::string &path) {
+    PROFILE_FUNCTION();
+    GltfDocument doc = loadGltf(path);
+    return std::make_unique<GltfModel>(doc);
+}
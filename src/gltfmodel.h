@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GLTFMODEL_H
+#define GLTFMODEL_H
+
+#include "gltfloader.h"
+#include "vertexarray.h"
+#include "vertexbuffer.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief GPU version of a GltfDocument
+ *
+ * Every buffer view referenced by a primitive becomes one GL buffer, uploaded straight from the mapped file.
+ * Accessors then map to glVertexAttribPointer / glDrawElements offsets into those buffers, so no vertex is
+ * copied or repacked on the CPU. Only accessors that have no in-place representation (sparse, or without
+ * buffer view) get a dedicated buffer from their materialized copy.
+ *
+ * Attribute locations follow the Vertex convention : 0 = POSITION, 1 = NORMAL, 2 = TEXCOORD_0, and 3 = COLOR_0.
+ */
+class GltfModel
+{
+public:
+    /**
+     * @pre a GL context is current
+     */
+    explicit GltfModel(const GltfDocument& doc);
+
+    /**
+     * @brief Draws every mesh instance of the scene, setting its world matrix first
+     * @param modelLocation : location of the mat4 model uniform in the bound program
+     */
+    void draw(int modelLocation);
+
+    /**
+     * @brief Materials of the document, referenced by index from the primitives
+     */
+    const std::vector<GltfMaterial>& getMaterials() const {return materials;}
+
+    std::size_t zeroCopyBufferCount() const {return viewBufferCount;}
+    std::size_t copiedBufferCount() const {return extraBuffers.size();}
+
+private:
+    GltfModel(const GltfModel&) = delete;
+    GltfModel& operator=(const GltfModel&) = delete;
+
+    struct Primitive {
+        std::unique_ptr<VertexArray> vao;
+        unsigned int mode;
+        unsigned int count; //Indices, or vertices when not indexed
+        unsigned int indexType; //0 when not indexed
+        std::size_t indexOffset;
+        int material;
+    };
+    struct Instance {
+        glm::mat4 world;
+        unsigned int firstPrimitive;
+        unsigned int primitiveCount;
+    };
+
+    unsigned int bufferForAccessor(const GltfDocument& doc, const GltfAccessor& accessor, std::size_t& offset);
+
+    std::vector<VertexBuffer> viewBuffers; //One per buffer view, empty when unused
+    std::vector<VertexBuffer> extraBuffers; //Materialized accessors
+    std::size_t viewBufferCount = 0;
+    std::vector<Primitive> primitives;
+    std::vector<Instance> instances;
+    std::vector<GltfMaterial> materials;
+};
+
+/**
+ * @brief loadGltfModel : loads a .gltf / .glb file and uploads it
+ * @return a unique_ptr containing a GltfModel
+ * @throw std::runtime_error
+ */
+std::unique_ptr<GltfModel> loadGltfModel(const std::string& path);
+
+#endif // GLTFMODEL_H
@@ -0,0 +1,115 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+
+void GpuDeletionQueue::release(GpuResourceType type, unsigned int id) {
+    if (id == 0)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    released.push_back({type, id});
+    pendingObjects.fetch_add(1, std::memory_order_relaxed);
+}
+
+void GpuDeletionQueue::endFrame() {
+    Batch batch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        batch.resources.swap(released);
+    }
+    if (!batch.resources.empty()) {
+        batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        batches.push_back(std::move(batch));
+    }
+
+    //Fences signal in order
+    while (!batches.empty()) {
+        GLenum status = glClientWaitSync(batches.front().fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break;
+        glDeleteSync(batches.front().fence);
+        destroy(batches.front().resources);
+        batches.pop_front();
+    }
+}
+
+void GpuDeletionQueue::flush() {
+    std::vector<Resource> resources;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        resources.swap(released);
+    }
+    if (batches.empty() && resources.empty())
+        return;
+
+    glFinish();
+    for (const Batch& batch : batches) {
+        glDeleteSync(batch.fence);
+        destroy(batch.resources);
+    }
+    batches.clear();
+    destroy(resources);
+}
+
+void GpuDeletionQueue::destroy(const std::vector<Resource> &resources) {
+    GpuMemory& memory = GpuMemory::global();
+    for (const Resource& resource : resources) {
+        switch (resource.type) {
+        case GpuResourceType::Buffer:
+            memory.release(GpuMemoryCategory::Buffer, resource.id);
+            glDeleteBuffers(1, &resource.id);
+            break;
+        case GpuResourceType::VertexArray:
+            glDeleteVertexArrays(1, &resource.id);
+            break;
+        case GpuResourceType::Texture:
+            memory.release(GpuMemoryCategory::Texture, resource.id);
+            glDeleteTextures(1, &resource.id);
+            break;
+        case GpuResourceType::Renderbuffer:
+            memory.release(GpuMemoryCategory::Renderbuffer, resource.id);
+            glDeleteRenderbuffers(1, &resource.id);
+            break;
+        case GpuResourceType::Framebuffer:
+            glDeleteFramebuffers(1, &resource.id);
+            break;
+        case GpuResourceType::Program:
+            memory.release(GpuMemoryCategory::Program, resource.id);
+            glDeleteProgram(resource.id);
+            break;
+        case GpuResourceType::Sampler:
+            glDeleteSamplers(1, &resource.id);
+            break;
+        case GpuResourceType::Query:
+            glDeleteQueries(1, &resource.id);
+            break;
+        }
+    }
+    pendingObjects.fetch_sub(resources.size(), std::memory_order_relaxed);
+}
+
+GpuDeletionQueue& GpuDeletionQueue::global() {
+    static GpuDeletionQueue queue;
+    return queue;
+}
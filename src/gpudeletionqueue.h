@@ -0,0 +1,102 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GPUDELETIONQUEUE_H
+#define GPUDELETIONQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <glad/glad.h>
+
+enum class GpuResourceType {
+    Buffer,
+    VertexArray,
+    Texture,
+    Renderbuffer,
+    Framebuffer,
+    Program,
+    Sampler,
+    Query
+};
+
+/**
+ * @brief Deletes GL objects once the GPU is done with them.
+ *
+ * Deleting an object the GPU may still read makes some drivers wait for it. Released objects are instead kept
+ * until a fence inserted at the end of the frame they were released in has signaled : that frame is the last one
+ * which can have used them. They are then deleted, and unregistered from GpuMemory.
+ *
+ * release() makes no GL call, so it can be called from any thread, e.g. when a worker drops the last reference
+ * to a mesh. The rest runs on the GL thread.
+ */
+class GpuDeletionQueue
+{
+public:
+    /**
+     * @brief Schedules the deletion of an object. 0 is ignored.
+     * @pre the object isn't used by commands issued after the end of the current frame
+     */
+    void release(GpuResourceType type, unsigned int id);
+
+    /**
+     * @brief Fences the objects released during the frame, and deletes the ones of the frames the GPU finished.
+     * Never waits. Call once per frame on the GL thread, after its last command.
+     */
+    void endFrame();
+
+    /**
+     * @brief Waits for the GPU and deletes every released object. Call on the GL thread, before the context goes.
+     */
+    void flush();
+
+    /**
+     * @brief Number of objects released but not deleted yet
+     */
+    std::size_t pendingCount() const {return pendingObjects.load(std::memory_order_relaxed);}
+
+    static GpuDeletionQueue& global();
+
+private:
+    struct Resource
+    {
+        GpuResourceType type;
+        unsigned int id;
+    };
+    struct Batch
+    {
+        GLsync fence;
+        std::vector<Resource> resources;
+    };
+
+    void destroy(const std::vector<Resource>& resources);
+
+    std::mutex mutex;
+    std::vector<Resource> released; //Since the last endFrame(), by any thread
+    std::deque<Batch> batches; //GL thread only, oldest first
+    std::atomic<std::size_t> pendingObjects{0};
+};
+
+#endif // GPUDELETIONQUEUE_H
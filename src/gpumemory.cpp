@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "gpumemory.h"
+#include "glextensions.h"
+#include "texture.h"
+#include <algorithm>
+#include <ostream>
+
+const char* gpuMemoryCategoryName(GpuMemoryCategory category) {
+    switch (category) {
+    case GpuMemoryCategory::Buffer: return "buffer";
+    case GpuMemoryCategory::Texture: return "texture";
+    case GpuMemoryCategory::Renderbuffer: return "renderbuffer";
+    case GpuMemoryCategory::Program: return "program";
+    }
+    return "";
+}
+
+GpuMemory& GpuMemory::global() {
+    static GpuMemory memory;
+    return memory;
+}
+
+void GpuMemory::add(Usage &usage, std::size_t bytes) {
+    usage.bytes += bytes;
+    usage.peak = std::max(usage.peak, usage.bytes);
+}
+
+void GpuMemory::remove(Usage &usage, std::size_t bytes) {
+    usage.bytes -= std::min(usage.bytes, bytes);
+}
+
+void GpuMemory::allocate(GpuMemoryCategory category, unsigned int id, std::size_t bytes, const std::string &tag) {
+    const unsigned int index = static_cast<unsigned int>(category);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = resources.find(key(category, id));
+    if (found != resources.end()) {
+        //Released first so that a resize doesn't count both sizes in the high-water marks
+        Resource& previous = found->second;
+        remove(all, previous.bytes);
+        remove(categories[index], previous.bytes);
+        remove(previous.tag->second, previous.bytes);
+        --previous.tag->second.resources;
+        --categories[index].resources;
+        --all.resources;
+    }
+
+    TagMap::iterator tagged = tags[index].find(tag);
+    if (tagged == tags[index].end())
+        tagged = tags[index].emplace(tag, Usage()).first;
+    Resource& resource = resources[key(category, id)];
+    resource = {bytes, tagged};
+    add(all, bytes);
+    add(categories[index], bytes);
+    add(tagged->second, bytes);
+    ++tagged->second.resources;
+    ++categories[index].resources;
+    ++all.resources;
+}
+
+void GpuMemory::release(GpuMemoryCategory category, unsigned int id) {
+    const unsigned int index = static_cast<unsigned int>(category);
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = resources.find(key(category, id));
+    if (found == resources.end())
+        return;
+    const Resource& resource = found->second;
+    remove(all, resource.bytes);
+    remove(categories[index], resource.bytes);
+    remove(resource.tag->second, resource.bytes);
+    --resource.tag->second.resources;
+    --categories[index].resources;
+    --all.resources;
+    resources.erase(found);
+}
+
+std::size_t GpuMemory::size(GpuMemoryCategory category, unsigned int id) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = resources.find(key(category, id));
+    return found != resources.end() ? found->second.bytes : 0;
+}
+
+GpuMemory::Usage GpuMemory::total() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return all;
+}
+
+GpuMemory::Usage GpuMemory::usage(GpuMemoryCategory category) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return categories[static_cast<unsigned int>(category)];
+}
+
+std::vector<GpuMemory::TagUsage> GpuMemory::usageByTag() const {
+    std::vector<TagUsage> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (unsigned int category = 0; category < gpuMemoryCategoryCount; ++category)
+            for (const auto& tag : tags[category])
+                result.push_back({static_cast<GpuMemoryCategory>(category), tag.first, tag.second});
+    }
+    std::stable_sort(result.begin(), result.end(), [](const TagUsage& a, const TagUsage& b) {
+        return a.usage.bytes > b.usage.bytes;
+    });
+    return result;
+}
+
+std::size_t GpuMemory::reportLeaks(std::ostream &out) const {
+    struct Leak {
+        std::uint64_t key;
+        std::size_t bytes;
+        const std::string* tag;
+    };
+    std::vector<Leak> leaks;
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& resource : resources)
+        leaks.push_back({resource.first, resource.second.bytes, &resource.second.tag->first});
+    std::sort(leaks.begin(), leaks.end(), [](const Leak& a, const Leak& b) {
+        return a.bytes != b.bytes ? a.bytes > b.bytes : a.key < b.key;
+    });
+
+    if (!leaks.empty())
+        out << leaks.size() << " GPU resources leaked, " << all.bytes << " bytes :\n";
+    for (const Leak& leak : leaks)
+        out << "  " << gpuMemoryCategoryName(static_cast<GpuMemoryCategory>(leak.key >> 32)) << ' '
+            << static_cast<unsigned int>(leak.key & 0xFFFFFFFFu) << " (" << *leak.tag << ") : " << leak.bytes << " bytes\n";
+    return leaks.size();
+}
+
+std::size_t GpuMemory::programSize(unsigned int program) {
+    if (!GLEXT_program_binary)
+        return 0;
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    return static_cast<std::size_t>(std::max(length, 0));
+}
+
+void trackedBufferData(GLenum target, unsigned int buffer, std::size_t size, const void *data, GLenum usage, const std::string &tag) {
+    glBufferData(target, static_cast<GLsizeiptr>(size), data, usage);
+    GpuMemory::global().allocate(GpuMemoryCategory::Buffer, buffer, size, tag);
+}
+
+void trackedRenderbufferStorage(unsigned int renderbuffer, GLenum internalFormat, unsigned int width, unsigned int height,
+                                const std::string &tag) {
+    glRenderbufferStorage(GL_RENDERBUFFER, internalFormat, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    GpuMemory::global().allocate(GpuMemoryCategory::Renderbuffer, renderbuffer, textureImageSize(internalFormat, width, height), tag);
+}
@@ -0,0 +1,150 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GPUMEMORY_H
+#define GPUMEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glad/glad.h>
+
+enum class GpuMemoryCategory {
+    Buffer,
+    Texture,
+    Renderbuffer,
+    Program ///< Estimated from the size of the program binary, 0 when the driver can't tell
+};
+
+const unsigned int gpuMemoryCategoryCount = 4;
+
+const char* gpuMemoryCategoryName(GpuMemoryCategory category);
+
+/**
+ * @brief Bookkeeping of the video memory allocated by the application : every GL wrapper registers the storage of
+ * its objects here, under a category and a tag telling what they are for ("Mesh", "Hi-Z", ...).
+ *
+ * Sizes are the ones requested from GL, the driver may round them up or keep extra copies. High-water marks are
+ * kept for the total, each category and each tag. Whatever is still registered at shutdown was leaked, see
+ * reportLeaks().
+ *
+ * \code
+ * trackedBufferData(GL_ARRAY_BUFFER, buffer, size, data, GL_STATIC_DRAW, "Terrain");
+ * //[...]
+ * GpuDeletionQueue::global().release(GpuResourceType::Buffer, buffer); //Unregistered once deleted
+ * \endcode
+ */
+class GpuMemory
+{
+public:
+    struct Usage
+    {
+        std::size_t bytes = 0;
+        std::size_t peak = 0; ///< Highest bytes ever
+        unsigned int resources = 0;
+    };
+
+    struct TagUsage
+    {
+        GpuMemoryCategory category;
+        std::string tag;
+        Usage usage;
+    };
+
+    /**
+     * @brief Records the storage of an object. An object already known is resized, and moved to the new tag.
+     * @param id : name of the GL object, in the namespace of its category
+     */
+    void allocate(GpuMemoryCategory category, unsigned int id, std::size_t bytes, const std::string& tag);
+
+    /**
+     * @brief Forgets an object, when it is deleted. Unknown objects are ignored.
+     */
+    void release(GpuMemoryCategory category, unsigned int id);
+
+    /**
+     * @brief Registered size of an object, 0 if unknown
+     */
+    std::size_t size(GpuMemoryCategory category, unsigned int id) const;
+
+    Usage total() const;
+    Usage usage(GpuMemoryCategory category) const;
+
+    /**
+     * @brief Usage of every tag seen so far, largest first
+     */
+    std::vector<TagUsage> usageByTag() const;
+
+    /**
+     * @brief Lists the objects still registered, one per line, largest first
+     * @return their number
+     */
+    std::size_t reportLeaks(std::ostream& out) const;
+
+    /**
+     * @brief Size to register for a linked program : the length of its binary when the driver exposes it
+     */
+    static std::size_t programSize(unsigned int program);
+
+    static GpuMemory& global();
+
+private:
+    typedef std::map<std::string, Usage> TagMap;
+    struct Resource
+    {
+        std::size_t bytes;
+        TagMap::iterator tag;
+    };
+
+    static std::uint64_t key(GpuMemoryCategory category, unsigned int id) {
+        return static_cast<std::uint64_t>(category) << 32 | id;
+    }
+    static void add(Usage& usage, std::size_t bytes);
+    static void remove(Usage& usage, std::size_t bytes);
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::uint64_t, Resource> resources;
+    TagMap tags[gpuMemoryCategoryCount];
+    Usage categories[gpuMemoryCategoryCount];
+    Usage all;
+};
+
+/**
+ * @brief glBufferData, with the new size of the buffer registered
+ * @pre buffer is bound to target
+ */
+void trackedBufferData(GLenum target, unsigned int buffer, std::size_t size, const void* data, GLenum usage, const std::string& tag);
+
+/**
+ * @brief glRenderbufferStorage, with the size of the storage registered
+ * @pre renderbuffer is bound to GL_RENDERBUFFER
+ */
+void trackedRenderbufferStorage(unsigned int renderbuffer, GLenum internalFormat, unsigned int width, unsigned int height,
+                                const std::string& tag);
+
+#endif // GPUMEMORY_H
@@ -0,0 +1,145 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "gpuprofiler.h"
+#include "framearena.h"
+#include "gpudeletionqueue.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+const std::uint64_t calibrationInterval = 256; //Frames between two GPU / CPU clock alignments
+
+} // namespace
+
+GpuProfiler::GpuProfiler() {
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &timerBits);
+    if (supported())
+        track = Profiler::global().addTrack("GPU");
+}
+
+GpuProfiler::~GpuProfiler() {
+    //Queries of the last frames may still be pending
+    for (const FrameQueries& frame : frames)
+        for (unsigned int query : frame.queries)
+            GpuDeletionQueue::global().release(GpuResourceType::Query, query);
+}
+
+void GpuProfiler::beginFrame() {
+    if (!supported())
+        return;
+    if (inFrame)
+        throw std::runtime_error("GpuProfiler::beginFrame called twice without endFrame");
+
+    //Oldest first, the last one being the set reused for this frame
+    for (unsigned int i = 1; i <= gpuProfilerFrames; ++i) {
+        FrameQueries& frame = frames[(current + i) % gpuProfilerFrames];
+        if (frame.pending && readBack(frame))
+            frame.pending = false;
+    }
+    current = (current + 1) % gpuProfilerFrames;
+    FrameQueries& frame = frames[current];
+    if (frame.pending) { //Still running after gpuProfilerFrames frames : don't wait for it
+        ++dropped;
+        frame.pending = false;
+    }
+
+    if (frameCount++ % calibrationInterval == 0)
+        calibrate();
+    frame.zones.clear();
+    frame.used = 0;
+    openZones.clear();
+    inFrame = true;
+    begin("GPU frame");
+}
+
+void GpuProfiler::endFrame() {
+    if (!supported() || !inFrame)
+        return;
+    if (openZones.size() != 1)
+        throw std::runtime_error("GpuProfiler::endFrame called with zones still open");
+    end();
+    frames[current].pending = true;
+    inFrame = false;
+}
+
+void GpuProfiler::begin(const char *name) {
+    if (!supported() || !inFrame) //Zones outside of a frame are ignored
+        return;
+    FrameQueries& frame = frames[current];
+    openZones.push_back(static_cast<unsigned int>(frame.zones.size()));
+    frame.zones.push_back({name, static_cast<unsigned int>(openZones.size() - 1), timestamp(frame), 0});
+}
+
+void GpuProfiler::end() {
+    if (!supported() || !inFrame || openZones.empty())
+        return;
+    FrameQueries& frame = frames[current];
+    frame.zones[openZones.back()].endQuery = timestamp(frame);
+    openZones.pop_back();
+}
+
+unsigned int GpuProfiler::timestamp(FrameQueries &frame) {
+    if (frame.used == frame.queries.size()) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        frame.queries.push_back(query);
+    }
+    glQueryCounter(frame.queries[frame.used], GL_TIMESTAMP);
+    return frame.used++;
+}
+
+bool GpuProfiler::readBack(FrameQueries &frame) {
+    //Checked one by one, nothing guarantees that queries become available in order
+    for (unsigned int i = 0; i < frame.used; ++i) {
+        int available = GL_FALSE;
+        glGetQueryObjectiv(frame.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return false;
+    }
+
+    FrameVector<GLuint64> times(frame.used);
+    for (unsigned int i = 0; i < frame.used; ++i)
+        glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &times[i]);
+
+    Profiler& profiler = Profiler::global();
+    lastResults.clear();
+    for (const Zone& zone : frame.zones) {
+        const std::uint64_t start = times[zone.beginQuery];
+        const std::uint64_t end = std::max<std::uint64_t>(times[zone.endQuery], start);
+        lastResults.push_back({zone.name, zone.depth, (end - start) / 1e6});
+        if (profiler.enabled())
+            profiler.record(track, zone.name, static_cast<std::uint64_t>(static_cast<std::int64_t>(start) + gpuToCpu),
+                            static_cast<std::uint64_t>(static_cast<std::int64_t>(end) + gpuToCpu));
+    }
+    return true;
+}
+
+//The GPU clock has its own origin and may drift a little from the CPU one
+void GpuProfiler::calibrate() {
+    GLint64 gpuNow = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpuNow); //Doesn't wait for the queued commands
+    gpuToCpu = static_cast<std::int64_t>(Profiler::now()) - gpuNow;
+}
@@ -0,0 +1,151 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GPUPROFILER_H
+#define GPUPROFILER_H
+
+#include "profiler.h"
+#include <cstdint>
+#include <vector>
+
+const unsigned int gpuProfilerFrames = 4; ///< Frames in flight, results come back that many frames late
+
+/**
+ * @brief Times GPU passes with timestamp queries, without ever waiting for the GPU.
+ *
+ * Each frame writes its queries into one of gpuProfilerFrames sets, read back when the set comes round again : by
+ * then the GPU is normally done with them. A frame whose queries still aren't available is dropped rather than
+ * waited on. Read back zones are also recorded on a "GPU" track of the CPU Profiler, on the same time base as
+ * the CPU zones, so that a trace shows whether the frame is CPU or GPU bound.
+ *
+ * Zones nest, as they are made of two timestamps and not of GL_TIME_ELAPSED queries, which can't.
+ *
+ * \code
+ * gpuProfiler.beginFrame();
+ * {
+ *     GPU_PROFILE_SCOPE(gpuProfiler, "Shadows");
+ *     // [...]
+ * }
+ * gpuProfiler.endFrame();
+ * window.display();
+ * \endcode
+ */
+class GpuProfiler
+{
+public:
+    struct Timing
+    {
+        const char* name;
+        unsigned int depth; ///< 0 for the whole frame, 1 for the top level zones
+        double milliseconds;
+    };
+
+    /**
+     * @pre an OpenGL context is current
+     */
+    GpuProfiler();
+    ~GpuProfiler();
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    /**
+     * @brief Reads back the finished frames and starts timing a new one
+     */
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * @brief Starts a zone in the current frame, up to the matching end()
+     * @param name : must outlive the profiler, typically a string literal
+     */
+    void begin(const char* name);
+    void end();
+
+    /**
+     * @brief The zones of the last frame read back, in the order they started. The first one is the whole frame.
+     */
+    const std::vector<Timing>& results() const {return lastResults;}
+
+    /**
+     * @brief False when the driver has no timer (GL_QUERY_COUNTER_BITS is 0), the profiler then does nothing
+     */
+    bool supported() const {return timerBits > 0;}
+
+    /**
+     * @brief Frames whose queries weren't available in time
+     */
+    std::uint64_t droppedFrames() const {return dropped;}
+
+private:
+    struct Zone
+    {
+        const char* name;
+        unsigned int depth;
+        unsigned int beginQuery, endQuery; //Indices in FrameQueries::queries
+    };
+    struct FrameQueries
+    {
+        std::vector<unsigned int> queries; //Grows as needed, reused from frame to frame
+        std::vector<Zone> zones;
+        unsigned int used = 0;
+        bool pending = false; //Ended and not read back yet
+    };
+
+    unsigned int timestamp(FrameQueries& frame);
+    bool readBack(FrameQueries& frame);
+    void calibrate();
+
+    FrameQueries frames[gpuProfilerFrames];
+    unsigned int current = 0;
+    bool inFrame = false;
+    std::vector<unsigned int> openZones; //Indices in the current frame's zones
+    std::vector<Timing> lastResults;
+    std::int64_t gpuToCpu = 0; //Added to GPU timestamps to get Profiler::now() times
+    std::uint64_t frameCount = 0;
+    std::uint64_t dropped = 0;
+    int timerBits = 0;
+    unsigned int track = 0;
+};
+
+/**
+ * @brief Times the GPU commands issued from its construction to its destruction. Use GPU_PROFILE_SCOPE().
+ */
+class GpuProfileZone
+{
+public:
+    GpuProfileZone(GpuProfiler& profiler, const char* name) : profiler(profiler) {profiler.begin(name);}
+    ~GpuProfileZone() {profiler.end();}
+
+private:
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+    GpuProfiler& profiler;
+};
+
+#ifndef NO_PROFILING
+#define GPU_PROFILE_SCOPE(profiler, name) GpuProfileZone PROFILE_CONCAT(gpuProfileZone, __LINE__)(profiler, name)
+#else
+#define GPU_PROFILE_SCOPE(profiler, name) ((void)0)
+#endif
+
+#endif // GPUPROFILER_H
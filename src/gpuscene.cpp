@@ -0,0 +1,244 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "gpuscene.h"
+#include "frustum.h"
+#include "glextensions.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+#include "meshformat.h"
+#include "renderstats.h"
+#include <algorithm>
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+namespace {
+
+const unsigned int commandWords = 5; //DrawElementsIndirectCommand
+const unsigned int cullGroupSize = 64; //local_size_x of shaders/cull.comp
+const unsigned int hiZGroupSize = 8;
+
+//Bound to GL_COPY_WRITE_BUFFER so that the VAO and indirect bindings are left untouched
+void uploadBuffer(unsigned int buffer, const void* data, std::size_t size) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    trackedBufferData(GL_COPY_WRITE_BUFFER, buffer, size, data, GL_DYNAMIC_DRAW, "GPU scene");
+}
+
+void clearBuffer(unsigned int buffer) {
+    const unsigned int zero = 0;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glClearBufferData(GL_COPY_WRITE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+}
+
+} // namespace
+
+GpuScene::GpuScene()
+    : cullShader(makeComputeShaderFromFile("shaders/cull.comp")), hiZShader(makeComputeShaderFromFile("shaders/hiz.comp"))
+{
+    unsigned int buffers[6];
+    glGenBuffers(6, buffers);
+    vertexBuffer = buffers[0];
+    indexBuffer = buffers[1];
+    instanceBuffer = buffers[2];
+    meshBuffer = buffers[3];
+    commandBuffer = buffers[4];
+    countBuffer = buffers[5];
+    uploadBuffer(countBuffer, nullptr, sizeof(unsigned int));
+
+    vao.initEmpty();
+    vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    for (const MeshFileAttribute& attribute : defaultVertexLayout()) {
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                              sizeof(Vertex), (void*)(std::size_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+    //The model matrix, one column per location
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    for (unsigned int column = 0; column < 4; ++column) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+        glEnableVertexAttribArray(3 + column);
+    }
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBindVertexArray(0);
+}
+
+GpuScene::~GpuScene() {
+    for (unsigned int buffer : {vertexBuffer, indexBuffer, instanceBuffer, meshBuffer, commandBuffer, countBuffer})
+        GpuDeletionQueue::global().release(GpuResourceType::Buffer, buffer);
+}
+
+unsigned int GpuScene::addMesh(const MeshData &mesh) {
+    MeshInfo info;
+    info.indexCount = static_cast<unsigned int>(mesh.indices.size());
+    info.firstIndex = static_cast<unsigned int>(indices.size());
+    info.baseVertex = static_cast<int>(vertices.size());
+    info.padding = 0;
+    glm::vec3 min = mesh.vertices.empty() ? glm::vec3(0.0f) : mesh.vertices[0].position, max = min;
+    for (const Vertex& v : mesh.vertices) {
+        min = glm::min(min, v.position);
+        max = glm::max(max, v.position);
+    }
+    const glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0;
+    for (const Vertex& v : mesh.vertices)
+        radius = std::max(radius, glm::length(v.position - center));
+    info.sphere = glm::vec4(center, radius);
+
+    vertices.insert(vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+    indices.insert(indices.end(), mesh.indices.begin(), mesh.indices.end());
+    meshes.push_back(info);
+    geometryDirty = true;
+    return static_cast<unsigned int>(meshes.size() - 1);
+}
+
+unsigned int GpuScene::addInstance(unsigned int mesh, const glm::mat4 &model) {
+    instances.push_back({model, mesh, {0, 0, 0}});
+    dirtyEnd = instances.size();
+    return static_cast<unsigned int>(instances.size() - 1);
+}
+
+void GpuScene::setTransform(unsigned int instance, const glm::mat4 &model) {
+    instances[instance].model = model;
+    if (dirtyBegin == dirtyEnd)
+        dirtyBegin = instance;
+    dirtyBegin = std::min<std::size_t>(dirtyBegin, instance);
+    dirtyEnd = std::max<std::size_t>(dirtyEnd, instance + 1);
+}
+
+void GpuScene::uploadGeometry() {
+    uploadBuffer(vertexBuffer, vertices.data(), vertices.size() * sizeof(Vertex));
+    uploadBuffer(indexBuffer, indices.data(), indices.size() * sizeof(unsigned int));
+    uploadBuffer(meshBuffer, meshes.data(), meshes.size() * sizeof(MeshInfo));
+    geometryDirty = false;
+}
+
+void GpuScene::uploadInstances() {
+    if (instances.size() > instanceCapacity) {
+        //Grown geometrically, everything is uploaded again
+        instanceCapacity = std::max(instances.size(), instanceCapacity * 2);
+        uploadBuffer(instanceBuffer, nullptr, instanceCapacity * sizeof(Instance));
+        uploadBuffer(commandBuffer, nullptr, instanceCapacity * commandWords * sizeof(unsigned int));
+        dirtyBegin = 0;
+        dirtyEnd = instances.size();
+    }
+    if (dirtyBegin < dirtyEnd) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, instanceBuffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, dirtyBegin * sizeof(Instance), (dirtyEnd - dirtyBegin) * sizeof(Instance),
+                        &instances[dirtyBegin]);
+    }
+    dirtyBegin = dirtyEnd = 0;
+}
+
+void GpuScene::cull(const glm::mat4 &viewProjection) {
+    if (instances.empty())
+        return;
+    if (geometryDirty)
+        uploadGeometry();
+    uploadInstances();
+
+    //Commands past the visible ones must draw nothing when the count can't come from the GPU
+    clearBuffer(countBuffer);
+    if (!GLEXT_indirect_parameters)
+        clearBuffer(commandBuffer);
+
+    unsigned int program = cullShader->getProgramId();
+    ++RenderStats::frame().programBinds;
+    glUseProgram(program);
+    const Frustum frustum(viewProjection);
+    glm::vec4 planes[6];
+    for (int i = 0; i < 6; ++i)
+        planes[i] = frustum.plane(i);
+    glUniform4fv(glGetUniformLocation(program, "frustumPlanes"), 6, glm::value_ptr(planes[0]));
+    glUniformMatrix4fv(glGetUniformLocation(program, "viewProjection"), 1, GL_FALSE, glm::value_ptr(viewProjection));
+    glUniform1ui(glGetUniformLocation(program, "instanceCount"), static_cast<unsigned int>(instances.size()));
+    const bool occlusion = occlusionEnabled && depthPyramid;
+    glUniform1i(glGetUniformLocation(program, "hiZLevels"), occlusion ? static_cast<int>(depthPyramid->levels()) : 0);
+    if (occlusion) {
+        depthPyramid->bind(0);
+        glUniform1i(glGetUniformLocation(program, "hiZ"), 0);
+        glUniform2f(glGetUniformLocation(program, "hiZSize"), float(depthPyramid->width()), float(depthPyramid->height()));
+    }
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, meshBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, countBuffer);
+    cullShader->dispatch(static_cast<unsigned int>((instances.size() + cullGroupSize - 1) / cullGroupSize));
+    glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void GpuScene::draw() {
+    if (instances.empty())
+        return;
+    vao.bind();
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    ++RenderStats::frame().drawCalls;
+    if (GLEXT_indirect_parameters) {
+        glBindBuffer(GL_PARAMETER_BUFFER_ARB, countBuffer);
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, static_cast<GLsizei>(instances.size()), 0);
+    } else {
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(instances.size()), 0);
+    }
+    glBindVertexArray(0);
+}
+
+void GpuScene::updateOcclusion(unsigned int width, unsigned int height) {
+    if (!occlusionEnabled || width == 0 || height == 0)
+        return;
+    if (!depthPyramid || depthPyramid->width() != width || depthPyramid->height() != height) {
+        depthCopy = std::make_unique<Texture2D>(width, height, TextureFormat{GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT}, 1);
+        depthPyramid = std::make_unique<Texture2D>(width, height, TextureFormat{GL_R32F, GL_RED, GL_FLOAT});
+        depthCopy->setMemoryTag("Hi-Z");
+        depthPyramid->setMemoryTag("Hi-Z");
+    }
+    //From the read framebuffer, the default one
+    glBindTexture(GL_TEXTURE_2D, depthCopy->id());
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+    unsigned int program = hiZShader->getProgramId();
+    ++RenderStats::frame().programBinds;
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "source"), 0);
+    for (unsigned int level = 0; level < depthPyramid->levels(); ++level) {
+        if (level == 0)
+            depthCopy->bind(0);
+        else
+            depthPyramid->bind(0);
+        glUniform1i(glGetUniformLocation(program, "sourceLevel"), static_cast<int>(level) - 1);
+        glUniform1i(glGetUniformLocation(program, "downsample"), level > 0);
+        glBindImageTexture(0, depthPyramid->id(), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        hiZShader->dispatch((depthPyramid->levelWidth(level) + hiZGroupSize - 1) / hiZGroupSize,
+                            (depthPyramid->levelHeight(level) + hiZGroupSize - 1) / hiZGroupSize);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+    }
+}
+
+unsigned int GpuScene::readVisibleCount() const {
+    unsigned int count = 0;
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    glBindBuffer(GL_COPY_READ_BUFFER, countBuffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, sizeof(count), &count);
+    return count;
+}
@@ -0,0 +1,142 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef GPUSCENE_H
+#define GPUSCENE_H
+
+#include "computeshader.h"
+#include "meshdata.h"
+#include "texture.h"
+#include "vertexarray.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <glm/mat4x4.hpp>
+
+/**
+ * @brief GPU-driven renderer for many instances of a few meshes.
+ *
+ * All meshes share one vertex and one index buffer. Instances live in a shader storage buffer, and each
+ * frame a compute pass (shaders/cull.comp) tests them against the frustum and against a depth pyramid of
+ * the previous frame, appending one indirect command per visible instance. A single
+ * glMultiDrawElementsIndirect then draws them all, so the CPU cost of draw() no longer depends on the
+ * instance count. The model matrices reach the vertex shader as per-instance attributes at locations 3 to 6
+ * (see shaders/gpudriven.vert), offset by the baseInstance of each command.
+ *
+ * The occlusion test uses the depth of the previous frame with the current view, so an object uncovered
+ * by a fast camera move may pop in one frame late.
+ *
+ * \code
+ * //Each frame
+ * scene.cull(projection * view);
+ * glUseProgram(program); //Set its uniforms
+ * scene.draw();
+ * scene.updateOcclusion(width, height); //Before swapping buffers
+ * \endcode
+ * @pre GLEXT_compute
+ */
+class GpuScene
+{
+public:
+    /**
+     * @brief Loads shaders/cull.comp and shaders/hiz.comp
+     * @throw std::runtime_error if they don't compile
+     */
+    GpuScene();
+    ~GpuScene();
+
+    /**
+     * @brief Appends a mesh to the shared buffers
+     * @return its index, for addInstance()
+     */
+    unsigned int addMesh(const MeshData& mesh);
+
+    /**
+     * @return index of the instance, for setTransform()
+     */
+    unsigned int addInstance(unsigned int mesh, const glm::mat4& model);
+    void setTransform(unsigned int instance, const glm::mat4& model);
+
+    std::size_t instanceCount() const {return instances.size();}
+
+    /**
+     * @brief Uploads what changed since last frame, then culls the instances on the GPU
+     */
+    void cull(const glm::mat4& viewProjection);
+
+    /**
+     * @brief Draws the instances cull() kept, with the program currently bound
+     */
+    void draw();
+
+    /**
+     * @brief Copies the depth buffer of the default framebuffer and builds the depth pyramid used by the next cull()
+     */
+    void updateOcclusion(unsigned int width, unsigned int height);
+
+    void setOcclusionCulling(bool enabled) {occlusionEnabled = enabled;}
+
+    /**
+     * @brief readVisibleCount : number of draws emitted by the last cull(). Waits for the GPU, debug only.
+     */
+    unsigned int readVisibleCount() const;
+
+private:
+    GpuScene(const GpuScene&) = delete;
+    GpuScene& operator=(const GpuScene&) = delete;
+
+    //std430 layouts of shaders/cull.comp
+    struct Instance {
+        glm::mat4 model;
+        unsigned int mesh;
+        unsigned int padding[3];
+    };
+    struct MeshInfo {
+        unsigned int indexCount;
+        unsigned int firstIndex;
+        int baseVertex;
+        unsigned int padding;
+        glm::vec4 sphere;
+    };
+
+    void uploadGeometry();
+    void uploadInstances();
+
+    std::unique_ptr<ComputeShader> cullShader, hiZShader;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<MeshInfo> meshes;
+    std::vector<Instance> instances;
+    bool geometryDirty = false;
+    std::size_t dirtyBegin = 0, dirtyEnd = 0; //Instances to upload
+
+    VertexArray vao;
+    unsigned int vertexBuffer = 0, indexBuffer = 0; //Owned by vao
+    unsigned int instanceBuffer = 0, meshBuffer = 0, commandBuffer = 0, countBuffer = 0;
+    std::size_t instanceCapacity = 0;
+
+    bool occlusionEnabled = true;
+    std::unique_ptr<Texture2D> depthCopy, depthPyramid;
+};
+
+#endif // GPUSCENE_H
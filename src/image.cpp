@@ -0,0 +1,501 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "image.h"
+#include "mappedfile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+/* Inflate, after zlib's "puff" reference decoder : canonical Huffman codes decoded bit by bit.
+ * Slower than table-driven decoders, which doesn't matter for an offline tool. */
+
+class BitReader
+{
+public:
+    BitReader(const unsigned char* data, std::size_t size) : p(data), end(data + size) {}
+
+    unsigned int bits(int count) {
+        while (bitCount < count) {
+            if (p == end)
+                throw std::runtime_error("Truncated deflate stream");
+            buffer |= static_cast<std::uint32_t>(*p++) << bitCount;
+            bitCount += 8;
+        }
+        unsigned int result = buffer & ((1u << count) - 1);
+        buffer >>= count;
+        bitCount -= count;
+        return result;
+    }
+
+    //Stored blocks start on a byte boundary. Less than 8 bits are ever buffered, so they can just be dropped.
+    void alignToByte() {
+        buffer = 0;
+        bitCount = 0;
+    }
+
+    const unsigned char* position() const {return p;}
+    std::size_t remaining() const {return static_cast<std::size_t>(end - p);}
+    void skip(std::size_t count) {p += count;}
+
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+    std::uint32_t buffer = 0;
+    int bitCount = 0;
+};
+
+struct Huffman {
+    std::uint16_t counts[16]; //Number of codes of each length
+    std::uint16_t symbols[288]; //Symbols ordered by code
+};
+
+void buildHuffman(Huffman& h, const unsigned char* lengths, int count) {
+    std::fill(std::begin(h.counts), std::end(h.counts), 0);
+    for (int i = 0; i < count; ++i)
+        ++h.counts[lengths[i]];
+    h.counts[0] = 0;
+    std::uint16_t offsets[16];
+    offsets[1] = 0;
+    for (int len = 1; len < 15; ++len)
+        offsets[len + 1] = offsets[len] + h.counts[len];
+    for (int i = 0; i < count; ++i)
+        if (lengths[i])
+            h.symbols[offsets[lengths[i]]++] = static_cast<std::uint16_t>(i);
+}
+
+int decodeSymbol(BitReader& in, const Huffman& h) {
+    int code = 0, first = 0, index = 0;
+    for (int len = 1; len < 16; ++len) {
+        code |= in.bits(1);
+        int count = h.counts[len];
+        if (code - first < count)
+            return h.symbols[index + (code - first)];
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    throw std::runtime_error("Invalid Huffman code in deflate stream");
+}
+
+const std::uint16_t lengthBase[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+const std::uint8_t lengthExtra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+const std::uint16_t distanceBase[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769,
+                                        1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+const std::uint8_t distanceExtra[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+void inflateCodes(BitReader& in, std::vector<unsigned char>& out, const Huffman& literals, const Huffman& distances) {
+    for (;;) {
+        int symbol = decodeSymbol(in, literals);
+        if (symbol < 256) {
+            out.push_back(static_cast<unsigned char>(symbol));
+        } else if (symbol == 256) {
+            return;
+        } else {
+            symbol -= 257;
+            if (symbol >= 29)
+                throw std::runtime_error("Invalid length code in deflate stream");
+            std::size_t length = lengthBase[symbol] + in.bits(lengthExtra[symbol]);
+            int distanceSymbol = decodeSymbol(in, distances);
+            if (distanceSymbol >= 30)
+                throw std::runtime_error("Invalid distance code in deflate stream");
+            std::size_t distance = distanceBase[distanceSymbol] + in.bits(distanceExtra[distanceSymbol]);
+            if (distance > out.size())
+                throw std::runtime_error("Distance too far back in deflate stream");
+            std::size_t from = out.size() - distance;
+            for (std::size_t i = 0; i < length; ++i) //Overlapping copies repeat the pattern
+                out.push_back(out[from + i]);
+        }
+    }
+}
+
+void inflateDynamic(BitReader& in, std::vector<unsigned char>& out) {
+    static const std::uint8_t order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+    int literalCount = in.bits(5) + 257;
+    int distanceCount = in.bits(5) + 1;
+    int codeLengthCount = in.bits(4) + 4;
+    if (literalCount > 286 || distanceCount > 30)
+        throw std::runtime_error("Invalid dynamic block header in deflate stream");
+
+    unsigned char lengths[320] = {};
+    for (int i = 0; i < codeLengthCount; ++i)
+        lengths[order[i]] = static_cast<unsigned char>(in.bits(3));
+    Huffman lengthCode;
+    buildHuffman(lengthCode, lengths, 19);
+
+    std::fill(std::begin(lengths), std::end(lengths), 0);
+    for (int i = 0; i < literalCount + distanceCount; ) {
+        int symbol = decodeSymbol(in, lengthCode);
+        if (symbol < 16) {
+            lengths[i++] = static_cast<unsigned char>(symbol);
+            continue;
+        }
+        unsigned char value = 0;
+        int repeat;
+        if (symbol == 16) {
+            if (i == 0)
+                throw std::runtime_error("Invalid repeat in deflate stream");
+            value = lengths[i - 1];
+            repeat = 3 + in.bits(2);
+        } else if (symbol == 17) {
+            repeat = 3 + in.bits(3);
+        } else {
+            repeat = 11 + in.bits(7);
+        }
+        if (i + repeat > literalCount + distanceCount)
+            throw std::runtime_error("Invalid repeat in deflate stream");
+        while (repeat--)
+            lengths[i++] = value;
+    }
+
+    Huffman literals, distances;
+    buildHuffman(literals, lengths, literalCount);
+    buildHuffman(distances, lengths + literalCount, distanceCount);
+    inflateCodes(in, out, literals, distances);
+}
+
+void inflateFixed(BitReader& in, std::vector<unsigned char>& out) {
+    static Huffman literals, distances;
+    static bool built = false;
+    if (!built) { //Static data, identical for every caller
+        unsigned char lengths[288];
+        std::fill(lengths, lengths + 144, 8);
+        std::fill(lengths + 144, lengths + 256, 9);
+        std::fill(lengths + 256, lengths + 280, 7);
+        std::fill(lengths + 280, lengths + 288, 8);
+        buildHuffman(literals, lengths, 288);
+        std::fill(lengths, lengths + 30, 5);
+        buildHuffman(distances, lengths, 30);
+        built = true;
+    }
+    inflateCodes(in, out, literals, distances);
+}
+
+std::uint32_t readBigEndian(const unsigned char* p) {
+    return std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+}
+
+int paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+float srgbToLinear(float c) {
+    return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float c) {
+    return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+} // namespace
+
+std::vector<unsigned char> inflateZlib(const unsigned char *data, std::size_t size, std::size_t sizeHint) {
+    if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0)
+        throw std::runtime_error("Invalid zlib header");
+    if (data[1] & 0x20)
+        throw std::runtime_error("zlib preset dictionaries are not supported");
+
+    //Deflate expands at most 1032:1 (258 bytes per 2-bit match), so a corrupt hint can't reserve more than that
+    const std::size_t maxRatio = 1032;
+    std::vector<unsigned char> out;
+    out.reserve(size > std::numeric_limits<std::size_t>::max() / maxRatio ? sizeHint : std::min(sizeHint, size * maxRatio));
+    BitReader in(data + 2, size - 2);
+    bool last;
+    do {
+        last = in.bits(1) != 0;
+        switch (in.bits(2)) {
+        case 0: {
+            in.alignToByte();
+            if (in.remaining() < 4)
+                throw std::runtime_error("Truncated deflate stream");
+            const unsigned char* p = in.position();
+            std::size_t length = p[0] | p[1] << 8;
+            if ((length ^ 0xFFFF) != static_cast<std::size_t>(p[2] | p[3] << 8) || in.remaining() < 4 + length)
+                throw std::runtime_error("Invalid stored block in deflate stream");
+            out.insert(out.end(), p + 4, p + 4 + length);
+            in.skip(4 + length);
+            break;
+        }
+        case 1:
+            inflateFixed(in, out);
+            break;
+        case 2:
+            inflateDynamic(in, out);
+            break;
+        default:
+            throw std::runtime_error("Invalid block type in deflate stream");
+        }
+    } while (!last);
+    return out;
+}
+
+Image decodePng(const unsigned char *data, std::size_t size) {
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (size < 8 || std::memcmp(data, signature, 8) != 0)
+        throw std::runtime_error("Not a PNG file");
+
+    std::uint32_t width = 0, height = 0;
+    int bitDepth = 0, colorType = -1;
+    std::vector<unsigned char> compressed, palette, transparency;
+    for (std::size_t offset = 8; offset + 12 <= size; ) {
+        std::uint32_t length = readBigEndian(data + offset);
+        const unsigned char* type = data + offset + 4;
+        const unsigned char* chunk = data + offset + 8;
+        if (offset + 12 + length > size)
+            throw std::runtime_error("Truncated PNG chunk");
+        if (std::memcmp(type, "IHDR", 4) == 0 && length >= 13) {
+            width = readBigEndian(chunk);
+            height = readBigEndian(chunk + 4);
+            bitDepth = chunk[8];
+            colorType = chunk[9];
+            if (chunk[12] != 0)
+                throw std::runtime_error("Interlaced PNG images are not supported");
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            palette.assign(chunk, chunk + length);
+        } else if (std::memcmp(type, "tRNS", 4) == 0) {
+            transparency.assign(chunk, chunk + length);
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), chunk, chunk + length);
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+        offset += 12 + length;
+    }
+
+    int channels;
+    switch (colorType) {
+    case 0: channels = 1; break; //Gray
+    case 2: channels = 3; break; //RGB
+    case 3: channels = 1; break; //Palette
+    case 4: channels = 2; break; //Gray + alpha
+    case 6: channels = 4; break; //RGBA
+    default: throw std::runtime_error("Invalid PNG color type");
+    }
+    if (width == 0 || height == 0 || (bitDepth != 1 && bitDepth != 2 && bitDepth != 4 && bitDepth != 8 && bitDepth != 16))
+        throw std::runtime_error("Invalid PNG header");
+    if (width > maxImageSize || height > maxImageSize)
+        throw std::runtime_error("PNG image too large");
+    if (colorType == 3 && palette.empty())
+        throw std::runtime_error("PNG palette missing");
+
+    const std::size_t stride = (static_cast<std::size_t>(width) * channels * bitDepth + 7) / 8;
+    const std::size_t pixelBytes = std::max<std::size_t>(1, channels * bitDepth / 8);
+    if (height > std::numeric_limits<std::size_t>::max() / (stride + 1))
+        throw std::runtime_error("PNG image too large");
+    const std::size_t rawSize = (stride + 1) * height;
+    std::vector<unsigned char> raw = inflateZlib(compressed.data(), compressed.size(), rawSize);
+    if (raw.size() < rawSize)
+        throw std::runtime_error("Truncated PNG image data");
+
+    //Unfilter in place, each row is preceded by its filter type
+    std::vector<unsigned char> previous(stride, 0);
+    for (std::uint32_t y = 0; y < height; ++y) {
+        unsigned char* row = &raw[y * (stride + 1) + 1];
+        int filter = row[-1];
+        for (std::size_t x = 0; x < stride; ++x) {
+            int left = x >= pixelBytes ? row[x - pixelBytes] : 0;
+            int up = previous[x];
+            int upLeft = x >= pixelBytes ? previous[x - pixelBytes] : 0;
+            switch (filter) {
+            case 0: break;
+            case 1: row[x] = static_cast<unsigned char>(row[x] + left); break;
+            case 2: row[x] = static_cast<unsigned char>(row[x] + up); break;
+            case 3: row[x] = static_cast<unsigned char>(row[x] + (left + up) / 2); break;
+            case 4: row[x] = static_cast<unsigned char>(row[x] + paeth(left, up, upLeft)); break;
+            default: throw std::runtime_error("Invalid PNG filter");
+            }
+        }
+        std::copy(row, row + stride, previous.begin());
+    }
+
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<std::size_t>(width) * height * 4);
+    const int maxValue = (1 << bitDepth) - 1;
+    for (std::uint32_t y = 0; y < height; ++y) {
+        const unsigned char* row = &raw[y * (stride + 1) + 1];
+        //Sample c of pixel x, as stored (not scaled)
+        auto sample = [&](std::uint32_t x, int c) -> int {
+            std::size_t index = static_cast<std::size_t>(x) * channels + c;
+            if (bitDepth == 8)
+                return row[index];
+            if (bitDepth == 16)
+                return row[index * 2] << 8 | row[index * 2 + 1];
+            std::size_t bit = index * bitDepth;
+            return (row[bit / 8] >> (8 - bitDepth - bit % 8)) & maxValue;
+        };
+        auto to8 = [&](int v) { return static_cast<unsigned char>(bitDepth == 16 ? v >> 8 : v * 255 / maxValue); };
+
+        for (std::uint32_t x = 0; x < width; ++x) {
+            unsigned char* out = image.pixel(x, y);
+            if (colorType == 3) {
+                std::size_t entry = static_cast<std::size_t>(sample(x, 0));
+                if (entry * 3 + 2 >= palette.size())
+                    throw std::runtime_error("PNG palette index out of range");
+                out[0] = palette[entry * 3];
+                out[1] = palette[entry * 3 + 1];
+                out[2] = palette[entry * 3 + 2];
+                out[3] = entry < transparency.size() ? transparency[entry] : 255;
+            } else if (channels <= 2) {
+                int gray = sample(x, 0);
+                out[0] = out[1] = out[2] = to8(gray);
+                if (channels == 2)
+                    out[3] = to8(sample(x, 1));
+                else //Color key
+                    out[3] = transparency.size() >= 2 && gray == (transparency[0] << 8 | transparency[1]) ? 0 : 255;
+            } else {
+                int r = sample(x, 0), g = sample(x, 1), b = sample(x, 2);
+                out[0] = to8(r);
+                out[1] = to8(g);
+                out[2] = to8(b);
+                if (channels == 4)
+                    out[3] = to8(sample(x, 3));
+                else
+                    out[3] = transparency.size() >= 6 && r == (transparency[0] << 8 | transparency[1])
+                             && g == (transparency[2] << 8 | transparency[3]) && b == (transparency[4] << 8 | transparency[5]) ? 0 : 255;
+            }
+        }
+    }
+    return image;
+}
+
+Image decodeTga(const unsigned char *data, std::size_t size) {
+    if (size < 18)
+        throw std::runtime_error("Not a TGA file");
+    const int idLength = data[0];
+    const int colorMapType = data[1];
+    const int imageType = data[2];
+    const unsigned int width = data[12] | data[13] << 8;
+    const unsigned int height = data[14] | data[15] << 8;
+    const int depth = data[16];
+    const bool topToBottom = (data[17] & 0x20) != 0;
+
+    const bool rle = imageType == 10 || imageType == 11;
+    const bool gray = imageType == 3 || imageType == 11;
+    if (colorMapType != 0 || (imageType != 2 && imageType != 3 && imageType != 10 && imageType != 11))
+        throw std::runtime_error("Unsupported TGA image type (color mapped images are not supported)");
+    if (gray ? depth != 8 : (depth != 24 && depth != 32))
+        throw std::runtime_error("Unsupported TGA pixel depth");
+    if (width == 0 || height == 0)
+        throw std::runtime_error("Empty TGA image");
+
+    const int bytes = depth / 8;
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    const unsigned char* p = data + 18 + idLength;
+    const unsigned char* end = data + size;
+    std::vector<unsigned char> raw(count * bytes);
+    if (!rle) {
+        if (static_cast<std::size_t>(end - p) < raw.size())
+            throw std::runtime_error("Truncated TGA image");
+        std::memcpy(raw.data(), p, raw.size());
+    } else {
+        for (std::size_t pixel = 0; pixel < count; ) {
+            if (p >= end)
+                throw std::runtime_error("Truncated TGA image");
+            int header = *p++;
+            std::size_t run = std::min<std::size_t>((header & 0x7F) + 1, count - pixel);
+            std::size_t needed = header & 0x80 ? bytes : run * bytes;
+            if (static_cast<std::size_t>(end - p) < needed)
+                throw std::runtime_error("Truncated TGA image");
+            for (std::size_t i = 0; i < run; ++i, ++pixel)
+                std::memcpy(&raw[pixel * bytes], header & 0x80 ? p : p + i * bytes, bytes);
+            p += needed;
+        }
+    }
+
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(count * 4);
+    for (unsigned int y = 0; y < height; ++y) {
+        unsigned int sourceRow = topToBottom ? y : height - 1 - y;
+        for (unsigned int x = 0; x < width; ++x) {
+            const unsigned char* in = &raw[(static_cast<std::size_t>(sourceRow) * width + x) * bytes];
+            unsigned char* out = image.pixel(x, y);
+            if (gray) {
+                out[0] = out[1] = out[2] = in[0];
+                out[3] = 255;
+            } else { //BGR(A)
+                out[0] = in[2];
+                out[1] = in[1];
+                out[2] = in[0];
+                out[3] = bytes == 4 ? in[3] : 255;
+            }
+        }
+    }
+    return image;
+}
+
+Image loadImage(const std::string &path) {
+    MappedFile file(path);
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(file.data());
+    try {
+        if (file.size() >= 8 && data[0] == 0x89 && data[1] == 'P')
+            return decodePng(data, file.size());
+        return decodeTga(data, file.size()); //TGA has no signature
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + " : " + e.what());
+    }
+}
+
+Image downsampleImage(const Image &image, bool srgb) {
+    Image result;
+    result.width = std::max(image.width / 2, 1u);
+    result.height = std::max(image.height / 2, 1u);
+    result.pixels.resize(static_cast<std::size_t>(result.width) * result.height * 4);
+
+    float toLinear[256];
+    for (int i = 0; i < 256; ++i)
+        toLinear[i] = srgb ? srgbToLinear(i / 255.0f) : i / 255.0f;
+
+    for (unsigned int y = 0; y < result.height; ++y) {
+        unsigned int y0 = std::min(2 * y, image.height - 1), y1 = std::min(2 * y + 1, image.height - 1);
+        for (unsigned int x = 0; x < result.width; ++x) {
+            unsigned int x0 = std::min(2 * x, image.width - 1), x1 = std::min(2 * x + 1, image.width - 1);
+            const unsigned char* texels[4] = {image.pixel(x0, y0), image.pixel(x1, y0), image.pixel(x0, y1), image.pixel(x1, y1)};
+            unsigned char* out = result.pixel(x, y);
+            for (int c = 0; c < 3; ++c) {
+                float sum = 0;
+                for (const unsigned char* t : texels)
+                    sum += toLinear[t[c]];
+                float value = srgb ? linearToSrgb(sum / 4) : sum / 4;
+                out[c] = static_cast<unsigned char>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+            }
+            int alpha = 0;
+            for (const unsigned char* t : texels)
+                alpha += t[3];
+            out[3] = static_cast<unsigned char>((alpha + 2) / 4);
+        }
+    }
+    return result;
+}
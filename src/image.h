@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 8-bit RGBA image in CPU memory, row-major with the top row first
+ */
+struct Image
+{
+    unsigned int width = 0, height = 0;
+    std::vector<unsigned char> pixels; ///< width * height * 4 bytes
+
+    unsigned char* pixel(unsigned int x, unsigned int y) {return &pixels[(static_cast<std::size_t>(y) * width + x) * 4];}
+    const unsigned char* pixel(unsigned int x, unsigned int y) const {return &pixels[(static_cast<std::size_t>(y) * width + x) * 4];}
+};
+
+/** @defgroup ImageIO
+ * Source image loading for the offline tools. Everything is converted to RGBA8 : gray images are replicated
+ * to RGB, missing alpha is opaque and 16-bit channels are truncated.
+ * @{ */
+
+const unsigned int maxImageSize = 1 << 16; ///< Largest width or height accepted, above what any GL supports
+
+/**
+ * @brief loadImage : reads a PNG or TGA file, recognized by its content
+ * @throw std::runtime_error if the file can't be read or uses an unsupported feature
+ */
+Image loadImage(const std::string& path);
+
+/**
+ * @brief decodePng : supports every color type and bit depth, except interlaced images
+ */
+Image decodePng(const unsigned char* data, std::size_t size);
+
+/**
+ * @brief decodeTga : supports true color (24/32-bit) and grayscale images, raw or RLE
+ */
+Image decodeTga(const unsigned char* data, std::size_t size);
+
+/**
+ * @brief inflateZlib : decompresses a zlib stream (RFC 1950 / 1951)
+ * @param sizeHint : expected decompressed size, to reserve memory. Bounded by what the input can expand to.
+ */
+std::vector<unsigned char> inflateZlib(const unsigned char* data, std::size_t size, std::size_t sizeHint = 0);
+
+/**
+ * @brief downsampleImage : halves the image with a box filter (odd sizes handled). Both dimensions stay >= 1.
+ * @param srgb : when true, color channels are averaged in linear space
+ */
+Image downsampleImage(const Image& image, bool srgb);
+
+/** @} */
+
+#endif // IMAGE_H
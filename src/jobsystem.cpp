@@ -0,0 +1,154 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "jobsystem.h"
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <string>
+
+namespace {
+
+long long nowNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+JobSystem::JobSystem(unsigned int threadCount) : lastUtilizationQuery(nowNanoseconds())
+{
+    if (threadCount == 0) {
+        unsigned int hardware = std::thread::hardware_concurrency();
+        threadCount = hardware > 1 ? hardware - 1 : 1;
+    }
+    for (unsigned int i = 0; i < threadCount; ++i)
+        workers.emplace_back([this, i]{
+            Profiler::global().setThreadName("Worker " + std::to_string(i));
+            workerLoop();
+        });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+JobSystem& JobSystem::global() {
+    static JobSystem instance;
+    return instance;
+}
+
+void JobSystem::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(std::move(job));
+    }
+    wakeUp.notify_one();
+}
+
+void JobSystem::workerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if (queue.empty())
+                return; //stopping, and nothing left to do
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        long long start = nowNanoseconds();
+        try {
+            PROFILE_SCOPE("Job");
+            job();
+        } catch (...) {
+        }
+        busyNanoseconds += nowNanoseconds() - start;
+    }
+}
+
+void JobSystem::parallelFor(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0)
+        return;
+
+    //Shared with the helper jobs, which may only start after this call returned
+    struct Loop {
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::size_t count;
+        const std::function<void(std::size_t)>* body;
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->count = count;
+    loop->body = &body;
+
+    auto work = [](Loop& l) {
+        std::size_t i;
+        //body is only dereferenced after grabbing a valid index, so it is still alive
+        while ((i = l.next.fetch_add(1)) < l.count) {
+            try {
+                (*l.body)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(l.mutex);
+                if (!l.error)
+                    l.error = std::current_exception();
+            }
+            if (l.done.fetch_add(1) + 1 == l.count) {
+                std::lock_guard<std::mutex> lock(l.mutex);
+                l.finished.notify_all();
+            }
+        }
+    };
+
+    std::size_t helpers = std::min<std::size_t>(workers.size(), count - 1);
+    for (std::size_t h = 0; h < helpers; ++h)
+        submit([loop, work]{ work(*loop); });
+
+    work(*loop);
+    {
+        std::unique_lock<std::mutex> lock(loop->mutex);
+        loop->finished.wait(lock, [&]{ return loop->done.load() == count; });
+    }
+    if (loop->error)
+        std::rethrow_exception(loop->error);
+}
+
+float JobSystem::utilization() {
+    long long now = nowNanoseconds();
+    long long elapsed = now - lastUtilizationQuery;
+    lastUtilizationQuery = now;
+    long long busy = busyNanoseconds.exchange(0);
+    if (elapsed <= 0 || workers.empty())
+        return 0;
+    return std::min(1.0f, static_cast<float>(busy) / (static_cast<float>(elapsed) * workers.size()));
+}
@@ -0,0 +1,97 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed pool of worker threads executing fire-and-forget jobs and parallel loops.
+ *
+ * \code
+ * //Typical usage
+ * JobSystem& jobs = JobSystem::global();
+ * jobs.parallelFor(chunks.size(), [&](std::size_t i) { parse(chunks[i]); });
+ * \endcode
+ */
+class JobSystem
+{
+public:
+    /**
+     * @brief Starts the worker threads
+     * @param threadCount : number of workers. 0 means one per hardware thread, minus the calling one.
+     */
+    explicit JobSystem(unsigned int threadCount = 0);
+    ~JobSystem();
+
+    /**
+     * @brief Queues a job on the workers. Exceptions thrown by the job are swallowed.
+     */
+    void submit(std::function<void()> job);
+
+    /**
+     * @brief Calls body(i) for each i in [0, count), spreading the calls over the workers and the calling thread.
+     * Blocks until every call returned.
+     * @throw rethrows the first exception thrown by body
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    /**
+     * @brief Number of worker threads (the calling thread of parallelFor comes in addition)
+     */
+    unsigned int threadCount() const {return static_cast<unsigned int>(workers.size());}
+
+    /**
+     * @brief Fraction of the time workers spent running jobs since the previous call, in [0, 1]
+     */
+    float utilization();
+
+    /**
+     * @brief Process-wide pool, created on first use
+     */
+    static JobSystem& global();
+
+private:
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> queue;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+
+    std::atomic<long long> busyNanoseconds{0};
+    long long lastUtilizationQuery;
+};
+
+#endif // JOBSYSTEM_H
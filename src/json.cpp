@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "json.h"
+#include "textparse.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const JsonValue nullValue;
+const int maxDepth = 512;
+
+} // namespace
+
+const JsonValue& JsonValue::at(std::size_t index) const {
+    return t == Type::Array && index < array.size() ? array[index] : nullValue;
+}
+
+const JsonValue& JsonValue::operator[](const char *key) const {
+    if (t != Type::Object)
+        return nullValue;
+    for (const Member& member : object)
+        if (member.first == key)
+            return member.second;
+    return nullValue;
+}
+
+/* Recursive descent parser, filling JsonValue in place to avoid copies of subtrees */
+class JsonParser
+{
+public:
+    JsonParser(const char* data, std::size_t size) : begin(data), p(data), end(data + size) {}
+
+    void parseDocument(JsonValue& root) {
+        parseValue(root, 0);
+        skipSpaces();
+        if (p != end)
+            fail("trailing characters");
+    }
+
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+
+    [[noreturn]] void fail(const char* reason) {
+        throw std::runtime_error(std::string("JSON error at offset ") + std::to_string(p - begin) + " : " + reason);
+    }
+
+    void skipSpaces() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            ++p;
+    }
+
+    void expect(char c) {
+        skipSpaces();
+        if (p >= end || *p != c)
+            fail("unexpected character");
+        ++p;
+    }
+
+    void expectWord(const char* word) {
+        std::size_t length = std::strlen(word);
+        if (static_cast<std::size_t>(end - p) < length || std::memcmp(p, word, length) != 0)
+            fail("invalid literal");
+        p += length;
+    }
+
+    void parseValue(JsonValue& value, int depth) {
+        if (depth > maxDepth)
+            fail("nesting too deep");
+        skipSpaces();
+        if (p >= end)
+            fail("unexpected end of input");
+        switch (*p) {
+        case '{':
+            parseObject(value, depth);
+            break;
+        case '[':
+            parseArray(value, depth);
+            break;
+        case '"':
+            value.t = JsonValue::Type::String;
+            parseString(value.string);
+            break;
+        case 't':
+            expectWord("true");
+            value.t = JsonValue::Type::Bool;
+            value.boolean = true;
+            break;
+        case 'f':
+            expectWord("false");
+            value.t = JsonValue::Type::Bool;
+            value.boolean = false;
+            break;
+        case 'n':
+            expectWord("null");
+            value.t = JsonValue::Type::Null;
+            break;
+        default:
+        {
+            const char* next = parseDecimal(p, end, value.number);
+            if (next == p)
+                fail("unexpected character");
+            p = next;
+            value.t = JsonValue::Type::Number;
+        }
+            break;
+        }
+    }
+
+    void parseObject(JsonValue& value, int depth) {
+        value.t = JsonValue::Type::Object;
+        ++p;
+        skipSpaces();
+        if (p < end && *p == '}') {
+            ++p;
+            return;
+        }
+        for (;;) {
+            skipSpaces();
+            if (p >= end || *p != '"')
+                fail("expected a key");
+            value.object.emplace_back();
+            JsonValue::Member& member = value.object.back();
+            parseString(member.first);
+            expect(':');
+            parseValue(member.second, depth + 1);
+            skipSpaces();
+            if (p < end && *p == ',') {
+                ++p;
+                continue;
+            }
+            expect('}');
+            return;
+        }
+    }
+
+    void parseArray(JsonValue& value, int depth) {
+        value.t = JsonValue::Type::Array;
+        ++p;
+        skipSpaces();
+        if (p < end && *p == ']') {
+            ++p;
+            return;
+        }
+        for (;;) {
+            value.array.emplace_back();
+            parseValue(value.array.back(), depth + 1);
+            skipSpaces();
+            if (p < end && *p == ',') {
+                ++p;
+                continue;
+            }
+            expect(']');
+            return;
+        }
+    }
+
+    unsigned int parseHex4() {
+        if (end - p < 4)
+            fail("truncated escape");
+        unsigned int code = 0;
+        for (int i = 0; i < 4; ++i, ++p) {
+            char c = *p;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else fail("invalid escape");
+        }
+        return code;
+    }
+
+    static void appendUtf8(std::string& out, unsigned int code) {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        } else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else if (code < 0x10000) {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code >> 18));
+            out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    void parseString(std::string& out) {
+        ++p; //Opening quote
+        for (;;) {
+            //Copy runs of plain characters at once
+            const char* run = p;
+            while (p < end && *p != '"' && *p != '\\')
+                ++p;
+            out.append(run, p);
+            if (p >= end)
+                fail("unterminated string");
+            if (*p++ == '"')
+                return;
+            if (p >= end)
+                fail("unterminated string");
+            switch (*p++) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u':
+            {
+                unsigned int code = parseHex4();
+                if (code >= 0xD800 && code <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    p += 2;
+                    unsigned int low = parseHex4();
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                appendUtf8(out, code);
+            }
+                break;
+            default:
+                fail("invalid escape");
+            }
+        }
+    }
+};
+
+JsonValue parseJson(const char *data, std::size_t size) {
+    JsonValue root;
+    JsonParser parser(data, size);
+    parser.parseDocument(root);
+    return root;
+}
@@ -0,0 +1,102 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Immutable JSON document node
+ *
+ * Lookups never throw : a missing key or index yields a null value, and the as*() accessors
+ * return their fallback when the type doesn't match.
+ *
+ * \code
+ * JsonValue root = parseJson(text.data(), text.size());
+ * for (const JsonValue& node : root["nodes"].items())
+ *     int mesh = node["mesh"].asInt(-1);
+ * \endcode
+ */
+class JsonValue
+{
+public:
+    enum class Type {Null, Bool, Number, String, Array, Object};
+    typedef std::pair<std::string, JsonValue> Member;
+
+    JsonValue() = default;
+
+    Type type() const {return t;}
+    bool isNull() const {return t == Type::Null;}
+    bool isNumber() const {return t == Type::Number;}
+    bool isString() const {return t == Type::String;}
+    bool isArray() const {return t == Type::Array;}
+    bool isObject() const {return t == Type::Object;}
+
+    bool asBool(bool fallback = false) const {return t == Type::Bool ? boolean : fallback;}
+    double asNumber(double fallback = 0) const {return t == Type::Number ? number : fallback;}
+    //Numbers out of the range of the type give the fallback
+    int asInt(int fallback = 0) const {
+        return t == Type::Number && number >= std::numeric_limits<int>::min() && number <= std::numeric_limits<int>::max()
+            ? static_cast<int>(number) : fallback;
+    }
+    std::size_t asSize(std::size_t fallback = 0) const {
+        return t == Type::Number && number >= 0 && number < static_cast<double>(std::numeric_limits<std::size_t>::max())
+            ? static_cast<std::size_t>(number) : fallback;
+    }
+    const std::string& asString() const {return string;}
+
+    /**
+     * @brief Number of elements of an array, or of members of an object
+     */
+    std::size_t size() const {return t == Type::Array ? array.size() : object.size();}
+    const std::vector<JsonValue>& items() const {return array;}
+    const std::vector<Member>& members() const {return object;}
+
+    const JsonValue& at(std::size_t index) const;
+    const JsonValue& operator[](const char* key) const;
+    const JsonValue& operator[](const std::string& key) const {return (*this)[key.c_str()];}
+    bool has(const char* key) const {return !(*this)[key].isNull();}
+
+private:
+    friend class JsonParser;
+
+    Type t = Type::Null;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<Member> object;
+};
+
+/**
+ * @brief parseJson : parses a complete JSON text (RFC 8259)
+ * @throw std::runtime_error on syntax errors, with the offending byte offset
+ */
+JsonValue parseJson(const char* data, std::size_t size);
+
+#endif // JSON_H
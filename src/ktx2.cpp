@@ -0,0 +1,157 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "ktx2.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+const unsigned char ktx2Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+namespace {
+
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must match the file layout");
+
+//Khronos data format descriptor values
+const std::uint8_t modelRgbsda = 1, modelBC1 = 128, modelBC3 = 130, modelBC4 = 131, modelBC5 = 132, modelBC7 = 134;
+const std::uint8_t primariesBt709 = 1;
+const std::uint8_t transferLinear = 1, transferSrgb = 2;
+const std::uint8_t channelRed = 0, channelGreen = 1, channelBlue = 2, channelAlpha = 15, channelColor = 0;
+
+struct Sample {
+    std::uint16_t bitOffset;
+    std::uint8_t bitLength; //Minus one
+    std::uint8_t channel;
+    std::uint32_t lower, upper;
+};
+
+struct FormatDescription {
+    std::uint8_t model;
+    bool srgb;
+    std::uint8_t blockSize; //Texels per side
+    std::uint8_t bytes; //Per block or per texel
+    std::vector<Sample> samples;
+};
+
+FormatDescription describe(std::uint32_t vkFormat) {
+    const Sample color64 = {0, 63, channelColor, 0, 0xFFFFFFFFu};
+    switch (vkFormat) {
+    case Ktx2R8G8B8A8Unorm: case Ktx2R8G8B8A8Srgb:
+        return {modelRgbsda, vkFormat == Ktx2R8G8B8A8Srgb, 1, 4,
+                {{0, 7, channelRed, 0, 255}, {8, 7, channelGreen, 0, 255}, {16, 7, channelBlue, 0, 255}, {24, 7, channelAlpha, 0, 255}}};
+    case Ktx2BC1RgbUnorm: case Ktx2BC1RgbSrgb:
+        return {modelBC1, vkFormat == Ktx2BC1RgbSrgb, 4, 8, {color64}};
+    case Ktx2BC3Unorm: case Ktx2BC3Srgb:
+        return {modelBC3, vkFormat == Ktx2BC3Srgb, 4, 16, {{0, 63, channelAlpha, 0, 0xFFFFFFFFu}, {64, 63, channelColor, 0, 0xFFFFFFFFu}}};
+    case Ktx2BC4Unorm:
+        return {modelBC4, false, 4, 8, {color64}};
+    case Ktx2BC5Unorm:
+        return {modelBC5, false, 4, 16, {{0, 63, channelRed, 0, 0xFFFFFFFFu}, {64, 63, channelGreen, 0, 0xFFFFFFFFu}}};
+    case Ktx2BC7Unorm: case Ktx2BC7Srgb:
+        return {modelBC7, vkFormat == Ktx2BC7Srgb, 4, 16, {{0, 127, channelColor, 0, 0xFFFFFFFFu}}};
+    default:
+        throw std::runtime_error("writeKtx2 : unsupported format " + std::to_string(vkFormat));
+    }
+}
+
+void put32(std::vector<unsigned char>& out, std::uint32_t v) {
+    for (int i = 0; i < 4; ++i)
+        out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+}
+
+std::vector<unsigned char> makeDataFormatDescriptor(const FormatDescription& format) {
+    std::vector<unsigned char> block;
+    const std::uint32_t blockSize = 24 + 16 * static_cast<std::uint32_t>(format.samples.size());
+    put32(block, 4 + blockSize); //Total size
+    put32(block, 0); //Vendor Khronos, basic descriptor
+    put32(block, 2 | blockSize << 16); //Version 2
+    block.push_back(format.model);
+    block.push_back(primariesBt709);
+    block.push_back(format.srgb ? transferSrgb : transferLinear);
+    block.push_back(0); //Straight alpha
+    for (int i = 0; i < 4; ++i) //Block dimensions minus one
+        block.push_back(i < 2 ? format.blockSize - 1 : 0);
+    block.push_back(format.bytes);
+    for (int i = 1; i < 8; ++i)
+        block.push_back(0);
+    for (const Sample& sample : format.samples) {
+        //sRGB only applies to color : the alpha sample of an RGBA8 format is flagged linear
+        bool linear = format.srgb && sample.channel == channelAlpha && format.model == modelRgbsda;
+        put32(block, sample.bitOffset | sample.bitLength << 16 | (sample.channel | (linear ? 0x10 : 0)) << 24);
+        put32(block, 0); //Sample position
+        put32(block, sample.lower);
+        put32(block, sample.upper);
+    }
+    return block;
+}
+
+std::size_t alignUp(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void writeKtx2(const std::string &path, std::uint32_t vkFormat, unsigned int width, unsigned int height,
+               unsigned int layers, unsigned int faces, const std::vector<std::vector<unsigned char>> &levels) {
+    const FormatDescription format = describe(vkFormat);
+    const std::vector<unsigned char> dfd = makeDataFormatDescriptor(format);
+
+    Ktx2Header header = {};
+    std::memcpy(header.identifier, ktx2Identifier, sizeof(ktx2Identifier));
+    header.vkFormat = vkFormat;
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.layerCount = layers;
+    header.faceCount = faces;
+    header.levelCount = static_cast<std::uint32_t>(levels.size());
+    header.dfdByteOffset = static_cast<std::uint32_t>(sizeof(Ktx2Header) + levels.size() * sizeof(Ktx2Level));
+    header.dfdByteLength = static_cast<std::uint32_t>(dfd.size());
+
+    //Levels are stored smallest first, aligned on a multiple of both the block size and 4
+    const std::size_t alignment = std::max<std::size_t>(format.bytes, 4) == 8 ? 8 : 16;
+    std::vector<Ktx2Level> index(levels.size());
+    std::size_t offset = header.dfdByteOffset + dfd.size();
+    for (std::size_t level = levels.size(); level-- > 0; ) {
+        offset = alignUp(offset, alignment);
+        index[level] = {offset, levels[level].size(), levels[level].size()};
+        offset += levels[level].size();
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not open file : " + path);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Ktx2Level));
+    file.write(reinterpret_cast<const char*>(dfd.data()), dfd.size());
+    std::size_t position = header.dfdByteOffset + dfd.size();
+    static const char padding[16] = {};
+    for (std::size_t level = levels.size(); level-- > 0; ) {
+        file.write(padding, index[level].byteOffset - position);
+        file.write(reinterpret_cast<const char*>(levels[level].data()), levels[level].size());
+        position = index[level].byteOffset + levels[level].size();
+    }
+    if (!file)
+        throw std::runtime_error("Could not write file : " + path);
+}
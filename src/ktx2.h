@@ -0,0 +1,83 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef KTX2_H
+#define KTX2_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* KTX 2.0 container (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html), as far as the engine uses it :
+ *
+ *   Ktx2Header (identifier included)
+ *   Ktx2Level[max(levelCount, 1)]
+ *   data format descriptor
+ *   level data, smallest level first, each level holding all its layers and faces
+ */
+
+struct Ktx2Header
+{
+    unsigned char identifier[12]; //Included so that the 64-bit fields are naturally aligned, like in the file
+    std::uint32_t vkFormat;
+    std::uint32_t typeSize;
+    std::uint32_t pixelWidth, pixelHeight, pixelDepth;
+    std::uint32_t layerCount, faceCount, levelCount;
+    std::uint32_t supercompressionScheme;
+    std::uint32_t dfdByteOffset, dfdByteLength;
+    std::uint32_t kvdByteOffset, kvdByteLength;
+    std::uint64_t sgdByteOffset, sgdByteLength;
+};
+
+struct Ktx2Level
+{
+    std::uint64_t byteOffset, byteLength, uncompressedByteLength;
+};
+
+extern const unsigned char ktx2Identifier[12];
+
+/** Vulkan format values used by the tools */
+enum Ktx2Format : std::uint32_t {
+    Ktx2R8G8B8A8Unorm = 37,
+    Ktx2R8G8B8A8Srgb = 43,
+    Ktx2BC1RgbUnorm = 131,
+    Ktx2BC1RgbSrgb = 132,
+    Ktx2BC3Unorm = 137,
+    Ktx2BC3Srgb = 138,
+    Ktx2BC4Unorm = 139,
+    Ktx2BC5Unorm = 141,
+    Ktx2BC7Unorm = 145,
+    Ktx2BC7Srgb = 146
+};
+
+/**
+ * @brief writeKtx2 : writes a 2D texture, array or cube map
+ * @param vkFormat : one of Ktx2Format
+ * @param layers : 0 for a non-array texture (an array can have a single layer)
+ * @param levels : data of each level (level 0 first), layers and faces one after another in each
+ * @throw std::runtime_error if the file can't be written or the format isn't one of Ktx2Format
+ */
+void writeKtx2(const std::string& path, std::uint32_t vkFormat, unsigned int width, unsigned int height,
+               unsigned int layers, unsigned int faces, const std::vector<std::vector<unsigned char>>& levels);
+
+#endif // KTX2_H
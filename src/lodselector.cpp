@@ -0,0 +1,80 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "lodselector.h"
+#include "camera.h"
+#include "mesh.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/geometric.hpp>
+
+namespace {
+
+template <class ErrorOf>
+unsigned int selectLod(ErrorOf errorOf, unsigned int lodCount, float size, unsigned int current, float maxPixelError, float hysteresis) {
+    if (lodCount == 0)
+        return 0;
+    current = std::min(current, lodCount - 1);
+    auto coarsestUnder = [&](float limit) {
+        unsigned int lod = 0;
+        while (lod + 1 < lodCount && errorOf(lod + 1) * size <= limit)
+            ++lod;
+        return lod;
+    };
+    if (errorOf(current) * size > maxPixelError)
+        return coarsestUnder(maxPixelError); //Too coarse : refine right away
+    return std::max(current, coarsestUnder(maxPixelError * (1.0f - hysteresis)));
+}
+
+} // namespace
+
+LodSelector::LodSelector(float maxPixelError, float hysteresis) : maxPixelError(maxPixelError), hysteresis(hysteresis) {}
+
+void LodSelector::setView(const Camera &camera, const glm::mat4 &projection, float viewportHeight) {
+    eye = camera.getPos();
+    //projection[1][1] maps half the view height to 1 in NDC, which spans half the viewport
+    pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+    orthographic = projection[3][3] == 1.0f;
+}
+
+float LodSelector::projectedSize(const glm::vec3 &boundsMin, const glm::vec3 &boundsMax, const glm::mat4 &model) const {
+    const glm::vec3 center(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f));
+    const float scale = std::max({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))});
+    const float radius = glm::length(boundsMax - boundsMin) * 0.5f * scale;
+    if (orthographic)
+        return 2.0f * radius * pixelsPerUnit;
+    const float distanceSquared = glm::dot(center - eye, center - eye);
+    if (distanceSquared <= radius * radius)
+        return std::numeric_limits<float>::infinity();
+    return 2.0f * radius * pixelsPerUnit / std::sqrt(distanceSquared - radius * radius);
+}
+
+unsigned int LodSelector::select(const Mesh &mesh, const glm::mat4 &model, unsigned int current) const {
+    return selectLod([&](unsigned int lod) {return mesh.lodError(lod);}, mesh.lodCount(),
+                     projectedSize(mesh.boundsMin(), mesh.boundsMax(), model), current, maxPixelError, hysteresis);
+}
+
+unsigned int LodSelector::select(const float *lodErrors, unsigned int lodCount, float size, unsigned int current) const {
+    return selectLod([&](unsigned int lod) {return lodErrors[lod];}, lodCount, size, current, maxPixelError, hysteresis);
+}
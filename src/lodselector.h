@@ -0,0 +1,86 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef LODSELECTOR_H
+#define LODSELECTOR_H
+
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+class Camera;
+class Mesh;
+
+/**
+ * @brief Picks levels of detail from the size objects take on screen.
+ *
+ * The simplification error of a LOD is stored relative to the diagonal of the mesh bounds, so multiplying it
+ * by the projected diagonal gives its error in pixels. The coarsest LOD whose error stays under maxPixelError
+ * is used. To avoid popping back and forth around the threshold, switching to a coarser LOD requires its error
+ * to be under (1 - hysteresis) * maxPixelError, so each object keeps its current LOD from frame to frame.
+ *
+ * \code
+ * //Each frame
+ * selector.setView(camera, projection, viewportHeight);
+ * object.lod = selector.select(mesh, object.model, object.lod);
+ * mesh.draw(object.lod);
+ * \endcode
+ */
+class LodSelector
+{
+public:
+    /**
+     * @param maxPixelError : largest error tolerated on screen, in pixels
+     * @param hysteresis : in [0, 1), margin required before switching to a coarser LOD
+     */
+    explicit LodSelector(float maxPixelError = 1.0f, float hysteresis = 0.25f);
+
+    /**
+     * @brief Updates the view used by the other functions. Call once per frame.
+     */
+    void setView(const Camera& camera, const glm::mat4& projection, float viewportHeight);
+
+    /**
+     * @brief projectedSize : diameter in pixels of the bounding sphere of a box transformed by model
+     * @return infinity when the camera is inside the sphere
+     */
+    float projectedSize(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::mat4& model) const;
+
+    /**
+     * @param current : LOD of the object last frame
+     */
+    unsigned int select(const Mesh& mesh, const glm::mat4& model, unsigned int current) const;
+
+    /**
+     * @param lodErrors : error of each LOD relative to the bounds diagonal, increasing, lodErrors[0] being 0
+     * @param size : projectedSize() of the object
+     */
+    unsigned int select(const float* lodErrors, unsigned int lodCount, float size, unsigned int current) const;
+
+private:
+    float maxPixelError, hysteresis;
+    glm::vec3 eye{0.0f};
+    float pixelsPerUnit = 1.0f; //At distance 1 for perspective projections
+    bool orthographic = false;
+};
+
+#endif // LODSELECTOR_H
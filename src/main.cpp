@@ -1,9 +1,15 @@
 #include <iostream>
 #include "application.h"
+#include "gpumemory.h"
 
-int main()
+int main(int argc, char** argv)
 {
-    Application app;
-
-    return app.run();
+    int result;
+    {
+        Application app(argc > 1 ? argv[1] : "");
+        result = app.run();
+    }
+    //Every GL object should have gone with the application
+    GpuMemory::global().reportLeaks(std::cerr);
+    return result;
 }
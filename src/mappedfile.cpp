@@ -0,0 +1,123 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "mappedfile.h"
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string &path) : _path(path)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error(std::string("Could not open file : ") + path);
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    fileHandle = file;
+    _size = static_cast<std::size_t>(size.QuadPart);
+    if (_size == 0)
+        return;
+    mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle)
+        _data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!_data) {
+        release();
+        throw std::runtime_error(std::string("Could not map file : ") + path);
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Could not open file : ") + path);
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error(std::string("Could not stat file : ") + path);
+    }
+    _size = static_cast<std::size_t>(info.st_size);
+    if (_size > 0) {
+        void* mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error(std::string("Could not map file : ") + path);
+        }
+        //Files are mostly parsed front to back
+        madvise(mapping, _size, MADV_SEQUENTIAL);
+        _data = static_cast<const char*>(mapping);
+    }
+    close(fd); //The mapping keeps its own reference
+#endif
+}
+
+MappedFile::MappedFile(MappedFile &&rhs) {
+    *this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile &&rhs) {
+    if (this == &rhs)
+        return *this;
+    release();
+    _path = std::move(rhs._path);
+    _data = rhs._data;
+    _size = rhs._size;
+    rhs._data = nullptr;
+    rhs._size = 0;
+#ifdef _WIN32
+    fileHandle = rhs.fileHandle;
+    mappingHandle = rhs.mappingHandle;
+    rhs.fileHandle = nullptr;
+    rhs.mappingHandle = nullptr;
+#endif
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+void MappedFile::release() {
+#ifdef _WIN32
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+    if (fileHandle)
+        CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (_data)
+        munmap(const_cast<char*>(_data), _size);
+#endif
+    _data = nullptr;
+    _size = 0;
+}
@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ * @invariant data() points to size() readable bytes (or is nullptr when size() == 0)
+ *
+ * The mapping lives as long as the object; pointers into data() must not outlive it.
+ */
+class MappedFile
+{
+public:
+    /**
+     * @brief Maps the file at path in memory
+     * @throw std::runtime_error if the file can't be opened or mapped
+     */
+    explicit MappedFile(const std::string& path);
+    MappedFile(MappedFile&& rhs);
+    MappedFile& operator=(MappedFile&& rhs);
+    ~MappedFile();
+
+    const char* data() const {return _data;}
+    std::size_t size() const {return _size;}
+    const std::string& path() const {return _path;}
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    void release();
+
+    std::string _path;
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,134 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "mesh.h"
+#include "gpumemory.h"
+#include "meshformat.h"
+#include "meshoptimize.h"
+#include "objloader.h"
+#include "renderstats.h"
+#include <glad/glad.h>
+#include <cstddef>
+
+namespace {
+
+//Bound to GL_COPY_WRITE_BUFFER so that the VAO currently bound, if any, is left untouched
+VertexBuffer uploadBuffer(const void* data, std::size_t size) {
+    unsigned int id;
+    glGenBuffers(1, &id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+    trackedBufferData(GL_COPY_WRITE_BUFFER, id, size, data, GL_STATIC_DRAW, "Mesh");
+    return VertexBuffer(id);
+}
+
+bool hasExtension(const std::string& path, const std::string& extension) {
+    return path.size() >= extension.size() && path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+} // namespace
+
+MeshLayout MeshLayout::fromMeshData(const MeshData &data) {
+    MeshLayout layout;
+    layout.attributes = defaultVertexLayout();
+    layout.vertexStride = sizeof(Vertex);
+    layout.indexSize = sizeof(unsigned int);
+    layout.lods.push_back({0, static_cast<std::uint32_t>(data.indices.size()), 0.0f, 0});
+    layout.boundsMin = data.boundsMin;
+    layout.boundsMax = data.boundsMax;
+    return layout;
+}
+
+MeshLayout MeshLayout::fromMeshFile(const MeshFile &file) {
+    const MeshFileHeader& header = file.header();
+    MeshLayout layout;
+    layout.attributes.assign(file.attributes(), file.attributes() + header.attributeCount);
+    layout.vertexStride = header.vertexStride;
+    layout.indexSize = header.indexSize;
+    layout.lods.assign(file.lods(), file.lods() + header.lodCount);
+    layout.boundsMin = glm::vec3(header.boundsMin[0], header.boundsMin[1], header.boundsMin[2]);
+    layout.boundsMax = glm::vec3(header.boundsMax[0], header.boundsMax[1], header.boundsMax[2]);
+    return layout;
+}
+
+Mesh::Mesh(const MeshData &data)
+    : Mesh(uploadBuffer(data.vertices.data(), data.vertices.size() * sizeof(Vertex)),
+           uploadBuffer(data.indices.data(), data.indices.size() * sizeof(unsigned int)),
+           MeshLayout::fromMeshData(data))
+{
+}
+
+//Straight from the mapping to the driver
+Mesh::Mesh(const MeshFile &file)
+    : Mesh(uploadBuffer(file.vertexData(), file.header().vertexDataSize),
+           uploadBuffer(file.indexData(), file.header().indexDataSize),
+           MeshLayout::fromMeshFile(file))
+{
+}
+
+Mesh::Mesh(VertexBuffer &&vertices, VertexBuffer &&indices, const MeshLayout &layout)
+    : indexType(layout.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT), min(layout.boundsMin), max(layout.boundsMax)
+{
+    for (const MeshFileLod& lod : layout.lods)
+        lods.push_back({lod.indexOffset, lod.indexCount, lod.error});
+
+    vao.initEmpty();
+    vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, vertices.id());
+    for (const MeshFileAttribute& attribute : layout.attributes) {
+        glVertexAttribPointer(attribute.location, attribute.components, attribute.type, attribute.normalized ? GL_TRUE : GL_FALSE,
+                              layout.vertexStride, (void*)(std::size_t)attribute.offset);
+        glEnableVertexAttribArray(attribute.location);
+    }
+    //Attached to the VAO since it is bound
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.id());
+    glBindVertexArray(0);
+
+    vao.takeVBO(std::move(vertices));
+    vao.takeVBO(std::move(indices));
+}
+
+void Mesh::draw(unsigned int lod) {
+    const Lod& range = lods[lod < lods.size() ? lod : lods.size() - 1];
+    std::size_t indexSize = indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+    vao.bind();
+    RenderStats::frame().countDraw(GL_TRIANGLES, range.count);
+    glDrawElements(GL_TRIANGLES, range.count, indexType, (void*)(range.first * indexSize));
+}
+
+std::unique_ptr<Mesh> makeMesh(const MeshData &data) {
+    return std::make_unique<Mesh>(data);
+}
+
+std::unique_ptr<Mesh> loadMesh(const std::string &path) {
+    MeshFile file(path);
+    return std::make_unique<Mesh>(file);
+}
+
+MeshData loadMeshData(const std::string &path) {
+    if (hasExtension(path, ".e3dmesh"))
+        return MeshFile(path).toMeshData();
+    MeshData data = loadObj(path);
+    std::vector<MeshLodData> noLods;
+    optimizeMesh(data, noLods);
+    return data;
+}
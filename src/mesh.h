@@ -0,0 +1,129 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESH_H
+#define MESH_H
+
+#include "meshdata.h"
+#include "meshformat.h"
+#include "vertexarray.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Describes the content of the vertex and index buffers of a Mesh
+ */
+struct MeshLayout
+{
+    std::vector<MeshFileAttribute> attributes;
+    unsigned int vertexStride;
+    unsigned int indexSize; //2 or 4 bytes
+    std::vector<MeshFileLod> lods;
+    glm::vec3 boundsMin, boundsMax;
+
+    static MeshLayout fromMeshData(const MeshData& data);
+    static MeshLayout fromMeshFile(const MeshFile& file);
+};
+
+/**
+ * @brief GPU-side indexed mesh : a VAO owning one vertex buffer and one index buffer.
+ * Levels of detail are ranges of the index buffer, LOD 0 being the full mesh.
+ * @see makeMesh(), loadMesh()
+ */
+class Mesh
+{
+public:
+    /**
+     * @brief Uploads data to the GPU
+     * @pre a GL context is current
+     */
+    explicit Mesh(const MeshData& data);
+
+    /**
+     * @brief Uploads the blobs of a mapped mesh file as they are, with its own vertex layout
+     * @pre a GL context is current
+     */
+    explicit Mesh(const MeshFile& file);
+
+    /**
+     * @brief Builds the VAO over buffers that already hold their data
+     * @param vertices, indices : buffers to take ownership of
+     * @pre a GL context is current
+     */
+    Mesh(VertexBuffer&& vertices, VertexBuffer&& indices, const MeshLayout& layout);
+
+    /**
+     * @brief Binds the VAO and issues one glDrawElements call
+     * @param lod : level of detail, clamped to lodCount() - 1
+     */
+    void draw(unsigned int lod = 0);
+
+    unsigned int indexCount(unsigned int lod = 0) const {return lods[lod < lods.size() ? lod : lods.size() - 1].count;}
+    unsigned int lodCount() const {return static_cast<unsigned int>(lods.size());}
+
+    /**
+     * @brief Simplification error of a LOD, relative to the diagonal of the bounds (0 for LOD 0)
+     */
+    float lodError(unsigned int lod) const {return lods[lod < lods.size() ? lod : lods.size() - 1].error;}
+
+    glm::vec3 boundsMin() const {return min;}
+    glm::vec3 boundsMax() const {return max;}
+
+private:
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    struct Lod {
+        unsigned int first; //In indices
+        unsigned int count;
+        float error;
+    };
+
+    VertexArray vao;
+    std::vector<Lod> lods;
+    unsigned int indexType; //GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    glm::vec3 min, max;
+};
+
+/**
+ * @brief makeMesh : uploads a MeshData
+ * @return a unique_ptr containing a Mesh
+ */
+std::unique_ptr<Mesh> makeMesh(const MeshData& data);
+
+/**
+ * @brief loadMesh : maps an engine mesh file (.e3dmesh) and uploads it with no parsing nor conversion
+ * @return a unique_ptr containing a Mesh
+ * @throw std::runtime_error
+ */
+std::unique_ptr<Mesh> loadMesh(const std::string& path);
+
+/**
+ * @brief loadMeshData : reads an OBJ or engine mesh file (.e3dmesh) to the CPU, without any GL call.
+ * OBJ files are optimized for the vertex cache as they would be by meshconv.
+ * @throw std::runtime_error
+ */
+MeshData loadMeshData(const std::string& path);
+
+#endif // MESH_H
@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESHDATA_H
+#define MESHDATA_H
+
+#include <vector>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+/**
+ * @brief Vertex layout used by meshes : location 0 = position, 1 = normal, 2 = uv
+ */
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+};
+
+/**
+ * @brief CPU-side indexed triangle mesh
+ * @invariant indices.size() % 3 == 0
+ * @invariant every index is < vertices.size()
+ */
+struct MeshData
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    glm::vec3 boundsMin{0.0f};
+    glm::vec3 boundsMax{0.0f};
+
+    std::size_t triangleCount() const {return indices.size() / 3;}
+
+    /**
+     * @brief Recomputes boundsMin / boundsMax from the vertex positions
+     */
+    void computeBounds();
+
+    /**
+     * @brief Overwrites the normals with area-weighted smooth normals
+     */
+    void computeNormals();
+};
+
+#endif // MESHDATA_H
@@ -0,0 +1,209 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "meshformat.h"
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+const char meshFileMagic[4] = {'E', '3', 'D', 'M'};
+
+std::uint64_t alignUp(std::uint64_t value) {
+    return (value + meshFileAlignment - 1) / meshFileAlignment * meshFileAlignment;
+}
+
+//Bounds check written so that it can't overflow
+bool inside(std::uint64_t offset, std::uint64_t size, std::uint64_t end) {
+    return offset <= end && size <= end - offset;
+}
+
+//Size in bytes of a vertex attribute, 0 for an unknown type
+std::uint64_t attributeSize(const MeshFileAttribute& attribute) {
+    if (attribute.components < 1 || attribute.components > 4)
+        return 0;
+    switch (attribute.type) {
+    case GL_BYTE: case GL_UNSIGNED_BYTE: return attribute.components;
+    case GL_SHORT: case GL_UNSIGNED_SHORT: case GL_HALF_FLOAT: return 2 * attribute.components;
+    case GL_INT: case GL_UNSIGNED_INT: case GL_FLOAT: return 4 * attribute.components;
+    case GL_INT_2_10_10_10_REV: case GL_UNSIGNED_INT_2_10_10_10_REV: return attribute.components == 4 ? 4 : 0;
+    default: return 0;
+    }
+}
+
+template <class Index>
+bool indicesBelow(const void* data, std::uint64_t count, std::uint32_t vertexCount) {
+    const Index* indices = static_cast<const Index*>(data);
+    Index largest = 0;
+    for (std::uint64_t i = 0; i < count; ++i)
+        largest = indices[i] > largest ? indices[i] : largest;
+    return count == 0 || largest < vertexCount;
+}
+
+const MeshFileAttribute vertexLayout[] = {
+    {0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position)},
+    {1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal)},
+    {2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, uv)},
+};
+
+} // namespace
+
+const std::vector<MeshFileAttribute>& defaultVertexLayout() {
+    static const std::vector<MeshFileAttribute> layout(std::begin(vertexLayout), std::end(vertexLayout));
+    return layout;
+}
+
+MeshFile::MeshFile(const std::string &path) : file(path)
+{
+    auto invalid = [&](const char* reason) {
+        return std::runtime_error(std::string("Invalid mesh file (") + reason + ") : " + path);
+    };
+
+    if (file.size() < sizeof(MeshFileHeader))
+        throw invalid("truncated header");
+    head = reinterpret_cast<const MeshFileHeader*>(file.data());
+    if (std::memcmp(head->magic, meshFileMagic, 4) != 0)
+        throw invalid("bad magic");
+    if (head->version != meshFileVersion)
+        throw invalid("unsupported version");
+    if (head->indexSize != 2 && head->indexSize != 4)
+        throw invalid("bad index size");
+    if (head->lodCount == 0)
+        throw invalid("no LOD");
+
+    std::uint64_t tablesEnd = sizeof(MeshFileHeader)
+                            + std::uint64_t(head->attributeCount) * sizeof(MeshFileAttribute)
+                            + std::uint64_t(head->lodCount) * sizeof(MeshFileLod);
+    if (tablesEnd > file.size())
+        throw invalid("truncated tables");
+    attrs = reinterpret_cast<const MeshFileAttribute*>(file.data() + sizeof(MeshFileHeader));
+    lodTable = reinterpret_cast<const MeshFileLod*>(attrs + head->attributeCount);
+
+    if (head->vertexDataSize != std::uint64_t(head->vertexCount) * head->vertexStride
+            || head->vertexDataOffset < tablesEnd
+            || !inside(head->vertexDataOffset, head->vertexDataSize, file.size())
+            || head->indexDataOffset < head->vertexDataOffset + head->vertexDataSize
+            || !inside(head->indexDataOffset, head->indexDataSize, file.size())
+            || head->indexDataSize % head->indexSize != 0)
+        throw invalid("bad blob bounds");
+
+    for (std::uint32_t a = 0; a < head->attributeCount; ++a) {
+        std::uint64_t size = attributeSize(attrs[a]);
+        if (size == 0)
+            throw invalid("bad attribute type");
+        if (!inside(attrs[a].offset, size, head->vertexStride))
+            throw invalid("bad attribute offset");
+    }
+    std::uint64_t indexCount = head->indexDataSize / head->indexSize;
+    for (std::uint32_t l = 0; l < head->lodCount; ++l)
+        if (std::uint64_t(lodTable[l].indexOffset) + lodTable[l].indexCount > indexCount || lodTable[l].indexCount % 3 != 0)
+            throw invalid("bad LOD range"); //Whole triangles only : the meshlet builder and the draws read them by three
+
+    //One pass over the index blob, so that nothing downstream reads past the vertices
+    bool indicesValid = head->indexSize == 4 ? indicesBelow<std::uint32_t>(indexData(), indexCount, head->vertexCount)
+                                             : indicesBelow<std::uint16_t>(indexData(), indexCount, head->vertexCount);
+    if (!indicesValid)
+        throw invalid("index out of range");
+}
+
+MeshData MeshFile::toMeshData() const {
+    if (head->vertexStride != sizeof(Vertex) || head->attributeCount != 3
+            || std::memcmp(attrs, vertexLayout, sizeof(vertexLayout)) != 0)
+        throw std::runtime_error("Mesh file doesn't use the default vertex layout : " + file.path());
+
+    MeshData mesh;
+    mesh.vertices.resize(head->vertexCount);
+    std::memcpy(mesh.vertices.data(), vertexData(), head->vertexDataSize);
+    const MeshFileLod& lod = lodTable[0];
+    mesh.indices.resize(lod.indexCount);
+    if (head->indexSize == 4) {
+        std::memcpy(mesh.indices.data(), static_cast<const std::uint32_t*>(indexData()) + lod.indexOffset, lod.indexCount * 4);
+    } else {
+        const std::uint16_t* source = static_cast<const std::uint16_t*>(indexData()) + lod.indexOffset;
+        for (std::uint32_t i = 0; i < lod.indexCount; ++i)
+            mesh.indices[i] = source[i];
+    }
+    mesh.boundsMin = glm::vec3(head->boundsMin[0], head->boundsMin[1], head->boundsMin[2]);
+    mesh.boundsMax = glm::vec3(head->boundsMax[0], head->boundsMax[1], head->boundsMax[2]);
+    return mesh;
+}
+
+void writeMeshFile(const std::string &path, const MeshData &mesh, const std::vector<MeshLodData> &lods) {
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, meshFileMagic, 4);
+    header.version = meshFileVersion;
+    header.vertexCount = static_cast<std::uint32_t>(mesh.vertices.size());
+    header.vertexStride = sizeof(Vertex);
+    header.attributeCount = sizeof(vertexLayout) / sizeof(vertexLayout[0]);
+    header.indexSize = mesh.vertices.size() <= 0xFFFF ? 2 : 4;
+    header.lodCount = static_cast<std::uint32_t>(lods.size() + 1);
+    for (int i = 0; i < 3; ++i) {
+        header.boundsMin[i] = mesh.boundsMin[i];
+        header.boundsMax[i] = mesh.boundsMax[i];
+    }
+
+    std::vector<MeshFileLod> lodTable(header.lodCount);
+    std::uint32_t indexCount = 0;
+    for (std::uint32_t l = 0; l < header.lodCount; ++l) {
+        const std::vector<unsigned int>& indices = l == 0 ? mesh.indices : lods[l - 1].indices;
+        lodTable[l].indexOffset = indexCount;
+        lodTable[l].indexCount = static_cast<std::uint32_t>(indices.size());
+        lodTable[l].error = l == 0 ? 0.0f : lods[l - 1].error;
+        lodTable[l].reserved = 0;
+        indexCount += lodTable[l].indexCount;
+    }
+
+    std::uint64_t tablesEnd = sizeof(MeshFileHeader) + sizeof(vertexLayout) + lodTable.size() * sizeof(MeshFileLod);
+    header.vertexDataOffset = alignUp(tablesEnd);
+    header.vertexDataSize = std::uint64_t(header.vertexCount) * header.vertexStride;
+    header.indexDataOffset = alignUp(header.vertexDataOffset + header.vertexDataSize);
+    header.indexDataSize = std::uint64_t(indexCount) * header.indexSize;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.good())
+        throw std::runtime_error(std::string("Could not open file for writing : ") + path);
+
+    const char padding[meshFileAlignment] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(vertexLayout), sizeof(vertexLayout));
+    out.write(reinterpret_cast<const char*>(lodTable.data()), lodTable.size() * sizeof(MeshFileLod));
+    out.write(padding, header.vertexDataOffset - tablesEnd);
+    out.write(reinterpret_cast<const char*>(mesh.vertices.data()), header.vertexDataSize);
+    out.write(padding, header.indexDataOffset - header.vertexDataOffset - header.vertexDataSize);
+    for (std::uint32_t l = 0; l < header.lodCount; ++l) {
+        const std::vector<unsigned int>& indices = l == 0 ? mesh.indices : lods[l - 1].indices;
+        if (header.indexSize == 4) {
+            out.write(reinterpret_cast<const char*>(indices.data()), indices.size() * 4);
+        } else {
+            std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+            out.write(reinterpret_cast<const char*>(shortIndices.data()), shortIndices.size() * 2);
+        }
+    }
+    if (!out.good())
+        throw std::runtime_error(std::string("Could not write file : ") + path);
+}
@@ -0,0 +1,139 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESHFORMAT_H
+#define MESHFORMAT_H
+
+#include "mappedfile.h"
+#include "meshdata.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/* Engine-native mesh file (.e3dmesh). Little-endian, laid out so that it can be used straight from
+ * a memory mapping :
+ *
+ *   MeshFileHeader
+ *   MeshFileAttribute[attributeCount]
+ *   MeshFileLod[lodCount]
+ *   vertex blob (vertexCount * vertexStride bytes, aligned on meshFileAlignment)
+ *   index blob  (all LODs one after another, aligned on meshFileAlignment)
+ */
+
+const std::uint32_t meshFileVersion = 1;
+const std::uint32_t meshFileAlignment = 64;
+
+struct MeshFileHeader
+{
+    char magic[4]; //"E3DM"
+    std::uint32_t version;
+    std::uint32_t vertexCount;
+    std::uint32_t vertexStride;
+    std::uint32_t attributeCount;
+    std::uint32_t indexSize; //2 or 4 bytes
+    std::uint32_t lodCount; //LOD 0 is the full resolution mesh
+    std::uint32_t reserved;
+    float boundsMin[3];
+    float boundsMax[3];
+    std::uint64_t vertexDataOffset;
+    std::uint64_t vertexDataSize;
+    std::uint64_t indexDataOffset;
+    std::uint64_t indexDataSize;
+};
+
+/**
+ * @brief Vertex layout descriptor, maps to one glVertexAttribPointer call
+ */
+struct MeshFileAttribute
+{
+    std::uint32_t location;
+    std::uint32_t components;
+    std::uint32_t type; //GL type enum (GL_FLOAT, GL_SHORT, ...)
+    std::uint32_t normalized;
+    std::uint32_t offset; //In bytes from the start of the vertex
+};
+
+struct MeshFileLod
+{
+    std::uint32_t indexOffset; //In indices from the start of the index blob
+    std::uint32_t indexCount;
+    float error; //Simplification error relative to the mesh extent, 0 for LOD 0
+    std::uint32_t reserved;
+};
+
+/**
+ * @brief Additional level of detail stored with a mesh, sharing its vertices
+ */
+struct MeshLodData
+{
+    std::vector<unsigned int> indices;
+    float error;
+};
+
+/**
+ * @brief Read-only view of a mesh file, mapped in memory. No data is copied or converted.
+ * @invariant the header, tables and blobs have been validated against the file size
+ */
+class MeshFile
+{
+public:
+    /**
+     * @brief Maps and validates the file
+     * @throw std::runtime_error if the file can't be read or is not a valid mesh file
+     */
+    explicit MeshFile(const std::string& path);
+
+    const MeshFileHeader& header() const {return *head;}
+    const MeshFileAttribute* attributes() const {return attrs;}
+    const MeshFileLod* lods() const {return lodTable;}
+    const void* vertexData() const {return file.data() + head->vertexDataOffset;}
+    const void* indexData() const {return file.data() + head->indexDataOffset;}
+
+    /**
+     * @brief Copies the content back to a MeshData (LOD 0 only, engine Vertex layout only)
+     * @throw std::runtime_error if the vertex layout differs from Vertex
+     */
+    MeshData toMeshData() const;
+
+private:
+    MappedFile file;
+    const MeshFileHeader* head;
+    const MeshFileAttribute* attrs;
+    const MeshFileLod* lodTable;
+};
+
+/**
+ * @brief defaultVertexLayout : attribute descriptors of the engine Vertex structure
+ */
+const std::vector<MeshFileAttribute>& defaultVertexLayout();
+
+/**
+ * @brief writeMeshFile : serializes a mesh in the engine format
+ * @param lods : additional LODs (LOD 0 being mesh.indices)
+ * @throw std::runtime_error if the file can't be written
+ *
+ * Indices are stored on 16 bits when the vertex count allows it.
+ */
+void writeMeshFile(const std::string& path, const MeshData& mesh, const std::vector<MeshLodData>& lods = {});
+
+#endif // MESHFORMAT_H
@@ -0,0 +1,210 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "meshlet.h"
+#include "frustum.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <glm/geometric.hpp>
+
+namespace {
+
+const unsigned int invalid = std::numeric_limits<unsigned int>::max();
+
+/** Ritter's bounding sphere : starts from two far apart points, then grows to include the others */
+void computeSphere(const std::vector<glm::vec3>& points, glm::vec3& center, float& radius) {
+    auto furthest = [&](const glm::vec3& from) {
+        std::size_t best = 0;
+        float bestDistance = -1.0f;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            float d = glm::dot(points[i] - from, points[i] - from);
+            if (d > bestDistance) {
+                bestDistance = d;
+                best = i;
+            }
+        }
+        return points[best];
+    };
+    glm::vec3 a = furthest(points[0]);
+    glm::vec3 b = furthest(a);
+    center = (a + b) * 0.5f;
+    radius = glm::length(b - a) * 0.5f;
+    for (const glm::vec3& p : points) {
+        float d = glm::length(p - center);
+        if (d > radius) {
+            float grown = (radius + d) * 0.5f;
+            center += (p - center) * ((grown - radius) / d);
+            radius = grown;
+        }
+    }
+}
+
+void computeBounds(Meshlet& meshlet, const MeshletData& data, const MeshData& mesh) {
+    std::vector<glm::vec3> points(meshlet.vertexCount);
+    for (unsigned int v = 0; v < meshlet.vertexCount; ++v)
+        points[v] = mesh.vertices[data.vertices[meshlet.vertexOffset + v]].position;
+    computeSphere(points, meshlet.center, meshlet.radius);
+
+    std::vector<glm::vec3> normals;
+    glm::vec3 axis(0.0f);
+    for (unsigned int t = 0; t < meshlet.triangleCount; ++t) {
+        const std::uint8_t* triangle = &data.triangles[3 * (meshlet.triangleOffset + t)];
+        glm::vec3 n = glm::cross(points[triangle[1]] - points[triangle[0]], points[triangle[2]] - points[triangle[0]]);
+        float length = glm::length(n);
+        if (length > 0) {
+            normals.push_back(n / length);
+            axis += normals.back();
+        }
+    }
+    meshlet.coneAxis = glm::vec3(0.0f);
+    meshlet.coneCutoff = 1.0f;
+    float length = glm::length(axis);
+    if (normals.empty() || length == 0)
+        return;
+    axis /= length;
+    float minDot = 1.0f;
+    for (const glm::vec3& n : normals)
+        minDot = std::min(minDot, glm::dot(axis, n));
+    meshlet.coneAxis = axis;
+    if (minDot > 0) //Otherwise some triangle faces every direction the others don't
+        meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+} // namespace
+
+MeshletData buildMeshlets(const MeshData &mesh, const std::vector<unsigned int> &indices, unsigned int maxVertices, unsigned int maxTriangles) {
+    if (maxVertices > 256 || maxVertices < 3 || maxTriangles < 1)
+        throw std::runtime_error("Invalid meshlet limits : " + std::to_string(maxVertices) + " vertices, "
+                                 + std::to_string(maxTriangles) + " triangles");
+    const std::size_t vertexCount = mesh.vertices.size();
+    const std::size_t triangleCount = indices.size() / 3;
+    MeshletData data;
+
+    //Vertex -> triangles adjacency, in compressed rows
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (unsigned int index : indices)
+        ++offsets[index + 1];
+    for (std::size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] += offsets[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    std::vector<bool> used(triangleCount, false);
+    std::vector<unsigned int> local(vertexCount, invalid); //Index in the current meshlet
+    std::size_t cursor = 0;
+    Meshlet current{};
+    glm::vec3 centroidSum(0.0f);
+
+    auto close = [&]() {
+        for (unsigned int v = 0; v < current.vertexCount; ++v)
+            local[data.vertices[current.vertexOffset + v]] = invalid;
+        computeBounds(current, data, mesh);
+        data.meshlets.push_back(current);
+        current = Meshlet{};
+        current.vertexOffset = static_cast<unsigned int>(data.vertices.size());
+        current.triangleOffset = static_cast<unsigned int>(data.triangles.size() / 3);
+        centroidSum = glm::vec3(0.0f);
+    };
+    auto newVertices = [&](unsigned int t) {
+        return (local[indices[3 * t]] == invalid) + (local[indices[3 * t + 1]] == invalid) + (local[indices[3 * t + 2]] == invalid);
+    };
+
+    for (std::size_t emitted = 0; emitted < triangleCount; ++emitted) {
+        //Best neighbour of the meshlet that still fits in it
+        unsigned int best = invalid;
+        int bestNew = 4;
+        float bestDistance = std::numeric_limits<float>::max();
+        if (current.triangleCount > 0 && current.triangleCount < maxTriangles) {
+            const glm::vec3 centroid = centroidSum / float(current.vertexCount);
+            for (unsigned int v = 0; v < current.vertexCount; ++v) {
+                unsigned int vertex = data.vertices[current.vertexOffset + v];
+                for (unsigned int a = offsets[vertex]; a < offsets[vertex + 1]; ++a) {
+                    unsigned int t = adjacency[a];
+                    int added = newVertices(t);
+                    if (used[t] || added > bestNew || current.vertexCount + added > maxVertices)
+                        continue;
+                    const glm::vec3 center = (mesh.vertices[indices[3 * t]].position + mesh.vertices[indices[3 * t + 1]].position
+                                              + mesh.vertices[indices[3 * t + 2]].position) / 3.0f;
+                    float distance = glm::dot(center - centroid, center - centroid);
+                    if (added < bestNew || distance < bestDistance) {
+                        best = t;
+                        bestNew = added;
+                        bestDistance = distance;
+                    }
+                }
+            }
+        }
+        if (best == invalid) {
+            if (current.triangleCount > 0)
+                close();
+            while (used[cursor])
+                ++cursor;
+            best = static_cast<unsigned int>(cursor);
+        }
+
+        used[best] = true;
+        for (int k = 0; k < 3; ++k) {
+            unsigned int vertex = indices[3 * best + k];
+            if (local[vertex] == invalid) {
+                local[vertex] = current.vertexCount++;
+                data.vertices.push_back(vertex);
+                centroidSum += mesh.vertices[vertex].position;
+            }
+            data.triangles.push_back(static_cast<std::uint8_t>(local[vertex]));
+        }
+        ++current.triangleCount;
+    }
+    if (current.triangleCount > 0)
+        close();
+    return data;
+}
+
+bool isMeshletVisible(const Meshlet &meshlet, const Frustum &frustum, const glm::vec3 &eye) {
+    if (!frustum.intersectsSphere(meshlet.center, meshlet.radius))
+        return false;
+    //Backfacing if every normal of the cone points away from the eye, wherever the triangles are in the sphere
+    const glm::vec3 toCenter = meshlet.center - eye;
+    return glm::dot(toCenter, meshlet.coneAxis) <= meshlet.coneCutoff * glm::length(toCenter) + meshlet.radius;
+}
+
+std::size_t cullMeshlets(const MeshletData &data, const Frustum &frustum, const glm::vec3 &eye, FrameVector<unsigned int> &indices) {
+    indices.clear();
+    std::size_t visible = 0;
+    for (const Meshlet& meshlet : data.meshlets) {
+        if (!isMeshletVisible(meshlet, frustum, eye))
+            continue;
+        ++visible;
+        const unsigned int* vertices = &data.vertices[meshlet.vertexOffset];
+        const std::uint8_t* triangles = &data.triangles[3 * meshlet.triangleOffset];
+        for (unsigned int i = 0; i < 3 * meshlet.triangleCount; ++i)
+            indices.push_back(vertices[triangles[i]]);
+    }
+    return visible;
+}
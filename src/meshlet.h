@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include "framearena.h"
+#include "meshdata.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/vec3.hpp>
+
+class Frustum;
+
+const unsigned int meshletMaxVertices = 64;
+const unsigned int meshletMaxTriangles = 124;
+
+/**
+ * @brief Small cluster of triangles with the bounds used to cull it as a whole
+ */
+struct Meshlet
+{
+    unsigned int vertexOffset; //In MeshletData::vertices
+    unsigned int triangleOffset; //In triangles of MeshletData::triangles
+    unsigned int vertexCount;
+    unsigned int triangleCount;
+    glm::vec3 center;
+    float radius;
+    glm::vec3 coneAxis; //Average front-facing normal
+    float coneCutoff; //Sine of the cone half-angle, 1 when the normals span more than a half-sphere
+};
+
+/**
+ * @brief A mesh split in meshlets. Each meshlet indexes its own vertex list with 8-bit local indices,
+ * which in turn refers to the vertices of the original mesh.
+ */
+struct MeshletData
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<unsigned int> vertices;
+    std::vector<std::uint8_t> triangles; //3 local indices per triangle
+
+    std::size_t triangleCount() const {return triangles.size() / 3;}
+};
+
+/** @defgroup Meshlets
+ * Meshlet clustering and CPU cluster culling. Everything here is plain CPU code.
+ * @{ */
+
+/**
+ * @brief buildMeshlets : splits triangles into meshlets
+ * @param indices : triangles referencing mesh.vertices, ideally ordered for the vertex cache (see optimizeVertexCache())
+ * @throw std::runtime_error if maxVertices is over 256 or either limit is too low for a triangle
+ *
+ * Meshlets grow greedily to the adjacent triangle adding the fewest vertices, the closest to the meshlet breaking
+ * ties, so they stay compact and their bounds tight. A meshlet is closed once full or when no neighbour fits.
+ */
+MeshletData buildMeshlets(const MeshData& mesh, const std::vector<unsigned int>& indices,
+                          unsigned int maxVertices = meshletMaxVertices, unsigned int maxTriangles = meshletMaxTriangles);
+
+/**
+ * @brief isMeshletVisible : frustum test of the bounding sphere, then backface test of the normal cone
+ * @param frustum, eye : in the space of the mesh
+ *
+ * The cone test is conservative over the whole sphere (Kapoulkine, "Meshlet culling"). It assumes the mesh
+ * isn't mirrored nor scaled non-uniformly in the space of the frustum.
+ */
+bool isMeshletVisible(const Meshlet& meshlet, const Frustum& frustum, const glm::vec3& eye);
+
+/**
+ * @brief cullMeshlets : writes the triangles of the visible meshlets to indices, as indices of the original mesh
+ * @param frustum, eye : in the space of the mesh
+ * @param[out] indices : cleared first. Reserve the index count of the mesh to avoid growing it in the arena.
+ * @return number of visible meshlets
+ */
+std::size_t cullMeshlets(const MeshletData& data, const Frustum& frustum, const glm::vec3& eye, FrameVector<unsigned int>& indices);
+
+/** @} */
+
+#endif // MESHLET_H
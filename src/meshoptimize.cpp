@@ -0,0 +1,295 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "meshoptimize.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <glm/geometric.hpp>
+
+namespace {
+
+//Tuning values from Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+const int forsythCacheSize = 32;
+const float lastTriangleScore = 0.75f;
+const float cacheDecayPower = 1.5f;
+const float valenceBoostScale = 2.0f;
+const float valenceBoostPower = 0.5f;
+const unsigned int invalid = std::numeric_limits<unsigned int>::max();
+
+float vertexScore(int cachePosition, unsigned int remaining) {
+    if (remaining == 0)
+        return -1.0f; //No triangle left to emit
+    float score = 0;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3)
+            score = lastTriangleScore; //Used by the last triangle, no matter which of its vertices
+        else
+            score = std::pow(1.0f - float(cachePosition - 3) / (forsythCacheSize - 3), cacheDecayPower);
+    }
+    //Favour vertices with few triangles left, to finish them off and avoid isolated stragglers
+    return score + valenceBoostScale * std::pow(float(remaining), -valenceBoostPower);
+}
+
+/** Simulates a FIFO cache, returns the number of misses for each triangle */
+std::vector<unsigned char> simulateFifo(const unsigned int* indices, std::size_t indexCount, std::size_t vertexCount,
+                                        unsigned int cacheSize) {
+    std::vector<unsigned int> timestamps(vertexCount, 0);
+    std::vector<unsigned char> misses(indexCount / 3, 0);
+    unsigned int time = cacheSize + 1;
+    for (std::size_t i = 0; i < indexCount; ++i) {
+        unsigned int& stamp = timestamps[indices[i]];
+        if (time - stamp > cacheSize) {
+            stamp = time++;
+            ++misses[i / 3];
+        }
+    }
+    return misses;
+}
+
+} // namespace
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int> &indices, std::size_t vertexCount, unsigned int cacheSize) {
+    VertexCacheStats stats;
+    if (indices.empty())
+        return stats;
+    std::vector<unsigned char> misses = simulateFifo(indices.data(), indices.size(), vertexCount, cacheSize);
+    std::size_t transformed = 0;
+    for (unsigned char m : misses)
+        transformed += m;
+    std::vector<bool> referenced(vertexCount, false);
+    std::size_t unique = 0;
+    for (unsigned int index : indices)
+        if (!referenced[index]) {
+            referenced[index] = true;
+            ++unique;
+        }
+    stats.acmr = float(transformed) / misses.size();
+    stats.atvr = float(transformed) / unique;
+    return stats;
+}
+
+void optimizeVertexCache(std::vector<unsigned int> &indices, std::size_t vertexCount) {
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    //Vertex -> triangles adjacency, in compressed rows
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int index : indices)
+        ++remaining[index];
+    std::vector<unsigned int> offsets(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] = offsets[v] + remaining[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<unsigned int> fill(offsets.begin(), offsets.end() - 1);
+        for (std::size_t i = 0; i < indices.size(); ++i)
+            adjacency[fill[indices[i]]++] = static_cast<unsigned int>(i / 3);
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v)
+        score[v] = vertexScore(-1, remaining[v]);
+    std::vector<float> triangleScore(triangleCount);
+    for (std::size_t t = 0; t < triangleCount; ++t)
+        triangleScore[t] = score[indices[3 * t]] + score[indices[3 * t + 1]] + score[indices[3 * t + 2]];
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    //One extra slot for each of the 3 vertices pushed before the cache is trimmed
+    std::vector<unsigned int> cache, nextCache;
+    cache.reserve(forsythCacheSize + 3);
+    nextCache.reserve(forsythCacheSize + 3);
+    unsigned int best = 0;
+    std::size_t cursor = 0;
+
+    while (best != invalid) {
+        emitted[best] = true;
+        nextCache.clear();
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = indices[3 * best + k];
+            result.push_back(v);
+            nextCache.push_back(v);
+            //Remove the triangle from the vertex' adjacency so only pending triangles are left
+            unsigned int* begin = &adjacency[offsets[v]];
+            unsigned int* end = begin + remaining[v];
+            *std::find(begin, end, best) = *(end - 1);
+            --remaining[v];
+        }
+        for (unsigned int v : cache)
+            if (v != nextCache[0] && v != nextCache[1] && v != nextCache[2])
+                nextCache.push_back(v);
+
+        //Rescore the vertices in and just out of the cache, and their pending triangles
+        for (std::size_t i = 0; i < nextCache.size(); ++i) {
+            unsigned int v = nextCache[i];
+            cachePosition[v] = i < forsythCacheSize ? static_cast<int>(i) : -1;
+            float updated = vertexScore(cachePosition[v], remaining[v]);
+            float delta = updated - score[v];
+            score[v] = updated;
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+                triangleScore[adjacency[a]] += delta;
+        }
+        if (nextCache.size() > forsythCacheSize)
+            nextCache.resize(forsythCacheSize);
+        cache.swap(nextCache);
+
+        best = invalid;
+        float bestScore = -1.0f;
+        for (unsigned int v : cache)
+            for (unsigned int a = offsets[v]; a < offsets[v] + remaining[v]; ++a)
+                if (triangleScore[adjacency[a]] > bestScore) {
+                    bestScore = triangleScore[adjacency[a]];
+                    best = adjacency[a];
+                }
+
+        //Dead end : nothing pending around the cache, restart from the next triangle in input order
+        if (best == invalid) {
+            while (cursor < triangleCount && emitted[cursor])
+                ++cursor;
+            if (cursor < triangleCount)
+                best = static_cast<unsigned int>(cursor);
+        }
+    }
+    indices.swap(result);
+}
+
+void optimizeOverdraw(std::vector<unsigned int> &indices, const std::vector<Vertex> &vertices, float threshold) {
+    const std::size_t triangleCount = indices.size() / 3;
+    if (triangleCount < 2)
+        return;
+    const unsigned int cacheSize = 16;
+
+    //Hard boundaries : triangles missing on all their vertices, the cache starts over there
+    std::vector<unsigned char> misses = simulateFifo(indices.data(), indices.size(), vertices.size(), cacheSize);
+    std::vector<std::size_t> hard;
+    for (std::size_t t = 0; t < triangleCount; ++t)
+        if (t == 0 || misses[t] == 3)
+            hard.push_back(t);
+    hard.push_back(triangleCount);
+
+    //Soft boundaries : inside a run, split once the ACMR since the last split is within threshold of the run's ACMR
+    std::vector<std::size_t> clusters;
+    std::vector<unsigned int> timestamps(vertices.size(), 0);
+    unsigned int time = cacheSize + 1;
+    for (std::size_t h = 0; h + 1 < hard.size(); ++h) {
+        const std::size_t begin = hard[h], end = hard[h + 1];
+        std::size_t runMisses = 0;
+        for (std::size_t t = begin; t < end; ++t)
+            runMisses += misses[t];
+        const float target = threshold * runMisses / (end - begin);
+
+        std::size_t localMisses = 0, localTriangles = 0;
+        for (std::size_t t = begin; t < end; ++t) {
+            if (localTriangles == 0) {
+                clusters.push_back(t);
+                time += cacheSize + 1; //Empties the simulated cache
+            }
+            for (int k = 0; k < 3; ++k) {
+                unsigned int& stamp = timestamps[indices[3 * t + k]];
+                if (time - stamp > cacheSize) {
+                    stamp = time++;
+                    ++localMisses;
+                }
+            }
+            ++localTriangles;
+            if (localTriangles >= 3 && localMisses <= target * localTriangles)
+                localMisses = localTriangles = 0;
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    glm::vec3 meshCenter(0.0f);
+    float meshArea = 0;
+    struct Cluster { std::size_t begin, end; float sortKey; };
+    std::vector<Cluster> sorted;
+    std::vector<glm::vec3> centroids;
+    std::vector<glm::vec3> normals;
+    for (std::size_t c = 0; c + 1 < clusters.size(); ++c) {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0;
+        for (std::size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const glm::vec3& p0 = vertices[indices[3 * t]].position;
+            const glm::vec3& p1 = vertices[indices[3 * t + 1]].position;
+            const glm::vec3& p2 = vertices[indices[3 * t + 2]].position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        meshCenter += centroid;
+        meshArea += area;
+        centroids.push_back(area > 0 ? centroid / area : vertices[indices[3 * clusters[c]]].position);
+        float length = glm::length(normal);
+        normals.push_back(length > 0 ? normal / length : glm::vec3(0.0f));
+        sorted.push_back({clusters[c], clusters[c + 1], 0.0f});
+    }
+    if (meshArea > 0)
+        meshCenter /= meshArea;
+
+    //Clusters facing away from the center occlude the ones facing inwards, whatever the view direction
+    for (std::size_t c = 0; c < sorted.size(); ++c)
+        sorted[c].sortKey = glm::dot(centroids[c] - meshCenter, normals[c]);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : sorted)
+        result.insert(result.end(), indices.begin() + 3 * cluster.begin, indices.begin() + 3 * cluster.end);
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(MeshData &mesh, std::vector<MeshLodData> &lods) {
+    std::vector<unsigned int> remap(mesh.vertices.size(), invalid);
+    std::vector<Vertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    auto renumber = [&](std::vector<unsigned int>& indices) {
+        for (unsigned int& index : indices) {
+            if (remap[index] == invalid) {
+                remap[index] = static_cast<unsigned int>(vertices.size());
+                vertices.push_back(mesh.vertices[index]);
+            }
+            index = remap[index];
+        }
+    };
+    renumber(mesh.indices);
+    for (MeshLodData& lod : lods)
+        renumber(lod.indices);
+    mesh.vertices.swap(vertices);
+}
+
+void optimizeMesh(MeshData &mesh, std::vector<MeshLodData> &lods, float overdrawThreshold) {
+    optimizeVertexCache(mesh.indices, mesh.vertices.size());
+    optimizeOverdraw(mesh.indices, mesh.vertices, overdrawThreshold);
+    for (MeshLodData& lod : lods) {
+        optimizeVertexCache(lod.indices, mesh.vertices.size());
+        optimizeOverdraw(lod.indices, mesh.vertices, overdrawThreshold);
+    }
+    optimizeVertexFetch(mesh, lods);
+}
@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESHOPTIMIZE_H
+#define MESHOPTIMIZE_H
+
+#include "meshdata.h"
+#include "meshformat.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Post-transform vertex cache efficiency of an index buffer, simulated with a FIFO cache
+ */
+struct VertexCacheStats
+{
+    float acmr = 0; ///< Average cache miss ratio : transformed vertices per triangle (0.5 at best, 3 at worst)
+    float atvr = 0; ///< Average transformed vertex ratio : transformed vertices per referenced vertex (1 at best)
+};
+
+/** @defgroup MeshOptimize
+ * Index and vertex reordering run when meshes are imported. None of these passes change the rendered result,
+ * only the order triangles and vertices are fed to the GPU.
+ * @{ */
+
+/**
+ * @brief analyzeVertexCache : simulates a FIFO post-transform cache of cacheSize entries
+ */
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, std::size_t vertexCount, unsigned int cacheSize = 16);
+
+/**
+ * @brief optimizeVertexCache : reorders triangles for the post-transform cache (Forsyth's linear-speed algorithm)
+ * @pre every index is < vertexCount
+ */
+void optimizeVertexCache(std::vector<unsigned int>& indices, std::size_t vertexCount);
+
+/**
+ * @brief optimizeOverdraw : reorders clusters of triangles so outward facing ones are drawn first
+ * @param indices : triangles already optimized for the vertex cache
+ * @param threshold : how much the ACMR may degrade, 1.05 allowing 5% more vertex transforms
+ *
+ * The index buffer is cut where the cache restarts anyway, and inside those runs wherever the ACMR stays under
+ * threshold times the run's own ACMR (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+ * Clusters are then sorted by how far along their normal they sit from the mesh center, which front-loads occluders.
+ */
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<Vertex>& vertices, float threshold = 1.05f);
+
+/**
+ * @brief optimizeVertexFetch : renumbers vertices in order of first use, so the vertex buffer is read linearly
+ *
+ * The first use is taken over mesh.indices then each LOD in turn. Vertices no index refers to are dropped.
+ */
+void optimizeVertexFetch(MeshData& mesh, std::vector<MeshLodData>& lods);
+
+/**
+ * @brief optimizeMesh : runs the three passes above on LOD 0 and every additional LOD
+ */
+void optimizeMesh(MeshData& mesh, std::vector<MeshLodData>& lods, float overdrawThreshold = 1.05f);
+
+/** @} */
+
+#endif // MESHOPTIMIZE_H
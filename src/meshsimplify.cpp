@@ -0,0 +1,257 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "meshsimplify.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <glm/geometric.hpp>
+
+namespace {
+
+/** Symmetric 4x4 matrix of a weighted sum of squared distances to planes, with the sum of the weights */
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    void addPlane(double a, double b, double c, double d, double weight) {
+        this->weight += weight;
+        a00 += weight * a * a; a01 += weight * a * b; a02 += weight * a * c; a03 += weight * a * d;
+        a11 += weight * b * b; a12 += weight * b * c; a13 += weight * b * d;
+        a22 += weight * c * c; a23 += weight * c * d;
+        a33 += weight * d * d;
+    }
+
+    Quadric& operator+=(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+        a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23;
+        a33 += q.a33;
+        weight += q.weight;
+        return *this;
+    }
+
+    double evaluate(const glm::vec3& p) const {
+        const double x = p.x, y = p.y, z = p.z;
+        return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+             + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+             + a22 * z * z + 2 * a23 * z
+             + a33;
+    }
+
+    /** Mean squared distance to the planes : a squared length, whatever the weights */
+    double meanSquaredDistance(const glm::vec3& p) const {
+        return weight > 0 ? std::max(evaluate(p), 0.0) / weight : 0;
+    }
+};
+
+struct Collapse {
+    unsigned int from, to;
+    double cost;
+};
+
+struct PositionHash {
+    std::size_t operator()(const glm::vec3& p) const {
+        std::uint32_t bits[3];
+        std::memcpy(bits, &p, sizeof(bits));
+        return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+    }
+};
+
+/**
+ * Vertices that must not move : those sharing their position with another vertex (normal / UV seams)
+ * and those on an open border (an edge used by a single triangle).
+ */
+std::vector<bool> findLockedVertices(const MeshData& mesh, const std::vector<unsigned int>& indices) {
+    std::vector<bool> locked(mesh.vertices.size(), false);
+    std::vector<unsigned int> canonical(mesh.vertices.size());
+    std::unordered_map<glm::vec3, unsigned int, PositionHash> byPosition;
+    for (unsigned int v = 0; v < mesh.vertices.size(); ++v) {
+        auto inserted = byPosition.emplace(mesh.vertices[v].position, v);
+        canonical[v] = inserted.first->second;
+        if (!inserted.second) {
+            locked[v] = true;
+            locked[inserted.first->second] = true;
+        }
+    }
+
+    //Edges seen an odd number of times in the welded mesh are borders
+    std::unordered_map<std::uint64_t, unsigned int> edgeUses;
+    for (std::size_t t = 0; t < indices.size(); t += 3)
+        for (int e = 0; e < 3; ++e) {
+            std::uint64_t a = canonical[indices[t + e]], b = canonical[indices[t + (e + 1) % 3]];
+            ++edgeUses[std::min(a, b) << 32 | std::max(a, b)];
+        }
+    for (std::size_t t = 0; t < indices.size(); t += 3)
+        for (int e = 0; e < 3; ++e) {
+            unsigned int a = indices[t + e], b = indices[t + (e + 1) % 3];
+            std::uint64_t ca = canonical[a], cb = canonical[b];
+            if (edgeUses[std::min(ca, cb) << 32 | std::max(ca, cb)] == 1)
+                locked[a] = locked[b] = true;
+        }
+    return locked;
+}
+
+/** True if moving `from` onto `to` flips or degenerates one of the triangles kept around `from` */
+bool flipsTriangles(const MeshData& mesh, const std::vector<unsigned int>& indices, const std::vector<unsigned int>& triangles,
+                    unsigned int from, unsigned int to) {
+    const glm::vec3& target = mesh.vertices[to].position;
+    for (unsigned int t : triangles) {
+        const unsigned int* tri = &indices[t * 3];
+        if (tri[0] == to || tri[1] == to || tri[2] == to)
+            continue; //Removed by the collapse
+        glm::vec3 p[3], q[3];
+        for (int i = 0; i < 3; ++i) {
+            p[i] = mesh.vertices[tri[i]].position;
+            q[i] = tri[i] == from ? target : p[i];
+        }
+        glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]), after = glm::cross(q[1] - q[0], q[2] - q[0]);
+        if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<unsigned int> simplifyMesh(const MeshData &mesh, const std::vector<unsigned int> &indices,
+                                       std::size_t targetIndexCount, float maxError, float &error) {
+    std::vector<unsigned int> result = indices;
+    error = 0;
+    glm::vec3 extent = mesh.boundsMax - mesh.boundsMin;
+    const double diagonal = std::max(static_cast<double>(glm::length(extent)), 1e-12);
+    const double maxCost = static_cast<double>(maxError) * maxError * diagonal * diagonal;
+    const std::size_t vertexCount = mesh.vertices.size();
+
+    const std::vector<bool> locked = findLockedVertices(mesh, indices);
+    std::vector<Quadric> quadrics(vertexCount);
+    for (std::size_t t = 0; t < result.size(); t += 3) {
+        const glm::vec3& p0 = mesh.vertices[result[t]].position;
+        glm::vec3 normal = glm::cross(mesh.vertices[result[t + 1]].position - p0, mesh.vertices[result[t + 2]].position - p0);
+        double area = glm::length(normal);
+        if (area <= 0)
+            continue;
+        normal /= static_cast<float>(area);
+        double d = -glm::dot(normal, p0);
+        for (int i = 0; i < 3; ++i)
+            quadrics[result[t + i]].addPlane(normal.x, normal.y, normal.z, d, area);
+    }
+
+    //Passes : collapse the cheapest independent edges, then rebuild the triangle list
+    double worstCost = 0;
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<std::vector<unsigned int>> vertexTriangles(vertexCount);
+    while (result.size() > targetIndexCount) {
+        for (std::vector<unsigned int>& triangles : vertexTriangles)
+            triangles.clear();
+        for (unsigned int t = 0; t < result.size() / 3; ++t)
+            for (int i = 0; i < 3; ++i)
+                vertexTriangles[result[t * 3 + i]].push_back(t);
+
+        std::vector<Collapse> collapses;
+        for (std::size_t t = 0; t < result.size(); t += 3)
+            for (int e = 0; e < 3; ++e) {
+                unsigned int a = result[t + e], b = result[t + (e + 1) % 3];
+                if (a > b)
+                    continue; //Each edge once from its two triangles is enough, borders being locked anyway
+                Quadric q = quadrics[a];
+                q += quadrics[b];
+                Collapse best{a, b, std::numeric_limits<double>::max()};
+                if (!locked[a])
+                    best = Collapse{a, b, q.meanSquaredDistance(mesh.vertices[b].position)};
+                if (!locked[b]) {
+                    double cost = q.meanSquaredDistance(mesh.vertices[a].position);
+                    if (cost < best.cost)
+                        best = Collapse{b, a, cost};
+                }
+                if (best.cost <= maxCost)
+                    collapses.push_back(best);
+            }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& x, const Collapse& y) {return x.cost < y.cost;});
+
+        for (unsigned int v = 0; v < vertexCount; ++v)
+            remap[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+        std::size_t removedIndices = 0;
+        const std::size_t wanted = result.size() - targetIndexCount;
+        for (const Collapse& collapse : collapses) {
+            if (touched[collapse.from] || touched[collapse.to])
+                continue;
+            if (flipsTriangles(mesh, result, vertexTriangles[collapse.from], collapse.from, collapse.to))
+                continue;
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            worstCost = std::max(worstCost, collapse.cost);
+            //The triangles around `from` change : their other vertices wait for the next pass
+            for (unsigned int t : vertexTriangles[collapse.from])
+                for (int i = 0; i < 3; ++i)
+                    touched[result[t * 3 + i]] = true;
+            removedIndices += 6; //An interior edge removes two triangles
+            if (removedIndices >= wanted)
+                break;
+        }
+        if (removedIndices == 0)
+            break;
+
+        std::size_t kept = 0;
+        for (std::size_t t = 0; t < result.size(); t += 3) {
+            unsigned int a = remap[result[t]], b = remap[result[t + 1]], c = remap[result[t + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+            result[kept++] = a;
+            result[kept++] = b;
+            result[kept++] = c;
+        }
+        result.resize(kept);
+    }
+
+    error = static_cast<float>(std::sqrt(worstCost) / diagonal);
+    return result;
+}
+
+std::vector<MeshLodData> generateLods(const MeshData &mesh, unsigned int count, float ratio) {
+    std::vector<MeshLodData> lods;
+    lods.reserve(count);
+    const std::vector<unsigned int>* previous = &mesh.indices;
+    float previousError = 0;
+    for (unsigned int l = 0; l < count; ++l) {
+        std::size_t target = static_cast<std::size_t>(previous->size() / 3 * ratio) * 3;
+        MeshLodData lod;
+        lod.indices = simplifyMesh(mesh, *previous, target, 1.0f, lod.error);
+        if (lod.indices.empty() || lod.indices.size() > previous->size() * 9 / 10)
+            break;
+        //Measured against the previous level : the sum bounds the error to the full mesh
+        lod.error += previousError;
+        previousError = lod.error;
+        lods.push_back(std::move(lod));
+        previous = &lods.back().indices;
+    }
+    return lods;
+}
@@ -0,0 +1,58 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef MESHSIMPLIFY_H
+#define MESHSIMPLIFY_H
+
+#include "meshdata.h"
+#include "meshformat.h"
+#include <cstddef>
+#include <vector>
+
+/** @defgroup MeshSimplify
+ * Level of detail generation with quadric error metrics (Garland & Heckbert). Edges are collapsed onto one of
+ * their vertices, so the simplified index buffers reference the original vertices and all LODs share one vertex buffer.
+ * Vertices on open borders and on attribute seams (several vertices at the same position) never move, which keeps
+ * silhouettes and UV layouts intact at the cost of a lower reduction on heavily seamed meshes.
+ * @{ */
+
+/**
+ * @brief simplifyMesh : collapses edges, cheapest first, until the index count or the error limit is reached
+ * @param indices : triangles to simplify, referencing mesh.vertices (e.g. a previous LOD)
+ * @param targetIndexCount : stops once the result has at most this many indices
+ * @param maxError : error limit, relative to the diagonal of the mesh bounds
+ * @param[out] error : worst root mean square distance of a collapsed vertex to the planes of the triangles it
+ * absorbed, relative to the diagonal of the mesh bounds (so independent of the scale of the mesh)
+ */
+std::vector<unsigned int> simplifyMesh(const MeshData& mesh, const std::vector<unsigned int>& indices,
+                                       std::size_t targetIndexCount, float maxError, float& error);
+
+/**
+ * @brief generateLods : builds a LOD chain, each level aiming at ratio times the triangles of the previous one
+ * @return up to count levels, fewer if the simplification stalls (less than 10% fewer triangles)
+ */
+std::vector<MeshLodData> generateLods(const MeshData& mesh, unsigned int count, float ratio = 0.5f);
+
+/** @} */
+
+#endif // MESHSIMPLIFY_H
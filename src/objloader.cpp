@@ -0,0 +1,313 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "objloader.h"
+#include "jobsystem.h"
+#include "mappedfile.h"
+#include "profiler.h"
+#include "textparse.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+//Minimum chunk size, so that small files don't pay for the threading
+const std::size_t minChunkSize = 1 << 20;
+
+//Relative (negative) OBJ indices can't be resolved before the chunks are merged
+enum RelativeFlags : unsigned char {
+    RelativePosition = 1,
+    RelativeUV = 2,
+    RelativeNormal = 4
+};
+
+/**
+ * Indices into the merged attribute arrays, -1 when absent.
+ * Before merging, relative indices are stored as offsets from the chunk's first element.
+ */
+struct Corner {
+    int p, t, n;
+    bool operator==(const Corner& rhs) const {return p == rhs.p && t == rhs.t && n == rhs.n;}
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<Corner> corners; //3 per triangle
+    std::vector<unsigned char> relative; //RelativeFlags, one per corner
+};
+
+inline const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+inline const char* nextLine(const char* p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline + 1 : end;
+}
+
+inline bool atLineEnd(const char* p, const char* end) {
+    return p >= end || *p == '\n' || *p == '\r' || *p == '#';
+}
+
+const char* parseFloat(const char* p, const char* end, float& result) {
+    p = skipSpaces(p, end);
+    double value;
+    const char* next = parseDecimal(p, end, value);
+    if (next == p)
+        throw std::runtime_error("Invalid number in OBJ file");
+    result = static_cast<float>(value);
+    return next;
+}
+
+const char* parseInt(const char* p, const char* end, int& result) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !isDigit(*p))
+        throw std::runtime_error("Invalid index in OBJ file");
+    int value = 0;
+    for (; p < end && isDigit(*p); ++p)
+        value = value * 10 + (*p - '0');
+    result = negative ? -value : value;
+    return p;
+}
+
+//Converts an OBJ index (1-based, or negative = relative to the end) to a 0-based one
+inline int resolveIndex(int index, std::size_t localCount, unsigned char flag, unsigned char& relative) {
+    if (index > 0)
+        return index - 1;
+    if (index == 0)
+        throw std::runtime_error("Invalid index 0 in OBJ file");
+    relative |= flag;
+    return static_cast<int>(localCount) + index;
+}
+
+const char* parseCorner(const char* p, const char* end, Chunk& chunk, Corner& corner, unsigned char& relative) {
+    int index;
+    relative = 0;
+    corner.t = corner.n = -1;
+    p = parseInt(p, end, index);
+    corner.p = resolveIndex(index, chunk.positions.size(), RelativePosition, relative);
+    if (p < end && *p == '/') {
+        ++p;
+        if (p < end && *p != '/') {
+            p = parseInt(p, end, index);
+            corner.t = resolveIndex(index, chunk.uvs.size(), RelativeUV, relative);
+        }
+        if (p < end && *p == '/') {
+            ++p;
+            p = parseInt(p, end, index);
+            corner.n = resolveIndex(index, chunk.normals.size(), RelativeNormal, relative);
+        }
+    }
+    return p;
+}
+
+void parseChunk(Chunk& chunk) {
+    const char* end = chunk.end;
+    for (const char* line = chunk.begin; line < end; line = nextLine(line, end)) {
+        const char* p = skipSpaces(line, end);
+        if (end - p < 2)
+            continue;
+        if (p[0] == 'v') {
+            if (p[1] == ' ' || p[1] == '\t') {
+                glm::vec3 v;
+                p = parseFloat(p + 1, end, v.x);
+                p = parseFloat(p, end, v.y);
+                parseFloat(p, end, v.z);
+                chunk.positions.push_back(v);
+            } else if (p[1] == 'n') {
+                glm::vec3 n;
+                p = parseFloat(p + 2, end, n.x);
+                p = parseFloat(p, end, n.y);
+                parseFloat(p, end, n.z);
+                chunk.normals.push_back(n);
+            } else if (p[1] == 't') {
+                glm::vec2 uv;
+                p = parseFloat(p + 2, end, uv.x);
+                p = skipSpaces(p, end);
+                //v is optional
+                if (atLineEnd(p, end))
+                    uv.y = 0;
+                else
+                    parseFloat(p, end, uv.y);
+                chunk.uvs.push_back(uv);
+            }
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            //Triangulated as a fan around the first corner
+            Corner first, previous, current;
+            unsigned char firstRelative, previousRelative, currentRelative;
+            int count = 0;
+            p = skipSpaces(p + 1, end);
+            while (!atLineEnd(p, end)) {
+                p = parseCorner(p, end, chunk, current, currentRelative);
+                if (count >= 2) {
+                    chunk.corners.push_back(first);
+                    chunk.corners.push_back(previous);
+                    chunk.corners.push_back(current);
+                    chunk.relative.push_back(firstRelative);
+                    chunk.relative.push_back(previousRelative);
+                    chunk.relative.push_back(currentRelative);
+                } else if (count == 0) {
+                    first = current;
+                    firstRelative = currentRelative;
+                }
+                previous = current;
+                previousRelative = currentRelative;
+                ++count;
+                p = skipSpaces(p, end);
+            }
+        }
+    }
+}
+
+//Splits [data, data + size) in roughly equal parts, cut right after a newline
+std::vector<Chunk> splitChunks(const char* data, std::size_t size, std::size_t count) {
+    std::vector<Chunk> chunks;
+    const char* end = data + size;
+    const char* begin = data;
+    for (std::size_t i = 1; i <= count && begin < end; ++i) {
+        const char* cut = i == count ? end : std::max(begin, data + size * i / count);
+        cut = cut < end ? nextLine(cut, end) : end;
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = cut;
+        chunks.push_back(std::move(chunk));
+        begin = cut;
+    }
+    return chunks;
+}
+
+inline std::size_t hashCorner(const Corner& c) {
+    std::uint64_t h = static_cast<std::uint32_t>(c.p) * 0x9E3779B97F4A7C15ull;
+    h ^= (static_cast<std::uint32_t>(c.t) + 0x7F4A7C15ull + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+    h ^= (static_cast<std::uint32_t>(c.n) + 0x165667B1ull + (h << 6) + (h >> 2)) * 0x165667B19E3779F9ull;
+    return static_cast<std::size_t>(h ^ (h >> 32));
+}
+
+} // namespace
+
+MeshData parseObj(const char *data, std::size_t size, JobSystem &jobs) {
+    std::size_t chunkCount = std::max<std::size_t>(1, std::min<std::size_t>(size / minChunkSize, (jobs.threadCount() + 1) * 4));
+    std::vector<Chunk> chunks = splitChunks(data, size, chunkCount);
+
+    jobs.parallelFor(chunks.size(), [&](std::size_t i) { parseChunk(chunks[i]); });
+
+    //Prefix sums give each chunk its place in the merged arrays
+    struct Offsets { std::size_t positions, normals, uvs, corners; };
+    std::vector<Offsets> offsets(chunks.size() + 1, Offsets{0, 0, 0, 0});
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        offsets[i + 1].positions = offsets[i].positions + chunks[i].positions.size();
+        offsets[i + 1].normals = offsets[i].normals + chunks[i].normals.size();
+        offsets[i + 1].uvs = offsets[i].uvs + chunks[i].uvs.size();
+        offsets[i + 1].corners = offsets[i].corners + chunks[i].corners.size();
+    }
+    const Offsets& total = offsets.back();
+    std::vector<glm::vec3> positions(total.positions), normals(total.normals);
+    std::vector<glm::vec2> uvs(total.uvs);
+    std::vector<Corner> corners(total.corners);
+
+    jobs.parallelFor(chunks.size(), [&](std::size_t i) {
+        Chunk& chunk = chunks[i];
+        const Offsets& base = offsets[i];
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + base.positions);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + base.normals);
+        std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + base.uvs);
+        for (std::size_t c = 0; c < chunk.corners.size(); ++c) {
+            Corner corner = chunk.corners[c];
+            unsigned char relative = chunk.relative[c];
+            if (relative & RelativePosition) corner.p += static_cast<int>(base.positions);
+            if (relative & RelativeUV) corner.t += static_cast<int>(base.uvs);
+            if (relative & RelativeNormal) corner.n += static_cast<int>(base.normals);
+            if (corner.p < 0 || corner.p >= static_cast<int>(total.positions)
+                    || corner.t >= static_cast<int>(total.uvs) || corner.t < -1
+                    || corner.n >= static_cast<int>(total.normals) || corner.n < -1)
+                throw std::runtime_error("Face references a missing vertex in OBJ file");
+            corners[base.corners + c] = corner;
+        }
+        //Release the chunk's memory early, merged copies are all we need
+        chunk = Chunk();
+    });
+
+    //Deduplication through an open addressing table : slot -> vertex index
+    MeshData mesh;
+    mesh.indices.resize(corners.size());
+    std::size_t tableSize = 1;
+    while (tableSize < corners.size() * 2)
+        tableSize <<= 1;
+    const unsigned int emptySlot = ~0u;
+    std::vector<unsigned int> table(tableSize, emptySlot);
+    std::vector<Corner> uniqueCorners;
+    uniqueCorners.reserve(total.positions);
+    bool missingNormals = false;
+
+    for (std::size_t c = 0; c < corners.size(); ++c) {
+        const Corner& corner = corners[c];
+        std::size_t slot = hashCorner(corner) & (tableSize - 1);
+        while (table[slot] != emptySlot && !(uniqueCorners[table[slot]] == corner))
+            slot = (slot + 1) & (tableSize - 1);
+        if (table[slot] == emptySlot) {
+            table[slot] = static_cast<unsigned int>(uniqueCorners.size());
+            uniqueCorners.push_back(corner);
+            missingNormals |= corner.n < 0;
+        }
+        mesh.indices[c] = table[slot];
+    }
+
+    mesh.vertices.resize(uniqueCorners.size());
+    for (std::size_t v = 0; v < uniqueCorners.size(); ++v) {
+        const Corner& corner = uniqueCorners[v];
+        Vertex& vertex = mesh.vertices[v];
+        vertex.position = positions[corner.p];
+        vertex.uv = corner.t >= 0 ? uvs[corner.t] : glm::vec2(0.0f);
+        vertex.normal = corner.n >= 0 ? normals[corner.n] : glm::vec3(0.0f);
+    }
+    if (missingNormals)
+        mesh.computeNormals();
+    mesh.computeBounds();
+    return mesh;
+}
+
+MeshData loadObj(const std::string &path, JobSystem &jobs) {
+    PROFILE_FUNCTION();
+    MappedFile file(path);
+    try {
+        return parseObj(file.data(), file.size(), jobs);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(std::string(e.what()) + " : " + path);
+    }
+}
+
+MeshData loadObj(const std::string &path) {
+    return loadObj(path, JobSystem::global());
+}
@@ -0,0 +1,57 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef OBJLOADER_H
+#define OBJLOADER_H
+
+#include "meshdata.h"
+#include <cstddef>
+#include <string>
+
+class JobSystem;
+
+/** @defgroup ObjLoader
+ * Wavefront OBJ import. Only geometry is read (v, vt, vn, f); polygons are triangulated as fans and
+ * groups are merged into a single mesh. Materials, lines and points are ignored.
+ * @{ */
+
+/**
+ * @brief loadObj : memory-maps an OBJ file and parses it on the job system
+ * @param path : path of the .obj file
+ * @param jobs : pool the chunks are parsed on
+ * @return an indexed mesh where every distinct position/uv/normal triple is one vertex
+ * @throw std::runtime_error if the file can't be read or references invalid indices
+ *
+ * If any face corner lacks a normal, smooth normals are computed for the whole mesh.
+ */
+MeshData loadObj(const std::string& path, JobSystem& jobs);
+MeshData loadObj(const std::string& path);
+
+/**
+ * @brief parseObj : same as loadObj(), from OBJ text already in memory
+ */
+MeshData parseObj(const char* data, std::size_t size, JobSystem& jobs);
+
+/** @} */
+
+#endif // OBJLOADER_H
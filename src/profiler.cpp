@@ -0,0 +1,193 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+struct Profiler::ThreadBuffer
+{
+    //Atomic so that the exporter may read slots being overwritten, it then discards them
+    struct Event {
+        std::atomic<const char*> name;
+        std::atomic<std::uint64_t> start, end;
+    };
+
+    std::unique_ptr<Event[]> events{new Event[profilerEventsPerThread]};
+    std::atomic<std::uint64_t> written{0}; //Events ever recorded, the last ones being in events[written % size]
+    //Guarded by Profiler::mutex
+    std::uint64_t clearedAt = 0;
+    std::string name;
+    unsigned int id = 0;
+};
+
+namespace {
+
+void appendEscaped(std::string& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+}
+
+struct ExportedEvent {
+    const char* name;
+    std::uint64_t start, end;
+};
+
+} // namespace
+
+thread_local Profiler::ThreadBuffer* Profiler::currentBuffer = nullptr;
+
+Profiler::Profiler() : origin(now()) {}
+
+Profiler::~Profiler() = default;
+
+Profiler& Profiler::global() {
+    static Profiler profiler;
+    return profiler;
+}
+
+std::uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::ThreadBuffer& Profiler::threadBuffer() {
+    if (!currentBuffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>());
+        currentBuffer = buffers.back().get();
+        currentBuffer->id = static_cast<unsigned int>(buffers.size());
+        currentBuffer->name = "Thread " + std::to_string(currentBuffer->id);
+    }
+    return *currentBuffer;
+}
+
+void Profiler::record(const char *name, std::uint64_t start, std::uint64_t end) {
+    write(threadBuffer(), name, start, end);
+}
+
+void Profiler::record(unsigned int track, const char *name, std::uint64_t start, std::uint64_t end) {
+    ThreadBuffer* buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (track == 0 || track > buffers.size())
+            throw std::runtime_error("Invalid profiler track : " + std::to_string(track));
+        buffer = buffers[track - 1].get(); //Never freed, nor moved
+    }
+    write(*buffer, name, start, end);
+}
+
+void Profiler::write(ThreadBuffer &buffer, const char *name, std::uint64_t start, std::uint64_t end) {
+    const std::uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    ThreadBuffer::Event& event = buffer.events[index % profilerEventsPerThread];
+    //Release : an exporter seeing these values also sees that the slot was reused
+    event.name.store(name, std::memory_order_release);
+    event.start.store(start, std::memory_order_release);
+    event.end.store(end, std::memory_order_release);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string &name) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer.name = name;
+}
+
+unsigned int Profiler::addTrack(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    buffers.push_back(std::make_unique<ThreadBuffer>());
+    buffers.back()->id = static_cast<unsigned int>(buffers.size());
+    buffers.back()->name = name;
+    return buffers.back()->id;
+}
+
+void Profiler::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& buffer : buffers)
+        buffer->clearedAt = buffer->written.load(std::memory_order_acquire);
+}
+
+std::string Profiler::traceJson() const {
+    std::string json = "{\"traceEvents\":[\n";
+    bool first = true;
+    char line[128];
+    std::vector<ExportedEvent> events;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& buffer : buffers) {
+        if (!first)
+            json += ",\n";
+        first = false;
+        std::snprintf(line, sizeof(line), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", buffer->id);
+        json += line;
+        appendEscaped(json, buffer->name);
+        json += "\"}}";
+
+        const std::uint64_t end = buffer->written.load(std::memory_order_acquire);
+        std::uint64_t begin = std::max(buffer->clearedAt, end > profilerEventsPerThread ? end - profilerEventsPerThread : 0);
+        events.clear();
+        for (std::uint64_t i = begin; i < end; ++i) {
+            const ThreadBuffer::Event& event = buffer->events[i % profilerEventsPerThread];
+            events.push_back({event.name.load(std::memory_order_acquire), event.start.load(std::memory_order_acquire),
+                              event.end.load(std::memory_order_acquire)});
+        }
+        //Slots reused by the thread while they were copied are torn, drop them
+        const std::uint64_t after = buffer->written.load(std::memory_order_acquire);
+        const std::uint64_t firstValid = after + 1 > profilerEventsPerThread ? after + 1 - profilerEventsPerThread : 0;
+        std::size_t skipped = firstValid > begin ? static_cast<std::size_t>(std::min<std::uint64_t>(firstValid - begin, events.size())) : 0;
+
+        for (std::size_t i = skipped; i < events.size(); ++i) {
+            const ExportedEvent& event = events[i];
+            //Microseconds, as the format wants
+            std::snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                          (event.start - std::min(event.start, origin)) / 1000.0, (event.end - event.start) / 1000.0, buffer->id);
+            json += ",\n{\"name\":\"";
+            appendEscaped(json, event.name);
+            json += line;
+        }
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
+
+void Profiler::writeTrace(const std::string &path) const {
+    std::string json = traceJson();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not open file : " + path);
+    file.write(json.data(), json.size());
+    if (!file)
+        throw std::runtime_error("Could not write file : " + path);
+}
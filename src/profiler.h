@@ -0,0 +1,165 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Collects timed zones from every thread and exports them in the Chrome trace event format,
+ * to be opened in chrome://tracing or Perfetto.
+ *
+ * Each thread records to its own ring buffer, which keeps its latest profilerEventsPerThread zones : recording
+ * takes no lock and never allocates, except the first time a thread records. Exporting reads the buffers while
+ * the threads keep writing, and leaves out the events overwritten in the meantime.
+ *
+ * Zones are recorded with the macros below, which compile to nothing when NO_PROFILING is defined
+ * (CMake option PROFILING).
+ *
+ * \code
+ * void Application::draw() {
+ *     PROFILE_FUNCTION();
+ *     {
+ *         PROFILE_SCOPE("Culling");
+ *         // [...]
+ *     }
+ * }
+ * //Later
+ * Profiler::global().writeTrace("trace.json");
+ * \endcode
+ */
+class Profiler
+{
+public:
+    /**
+     * @brief Zones are recorded only while enabled. Enabled by default.
+     */
+    void setEnabled(bool enabled) {on.store(enabled, std::memory_order_relaxed);}
+    bool enabled() const {return on.load(std::memory_order_relaxed);}
+
+    /**
+     * @brief Records a zone on the calling thread
+     * @param name : must outlive the profiler, typically a string literal
+     * @param start, end : from now()
+     */
+    void record(const char* name, std::uint64_t start, std::uint64_t end);
+
+    /**
+     * @brief Names the calling thread in the traces
+     */
+    void setThreadName(const std::string& name);
+
+    /**
+     * @brief Adds a timeline for zones that don't run on a thread of the process, e.g. GPU passes
+     * @return the track to record these zones on
+     */
+    unsigned int addTrack(const std::string& name);
+
+    /**
+     * @brief Records a zone on a track from addTrack(). Takes a lock, meant for a few zones per frame.
+     * @pre a track is written by one thread at a time
+     */
+    void record(unsigned int track, const char* name, std::uint64_t start, std::uint64_t end);
+
+    /**
+     * @brief Forgets the zones recorded so far
+     */
+    void clear();
+
+    /**
+     * @brief The zones recorded since the last clear(), as Chrome trace event JSON
+     */
+    std::string traceJson() const;
+
+    /**
+     * @brief Writes traceJson() to a file
+     * @throw std::runtime_error if the file can't be written
+     */
+    void writeTrace(const std::string& path) const;
+
+    /**
+     * @brief Timestamp in nanoseconds, from a steady clock
+     */
+    static std::uint64_t now();
+
+    static Profiler& global();
+
+private:
+    struct ThreadBuffer;
+
+    Profiler();
+    ~Profiler();
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+    ThreadBuffer& threadBuffer();
+    static void write(ThreadBuffer& buffer, const char* name, std::uint64_t start, std::uint64_t end);
+    static thread_local ThreadBuffer* currentBuffer; //Of the calling thread, registered on first use
+
+    std::atomic<bool> on{true};
+    mutable std::mutex mutex; //Guards the list of buffers, not their content
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    std::uint64_t origin; //now() at construction, traces start from there
+};
+
+const std::size_t profilerEventsPerThread = 1 << 16;
+
+/**
+ * @brief Records the zone from its construction to its destruction. Use PROFILE_SCOPE().
+ */
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name)
+        : name(Profiler::global().enabled() ? name : nullptr), start(this->name ? Profiler::now() : 0) {}
+    ~ProfileZone() {
+        if (name)
+            Profiler::global().record(name, start, Profiler::now());
+    }
+
+private:
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+    const char* name;
+    std::uint64_t start;
+};
+
+#ifndef NO_PROFILING
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+/// Profiles the rest of the enclosing scope. name must be a string literal or outlive the profiler.
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+/// Profiles the rest of the enclosing function, under its name
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,185 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "programcache.h"
+#include "glextensions.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+
+//File layout : header followed by the binary
+struct ProgramFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t binaryFormat;
+    std::uint32_t binarySize;
+    std::uint64_t binaryHash;
+};
+
+const char programFileMagic[4] = {'E', '3', 'D', 'P'};
+const std::uint32_t programFileVersion = 1;
+
+std::uint64_t hashString(const std::string& s, std::uint64_t seed) {
+    //The length keeps ("ab", "c") and ("a", "bc") apart
+    std::uint64_t size = s.size();
+    return hashBytes(s.data(), s.size(), hashBytes(&size, sizeof(size), seed));
+}
+
+void makeDirectory(const std::string& path) {
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+} // namespace
+
+std::uint64_t hashBytes(const void *data, std::size_t size, std::uint64_t seed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        seed ^= bytes[i];
+        seed *= 0x100000001b3ull;
+    }
+    return seed;
+}
+
+ProgramCache& ProgramCache::global() {
+    static ProgramCache cache;
+    return cache;
+}
+
+void ProgramCache::setDirectory(const std::string &directory) {
+    if (directory.empty() || !GLEXT_program_binary) {
+        this->directory.clear();
+        return;
+    }
+    makeDirectory(directory);
+    this->directory = directory;
+    driver.clear();
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        driver += value ? value : "";
+        driver += '\n';
+    }
+}
+
+std::uint64_t ProgramCache::makeKey(const std::string &vertex, const std::string &fragment, const std::string &defines) const {
+    std::uint64_t key = hashString(driver, hashBytes(&programFileVersion, sizeof(programFileVersion)));
+    key = hashString(defines, key);
+    key = hashString(vertex, key);
+    return hashString(fragment, key);
+}
+
+std::string ProgramCache::pathOf(std::uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + name;
+}
+
+unsigned int ProgramCache::load(std::uint64_t key) {
+    if (!enabled())
+        return 0;
+    const std::string path = pathOf(key);
+    std::ifstream file(path, std::ios::binary);
+    ProgramFileHeader header;
+    std::vector<char> binary;
+    bool valid = false;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header))
+            && std::equal(programFileMagic, programFileMagic + 4, header.magic)
+            && header.version == programFileVersion && header.key == key) {
+        binary.resize(header.binarySize);
+        valid = file.read(binary.data(), binary.size())
+                && hashBytes(binary.data(), binary.size()) == header.binaryHash;
+    }
+    file.close();
+    if (!valid) {
+        if (!binary.empty()) //Truncated or corrupted
+            std::remove(path.c_str());
+        ++misses;
+        return 0;
+    }
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        //Typically a driver change that didn't show in the version string
+        glDeleteProgram(program);
+        std::remove(path.c_str());
+        ++misses;
+        return 0;
+    }
+    ++hits;
+    return program;
+}
+
+void ProgramCache::prepare(unsigned int program) const {
+    if (enabled())
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void ProgramCache::store(std::uint64_t key, unsigned int program) {
+    if (!enabled())
+        return;
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    binary.resize(length);
+
+    ProgramFileHeader header;
+    std::copy(programFileMagic, programFileMagic + 4, header.magic);
+    header.version = programFileVersion;
+    header.key = key;
+    header.binaryFormat = format;
+    header.binarySize = static_cast<std::uint32_t>(binary.size());
+    header.binaryHash = hashBytes(binary.data(), binary.size());
+
+    //Written aside then renamed, so that a crash never leaves a partial entry behind
+    const std::string path = pathOf(key);
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), binary.size());
+        if (!file)
+            return;
+    }
+    std::remove(path.c_str());
+    std::rename(temporary.c_str(), path.c_str());
+}
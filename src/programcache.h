@@ -0,0 +1,103 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief On-disk cache of linked program binaries (glGetProgramBinary / glProgramBinary).
+ *
+ * Entries are keyed by a hash of the shader sources, the injected defines and the driver identity
+ * (vendor, renderer, version), so a driver update invalidates them. A binary rejected by the driver
+ * is deleted and the caller compiles from source again. Disabled until setDirectory() is called,
+ * or when the context doesn't support program binaries.
+ *
+ * \code
+ * //Typical usage, once the context exists
+ * ProgramCache::global().setDirectory("shadercache");
+ * auto shader = makeShaderFromFile("a.vert", "a.frag"); //Shader looks the cache up by itself
+ * \endcode
+ */
+class ProgramCache
+{
+public:
+    ProgramCache() = default;
+
+    /**
+     * @brief Enables the cache, storing binaries in directory (created if needed). An empty path disables it.
+     * @pre a GL context is current and loadGLExtensions() was called
+     */
+    void setDirectory(const std::string& directory);
+    bool enabled() const {return !directory.empty();}
+
+    /**
+     * @brief makeKey : hashes the sources of a program along with the driver identity
+     * @param defines : defines injected in the sources, if not already part of them
+     */
+    std::uint64_t makeKey(const std::string& vertex, const std::string& fragment, const std::string& defines = "") const;
+
+    /**
+     * @brief Creates a program from the cached binary
+     * @return the linked program, or 0 on a miss or if the driver rejected the binary
+     */
+    unsigned int load(std::uint64_t key);
+
+    /**
+     * @brief To call before linking a program that will be stored
+     */
+    void prepare(unsigned int program) const;
+
+    /**
+     * @brief Saves the binary of a linked program. Failures are silent, the cache is only an optimization.
+     */
+    void store(std::uint64_t key, unsigned int program);
+
+    std::size_t hitCount() const {return hits;}
+    std::size_t missCount() const {return misses;}
+
+    /**
+     * @brief Cache used by Shader
+     */
+    static ProgramCache& global();
+
+private:
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+    std::string pathOf(std::uint64_t key) const;
+
+    std::string directory;
+    std::string driver; //Vendor, renderer and version strings
+    std::size_t hits = 0, misses = 0;
+};
+
+/**
+ * @brief hashBytes : 64-bit FNV-1a hash
+ * @param seed : result of a previous call, to hash several blocks as one
+ */
+std::uint64_t hashBytes(const void* data, std::size_t size, std::uint64_t seed = 0xcbf29ce484222325ull);
+
+#endif // PROGRAMCACHE_H
@@ -0,0 +1,65 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <cstdint>
+#include <glad/glad.h>
+
+/**
+ * @brief Counters of the GL work issued during a frame, for the debug overlay.
+ *
+ * Incremented by the draw and bind calls of the wrappers (Mesh, VertexArray, Texture, ...), on the GL thread only.
+ * Indirect draws count as one draw call each, their triangles are only known to the GPU.
+ */
+struct RenderStats
+{
+    unsigned int drawCalls = 0;
+    std::uint64_t triangles = 0;
+    unsigned int dispatches = 0; ///< Compute
+    unsigned int programBinds = 0;
+    unsigned int vertexArrayBinds = 0;
+    unsigned int textureBinds = 0;
+
+    unsigned int stateChanges() const {return programBinds + vertexArrayBinds + textureBinds;}
+
+    /**
+     * @brief Counts a direct draw call
+     * @param count : vertices or indices drawn
+     */
+    void countDraw(GLenum mode, std::uint64_t count, std::uint64_t instances = 1) {
+        ++drawCalls;
+        if (mode == GL_TRIANGLES)
+            triangles += count / 3 * instances;
+        else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count >= 3)
+            triangles += (count - 2) * instances;
+    }
+
+    /**
+     * @brief Counters of the frame being drawn, reset by the application at the start of each frame
+     */
+    static RenderStats& frame();
+};
+
+#endif // RENDERSTATS_H
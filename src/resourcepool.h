@@ -0,0 +1,277 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef RESOURCEPOOL_H
+#define RESOURCEPOOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+const unsigned int handleIndexBits = 20; ///< Up to 1M objects per pool, the other 12 bits are the generation
+const std::uint32_t handleIndexMask = (1u << handleIndexBits) - 1;
+const std::uint32_t handleMaxGeneration = (1u << (32 - handleIndexBits)) - 1;
+
+const unsigned int poolChunkBits = 8; ///< 256 objects per chunk
+const unsigned int poolRetireFrames = 3; ///< collect() calls a released object survives, the GPU may still use it
+
+/**
+ * @brief 32 bits reference to an object of a ResourcePool : index of its slot and generation of the slot.
+ * A slot changes generation when its object is released, so handles to released objects are recognized as stale
+ * instead of silently pointing to whatever reuses the slot.
+ * @param Tag : type of the objects, only there to tell handles apart
+ */
+template <class Tag>
+struct Handle
+{
+    std::uint32_t value = 0; ///< 0 is never given out
+
+    /**
+     * @brief Whether the handle was set. The object may have been released since, see ResourcePool::get().
+     */
+    bool valid() const {return value != 0;}
+    std::uint32_t index() const {return value & handleIndexMask;}
+    std::uint32_t generation() const {return value >> handleIndexBits;}
+
+    static Handle make(std::uint32_t index, std::uint32_t generation) {
+        Handle handle;
+        handle.value = generation << handleIndexBits | index;
+        return handle;
+    }
+
+    bool operator==(const Handle& other) const {return value == other.value;}
+    bool operator!=(const Handle& other) const {return value != other.value;}
+};
+
+/**
+ * @brief Storage of objects referenced by generational handles.
+ *
+ * Objects are stored contiguously in chunks which never move, so pointers to them stay valid while the pool
+ * grows. Released objects are destroyed poolRetireFrames calls to collect() later, once the frames that may still
+ * use them are done ; their handles become stale right away.
+ *
+ * get() doesn't lock and may be called from any thread : an object got during a frame stays alive until the end
+ * of that frame even if it's released meanwhile. create(), release() and collect() lock the pool.
+ *
+ * \code
+ * ResourcePool<Texture> textures;
+ * Handle<Texture> handle = textures.create(...);
+ * if (Texture* texture = textures.get(handle))
+ *     texture->bind(0);
+ * textures.release(handle);
+ * //Once per frame
+ * textures.collect();
+ * \endcode
+ * @param Tag : type of the handles, T by default
+ */
+template <class T, class Tag = T>
+class ResourcePool
+{
+public:
+    typedef Handle<Tag> HandleType;
+
+    ResourcePool() {
+        for (auto& chunk : chunks)
+            chunk.store(nullptr, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Destroys every object, released or not
+     */
+    ~ResourcePool() {
+        for (std::uint32_t i = 0; i < slotCount; ++i) {
+            Chunk& chunk = *chunks[i >> poolChunkBits].load(std::memory_order_relaxed);
+            const std::uint32_t slot = i & chunkMask;
+            if (chunk.states[slot] != Free)
+                chunk.object(slot)->~T();
+        }
+        for (auto& chunk : chunks)
+            delete chunk.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Constructs an object from args
+     * @throw std::runtime_error if the pool is full, or what the constructor of T throws
+     */
+    template <class... Args>
+    HandleType create(Args&&... args) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if (slotCount > handleIndexMask)
+                throw std::runtime_error("Resource pool is full");
+            index = slotCount;
+            if ((index & chunkMask) == 0)
+                chunks[index >> poolChunkBits].store(new Chunk(), std::memory_order_release);
+            ++slotCount;
+        }
+
+        Chunk& chunk = *chunks[index >> poolChunkBits].load(std::memory_order_relaxed);
+        const std::uint32_t slot = index & chunkMask;
+        try {
+            new (&chunk.objects[slot]) T(std::forward<Args>(args)...);
+        } catch (...) {
+            freeSlots.push_back(index);
+            throw;
+        }
+        chunk.states[slot] = Alive;
+        ++aliveCount;
+        return HandleType::make(index, chunk.generations[slot].load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Returns the object, nullptr if the handle is unset or stale
+     */
+    T* get(HandleType handle) {
+        if (!handle.valid())
+            return nullptr;
+        Chunk* chunk = chunks[handle.index() >> poolChunkBits].load(std::memory_order_acquire);
+        const std::uint32_t slot = handle.index() & chunkMask;
+        if (!chunk || chunk->generations[slot].load(std::memory_order_acquire) != handle.generation())
+            return nullptr;
+        return chunk->object(slot);
+    }
+    const T* get(HandleType handle) const {return const_cast<ResourcePool*>(this)->get(handle);}
+
+    bool contains(HandleType handle) const {return get(handle) != nullptr;}
+
+    /**
+     * @brief Makes the handle stale and schedules the destruction of its object. Stale handles are ignored.
+     */
+    void release(HandleType handle) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!contains(handle))
+            return;
+        Chunk& chunk = *chunks[handle.index() >> poolChunkBits].load(std::memory_order_relaxed);
+        const std::uint32_t slot = handle.index() & chunkMask;
+        const std::uint32_t generation = handle.generation() == handleMaxGeneration ? 1 : handle.generation() + 1;
+        chunk.generations[slot].store(generation, std::memory_order_release);
+        chunk.states[slot] = Retired;
+        retired.push_back({handle.index(), collects});
+        --aliveCount;
+    }
+
+    /**
+     * @brief Destroys the objects released long enough ago and recycles their slots. Call once per frame.
+     * @pre the destructor of T doesn't use the pool
+     */
+    void collect() {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++collects;
+        while (!retired.empty() && collects - retired.front().collect >= poolRetireFrames) {
+            const std::uint32_t index = retired.front().index;
+            retired.pop_front();
+            Chunk& chunk = *chunks[index >> poolChunkBits].load(std::memory_order_relaxed);
+            const std::uint32_t slot = index & chunkMask;
+            chunk.object(slot)->~T();
+            chunk.states[slot] = Free;
+            freeSlots.push_back(index);
+        }
+    }
+
+    /**
+     * @brief Calls f(handle, object) for every object not released
+     * @pre f doesn't create nor release objects of this pool
+     */
+    template <class F>
+    void forEach(F f) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::uint32_t i = 0; i < slotCount; ++i) {
+            const Chunk& chunk = *chunks[i >> poolChunkBits].load(std::memory_order_relaxed);
+            const std::uint32_t slot = i & chunkMask;
+            if (chunk.states[slot] == Alive)
+                f(HandleType::make(i, chunk.generations[slot].load(std::memory_order_relaxed)),
+                  *const_cast<Chunk&>(chunk).object(slot));
+        }
+    }
+
+    /**
+     * @brief Number of objects not released
+     */
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return aliveCount;
+    }
+
+    /**
+     * @brief Number of objects released but not destroyed yet
+     */
+    std::size_t retiredCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return retired.size();
+    }
+
+private:
+    ResourcePool(const ResourcePool&) = delete;
+    ResourcePool& operator=(const ResourcePool&) = delete;
+
+    static const std::uint32_t chunkSize = 1u << poolChunkBits;
+    static const std::uint32_t chunkMask = chunkSize - 1;
+    static const std::uint32_t maxChunks = (handleIndexMask + 1) / chunkSize;
+
+    enum SlotState : unsigned char {Free, Alive, Retired};
+
+    //Objects first, so that iterating over them touches as few cache lines as possible
+    struct Chunk
+    {
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type objects[chunkSize];
+        std::atomic<std::uint32_t> generations[chunkSize];
+        SlotState states[chunkSize];
+
+        Chunk() {
+            for (std::uint32_t i = 0; i < chunkSize; ++i) {
+                generations[i].store(1, std::memory_order_relaxed);
+                states[i] = Free;
+            }
+        }
+        T* object(std::uint32_t slot) {return reinterpret_cast<T*>(&objects[slot]);}
+    };
+
+    struct RetiredSlot
+    {
+        std::uint32_t index;
+        std::uint64_t collect; //Value of collects when released
+    };
+
+    std::atomic<Chunk*> chunks[maxChunks];
+    std::uint32_t slotCount = 0; //Slots ever used
+
+    mutable std::mutex mutex;
+    std::vector<std::uint32_t> freeSlots;
+    std::deque<RetiredSlot> retired;
+    std::uint64_t collects = 0;
+    std::size_t aliveCount = 0;
+};
+
+#endif // RESOURCEPOOL_H
@@ -22,10 +22,46 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "shader.h"
+#include "glextensions.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+#include "profiler.h"
+#include "programcache.h"
+#include "shaderpreprocessor.h"
+#include "shaderwatcher.h"
 #include <glad/glad.h>
 #include <stdexcept>
 #include <fstream>
 #include <sstream>
+#include <utility>
+
+namespace {
+
+const char* shaderTypeName(GLenum type) {
+    switch (type) {
+    case GL_VERTEX_SHADER: return "vertex";
+    case GL_FRAGMENT_SHADER: return "fragment";
+    case GL_GEOMETRY_SHADER: return "geometry";
+    case GL_COMPUTE_SHADER: return "compute";
+    default: return "";
+    }
+}
+
+void checkCompileStatus(unsigned int shader) {
+    int success;
+    char infolog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        int type;
+        glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+        glGetShaderInfoLog(shader, 512, nullptr, infolog);
+        std::string errorLog = std::string("Error compiling ") + shaderTypeName(type) + " shader : " + infolog;
+        throw std::runtime_error(errorLog);
+    }
+}
+
+} // namespace
 
 std::string readFile(const std::string &path) {
     std::ifstream file;
@@ -40,70 +76,178 @@ std::string readFile(const std::string &path) {
 }
 
 std::unique_ptr<Shader> makeShaderFromFile(const std::string &vertexPath, const std::string &fragmentPath) {
-    std::string vertexCode = readFile(vertexPath);
-    std::string fragmentCode = readFile(fragmentPath);
-    return makeShaderFromSource(vertexCode, fragmentCode);
+    return makeShaderFromFileAsync(vertexPath, fragmentPath).get();
 }
 
 std::unique_ptr<Shader> makeShaderFromSource(const std::string &vertexSource, const std::string &fragmentSource) {
     return std::make_unique<Shader>(vertexSource, fragmentSource);
 }
 
-Shader::Shader(const std::string &vertex, const std::string &frag)
+ShaderFuture makeShaderFromFileAsync(const std::string &vertexPath, const std::string &fragmentPath) {
+    PROFILE_FUNCTION();
+    PreprocessedShader vertex = preprocessShader(vertexPath);
+    PreprocessedShader fragment = preprocessShader(fragmentPath);
+    ShaderFuture result = makeShaderFromSourceAsync(vertex.source, fragment.source);
+    result.vertexPath = vertexPath;
+    result.fragmentPath = fragmentPath;
+    result.files = vertex.files;
+    result.files.insert(result.files.end(), fragment.files.begin(), fragment.files.end());
+    return result;
+}
+
+ShaderFuture makeShaderFromSourceAsync(const std::string &vertexSource, const std::string &fragmentSource) {
+    PROFILE_FUNCTION();
+    ShaderFuture result;
+    ProgramCache& cache = ProgramCache::global();
+    if (cache.enabled()) {
+        result.cacheKey = cache.makeKey(vertexSource, fragmentSource);
+        result.program = cache.load(result.cacheKey);
+        if (result.program)
+            return result;
+    }
+
+    //No status query anywhere, so that nothing forces the driver to finish
+    result.vertexShader = beginCompileShader(GL_VERTEX_SHADER, vertexSource);
+    result.fragmentShader = beginCompileShader(GL_FRAGMENT_SHADER, fragmentSource);
+
+    result.program = glCreateProgram();
+    glAttachShader(result.program, result.vertexShader);
+    glAttachShader(result.program, result.fragmentShader);
+    cache.prepare(result.program);
+    glLinkProgram(result.program);
+    return result;
+}
+
+ShaderFuture::ShaderFuture(ShaderFuture &&rhs)
+    : program(rhs.program), vertexShader(rhs.vertexShader), fragmentShader(rhs.fragmentShader), cacheKey(rhs.cacheKey),
+      vertexPath(std::move(rhs.vertexPath)), fragmentPath(std::move(rhs.fragmentPath)), files(std::move(rhs.files))
 {
-    unsigned int vertexShader = compileShader(GL_VERTEX_SHADER, vertex);
-    unsigned int fragmentShader = compileShader(GL_FRAGMENT_SHADER, frag);
+    rhs.program = rhs.vertexShader = rhs.fragmentShader = 0;
+}
+
+ShaderFuture& ShaderFuture::operator=(ShaderFuture &&rhs) {
+    if (this != &rhs) {
+        release();
+        std::swap(program, rhs.program);
+        std::swap(vertexShader, rhs.vertexShader);
+        std::swap(fragmentShader, rhs.fragmentShader);
+        cacheKey = rhs.cacheKey;
+        vertexPath = std::move(rhs.vertexPath);
+        fragmentPath = std::move(rhs.fragmentPath);
+        files = std::move(rhs.files);
+    }
+    return *this;
+}
+
+ShaderFuture::~ShaderFuture() {
+    release();
+}
+
+void ShaderFuture::release() {
+    //glDeleteShader silently ignores 0, and deleting the program detaches them
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    if (program)
+        glDeleteProgram(program);
+    program = vertexShader = fragmentShader = 0;
+}
 
-    program = glCreateProgram();
+bool ShaderFuture::ready() const {
+    if (!GLEXT_parallel_shader_compile || !program)
+        return true;
+    int done = GL_FALSE;
+    glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
 
-    glAttachShader(program, vertexShader);
-    glAttachShader(program, fragmentShader);
+std::unique_ptr<Shader> ShaderFuture::get() {
+    std::unique_ptr<Shader> result(new Shader(finish()));
+    if (!vertexPath.empty())
+        ShaderWatcher::global().track(*result, vertexPath, fragmentPath, files);
+    return result;
+}
 
-    glLinkProgram(program);
+unsigned int ShaderFuture::finish() {
+    PROFILE_SCOPE("ShaderFuture::finish");
+    if (!program)
+        throw std::runtime_error("ShaderFuture::get called on an invalid future");
+    if (!vertexShader) { //Loaded from the program cache, already linked
+        unsigned int result = program;
+        program = 0;
+        return result;
+    }
 
+    int success;
+    char infolog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
     {
-        int success;
-        char infolog[512];
-        glGetProgramiv(program, GL_LINK_STATUS, &success);
-        if (!success)
-        {
-            glGetProgramInfoLog(program, 512, nullptr, infolog);
-            std::string errorLog = std::string("Error linking shader : ") + infolog;
-            throw std::runtime_error(errorLog);
+        //A compile error is the more useful message
+        try {
+            checkCompileStatus(vertexShader);
+            checkCompileStatus(fragmentShader);
+        } catch (...) {
+            release();
+            throw;
         }
+        glGetProgramInfoLog(program, 512, nullptr, infolog);
+        std::string errorLog = std::string("Error linking shader : ") + infolog;
+        release();
+        throw std::runtime_error(errorLog);
     }
 
-    glUseProgram(program);
+    ProgramCache::global().store(cacheKey, program);
 
     /* Cleanup AFTER linking */
     glDetachShader(program, vertexShader);
-    glDeleteShader(vertexShader);
     glDetachShader(program, fragmentShader);
-    glDeleteShader(fragmentShader);
+    unsigned int result = program;
+    program = 0;
+    release();
+    return result;
+}
+
+Shader::Shader(const std::string &vertex, const std::string &frag)
+    : Shader(makeShaderFromSourceAsync(vertex, frag).finish())
+{
+}
+
+Shader::Shader(unsigned int program) : program(program), reflection(reflectProgram(program))
+{
+    GpuMemory::global().allocate(GpuMemoryCategory::Program, program, GpuMemory::programSize(program), "Shader");
+    glUseProgram(program);
 }
 
 Shader::~Shader() {
-    glDeleteProgram(program);
+    ShaderWatcher::global().untrack(*this);
+    GpuDeletionQueue::global().release(GpuResourceType::Program, program);
 }
 
+void Shader::reload(const std::string &vertex, const std::string &frag) {
+    unsigned int replacement = makeShaderFromSourceAsync(vertex, frag).finish();
+    GpuDeletionQueue::global().release(GpuResourceType::Program, program); //Frames in flight may still use it
+    GpuMemory::global().allocate(GpuMemoryCategory::Program, replacement, GpuMemory::programSize(replacement), "Shader");
+    program = replacement;
+    reflection = reflectProgram(program);
+}
 
-unsigned int compileShader(GLenum type, const std::string &source) {
+
+unsigned int beginCompileShader(GLenum type, const std::string &source) {
     unsigned int result = glCreateShader(type);
     const GLchar *source_data = source.data();
-    glShaderSource(result, 1, &source_data, nullptr);
+    GLint length = static_cast<GLint>(source.size());
+    glShaderSource(result, 1, &source_data, &length);
     glCompileShader(result);
+    return result;
+}
 
-    {
-        int success;
-        char infolog[512];
-        glGetShaderiv(result, GL_COMPILE_STATUS, &success);
-        if (!success)
-        {
-            glGetShaderInfoLog(result, 512, nullptr, infolog);
-            std::string errorLog = std::string("Error compiling fragment shader : ") + infolog;
-            throw std::runtime_error(errorLog);
-        }
+unsigned int compileShader(GLenum type, const std::string &source) {
+    unsigned int result = beginCompileShader(type, source);
+    try {
+        checkCompileStatus(result);
+    } catch (...) {
+        glDeleteShader(result);
+        throw;
     }
-
     return result;
 }
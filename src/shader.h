@@ -26,8 +26,13 @@ SOFTWARE.
 
 #include <string>
 #include <memory>
+#include <vector>
+#include "shaderreflection.h"
+#include <cstdint>
 #include <glad/glad.h>
 
+class ShaderFuture;
+
 /**
  * @brief Class holding an OpenGL Shader (one vertex + one fragment)
  * @invariant : getProgramId() is a valid OpenGL Program
@@ -52,6 +57,8 @@ public:
      * @brief Builds a "classic" shader (one vertex + one fragment) from source strings
      * @param vertex : Source code of the Vertex Shader
      * @param frag : Source code of the Fragment Shader
+     *
+     * The linked program is looked up in / saved to ProgramCache::global() when it is enabled.
      */
     Shader(const std::string& vertex, const std::string& frag);
     ~Shader();
@@ -61,12 +68,85 @@ public:
      * @return ProgramID
      */
     unsigned int getProgramId() const {return program;}
+
+    /**
+     * @brief getReflection : interface of the program, queried once at link time
+     */
+    const ShaderReflection& getReflection() const {return reflection;}
+
+    /**
+     * @brief Replaces the program by a new one built from these sources. Its id changes.
+     * @throw std::runtime_error on compile or link errors, in which case the current program is kept
+     */
+    void reload(const std::string& vertex, const std::string& frag);
 private:
+    friend class ShaderFuture;
+    explicit Shader(unsigned int program); //Adopts a linked program
     Shader(const Shader&) = delete;
     Shader& operator= (const Shader&) = delete;
     Shader(Shader&&) = delete;
     Shader& operator = (Shader&&) = delete; //Use unique ptrs !
     unsigned int program;
+    ShaderReflection reflection;
+};
+
+/**
+ * @brief Shader whose compilation and link were issued but not waited for.
+ *
+ * The driver may compile in the background (natively, or through GL_KHR_parallel_shader_compile) as long as
+ * nobody asks for the result. Issue all the shaders up front, do other work, then call get().
+ *
+ * \code
+ * //Typical usage
+ * ShaderFuture pending = makeShaderFromFileAsync("myshader.vert", "myshader.frag");
+ * // [...] load assets
+ * std::unique_ptr<Shader> shader = pending.get();
+ * \endcode
+ */
+class ShaderFuture
+{
+public:
+    ShaderFuture(ShaderFuture&& rhs);
+    ShaderFuture& operator=(ShaderFuture&& rhs);
+    /**
+     * @brief Deletes the GL objects if get() wasn't called
+     */
+    ~ShaderFuture();
+
+    /**
+     * @brief valid : false once get() was called
+     */
+    bool valid() const {return program != 0;}
+
+    /**
+     * @brief ready : tells whether get() would return without waiting.
+     * Always true without GL_KHR_parallel_shader_compile, since there is no way to know.
+     */
+    bool ready() const;
+
+    /**
+     * @brief Waits for the program and returns it
+     * @pre valid()
+     * @throw std::runtime_error on compile or link errors
+     */
+    std::unique_ptr<Shader> get();
+
+private:
+    friend class Shader;
+    friend ShaderFuture makeShaderFromSourceAsync(const std::string& vertexCode, const std::string& fragmentCode);
+    friend ShaderFuture makeShaderFromFileAsync(const std::string& vertexPath, const std::string& fragmentPath);
+    ShaderFuture() = default;
+    ShaderFuture(const ShaderFuture&) = delete;
+    ShaderFuture& operator=(const ShaderFuture&) = delete;
+    unsigned int finish(); //Checks the status, releases ownership of the program
+    void release();
+
+    unsigned int program = 0;
+    unsigned int vertexShader = 0, fragmentShader = 0; //0 when loaded from the program cache
+    std::uint64_t cacheKey = 0;
+    //Set by makeShaderFromFileAsync, for ShaderWatcher
+    std::string vertexPath, fragmentPath;
+    std::vector<std::string> files;
 };
 
 /** @defgroup ShaderUtility
@@ -81,6 +161,12 @@ private:
 
 unsigned int compileShader(GLenum type, const std::string& source);
 
+/**
+ * @brief beginCompileShader : like compileShader, but doesn't wait for the result
+ * @return the id of the shader, whose GL_COMPILE_STATUS is still to be checked
+ */
+unsigned int beginCompileShader(GLenum type, const std::string& source);
+
 /**
  * @brief readFile : read a file and returns all its content as a std::string
  * @param path : path of the file
@@ -91,7 +177,8 @@ unsigned int compileShader(GLenum type, const std::string& source);
 std::string readFile(const std::string& path);
 
 /**
- * @brief makeShaderFromFile : creates a Shader from two files (by reading them)
+ * @brief makeShaderFromFile : creates a Shader from two files (by reading them). #include directives are expanded.
+ * The shader is reloaded when the files change, see ShaderWatcher.
  * @param vertexPath : path of the file containing Vertex Shader source code
  * @param fragmentPath : path of the file containing Fragment Shader source code.
  * @return a unique_ptr containing a Shader
@@ -110,6 +197,18 @@ std::unique_ptr<Shader> makeShaderFromFile(const std::string& vertexPath, const
 
 std::unique_ptr<Shader> makeShaderFromSource(const std::string& vertexCode, const std::string& fragmentCode);
 
+/**
+ * @brief makeShaderFromFileAsync : reads the two files and issues the compilation without waiting for it.
+ * The shader is reloaded when the files change, see ShaderWatcher.
+ * @throw std::runtime_error if a file can't be read. Compile errors are reported by ShaderFuture::get().
+ */
+ShaderFuture makeShaderFromFileAsync(const std::string& vertexPath, const std::string& fragmentPath);
+
+/**
+ * @brief makeShaderFromSourceAsync : issues the compilation without waiting for it
+ */
+ShaderFuture makeShaderFromSourceAsync(const std::string& vertexCode, const std::string& fragmentCode);
+
 /** @} */
 
 #endif // SHADER_H
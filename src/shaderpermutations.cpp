@@ -0,0 +1,76 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "shaderpermutations.h"
+#include <stdexcept>
+#include <utility>
+
+ShaderPermutations::ShaderPermutations(const std::string &vertexPath, const std::string &fragmentPath, std::vector<std::string> features)
+    : vertex(preprocessShader(vertexPath)), fragment(preprocessShader(fragmentPath)), features(std::move(features))
+{
+    if (this->features.size() > 32)
+        throw std::runtime_error("ShaderPermutations : at most 32 features");
+    for (std::size_t i = 0; i < this->features.size(); ++i)
+        if (usesIdentifier(vertex.source, this->features[i]) || usesIdentifier(fragment.source, this->features[i]))
+            usedFeatures |= 1u << i;
+}
+
+ShaderPermutations::Variant& ShaderPermutations::variant(std::uint32_t mask) {
+    auto found = byMask.find(mask);
+    if (found != byMask.end())
+        return *found->second;
+
+    std::vector<ShaderDefine> vertexDefines, fragmentDefines;
+    for (std::size_t i = 0; i < features.size(); ++i) {
+        if (!(mask & (1u << i)))
+            continue;
+        if (usesIdentifier(vertex.source, features[i]))
+            vertexDefines.push_back({features[i]});
+        if (usesIdentifier(fragment.source, features[i]))
+            fragmentDefines.push_back({features[i]});
+    }
+    std::string vertexSource = injectDefines(vertex, vertexDefines);
+    std::string fragmentSource = injectDefines(fragment, fragmentDefines);
+
+    std::string key = vertexSource;
+    key += '\0';
+    key += fragmentSource;
+    std::unique_ptr<Variant>& result = programs[key];
+    if (!result) {
+        result = std::make_unique<Variant>(Variant{nullptr, makeShaderFromSourceAsync(vertexSource, fragmentSource)});
+    }
+    byMask[mask] = result.get();
+    return *result;
+}
+
+Shader& ShaderPermutations::get(std::uint32_t mask) {
+    Variant& result = variant(mask);
+    if (!result.shader)
+        result.shader = result.pending.get();
+    return *result.shader;
+}
+
+void ShaderPermutations::prepare(const std::vector<std::uint32_t> &masks) {
+    for (std::uint32_t mask : masks)
+        variant(mask);
+}
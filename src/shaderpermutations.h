@@ -0,0 +1,92 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHADERPERMUTATIONS_H
+#define SHADERPERMUTATIONS_H
+
+#include "shader.h"
+#include "shaderpreprocessor.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Variants of one vertex + fragment shader pair, specialized by a feature bitmask.
+ *
+ * Bit i of the mask defines features[i] (to 1) in both stages. A feature is only injected in the sources that
+ * mention it, so masks differing by unused features resolve to the same program : variants are deduplicated
+ * by their final sources, not by their mask. Programs are compiled on first use.
+ *
+ * \code
+ * //Typical usage
+ * ShaderPermutations lit("shaders/lit.vert", "shaders/lit.frag", {"HAS_NORMAL_MAP", "HAS_SHADOWS"});
+ * lit.prepare({0, 1, 3}); //Optional, compiles in the background
+ * Shader& shader = lit.get(material.normalMap ? 1 : 0);
+ * \endcode
+ */
+class ShaderPermutations
+{
+public:
+    /**
+     * @throw std::runtime_error if the files can't be read
+     * @pre features.size() <= 32
+     */
+    ShaderPermutations(const std::string& vertexPath, const std::string& fragmentPath, std::vector<std::string> features);
+
+    /**
+     * @brief Returns the variant, compiling it if needed
+     * @throw std::runtime_error on compile errors
+     */
+    Shader& get(std::uint32_t mask);
+
+    /**
+     * @brief Issues the compilation of several variants without waiting for them
+     */
+    void prepare(const std::vector<std::uint32_t>& masks);
+
+    /**
+     * @brief mask with the bits of the features used by neither stage cleared
+     */
+    std::uint32_t effectiveMask(std::uint32_t mask) const {return mask & usedFeatures;}
+
+    const std::vector<std::string>& getFeatures() const {return features;}
+    std::size_t programCount() const {return programs.size();}
+
+private:
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        ShaderFuture pending;
+    };
+    Variant& variant(std::uint32_t mask);
+
+    PreprocessedShader vertex, fragment;
+    std::vector<std::string> features;
+    std::uint32_t usedFeatures = 0;
+    std::unordered_map<std::uint32_t, Variant*> byMask;
+    std::unordered_map<std::string, std::unique_ptr<Variant>> programs; //By final vertex + fragment source
+};
+
+#endif // SHADERPERMUTATIONS_H
@@ -0,0 +1,181 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "shaderpreprocessor.h"
+#include "shader.h"
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+
+bool isIdentifierChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+const char* skipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    return p;
+}
+
+//Matches "#<directive>" at the start of a line, returns the position after it or nullptr
+const char* matchDirective(const char* p, const char* end, const char* directive) {
+    p = skipSpaces(p, end);
+    if (p == end || *p != '#')
+        return nullptr;
+    p = skipSpaces(p + 1, end);
+    std::size_t length = std::char_traits<char>::length(directive);
+    if (static_cast<std::size_t>(end - p) < length || !std::equal(directive, directive + length, p))
+        return nullptr;
+    p += length;
+    if (p < end && isIdentifierChar(*p))
+        return nullptr;
+    return p;
+}
+
+std::string directoryOf(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+std::string defineLines(const std::vector<ShaderDefine>& defines) {
+    std::string result;
+    for (const ShaderDefine& define : defines)
+        result += "#define " + define.name + " " + define.value + "\n";
+    return result;
+}
+
+class Preprocessor
+{
+public:
+    explicit Preprocessor(PreprocessedShader& result) : result(result) {}
+
+    void process(const std::string& path) {
+        if (std::find(onceFiles.begin(), onceFiles.end(), path) != onceFiles.end())
+            return;
+        if (std::find(stack.begin(), stack.end(), path) != stack.end())
+            throw std::runtime_error("Recursive include of " + path);
+
+        const std::string text = readFile(path);
+        const int fileIndex = static_cast<int>(result.files.size());
+        result.files.push_back(path);
+        stack.push_back(path);
+        if (fileIndex > 0)
+            result.source += "#line 1 " + std::to_string(fileIndex) + "\n";
+
+        const char* p = text.data();
+        const char* end = p + text.size();
+        int line = 1;
+        while (p < end) {
+            const char* lineEnd = std::find(p, end, '\n');
+            const char* after;
+            if ((after = matchDirective(p, lineEnd, "include"))) {
+                after = skipSpaces(after, lineEnd);
+                char close = after < lineEnd && *after == '<' ? '>' : '"';
+                const char* nameEnd = after < lineEnd ? std::find(after + 1, lineEnd, close) : lineEnd;
+                if (after == lineEnd || (*after != '"' && *after != '<') || nameEnd == lineEnd)
+                    throw std::runtime_error(path + ":" + std::to_string(line) + " : malformed #include");
+                process(normalizePath(directoryOf(path) + std::string(after + 1, nameEnd)));
+                result.source += "#line " + std::to_string(line + 1) + " " + std::to_string(fileIndex) + "\n";
+            } else if ((after = matchDirective(p, lineEnd, "pragma")) && std::string(skipSpaces(after, lineEnd), lineEnd).compare(0, 4, "once") == 0) {
+                onceFiles.push_back(path);
+                result.source += "\n"; //Keeps line numbers right
+            } else {
+                result.source.append(p, lineEnd);
+                result.source += '\n';
+                if (fileIndex == 0 && !versionFound && matchDirective(p, lineEnd, "version")) {
+                    versionFound = true;
+                    result.defineOffset = result.source.size();
+                    result.source += "#line " + std::to_string(line + 1) + " 0\n";
+                }
+            }
+            p = lineEnd < end ? lineEnd + 1 : end;
+            ++line;
+        }
+        stack.pop_back();
+    }
+
+private:
+    PreprocessedShader& result;
+    std::vector<std::string> stack;
+    std::vector<std::string> onceFiles;
+    bool versionFound = false;
+};
+
+} // namespace
+
+PreprocessedShader preprocessShader(const std::string &path, const std::vector<ShaderDefine> &defines) {
+    PreprocessedShader result;
+    Preprocessor(result).process(normalizePath(path));
+    if (!defines.empty())
+        result.source = injectDefines(result, defines);
+    return result;
+}
+
+std::string injectDefines(const PreprocessedShader &shader, const std::vector<ShaderDefine> &defines) {
+    std::string result = shader.source;
+    std::string lines = defineLines(defines);
+    if (shader.defineOffset == 0 && !lines.empty()) //No #version : nothing resets the line numbers yet
+        lines += "#line 1 0\n";
+    result.insert(shader.defineOffset, lines);
+    return result;
+}
+
+std::string normalizePath(const std::string &path) {
+    const bool absolute = !path.empty() && (path[0] == '/' || path[0] == '\\');
+    std::vector<std::string> components;
+    std::size_t start = 0;
+    while (start <= path.size()) {
+        std::size_t end = path.find_first_of("/\\", start);
+        if (end == std::string::npos)
+            end = path.size();
+        std::string component = path.substr(start, end - start);
+        if (component == "..") {
+            if (!components.empty() && components.back() != "..")
+                components.pop_back();
+            else if (!absolute) //Above the root, nothing to go up to
+                components.push_back(component);
+        } else if (!component.empty() && component != ".") {
+            components.push_back(component);
+        }
+        start = end + 1;
+    }
+
+    std::string result = absolute ? "/" : "";
+    for (std::size_t i = 0; i < components.size(); ++i)
+        result += (i > 0 ? "/" : "") + components[i];
+    return result;
+}
+
+bool usesIdentifier(const std::string &source, const std::string &name) {
+    if (name.empty())
+        return false;
+    for (std::size_t pos = source.find(name); pos != std::string::npos; pos = source.find(name, pos + 1)) {
+        bool startsWord = pos == 0 || !isIdentifierChar(source[pos - 1]);
+        bool endsWord = pos + name.size() == source.size() || !isIdentifierChar(source[pos + name.size()]);
+        if (startsWord && endsWord)
+            return true;
+    }
+    return false;
+}
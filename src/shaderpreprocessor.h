@@ -0,0 +1,79 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHADERPREPROCESSOR_H
+#define SHADERPREPROCESSOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct ShaderDefine
+{
+    std::string name;
+    std::string value = "1";
+};
+
+/**
+ * @brief Shader source with its includes expanded
+ */
+struct PreprocessedShader
+{
+    std::string source;
+    std::vector<std::string> files; ///< files[i] is the source string number i of the #line directives, files[0] the root
+    std::size_t defineOffset = 0; ///< Where defines go : right after #version
+};
+
+/** @defgroup ShaderPreprocessor
+ * Expands #include "file" directives (paths relative to the including file, #pragma once supported) and
+ * injects #defines after the #version line. #line directives are emitted so that compiler messages point
+ * to the right file and line : "0(12)" means line 12 of files[0].
+ * @{ */
+
+/**
+ * @brief preprocessShader : reads a shader file and expands its includes
+ * @param defines : injected right after #version
+ * @throw std::runtime_error if a file can't be read or on recursive includes
+ */
+PreprocessedShader preprocessShader(const std::string& path, const std::vector<ShaderDefine>& defines = {});
+
+/**
+ * @brief injectDefines : returns the source with more defines injected, without reading the files again
+ */
+std::string injectDefines(const PreprocessedShader& shader, const std::vector<ShaderDefine>& defines);
+
+/**
+ * @brief normalizePath : removes "." and "dir/.." components and uses '/' separators, so that a file always gets
+ * the same name whatever path it is reached through ("a/../b.glsl" becomes "b.glsl"). Purely lexical, symbolic
+ * links are not resolved.
+ */
+std::string normalizePath(const std::string& path);
+
+/**
+ * @brief usesIdentifier : tells whether name appears as a whole word in the source (comments included)
+ */
+bool usesIdentifier(const std::string& source, const std::string& name);
+
+/** @} */
+
+#endif // SHADERPREPROCESSOR_H
@@ -0,0 +1,289 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "shaderreflection.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+bool isSamplerType(unsigned int type) {
+    switch (type) {
+    case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW: case GL_SAMPLER_BUFFER:
+    case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_RECT: case GL_INT_SAMPLER_BUFFER:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+    case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isIntegerType(unsigned int type) {
+    switch (type) {
+    case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+    case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+    case GL_BOOL: case GL_BOOL_VEC2: case GL_BOOL_VEC3: case GL_BOOL_VEC4:
+        return true;
+    default:
+        return false;
+    }
+}
+
+//"lights[0]" -> "lights"
+std::string baseName(const char* name) {
+    std::string result(name);
+    if (result.size() > 3 && result.compare(result.size() - 3, 3, "[0]") == 0)
+        result.resize(result.size() - 3);
+    return result;
+}
+
+template <class T>
+const T* findByName(const std::vector<T>& items, const std::string& name) {
+    auto found = std::find_if(items.begin(), items.end(), [&](const T& item) { return item.name == name; });
+    return found == items.end() ? nullptr : &*found;
+}
+
+} // namespace
+
+const ShaderAttribute* ShaderReflection::findAttribute(const std::string &name) const {
+    return findByName(attributes, name);
+}
+
+const ShaderUniform* ShaderReflection::findUniform(const std::string &name) const {
+    return findByName(uniforms, name);
+}
+
+const ShaderUniformBlock* ShaderReflection::findBlock(const std::string &name) const {
+    return findByName(blocks, name);
+}
+
+int glTypeComponents(unsigned int type) {
+    switch (type) {
+    case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL: return 1;
+    case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2: return 2;
+    case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3: return 3;
+    case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4: case GL_FLOAT_MAT2: return 4;
+    case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2: return 6;
+    case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2: return 8;
+    case GL_FLOAT_MAT3: return 9;
+    case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3: return 12;
+    case GL_FLOAT_MAT4: return 16;
+    default: return 1;
+    }
+}
+
+ShaderReflection reflectProgram(unsigned int program) {
+    ShaderReflection result;
+    int count, maxLength;
+    std::vector<char> name;
+
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (int i = 0; i < count; ++i) {
+        ShaderAttribute attribute;
+        GLenum type;
+        glGetActiveAttrib(program, i, maxLength, nullptr, &attribute.size, &type, name.data());
+        attribute.name = baseName(name.data());
+        attribute.type = type;
+        attribute.location = glGetAttribLocation(program, name.data());
+        if (attribute.location >= 0) //Built-ins such as gl_VertexID have none
+            result.attributes.push_back(attribute);
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    for (int i = 0; i < count; ++i) {
+        ShaderUniformBlock block;
+        glGetActiveUniformBlockName(program, i, maxLength, nullptr, name.data());
+        block.name = name.data();
+        block.index = i;
+        glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_BINDING, &block.binding);
+        glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &block.size);
+        result.blocks.push_back(block);
+    }
+
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    name.resize(std::max(maxLength, 1));
+    std::vector<GLuint> indices(count);
+    std::vector<int> blockIndex(count), offset(count), arrayStride(count), matrixStride(count), rowMajor(count);
+    for (int i = 0; i < count; ++i)
+        indices[i] = i;
+    if (count > 0) {
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_BLOCK_INDEX, blockIndex.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_OFFSET, offset.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_ARRAY_STRIDE, arrayStride.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_MATRIX_STRIDE, matrixStride.data());
+        glGetActiveUniformsiv(program, count, indices.data(), GL_UNIFORM_IS_ROW_MAJOR, rowMajor.data());
+    }
+    for (int i = 0; i < count; ++i) {
+        ShaderUniform uniform;
+        GLenum type;
+        glGetActiveUniform(program, i, maxLength, nullptr, &uniform.size, &type, name.data());
+        uniform.name = baseName(name.data());
+        uniform.type = type;
+        uniform.block = blockIndex[i];
+        uniform.location = uniform.block < 0 ? glGetUniformLocation(program, name.data()) : -1;
+        uniform.offset = offset[i];
+        uniform.arrayStride = arrayStride[i];
+        uniform.matrixStride = matrixStride[i];
+        uniform.rowMajor = rowMajor[i] != 0;
+        if (uniform.block >= 0)
+            result.blocks[uniform.block].members.push_back(static_cast<int>(result.uniforms.size()));
+
+        if (isSamplerType(type) && uniform.location >= 0) {
+            int unit = 0;
+            glGetUniformiv(program, uniform.location, &unit);
+            result.samplers.push_back({uniform.name, uniform.location, type, uniform.size, unit});
+        }
+        result.uniforms.push_back(uniform);
+    }
+    return result;
+}
+
+std::string validateVertexLayout(const ShaderReflection &shader, const std::vector<MeshFileAttribute> &layout) {
+    std::string errors;
+    for (const ShaderAttribute& attribute : shader.attributes) {
+        //Matrices and arrays span several consecutive locations, checking the first one is enough here
+        auto fed = std::find_if(layout.begin(), layout.end(), [&](const MeshFileAttribute& a) {
+            return static_cast<int>(a.location) == attribute.location;
+        });
+        if (fed == layout.end()) {
+            errors += "Attribute " + attribute.name + " (location " + std::to_string(attribute.location) + ") is not fed by the layout\n";
+            continue;
+        }
+        //Meshes declare every attribute with glVertexAttribPointer, which converts to float
+        if (isIntegerType(attribute.type))
+            errors += "Attribute " + attribute.name + " is an integer in the shader but is fed float data\n";
+    }
+    return errors;
+}
+
+UniformBlockData::UniformBlockData(const ShaderReflection &reflection, const std::string &blockName)
+{
+    const ShaderUniformBlock* block = reflection.findBlock(blockName);
+    if (!block)
+        throw std::runtime_error("No active uniform block named " + blockName);
+    bytes.resize(block->size);
+    blockBinding = block->binding;
+    for (int index : block->members) {
+        const ShaderUniform& uniform = reflection.uniforms[index];
+        members[uniform.name] = uniform;
+        //Members of named instances are reported as "Block.member", allow "member" as well
+        std::size_t dot = uniform.name.find('.');
+        if (dot != std::string::npos && uniform.name.compare(0, dot, blockName) == 0)
+            members[uniform.name.substr(dot + 1)] = uniform;
+    }
+}
+
+unsigned char* UniformBlockData::member(const std::string &name, unsigned int type, int index, const ShaderUniform *&uniform) {
+    auto found = members.find(name);
+    if (found == members.end() || index < 0 || index >= found->second.size)
+        return nullptr;
+    uniform = &found->second;
+    if (uniform->type != type)
+        throw std::runtime_error("Uniform block member " + name + " has another type");
+    return bytes.data() + uniform->offset + index * uniform->arrayStride;
+}
+
+bool UniformBlockData::set(const std::string &name, float value, int index) {
+    const ShaderUniform* uniform;
+    unsigned char* target = member(name, GL_FLOAT, index, uniform);
+    if (target)
+        std::memcpy(target, &value, sizeof(value));
+    return target != nullptr;
+}
+
+bool UniformBlockData::set(const std::string &name, int value, int index) {
+    const ShaderUniform* uniform;
+    unsigned char* target = member(name, GL_INT, index, uniform);
+    if (target)
+        std::memcpy(target, &value, sizeof(value));
+    return target != nullptr;
+}
+
+bool UniformBlockData::set(const std::string &name, const glm::vec2 &value, int index) {
+    const ShaderUniform* uniform;
+    unsigned char* target = member(name, GL_FLOAT_VEC2, index, uniform);
+    if (target)
+        std::memcpy(target, &value, sizeof(value));
+    return target != nullptr;
+}
+
+bool UniformBlockData::set(const std::string &name, const glm::vec3 &value, int index) {
+    const ShaderUniform* uniform;
+    unsigned char* target = member(name, GL_FLOAT_VEC3, index, uniform);
+    if (target)
+        std::memcpy(target, &value, sizeof(value));
+    return target != nullptr;
+}
+
+bool UniformBlockData::set(const std::string &name, const glm::vec4 &value, int index) {
+    const ShaderUniform* uniform;
+    unsigned char* target = member(name, GL_FLOAT_VEC4, index, uniform);
+    if (target)
+        std::memcpy(target, &value, sizeof(value));
+    return target != nullptr;
+}
+
+//Columns (or rows) are padded to matrixStride, e.g. 16 bytes for a mat3 in std140
+template <class Matrix>
+bool UniformBlockData::setMatrix(const std::string &name, const Matrix &value, unsigned int type, int index) {
+    const ShaderUniform* uniform;
+    unsigned char* target = member(name, type, index, uniform);
+    if (!target)
+        return false;
+    const int size = Matrix::length();
+    for (int c = 0; c < size; ++c)
+        for (int r = 0; r < size; ++r) {
+            float element = value[c][r];
+            int stride = uniform->rowMajor ? r * uniform->matrixStride + c * 4 : c * uniform->matrixStride + r * 4;
+            std::memcpy(target + stride, &element, sizeof(float));
+        }
+    return true;
+}
+
+bool UniformBlockData::set(const std::string &name, const glm::mat3 &value, int index) {
+    return setMatrix(name, value, GL_FLOAT_MAT3, index);
+}
+
+bool UniformBlockData::set(const std::string &name, const glm::mat4 &value, int index) {
+    return setMatrix(name, value, GL_FLOAT_MAT4, index);
+}
+
+void UniformBlockData::upload(unsigned int buffer) const {
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, bytes.size(), bytes.data());
+}
@@ -0,0 +1,169 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHADERREFLECTION_H
+#define SHADERREFLECTION_H
+
+#include "meshformat.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+struct ShaderAttribute
+{
+    std::string name;
+    int location;
+    unsigned int type; ///< GL_FLOAT_VEC3, GL_INT, ...
+    int size; ///< Array size, 1 for non-arrays
+};
+
+struct ShaderUniform
+{
+    std::string name; ///< Without the "[0]" suffix of arrays
+    int location; ///< -1 for members of uniform blocks
+    unsigned int type;
+    int size; ///< Array size, 1 for non-arrays
+    int block; ///< Index in ShaderReflection::blocks, -1 for the default block
+    int offset, arrayStride, matrixStride; ///< In bytes, in the block. -1 for the default block
+    bool rowMajor;
+};
+
+struct ShaderUniformBlock
+{
+    std::string name;
+    unsigned int index; ///< For glUniformBlockBinding
+    int binding;
+    int size; ///< Minimal size of the buffer, in bytes
+    std::vector<int> members; ///< Indices in ShaderReflection::uniforms
+};
+
+struct ShaderSampler
+{
+    std::string name;
+    int location;
+    unsigned int type; ///< GL_SAMPLER_2D, ...
+    int size;
+    int unit; ///< Texture unit the sampler reads, as set by glUniform1i
+};
+
+/**
+ * @brief Everything a linked program exposes : inputs, uniforms, uniform blocks and samplers.
+ * Inactive variables (optimized away by the compiler) are not listed.
+ */
+struct ShaderReflection
+{
+    std::vector<ShaderAttribute> attributes;
+    std::vector<ShaderUniform> uniforms; ///< Samplers included
+    std::vector<ShaderUniformBlock> blocks;
+    std::vector<ShaderSampler> samplers;
+
+    /** @return nullptr when not found */
+    const ShaderAttribute* findAttribute(const std::string& name) const;
+    const ShaderUniform* findUniform(const std::string& name) const;
+    const ShaderUniformBlock* findBlock(const std::string& name) const;
+};
+
+/** @defgroup ShaderReflection
+ * @{ */
+
+/**
+ * @brief reflectProgram : queries the interface of a linked program
+ * @pre program linked successfully
+ */
+ShaderReflection reflectProgram(unsigned int program);
+
+/**
+ * @brief validateVertexLayout : checks that a vertex layout feeds every attribute a shader reads
+ * @return an empty string when valid, a description of the problems otherwise
+ *
+ * Reports the attributes with no matching location, and integer attributes (meshes only feed float data).
+ */
+std::string validateVertexLayout(const ShaderReflection& shader, const std::vector<MeshFileAttribute>& layout);
+
+/**
+ * @brief glTypeComponents : number of scalars in a GLSL type (GL_FLOAT_MAT4 is 16)
+ */
+int glTypeComponents(unsigned int type);
+
+/** @} */
+
+/**
+ * @brief CPU copy of a uniform block, laid out exactly like the GPU expects it (std140, shared or packed).
+ *
+ * Offsets and strides come from the program, so uploading is a single glBufferSubData of the whole block.
+ *
+ * \code
+ * //Typical usage
+ * UniformBlockData camera(shader->getReflection(), "Camera");
+ * camera.set("view", cam.getView());
+ * camera.set("lights", light, 2); //lights[2]
+ * camera.upload(ubo);
+ * \endcode
+ */
+class UniformBlockData
+{
+public:
+    /**
+     * @throw std::runtime_error if the program has no active block with this name
+     */
+    UniformBlockData(const ShaderReflection& reflection, const std::string& blockName);
+
+    /**
+     * @brief Writes a member. Returns false if the block has no such active member.
+     * @param index : array element
+     * @throw std::runtime_error if the member has another type
+     */
+    bool set(const std::string& name, float value, int index = 0);
+    bool set(const std::string& name, int value, int index = 0);
+    bool set(const std::string& name, const glm::vec2& value, int index = 0);
+    bool set(const std::string& name, const glm::vec3& value, int index = 0);
+    bool set(const std::string& name, const glm::vec4& value, int index = 0);
+    bool set(const std::string& name, const glm::mat3& value, int index = 0);
+    bool set(const std::string& name, const glm::mat4& value, int index = 0);
+
+    const void* data() const {return bytes.data();}
+    std::size_t size() const {return bytes.size();}
+    int binding() const {return blockBinding;}
+
+    /**
+     * @brief Uploads the whole block to a buffer of at least size() bytes
+     */
+    void upload(unsigned int buffer) const;
+
+private:
+    unsigned char* member(const std::string& name, unsigned int type, int index, const ShaderUniform*& uniform);
+    template <class Matrix>
+    bool setMatrix(const std::string& name, const Matrix& value, unsigned int type, int index);
+
+    std::vector<unsigned char> bytes;
+    std::unordered_map<std::string, ShaderUniform> members;
+    int blockBinding;
+};
+
+#endif // SHADERREFLECTION_H
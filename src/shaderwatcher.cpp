@@ -0,0 +1,77 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "shaderwatcher.h"
+#include "shader.h"
+#include "shaderpreprocessor.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+ShaderWatcher& ShaderWatcher::global() {
+    static ShaderWatcher watcher;
+    return watcher;
+}
+
+void ShaderWatcher::track(Shader &shader, const std::string &vertexPath, const std::string &fragmentPath, const std::vector<std::string> &files) {
+    shaders[&shader] = Entry{vertexPath, fragmentPath, files};
+    for (const std::string& file : files)
+        watcher.watch(file);
+}
+
+void ShaderWatcher::untrack(Shader &shader) {
+    shaders.erase(&shader);
+}
+
+std::size_t ShaderWatcher::update() {
+    std::vector<std::string> changed = watcher.poll();
+    if (changed.empty())
+        return 0;
+
+    std::size_t reloaded = 0;
+    for (auto& tracked : shaders) {
+        Entry& entry = tracked.second;
+        bool dirty = std::any_of(entry.files.begin(), entry.files.end(), [&](const std::string& file) {
+            return std::find(changed.begin(), changed.end(), file) != changed.end();
+        });
+        if (!dirty)
+            continue;
+
+        try {
+            PreprocessedShader vertex = preprocessShader(entry.vertexPath);
+            PreprocessedShader fragment = preprocessShader(entry.fragmentPath);
+            //Includes may have changed as well
+            entry.files = vertex.files;
+            entry.files.insert(entry.files.end(), fragment.files.begin(), fragment.files.end());
+            for (const std::string& file : entry.files)
+                watcher.watch(file);
+
+            tracked.first->reload(vertex.source, fragment.source);
+            ++reloaded;
+            std::cerr << "Reloaded shader " << entry.vertexPath << " + " << entry.fragmentPath << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << entry.vertexPath << " + " << entry.fragmentPath << " : " << e.what() << std::endl;
+        }
+    }
+    return reloaded;
+}
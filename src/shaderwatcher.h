@@ -0,0 +1,66 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SHADERWATCHER_H
+#define SHADERWATCHER_H
+
+#include "filewatcher.h"
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Shader;
+
+/**
+ * @brief Recompiles shaders when their source files (includes too) change.
+ *
+ * Shaders made by makeShaderFromFile() and makeShaderFromFileAsync() register themselves and unregister on
+ * destruction. On a compile error the message is printed and the shader keeps its previous program.
+ * Programs get new ids when reloaded : bind them with glUseProgram every frame, and set their uniforms again.
+ */
+class ShaderWatcher
+{
+public:
+    void track(Shader& shader, const std::string& vertexPath, const std::string& fragmentPath, const std::vector<std::string>& files);
+    void untrack(Shader& shader);
+
+    /**
+     * @brief Reloads the shaders whose files changed. Call on the GL thread, e.g. once per frame.
+     * @return the number of shaders successfully reloaded
+     */
+    std::size_t update();
+
+    static ShaderWatcher& global();
+
+private:
+    struct Entry {
+        std::string vertexPath, fragmentPath;
+        std::vector<std::string> files;
+    };
+
+    FileWatcher watcher;
+    std::unordered_map<Shader*, Entry> shaders;
+};
+
+#endif // SHADERWATCHER_H
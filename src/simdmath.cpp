@@ -0,0 +1,499 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "simdmath.h"
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMDMATH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+void Vec4SoA::resize(std::size_t n) {
+    x.resize(n); y.resize(n); z.resize(n); w.resize(n);
+}
+
+void Vec4SoA::push_back(const glm::vec4 &v) {
+    x.push_back(v.x); y.push_back(v.y); z.push_back(v.z); w.push_back(v.w);
+}
+
+void TransformSoA::resize(std::size_t n) {
+    tx.resize(n); ty.resize(n); tz.resize(n);
+    rx.resize(n); ry.resize(n); rz.resize(n); rw.resize(n, 1.0f);
+    sx.resize(n, 1.0f); sy.resize(n, 1.0f); sz.resize(n, 1.0f);
+}
+
+void TransformSoA::push_back(const glm::vec3 &t, const glm::quat &r, const glm::vec3 &s) {
+    tx.push_back(t.x); ty.push_back(t.y); tz.push_back(t.z);
+    rx.push_back(r.x); ry.push_back(r.y); rz.push_back(r.z); rw.push_back(r.w);
+    sx.push_back(s.x); sy.push_back(s.y); sz.push_back(s.z);
+}
+
+void AABBSoA::resize(std::size_t n) {
+    minX.resize(n); minY.resize(n); minZ.resize(n);
+    maxX.resize(n); maxY.resize(n); maxZ.resize(n);
+}
+
+void AABBSoA::push_back(const glm::vec3 &min, const glm::vec3 &max) {
+    minX.push_back(min.x); minY.push_back(min.y); minZ.push_back(min.z);
+    maxX.push_back(max.x); maxY.push_back(max.y); maxZ.push_back(max.z);
+}
+
+/* Kernel table. Every kernel handles the [begin, end) range so that SIMD versions can
+ * delegate their remainder to the scalar one. */
+namespace {
+
+struct Kernels {
+    void (*multiply)(const glm::mat4* lhs, std::size_t lhsStride, const glm::mat4* rhs, glm::mat4* out, std::size_t begin, std::size_t end);
+    void (*transform)(const glm::mat4& m, const Vec4SoA& in, Vec4SoA& out, std::size_t begin, std::size_t end);
+    void (*composeTRS)(const TransformSoA& trs, glm::mat4* out, std::size_t begin, std::size_t end);
+    void (*transformAABB)(const glm::mat4* matrices, const AABBSoA& in, AABBSoA& out, std::size_t begin, std::size_t end);
+};
+
+/* Scalar reference */
+
+void multiplyScalar(const glm::mat4* lhs, std::size_t lhsStride, const glm::mat4* rhs, glm::mat4* out, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i)
+        out[i] = lhs[i * lhsStride] * rhs[i];
+}
+
+void transformScalar(const glm::mat4& m, const Vec4SoA& in, Vec4SoA& out, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        glm::vec4 v = m * in.get(i);
+        out.x[i] = v.x; out.y[i] = v.y; out.z[i] = v.z; out.w[i] = v.w;
+    }
+}
+
+void composeTRSScalar(const TransformSoA& trs, glm::mat4* out, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        glm::mat4 r = glm::mat4_cast(glm::quat(trs.rw[i], trs.rx[i], trs.ry[i], trs.rz[i]));
+        r[0] *= trs.sx[i];
+        r[1] *= trs.sy[i];
+        r[2] *= trs.sz[i];
+        r[3] = glm::vec4(trs.tx[i], trs.ty[i], trs.tz[i], 1.0f);
+        out[i] = r;
+    }
+}
+
+void transformAABBScalar(const glm::mat4* matrices, const AABBSoA& in, AABBSoA& out, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const glm::mat4& m = matrices[i];
+        glm::vec3 center(in.minX[i] + in.maxX[i], in.minY[i] + in.maxY[i], in.minZ[i] + in.maxZ[i]);
+        glm::vec3 extent(in.maxX[i] - in.minX[i], in.maxY[i] - in.minY[i], in.maxZ[i] - in.minZ[i]);
+        center *= 0.5f;
+        extent *= 0.5f;
+        glm::vec3 newCenter = glm::vec3(m * glm::vec4(center, 1.0f));
+        glm::vec3 newExtent = glm::abs(glm::vec3(m[0])) * extent.x
+                            + glm::abs(glm::vec3(m[1])) * extent.y
+                            + glm::abs(glm::vec3(m[2])) * extent.z;
+        out.minX[i] = newCenter.x - newExtent.x; out.maxX[i] = newCenter.x + newExtent.x;
+        out.minY[i] = newCenter.y - newExtent.y; out.maxY[i] = newCenter.y + newExtent.y;
+        out.minZ[i] = newCenter.z - newExtent.z; out.maxZ[i] = newCenter.z + newExtent.z;
+    }
+}
+
+const Kernels scalarKernels = {multiplyScalar, transformScalar, composeTRSScalar, transformAABBScalar};
+
+#ifdef SIMDMATH_X86
+
+/* SSE2 */
+
+void multiplySSE2(const glm::mat4* lhs, std::size_t lhsStride, const glm::mat4* rhs, glm::mat4* out, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const float* a = &lhs[i * lhsStride][0][0];
+        const float* b = &rhs[i][0][0];
+        float* o = &out[i][0][0];
+        __m128 a0 = _mm_loadu_ps(a);
+        __m128 a1 = _mm_loadu_ps(a + 4);
+        __m128 a2 = _mm_loadu_ps(a + 8);
+        __m128 a3 = _mm_loadu_ps(a + 12);
+        for (int j = 0; j < 4; ++j) {
+            __m128 col = _mm_loadu_ps(b + 4 * j);
+            __m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1))));
+            r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2))));
+            r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3))));
+            _mm_storeu_ps(o + 4 * j, r);
+        }
+    }
+}
+
+void transformSSE2(const glm::mat4& m, const Vec4SoA& in, Vec4SoA& out, std::size_t begin, std::size_t end) {
+    __m128 mc[4][4];
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            mc[c][r] = _mm_set1_ps(m[c][r]);
+
+    float* dst[4] = {out.x.data(), out.y.data(), out.z.data(), out.w.data()};
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(in.x.data() + i);
+        __m128 y = _mm_loadu_ps(in.y.data() + i);
+        __m128 z = _mm_loadu_ps(in.z.data() + i);
+        __m128 w = _mm_loadu_ps(in.w.data() + i);
+        for (int r = 0; r < 4; ++r) {
+            __m128 v = _mm_mul_ps(mc[0][r], x);
+            v = _mm_add_ps(v, _mm_mul_ps(mc[1][r], y));
+            v = _mm_add_ps(v, _mm_mul_ps(mc[2][r], z));
+            v = _mm_add_ps(v, _mm_mul_ps(mc[3][r], w));
+            _mm_storeu_ps(dst[r] + i, v);
+        }
+    }
+    transformScalar(m, in, out, i, end);
+}
+
+void composeTRSSSE2(const TransformSoA& trs, glm::mat4* out, std::size_t begin, std::size_t end) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 zero = _mm_setzero_ps();
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 qx = _mm_loadu_ps(trs.rx.data() + i);
+        __m128 qy = _mm_loadu_ps(trs.ry.data() + i);
+        __m128 qz = _mm_loadu_ps(trs.rz.data() + i);
+        __m128 qw = _mm_loadu_ps(trs.rw.data() + i);
+        __m128 xx = _mm_mul_ps(qx, qx), yy = _mm_mul_ps(qy, qy), zz = _mm_mul_ps(qz, qz);
+        __m128 xy = _mm_mul_ps(qx, qy), xz = _mm_mul_ps(qx, qz), yz = _mm_mul_ps(qy, qz);
+        __m128 wx = _mm_mul_ps(qw, qx), wy = _mm_mul_ps(qw, qy), wz = _mm_mul_ps(qw, qz);
+        __m128 sx = _mm_loadu_ps(trs.sx.data() + i);
+        __m128 sy = _mm_loadu_ps(trs.sy.data() + i);
+        __m128 sz = _mm_loadu_ps(trs.sz.data() + i);
+
+        //cols[c][r] holds element (c, r) of 4 matrices
+        __m128 cols[4][4];
+        cols[0][0] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+        cols[0][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sx);
+        cols[0][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sx);
+        cols[0][3] = zero;
+        cols[1][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sy);
+        cols[1][1] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+        cols[1][2] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sy);
+        cols[1][3] = zero;
+        cols[2][0] = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sz);
+        cols[2][1] = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sz);
+        cols[2][2] = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+        cols[2][3] = zero;
+        cols[3][0] = _mm_loadu_ps(trs.tx.data() + i);
+        cols[3][1] = _mm_loadu_ps(trs.ty.data() + i);
+        cols[3][2] = _mm_loadu_ps(trs.tz.data() + i);
+        cols[3][3] = one;
+
+        for (int c = 0; c < 4; ++c) {
+            __m128 r0 = cols[c][0], r1 = cols[c][1], r2 = cols[c][2], r3 = cols[c][3];
+            _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+            _mm_storeu_ps(&out[i + 0][c][0], r0);
+            _mm_storeu_ps(&out[i + 1][c][0], r1);
+            _mm_storeu_ps(&out[i + 2][c][0], r2);
+            _mm_storeu_ps(&out[i + 3][c][0], r3);
+        }
+    }
+    composeTRSScalar(trs, out, i, end);
+}
+
+//Loads column c of matrices m[0..3] so that result[r] holds element (c, r) of each matrix
+inline void loadColumnTransposed4(const glm::mat4* m, int c, __m128 result[4]) {
+    __m128 r0 = _mm_loadu_ps(&m[0][c][0]);
+    __m128 r1 = _mm_loadu_ps(&m[1][c][0]);
+    __m128 r2 = _mm_loadu_ps(&m[2][c][0]);
+    __m128 r3 = _mm_loadu_ps(&m[3][c][0]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    result[0] = r0; result[1] = r1; result[2] = r2; result[3] = r3;
+}
+
+void transformAABBSSE2(const glm::mat4* matrices, const AABBSoA& in, AABBSoA& out, std::size_t begin, std::size_t end) {
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 m[4][4];
+        for (int c = 0; c < 4; ++c)
+            loadColumnTransposed4(matrices + i, c, m[c]);
+
+        __m128 minX = _mm_loadu_ps(in.minX.data() + i), maxX = _mm_loadu_ps(in.maxX.data() + i);
+        __m128 minY = _mm_loadu_ps(in.minY.data() + i), maxY = _mm_loadu_ps(in.maxY.data() + i);
+        __m128 minZ = _mm_loadu_ps(in.minZ.data() + i), maxZ = _mm_loadu_ps(in.maxZ.data() + i);
+        __m128 cx = _mm_mul_ps(_mm_add_ps(minX, maxX), half), ex = _mm_mul_ps(_mm_sub_ps(maxX, minX), half);
+        __m128 cy = _mm_mul_ps(_mm_add_ps(minY, maxY), half), ey = _mm_mul_ps(_mm_sub_ps(maxY, minY), half);
+        __m128 cz = _mm_mul_ps(_mm_add_ps(minZ, maxZ), half), ez = _mm_mul_ps(_mm_sub_ps(maxZ, minZ), half);
+
+        float* outMin[3] = {out.minX.data(), out.minY.data(), out.minZ.data()};
+        float* outMax[3] = {out.maxX.data(), out.maxY.data(), out.maxZ.data()};
+        for (int r = 0; r < 3; ++r) {
+            __m128 c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][r], cx), _mm_mul_ps(m[1][r], cy)),
+                                  _mm_add_ps(_mm_mul_ps(m[2][r], cz), m[3][r]));
+            __m128 e = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(signMask, m[0][r]), ex),
+                                             _mm_mul_ps(_mm_andnot_ps(signMask, m[1][r]), ey)),
+                                  _mm_mul_ps(_mm_andnot_ps(signMask, m[2][r]), ez));
+            _mm_storeu_ps(outMin[r] + i, _mm_sub_ps(c, e));
+            _mm_storeu_ps(outMax[r] + i, _mm_add_ps(c, e));
+        }
+    }
+    transformAABBScalar(matrices, in, out, i, end);
+}
+
+const Kernels sse2Kernels = {multiplySSE2, transformSSE2, composeTRSSSE2, transformAABBSSE2};
+
+/* AVX2 + FMA. These functions are compiled for AVX2 regardless of the global flags, and are only
+ * reached when the CPU reports support for it. */
+
+TARGET_AVX2 void multiplyAVX2(const glm::mat4* lhs, std::size_t lhsStride, const glm::mat4* rhs, glm::mat4* out, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+        const float* a = &lhs[i * lhsStride][0][0];
+        const float* b = &rhs[i][0][0];
+        float* o = &out[i][0][0];
+        //Each lhs column duplicated in both 128 bits lanes, so two output columns are computed at once
+        __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a));
+        __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+        __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+        __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+        for (int j = 0; j < 4; j += 2) {
+            __m256 cols = _mm256_loadu_ps(b + 4 * j);
+            __m256 r = _mm256_mul_ps(a0, _mm256_shuffle_ps(cols, cols, _MM_SHUFFLE(0, 0, 0, 0)));
+            r = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(cols, cols, _MM_SHUFFLE(1, 1, 1, 1)), r);
+            r = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(cols, cols, _MM_SHUFFLE(2, 2, 2, 2)), r);
+            r = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(cols, cols, _MM_SHUFFLE(3, 3, 3, 3)), r);
+            _mm256_storeu_ps(o + 4 * j, r);
+        }
+    }
+}
+
+TARGET_AVX2 void transformAVX2(const glm::mat4& m, const Vec4SoA& in, Vec4SoA& out, std::size_t begin, std::size_t end) {
+    __m256 mc[4][4];
+    for (int c = 0; c < 4; ++c)
+        for (int r = 0; r < 4; ++r)
+            mc[c][r] = _mm256_set1_ps(m[c][r]);
+
+    float* dst[4] = {out.x.data(), out.y.data(), out.z.data(), out.w.data()};
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 x = _mm256_loadu_ps(in.x.data() + i);
+        __m256 y = _mm256_loadu_ps(in.y.data() + i);
+        __m256 z = _mm256_loadu_ps(in.z.data() + i);
+        __m256 w = _mm256_loadu_ps(in.w.data() + i);
+        for (int r = 0; r < 4; ++r) {
+            __m256 v = _mm256_mul_ps(mc[0][r], x);
+            v = _mm256_fmadd_ps(mc[1][r], y, v);
+            v = _mm256_fmadd_ps(mc[2][r], z, v);
+            v = _mm256_fmadd_ps(mc[3][r], w, v);
+            _mm256_storeu_ps(dst[r] + i, v);
+        }
+    }
+    transformSSE2(m, in, out, i, end);
+}
+
+TARGET_AVX2 void composeTRSAVX2(const TransformSoA& trs, glm::mat4* out, std::size_t begin, std::size_t end) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 qx = _mm256_loadu_ps(trs.rx.data() + i);
+        __m256 qy = _mm256_loadu_ps(trs.ry.data() + i);
+        __m256 qz = _mm256_loadu_ps(trs.rz.data() + i);
+        __m256 qw = _mm256_loadu_ps(trs.rw.data() + i);
+        __m256 xx = _mm256_mul_ps(qx, qx), yy = _mm256_mul_ps(qy, qy), zz = _mm256_mul_ps(qz, qz);
+        __m256 xy = _mm256_mul_ps(qx, qy), xz = _mm256_mul_ps(qx, qz), yz = _mm256_mul_ps(qy, qz);
+        __m256 wx = _mm256_mul_ps(qw, qx), wy = _mm256_mul_ps(qw, qy), wz = _mm256_mul_ps(qw, qz);
+        __m256 sx = _mm256_loadu_ps(trs.sx.data() + i);
+        __m256 sy = _mm256_loadu_ps(trs.sy.data() + i);
+        __m256 sz = _mm256_loadu_ps(trs.sz.data() + i);
+
+        __m256 cols[4][4];
+        cols[0][0] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(yy, zz), one), sx);
+        cols[0][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xy, wz)), sx);
+        cols[0][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)), sx);
+        cols[0][3] = zero;
+        cols[1][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)), sy);
+        cols[1][1] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, zz), one), sy);
+        cols[1][2] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(yz, wx)), sy);
+        cols[1][3] = zero;
+        cols[2][0] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_add_ps(xz, wy)), sz);
+        cols[2][1] = _mm256_mul_ps(_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)), sz);
+        cols[2][2] = _mm256_mul_ps(_mm256_fnmadd_ps(two, _mm256_add_ps(xx, yy), one), sz);
+        cols[2][3] = zero;
+        cols[3][0] = _mm256_loadu_ps(trs.tx.data() + i);
+        cols[3][1] = _mm256_loadu_ps(trs.ty.data() + i);
+        cols[3][2] = _mm256_loadu_ps(trs.tz.data() + i);
+        cols[3][3] = one;
+
+        for (int c = 0; c < 4; ++c) {
+            for (int half = 0; half < 2; ++half) {
+                __m128 r0, r1, r2, r3;
+                if (half == 0) {
+                    r0 = _mm256_castps256_ps128(cols[c][0]); r1 = _mm256_castps256_ps128(cols[c][1]);
+                    r2 = _mm256_castps256_ps128(cols[c][2]); r3 = _mm256_castps256_ps128(cols[c][3]);
+                } else {
+                    r0 = _mm256_extractf128_ps(cols[c][0], 1); r1 = _mm256_extractf128_ps(cols[c][1], 1);
+                    r2 = _mm256_extractf128_ps(cols[c][2], 1); r3 = _mm256_extractf128_ps(cols[c][3], 1);
+                }
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                glm::mat4* o = out + i + 4 * half;
+                _mm_storeu_ps(&o[0][c][0], r0);
+                _mm_storeu_ps(&o[1][c][0], r1);
+                _mm_storeu_ps(&o[2][c][0], r2);
+                _mm_storeu_ps(&o[3][c][0], r3);
+            }
+        }
+    }
+    composeTRSSSE2(trs, out, i, end);
+}
+
+TARGET_AVX2 void transformAABBAVX2(const glm::mat4* matrices, const AABBSoA& in, AABBSoA& out, std::size_t begin, std::size_t end) {
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 m[4][4];
+        for (int c = 0; c < 4; ++c) {
+            __m128 lo[4], hi[4];
+            loadColumnTransposed4(matrices + i, c, lo);
+            loadColumnTransposed4(matrices + i + 4, c, hi);
+            for (int r = 0; r < 4; ++r)
+                m[c][r] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo[r]), hi[r], 1);
+        }
+
+        __m256 minX = _mm256_loadu_ps(in.minX.data() + i), maxX = _mm256_loadu_ps(in.maxX.data() + i);
+        __m256 minY = _mm256_loadu_ps(in.minY.data() + i), maxY = _mm256_loadu_ps(in.maxY.data() + i);
+        __m256 minZ = _mm256_loadu_ps(in.minZ.data() + i), maxZ = _mm256_loadu_ps(in.maxZ.data() + i);
+        __m256 cx = _mm256_mul_ps(_mm256_add_ps(minX, maxX), half), ex = _mm256_mul_ps(_mm256_sub_ps(maxX, minX), half);
+        __m256 cy = _mm256_mul_ps(_mm256_add_ps(minY, maxY), half), ey = _mm256_mul_ps(_mm256_sub_ps(maxY, minY), half);
+        __m256 cz = _mm256_mul_ps(_mm256_add_ps(minZ, maxZ), half), ez = _mm256_mul_ps(_mm256_sub_ps(maxZ, minZ), half);
+
+        float* outMin[3] = {out.minX.data(), out.minY.data(), out.minZ.data()};
+        float* outMax[3] = {out.maxX.data(), out.maxY.data(), out.maxZ.data()};
+        for (int r = 0; r < 3; ++r) {
+            __m256 c = _mm256_fmadd_ps(m[0][r], cx, _mm256_fmadd_ps(m[1][r], cy, _mm256_fmadd_ps(m[2][r], cz, m[3][r])));
+            __m256 e = _mm256_mul_ps(_mm256_andnot_ps(signMask, m[0][r]), ex);
+            e = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, m[1][r]), ey, e);
+            e = _mm256_fmadd_ps(_mm256_andnot_ps(signMask, m[2][r]), ez, e);
+            _mm256_storeu_ps(outMin[r] + i, _mm256_sub_ps(c, e));
+            _mm256_storeu_ps(outMax[r] + i, _mm256_add_ps(c, e));
+        }
+    }
+    transformAABBSSE2(matrices, in, out, i, end);
+}
+
+const Kernels avx2Kernels = {multiplyAVX2, transformAVX2, composeTRSAVX2, transformAABBAVX2};
+
+#endif // SIMDMATH_X86
+
+const Kernels* kernelsFor(SimdLevel level) {
+#ifdef SIMDMATH_X86
+    switch (level) {
+    case SimdLevel::AVX2:
+        return &avx2Kernels;
+    case SimdLevel::SSE2:
+        return &sse2Kernels;
+    default:
+        break;
+    }
+#endif
+    (void) level;
+    return &scalarKernels;
+}
+
+std::atomic<int> forcedLevel(-1);
+
+const Kernels& kernels() {
+    static const Kernels* detected = kernelsFor(detectSimdLevel());
+    int forced = forcedLevel.load(std::memory_order_relaxed);
+    return forced < 0 ? *detected : *kernelsFor(static_cast<SimdLevel>(forced));
+}
+
+} // namespace
+
+SimdLevel detectSimdLevel() {
+#ifdef SIMDMATH_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool fma = (info[2] & (1 << 12)) != 0;
+    bool ymmEnabled = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0;
+    if (avx2 && fma && ymmEnabled)
+        return SimdLevel::AVX2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return SimdLevel::AVX2;
+#endif
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel activeSimdLevel() {
+    int forced = forcedLevel.load(std::memory_order_relaxed);
+    return forced < 0 ? detectSimdLevel() : static_cast<SimdLevel>(forced);
+}
+
+void forceSimdLevel(SimdLevel level) {
+    if (static_cast<int>(level) > static_cast<int>(detectSimdLevel()))
+        throw std::runtime_error(std::string("SIMD level not supported by this CPU : ") + simdLevelName(level));
+    forcedLevel.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::SSE2:
+        return "SSE2";
+    default:
+        return "Scalar";
+    }
+}
+
+void batchMultiply(const glm::mat4 *lhs, const glm::mat4 *rhs, glm::mat4 *out, std::size_t count) {
+    kernels().multiply(lhs, 1, rhs, out, 0, count);
+}
+
+void batchMultiply(const glm::mat4 &lhs, const glm::mat4 *rhs, glm::mat4 *out, std::size_t count) {
+    kernels().multiply(&lhs, 0, rhs, out, 0, count);
+}
+
+void batchTransform(const glm::mat4 &m, const Vec4SoA &in, Vec4SoA &out) {
+    out.resize(in.size());
+    kernels().transform(m, in, out, 0, in.size());
+}
+
+void batchComposeTRS(const TransformSoA &trs, glm::mat4 *out) {
+    kernels().composeTRS(trs, out, 0, trs.size());
+}
+
+void batchTransformAABB(const glm::mat4 *matrices, const AABBSoA &in, AABBSoA &out) {
+    out.resize(in.size());
+    kernels().transformAABB(matrices, in, out, 0, in.size());
+}
@@ -0,0 +1,140 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef SIMDMATH_H
+#define SIMDMATH_H
+
+#include <cstddef>
+#include <vector>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+/**
+ * @brief Instruction sets the batched math kernels can run on.
+ */
+enum class SimdLevel {
+    Scalar, ///< Plain glm calls, always available
+    SSE2,
+    AVX2    ///< AVX2 + FMA
+};
+
+/**
+ * @brief Structure-of-arrays storage for 4D vectors (one array per component).
+ */
+struct Vec4SoA
+{
+    std::vector<float> x, y, z, w;
+
+    std::size_t size() const {return x.size();}
+    void resize(std::size_t n);
+    void push_back(const glm::vec4& v);
+    glm::vec4 get(std::size_t i) const {return {x[i], y[i], z[i], w[i]};}
+};
+
+/**
+ * @brief Structure-of-arrays storage for Translation / Rotation / Scale transforms.
+ * @invariant All arrays have the same size
+ */
+struct TransformSoA
+{
+    std::vector<float> tx, ty, tz;
+    std::vector<float> rx, ry, rz, rw; //Unit quaternion
+    std::vector<float> sx, sy, sz;
+
+    std::size_t size() const {return tx.size();}
+    void resize(std::size_t n);
+    void push_back(const glm::vec3& t, const glm::quat& r, const glm::vec3& s);
+};
+
+/**
+ * @brief Structure-of-arrays storage for axis-aligned bounding boxes.
+ */
+struct AABBSoA
+{
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+
+    std::size_t size() const {return minX.size();}
+    void resize(std::size_t n);
+    void push_back(const glm::vec3& min, const glm::vec3& max);
+};
+
+/** @defgroup SimdMath
+ * Batched math kernels. The implementation is picked once at runtime from the best instruction set
+ * supported by the CPU (see activeSimdLevel()). All kernels accept unaligned data.
+ * @{ */
+
+/**
+ * @brief detectSimdLevel : queries the CPU for the best supported instruction set
+ */
+SimdLevel detectSimdLevel();
+
+/**
+ * @brief activeSimdLevel : returns the instruction set currently used by the kernels
+ */
+SimdLevel activeSimdLevel();
+
+/**
+ * @brief forceSimdLevel : overrides runtime dispatch (used for benchmarking and validation)
+ * @pre level <= detectSimdLevel()
+ * @throw std::runtime_error if the CPU doesn't support the requested level
+ */
+void forceSimdLevel(SimdLevel level);
+
+const char* simdLevelName(SimdLevel level);
+
+/**
+ * @brief batchMultiply : out[i] = lhs[i] * rhs[i]
+ * @pre out doesn't alias lhs or rhs
+ */
+void batchMultiply(const glm::mat4* lhs, const glm::mat4* rhs, glm::mat4* out, std::size_t count);
+
+/**
+ * @brief batchMultiply : out[i] = lhs * rhs[i] (e.g. viewProjection * model[i])
+ * @pre out doesn't alias rhs
+ */
+void batchMultiply(const glm::mat4& lhs, const glm::mat4* rhs, glm::mat4* out, std::size_t count);
+
+/**
+ * @brief batchTransform : out[i] = m * in[i]. out is resized to in.size().
+ */
+void batchTransform(const glm::mat4& m, const Vec4SoA& in, Vec4SoA& out);
+
+/**
+ * @brief batchComposeTRS : out[i] = translate(t[i]) * mat4_cast(r[i]) * scale(s[i])
+ * @pre out points to at least trs.size() matrices
+ */
+void batchComposeTRS(const TransformSoA& trs, glm::mat4* out);
+
+/**
+ * @brief batchTransformAABB : computes the axis-aligned box enclosing each in[i] transformed by matrices[i]
+ * @pre matrices points to at least in.size() matrices
+ *
+ * out is resized to in.size(). Uses the center/extent formulation, so boxes stay tight for affine matrices.
+ */
+void batchTransformAABB(const glm::mat4* matrices, const AABBSoA& in, AABBSoA& out);
+
+/** @} */
+
+#endif // SIMDMATH_H
@@ -0,0 +1,176 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Block compression : encoded blocks decode back close to the source, with reference BC1 / BC4 decoders.
+ */
+#include "../bcencoder.h"
+#include "../jobsystem.h"
+#include "test.h"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+void decodeColor565(unsigned int color, int* rgb) {
+    rgb[0] = (color >> 11 & 31) * 255 / 31;
+    rgb[1] = (color >> 5 & 63) * 255 / 63;
+    rgb[2] = (color & 31) * 255 / 31;
+}
+
+/** Color part of BC1 and BC3, writing RGBA texels. BC3 always uses the four color mode. */
+void decodeColorBlock(const unsigned char* block, bool alwaysFourColors, unsigned char* rgba) {
+    const unsigned int color0 = block[0] | block[1] << 8, color1 = block[2] | block[3] << 8;
+    int palette[4][4];
+    decodeColor565(color0, palette[0]);
+    decodeColor565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    for (int c = 0; c < 3; ++c) {
+        if (color0 > color1 || alwaysFourColors) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    if (color0 <= color1 && !alwaysFourColors)
+        palette[3][3] = 0;
+    const std::uint32_t indices = block[4] | block[5] << 8 | block[6] << 16 | static_cast<std::uint32_t>(block[7]) << 24;
+    for (int texel = 0; texel < 16; ++texel)
+        for (int c = 0; c < 4; ++c)
+            rgba[texel * 4 + c] = static_cast<unsigned char>(palette[indices >> (2 * texel) & 3][c]);
+}
+
+/** BC4 block, written to one channel of RGBA texels */
+void decodeChannelBlock(const unsigned char* block, int channel, unsigned char* rgba) {
+    const int value0 = block[0], value1 = block[1];
+    int palette[8] = {value0, value1};
+    for (int i = 1; i < 7; ++i) {
+        if (value0 > value1)
+            palette[i + 1] = ((7 - i) * value0 + i * value1) / 7;
+        else if (i < 5)
+            palette[i + 1] = ((5 - i) * value0 + i * value1) / 5;
+    }
+    if (value0 <= value1) {
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    std::uint64_t indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= static_cast<std::uint64_t>(block[2 + i]) << (8 * i);
+    for (int texel = 0; texel < 16; ++texel)
+        rgba[texel * 4 + channel] = static_cast<unsigned char>(palette[indices >> (3 * texel) & 7]);
+}
+
+/** Smooth gradients, as in most textures, with a hard edge every few blocks */
+std::vector<unsigned char> makeImage(unsigned int width, unsigned int height) {
+    std::vector<unsigned char> rgba(width * height * 4);
+    for (unsigned int y = 0; y < height; ++y)
+        for (unsigned int x = 0; x < width; ++x) {
+            unsigned char* texel = &rgba[(y * width + x) * 4];
+            texel[0] = static_cast<unsigned char>(x * 255 / (width - 1));
+            texel[1] = static_cast<unsigned char>(y * 255 / (height - 1));
+            texel[2] = static_cast<unsigned char>((x / 6 + y / 6) % 2 ? 200 : 40);
+            texel[3] = static_cast<unsigned char>(128 + 127 * std::sin(x * 0.3f + y * 0.2f));
+        }
+    return rgba;
+}
+
+/** Root mean square error over the given channels, block by block through decode */
+template <class Decode>
+double roundTripError(const std::vector<unsigned char>& image, unsigned int size, BlockFormat format, int firstChannel,
+                      int channelCount, Decode decode) {
+    std::vector<unsigned char> block(blockBytes(format));
+    double sum = 0;
+    for (unsigned int by = 0; by < size; by += 4)
+        for (unsigned int bx = 0; bx < size; bx += 4) {
+            unsigned char texels[64], decoded[64] = {};
+            for (unsigned int i = 0; i < 16; ++i)
+                for (int c = 0; c < 4; ++c)
+                    texels[i * 4 + c] = image[((by + i / 4) * size + bx + i % 4) * 4 + c];
+            switch (format) {
+            case BlockFormat::BC1: encodeBC1(texels, block.data()); break;
+            case BlockFormat::BC3: encodeBC3(texels, block.data()); break;
+            case BlockFormat::BC5: encodeBC5(texels, block.data()); break;
+            default: break;
+            }
+            decode(block.data(), decoded);
+            for (unsigned int i = 0; i < 16; ++i)
+                for (int c = firstChannel; c < firstChannel + channelCount; ++c) {
+                    const double difference = double(decoded[i * 4 + c]) - texels[i * 4 + c];
+                    sum += difference * difference;
+                }
+        }
+    return std::sqrt(sum / (size * size * channelCount));
+}
+
+} // namespace
+
+int main() {
+    const unsigned int size = 64;
+    const std::vector<unsigned char> image = makeImage(size, size);
+
+    const double bc1 = roundTripError(image, size, BlockFormat::BC1, 0, 3, [](const unsigned char* block, unsigned char* rgba) {
+        decodeColorBlock(block, false, rgba);
+    });
+    const double bc3Color = roundTripError(image, size, BlockFormat::BC3, 0, 3, [](const unsigned char* block, unsigned char* rgba) {
+        decodeColorBlock(block + 8, true, rgba);
+    });
+    const double bc3Alpha = roundTripError(image, size, BlockFormat::BC3, 3, 1, [](const unsigned char* block, unsigned char* rgba) {
+        decodeChannelBlock(block, 3, rgba);
+    });
+    const double bc5 = roundTripError(image, size, BlockFormat::BC5, 0, 2, [](const unsigned char* block, unsigned char* rgba) {
+        decodeChannelBlock(block, 0, rgba);
+        decodeChannelBlock(block + 8, 1, rgba);
+    });
+    //Four levels per block for colors, eight for channels : the wavy alpha spans half the range in most blocks,
+    //the gradients of BC5 are exact but for rounding
+    CHECK(bc1 < 5.0);
+    CHECK(bc3Color < 5.0);
+    CHECK(bc3Alpha < 6.0);
+    CHECK(bc5 < 1.0);
+
+    //A solid block only loses the 565 quantization
+    unsigned char solid[64], block[16], decoded[64];
+    for (int i = 0; i < 16; ++i) {
+        solid[i * 4] = 200;
+        solid[i * 4 + 1] = 100;
+        solid[i * 4 + 2] = 50;
+        solid[i * 4 + 3] = 255;
+    }
+    encodeBC1(solid, block);
+    decodeColorBlock(block, false, decoded);
+    bool close = true;
+    for (int i = 0; i < 64; ++i)
+        close = close && std::abs(int(decoded[i]) - int(solid[i])) <= 4;
+    CHECK(close);
+
+    //Sizes that aren't a multiple of 4 are padded to whole blocks
+    JobSystem jobs(2);
+    const std::vector<unsigned char> odd = makeImage(10, 6);
+    CHECK(compressImage(odd.data(), 10, 6, BlockFormat::BC1, jobs).size() == 3 * 2 * 8);
+    CHECK(compressImage(odd.data(), 10, 6, BlockFormat::BC5, jobs).size() == 3 * 2 * 16);
+    return testResult();
+}
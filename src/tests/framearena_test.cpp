@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Frame arenas : alignment, reuse after reset, growth after an overflow and frame vectors moving between arenas.
+ */
+#include "../framearena.h"
+#include "test.h"
+#include <cstdint>
+
+namespace {
+
+bool aligned(const void* pointer, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(pointer) % alignment == 0;
+}
+
+} // namespace
+
+int main() {
+    {
+        LinearArena arena(1024);
+        char* byte = static_cast<char*>(arena.allocate(1, 1));
+        void* wide = arena.allocate(8, 64);
+        CHECK(aligned(wide, 64));
+        CHECK(aligned(arena.allocate<double>(3), alignof(double)));
+        CHECK(arena.stats().allocations == 3 && arena.stats().overflows == 0);
+
+        //Only the last allocation is given back
+        char* last = static_cast<char*>(arena.allocate(16, 1));
+        arena.deallocate(last, 16);
+        CHECK(arena.allocate(16, 1) == last);
+        arena.deallocate(wide, 8);
+        CHECK(arena.allocate(16, 1) != wide);
+
+        arena.reset();
+        CHECK(arena.stats().allocations == 0);
+        CHECK(arena.allocate(1, 1) == byte);
+    }
+    {
+        //Overflows go to the heap, and the block grows at the reset to fit the same frame
+        LinearArena arena(256);
+        void* inside = arena.allocate(200);
+        void* outside = arena.allocate(300, 32);
+        CHECK(inside != nullptr && aligned(outside, 32));
+        CHECK(arena.stats().overflows == 1 && arena.stats().used >= 500);
+        arena.reset();
+        CHECK(arena.stats().capacity >= 500 && arena.stats().peak >= 500);
+        arena.allocate(200);
+        arena.allocate(300, 32);
+        CHECK(arena.stats().overflows == 0);
+    }
+    {
+        //Two arenas used in turn : memory of a frame is still valid during the next one
+        FrameArena frames(4096);
+        frames.beginFrame();
+        LinearArena* previous = &frames.current();
+        unsigned int* kept = static_cast<unsigned int*>(frames.allocate(sizeof(unsigned int)));
+        *kept = 42;
+        frames.beginFrame();
+        CHECK(&frames.current() != previous);
+        frames.allocate(64);
+        CHECK(*kept == 42);
+        CHECK(frames.lastFrame().allocations == 1);
+        frames.beginFrame();
+        CHECK(&frames.current() == previous && frames.current().stats().allocations == 0);
+    }
+    {
+        //Assigning a new vector moves a member to the arena of the current frame
+        FrameArena& frames = FrameArena::global();
+        frames.beginFrame();
+        FrameVector<int> values;
+        values.reserve(16);
+        values.push_back(1);
+        frames.beginFrame();
+        values = FrameVector<int>();
+        values.reserve(16);
+        CHECK(values.get_allocator() == ArenaAllocator<int>(frames.current()));
+        CHECK(frames.current().stats().allocations == 1);
+    }
+    return testResult();
+}
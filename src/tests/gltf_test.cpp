@@ -0,0 +1,149 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Validation of glTF files : malformed hierarchies, buffers, views and accessors must be rejected, and only the
+ * nodes of the default scene get a world matrix.
+ */
+#include "../gltfloader.h"
+#include "test.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+GltfDocument load(const std::string& nodes, const std::string& scenes = "") {
+    std::string json = "{\"asset\":{\"version\":\"2.0\"},\"nodes\":" + nodes;
+    if (!scenes.empty())
+        json += ",\"scenes\":" + scenes;
+    json += "}";
+    return loadGltf(writeTestFile("gltf_test.gltf", json));
+}
+
+//16 bytes buffer, as a data URI
+const std::string buffer16 = "[{\"byteLength\":16,\"uri\":\"data:application/octet-stream;base64,AAAAAAAAAAAAAAAAAAAAAA==\"}]";
+
+GltfDocument loadBuffers(const std::string& buffers, const std::string& views, const std::string& accessors = "[]") {
+    return loadGltf(writeTestFile("gltf_test.gltf", "{\"asset\":{\"version\":\"2.0\"},\"buffers\":" + buffers
+                                  + ",\"bufferViews\":" + views + ",\"accessors\":" + accessors + "}"));
+}
+
+GltfDocument loadMembers(const std::string& members) {
+    return loadGltf(writeTestFile("gltf_test.gltf", "{\"asset\":{\"version\":\"2.0\"}," + members + "}"));
+}
+
+std::string accessor(const std::string& count, const std::string& extra = "") {
+    return "[{\"bufferView\":0,\"componentType\":5126,\"type\":\"VEC4\",\"count\":" + count + extra + "}]";
+}
+
+std::string glb(std::uint32_t version, std::uint32_t length, const std::string& chunks) {
+    std::string bytes = "glTF";
+    bytes.append(reinterpret_cast<const char*>(&version), 4);
+    bytes.append(reinterpret_cast<const char*>(&length), 4);
+    return writeTestFile("gltf_test.glb", bytes + chunks);
+}
+
+} // namespace
+
+int main() {
+    //Valid tree, parent listed after its child
+    GltfDocument doc = load("[{\"translation\":[1,0,0]},{\"children\":[0],\"translation\":[0,2,0]},{}]",
+                            "[{\"nodes\":[1]}]");
+    CHECK(doc.sceneRoots.size() == 1 && doc.sceneRoots[0] == 1);
+    CHECK(doc.nodes[0].parent == 1);
+    CHECK(doc.nodes[0].inScene && doc.nodes[1].inScene);
+    CHECK(!doc.nodes[2].inScene); //Not part of the scene
+    CHECK(doc.nodes[0].world[3][0] == 1.0f && doc.nodes[0].world[3][1] == 2.0f);
+
+    //Three levels, with more siblings than one SIMD batch holds
+    doc = load("[{\"children\":[1],\"translation\":[1,0,0],\"scale\":[2,2,2]},{\"children\":[2,3,4,5,6],\"translation\":[0,1,0]},"
+               "{\"translation\":[0,0,0]},{\"translation\":[1,0,0]},{\"translation\":[2,0,0]},{\"translation\":[3,0,0]},"
+               "{\"translation\":[4,0,0]}]");
+    bool worlds = true;
+    for (int i = 0; i < 5; ++i)
+        worlds = worlds && doc.nodes[2 + i].inScene && doc.nodes[2 + i].world[3] == glm::vec4(1.0f + 2.0f * i, 2.0f, 0.0f, 1.0f)
+                && doc.nodes[2 + i].world[0][0] == 2.0f;
+    CHECK(worlds);
+
+    //Without scenes, every parentless node is a root
+    doc = load("[{\"children\":[1]},{},{}]");
+    CHECK(doc.sceneRoots.size() == 2);
+    CHECK(doc.nodes[0].inScene && doc.nodes[1].inScene && doc.nodes[2].inScene);
+
+    CHECK_THROWS(load("[{\"children\":[0]}]")); //Self loop
+    CHECK_THROWS(load("[{\"children\":[2]},{\"children\":[2]},{}]")); //Two parents
+    CHECK_THROWS(load("[{\"children\":[1]},{\"children\":[0]}]")); //Cycle without roots
+    CHECK_THROWS(load("[{\"children\":[1]},{\"children\":[0]}]", "[{\"nodes\":[0]}]")); //Cycle given as a root
+    CHECK_THROWS(load("[{},{\"children\":[2]},{\"children\":[3]},{\"children\":[1]}]")); //Cycle beside a root
+    CHECK_THROWS(load("[{\"children\":[1]},{}]", "[{\"nodes\":[1]}]")); //Scene root with a parent
+    CHECK_THROWS(load("[{}]", "[{\"nodes\":[0,0]}]")); //Root listed twice
+    CHECK_THROWS(load("[{\"children\":[5]}]")); //Out of range
+    CHECK_THROWS(load("[{\"children\":[null]}]"));
+
+    //Buffers, views and accessors
+    doc = loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]", accessor("1"));
+    CHECK(doc.accessors.size() == 1 && doc.accessors[0].count == 1);
+    CHECK_THROWS(loadBuffers("[{\"byteLength\":32,\"uri\":\"data:application/octet-stream;base64,AAAA\"}]", "[]"));
+    CHECK_THROWS(loadBuffers("[{\"byteLength\":3,\"uri\":\"data:application/octet-stream;base64,A*A=\"}]", "[]"));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteOffset\":8,\"byteLength\":16}]"));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteOffset\":18446744073709549568,\"byteLength\":2048}]")); //Wraps to 0
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":1,\"byteLength\":16}]"));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]", accessor("2")));
+    CHECK_THROWS(loadBuffers(buffer16, "[]", "[{\"componentType\":5126,\"type\":\"VEC4\",\"count\":0}]"));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]", accessor("1", ",\"byteOffset\":4")));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]", accessor("4611686018427387904"))); //Wraps to 0 bytes
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]", accessor("1e30")));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]",
+                             "[{\"bufferView\":0,\"componentType\":5127,\"type\":\"VEC4\",\"count\":1}]"));
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]",
+                             "[{\"componentType\":5126,\"type\":\"VEC4\",\"count\":4611686018427387904}]"));
+    //Sparse indices and values past their view, their sizes wrapping to 0
+    CHECK_THROWS(loadBuffers(buffer16, "[{\"buffer\":0,\"byteLength\":16}]",
+                             "[{\"componentType\":5126,\"type\":\"VEC4\",\"count\":1,\"sparse\":{\"count\":4611686018427387904,"
+                             "\"indices\":{\"bufferView\":0,\"componentType\":5125},\"values\":{\"bufferView\":0}}}]"));
+
+    //Indices into other arrays and enumerations
+    const std::string image = "\"images\":[{\"uri\":\"image.png\"}],";
+    CHECK(loadMembers(image + "\"samplers\":[{}],\"textures\":[{\"source\":0,\"sampler\":0}]").textures[0].sampler == 0);
+    CHECK_THROWS(loadMembers(image + "\"textures\":[{\"source\":0,\"sampler\":0}]"));
+    CHECK_THROWS(loadMembers(image + "\"samplers\":[{}],\"textures\":[{\"source\":0,\"sampler\":-2}]"));
+    const std::string positions = "\"buffers\":" + buffer16 + ",\"bufferViews\":[{\"buffer\":0,\"byteLength\":16}],"
+            "\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"type\":\"VEC3\",\"count\":1}],";
+    CHECK(loadMembers(positions + "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"mode\":6}]}]")
+          .meshes[0].primitives[0].mode == 6);
+    CHECK_THROWS(loadMembers(positions + "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"mode\":7}]}]"));
+    CHECK_THROWS(loadMembers(positions + "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0},\"mode\":-1}]}]"));
+
+    //GLB containers
+    const std::string json = "{\"asset\":{\"version\":\"2.0\"}}";
+    std::string chunk(8, '\0');
+    const std::uint32_t jsonChunk[2] = {static_cast<std::uint32_t>(json.size()), 0x4E4F534Au};
+    std::memcpy(&chunk[0], jsonChunk, 8);
+    CHECK(loadGltf(glb(2, static_cast<std::uint32_t>(12 + chunk.size() + json.size()), chunk + json)).nodes.empty());
+    CHECK_THROWS(loadGltf(glb(1, static_cast<std::uint32_t>(12 + chunk.size() + json.size()), chunk + json)));
+    CHECK_THROWS(loadGltf(glb(2, 1000, chunk + json.substr(0, 10)))); //Truncated chunk
+    CHECK_THROWS(loadGltf(glb(2, 12, chunk + json))); //Length ends before the JSON chunk
+    CHECK_THROWS(loadGltf(glb(2, 1000, ""))); //Truncated header
+    return testResult();
+}
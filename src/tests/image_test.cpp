@@ -0,0 +1,158 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Image decoding : zlib streams with stored, fixed and dynamic Huffman blocks, PNG filters and palettes, and
+ * rejection of corrupt input. The compressed data was produced by zlib.
+ */
+#include "../image.h"
+#include "test.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+//"abracadabra abracadabra", fixed Huffman codes
+const unsigned char fixedStream[] = {
+    0x78, 0x01, 0x4b, 0x4c, 0x2a, 0x4a, 0x4c, 0x4e, 0x4c, 0x49, 0x04, 0x52, 0x0a, 0x89, 0x08, 0x36, 0x00, 0x69,
+    0x55, 0x08, 0xc9
+};
+
+//The squares of 0 to 49 separated by spaces, dynamic Huffman codes
+const unsigned char dynamicStream[] = {
+    0x78, 0xda, 0x15, 0x8e, 0xd1, 0x15, 0x00, 0x20, 0x08, 0x02, 0x57, 0x61, 0x04, 0x31, 0x32, 0xdd, 0x7f, 0xb1,
+    0xf0, 0x8b, 0x57, 0x9e, 0x78, 0x01, 0x42, 0x18, 0xb0, 0x90, 0x17, 0xa7, 0xa0, 0x41, 0x09, 0x4d, 0x30, 0x02,
+    0x4c, 0xa7, 0xe4, 0xa9, 0x89, 0x31, 0x62, 0x26, 0xaf, 0xb3, 0x07, 0x27, 0x65, 0xde, 0xdb, 0xe6, 0x24, 0x67,
+    0x0b, 0x37, 0x07, 0xf7, 0x15, 0xca, 0x5c, 0x39, 0x9f, 0xdf, 0xcf, 0xff, 0xed, 0xf9, 0x98, 0x9b, 0xda, 0x5e,
+    0x2f, 0x32, 0xdc, 0x40, 0xba, 0x8a, 0xdb, 0xc9, 0x74, 0x39, 0xcf, 0x5e, 0xd1, 0x9e, 0xbb, 0x7b, 0xb7, 0x56,
+    0xa0, 0xd6, 0xe4, 0xd9, 0x88, 0xad, 0x75, 0xb0, 0x61, 0xc6, 0x5a, 0x70, 0x8d, 0x33, 0x06, 0x79, 0x42, 0x48,
+    0x05, 0x3f, 0xb7, 0xba, 0x25, 0x47
+};
+
+//5x5 RGBA, row y filtered with filter type y (none, sub, up, average, Paeth)
+const unsigned char filteredPng[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00,
+    0x00, 0x05, 0x00, 0x00, 0x00, 0x05, 0x08, 0x06, 0x00, 0x00, 0x00, 0x8d, 0x6f, 0x26, 0xe5, 0x00, 0x00, 0x00,
+    0x57, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x63, 0x60, 0x60, 0x60, 0xf8, 0x6f, 0xc4, 0xc0, 0xf0, 0x35, 0x85,
+    0x81, 0xe1, 0xf5, 0x34, 0x06, 0x86, 0x87, 0x27, 0x18, 0x18, 0xae, 0x33, 0xb2, 0xdb, 0x80, 0x04, 0x79, 0xbf,
+    0x21, 0x63, 0x26, 0xa0, 0x20, 0x03, 0xbb, 0x0d, 0x2f, 0x10, 0x4b, 0x01, 0xb1, 0x3a, 0x10, 0x9b, 0x30, 0x30,
+    0xf3, 0x55, 0x30, 0x34, 0xc8, 0xca, 0x49, 0xfd, 0x96, 0x95, 0x53, 0x04, 0x62, 0x75, 0x20, 0xd6, 0xfb, 0xcd,
+    0x02, 0x56, 0xc9, 0x00, 0x54, 0xc9, 0x00, 0x54, 0xc9, 0x00, 0x54, 0xc9, 0x60, 0xc2, 0x00, 0x00, 0x44, 0xdc,
+    0x15, 0xcc, 0x71, 0x95, 0xbb, 0xf2, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+};
+
+//3x2, 2 bits per pixel palette
+const unsigned char palettePng[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52, 0x00, 0x00,
+    0x00, 0x03, 0x00, 0x00, 0x00, 0x02, 0x02, 0x03, 0x00, 0x00, 0x00, 0xe0, 0x1a, 0x8e, 0x89, 0x00, 0x00, 0x00,
+    0x0c, 0x50, 0x4c, 0x54, 0x45, 0xff, 0x00, 0x00, 0x00, 0xff, 0x00, 0x00, 0x00, 0xff, 0x0a, 0x14, 0x1e, 0x22,
+    0x88, 0x29, 0x04, 0x00, 0x00, 0x00, 0x0c, 0x49, 0x44, 0x41, 0x54, 0x78, 0x9c, 0x63, 0x90, 0x60, 0x78, 0x02,
+    0x00, 0x01, 0x30, 0x00, 0xfd, 0x56, 0xcd, 0x1c, 0x73, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae,
+    0x42, 0x60, 0x82
+};
+
+std::string squares() {
+    std::string text;
+    for (int i = 0; i < 50; ++i)
+        text += (i > 0 ? " " : "") + std::to_string(i * i);
+    return text;
+}
+
+std::string inflated(const unsigned char* data, std::size_t size) {
+    std::vector<unsigned char> result = inflateZlib(data, size);
+    return std::string(result.begin(), result.end());
+}
+
+bool hasPixel(const Image& image, unsigned int x, unsigned int y, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    const unsigned char* p = image.pixel(x, y);
+    return p[0] == r && p[1] == g && p[2] == b && p[3] == a;
+}
+
+} // namespace
+
+//Corrupt sizes must be reported like any other decoding error, not as std::bad_alloc
+bool rejectsSize(std::vector<unsigned char> png, unsigned int width, unsigned int height) {
+    for (int i = 0; i < 4; ++i) {
+        png[16 + i] = static_cast<unsigned char>(width >> (24 - 8 * i));
+        png[20 + i] = static_cast<unsigned char>(height >> (24 - 8 * i));
+    }
+    try {
+        decodePng(png.data(), png.size());
+    } catch (const std::runtime_error&) {
+        return true;
+    } catch (...) {
+    }
+    return false;
+}
+
+int main() {
+    CHECK(inflated(fixedStream, sizeof(fixedStream)) == "abracadabra abracadabra");
+    CHECK(inflated(dynamicStream, sizeof(dynamicStream)) == squares());
+
+    //Stored block
+    const unsigned char stored[] = {0x78, 0x01, 0x01, 0x05, 0x00, 0xfa, 0xff, 'h', 'e', 'l', 'l', 'o', 0x06, 0x2c, 0x02, 0x15};
+    CHECK(inflated(stored, sizeof(stored)) == "hello");
+    unsigned char badLength[sizeof(stored)];
+    std::copy(stored, stored + sizeof(stored), badLength);
+    badLength[5] = 0; //NLEN isn't the complement of LEN
+    CHECK_THROWS(inflateZlib(badLength, sizeof(badLength)));
+
+    CHECK_THROWS(inflateZlib(dynamicStream, sizeof(dynamicStream) / 2));
+    const unsigned char badHeader[] = {0x78, 0x02, 0x01, 0x00, 0x00, 0xff, 0xff};
+    CHECK_THROWS(inflateZlib(badHeader, sizeof(badHeader)));
+    const unsigned char badBlockType[] = {0x78, 0x01, 0x07, 0x00};
+    CHECK_THROWS(inflateZlib(badBlockType, sizeof(badBlockType)));
+
+    const Image image = decodePng(filteredPng, sizeof(filteredPng));
+    CHECK(image.width == 5 && image.height == 5 && image.pixels.size() == 5 * 5 * 4);
+    bool matches = image.pixels.size() == 5 * 5 * 4;
+    for (unsigned int y = 0; y < 5 && matches; ++y)
+        for (unsigned int x = 0; x < 5; ++x)
+            matches = matches && hasPixel(image, x, y, (x * 50 + y * 7) % 256, (y * 60) % 256, (x * y * 13) % 256, 255 - x * 10);
+    CHECK(matches);
+
+    const Image palette = decodePng(palettePng, sizeof(palettePng));
+    CHECK(palette.width == 3 && palette.height == 2);
+    CHECK(palette.pixels.size() == 3 * 2 * 4 && hasPixel(palette, 0, 0, 255, 0, 0, 255) && hasPixel(palette, 1, 0, 0, 255, 0, 255)
+          && hasPixel(palette, 2, 0, 0, 0, 255, 255) && hasPixel(palette, 0, 1, 10, 20, 30, 255) && hasPixel(palette, 2, 1, 0, 255, 0, 255));
+
+    //Corrupt files
+    std::vector<unsigned char> png(filteredPng, filteredPng + sizeof(filteredPng));
+    CHECK_THROWS(decodePng(png.data(), 40));
+    std::vector<unsigned char> notPng = png;
+    notPng[1] = 'X';
+    CHECK_THROWS(decodePng(notPng.data(), notPng.size()));
+    std::vector<unsigned char> interlaced = png;
+    interlaced[28] = 1;
+    CHECK_THROWS(decodePng(interlaced.data(), interlaced.size()));
+    std::vector<unsigned char> badColorType = png;
+    badColorType[25] = 5;
+    CHECK_THROWS(decodePng(badColorType.data(), badColorType.size()));
+    CHECK(rejectsSize(png, 5, 0x7fffffff));
+    CHECK(rejectsSize(png, 0xffffffff, 0xffffffff));
+    CHECK(rejectsSize(png, maxImageSize + 1, 5));
+    CHECK(rejectsSize(png, maxImageSize, maxImageSize)); //Within the limits, but far more than the data holds
+    return testResult();
+}
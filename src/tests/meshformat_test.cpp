@@ -0,0 +1,124 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Loading of .e3dmesh files : a valid file round-trips, corrupted headers and indices are rejected.
+ */
+#include "../meshformat.h"
+#include "test.h"
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+MeshData makeQuad() {
+    MeshData mesh;
+    for (int i = 0; i < 4; ++i)
+        mesh.vertices.push_back({glm::vec3(i & 1, i >> 1, 0), glm::vec3(0, 0, 1), glm::vec2(i & 1, i >> 1)});
+    mesh.indices = {0, 1, 3, 0, 3, 2};
+    mesh.computeBounds();
+    return mesh;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+//Writes a copy of the valid file changed by corrupt
+std::string corrupted(const std::string& valid, const std::function<void(std::string&)>& corrupt) {
+    std::string bytes = valid;
+    corrupt(bytes);
+    return writeTestFile("meshformat_test_corrupt.e3dmesh", bytes);
+}
+
+template <class T>
+void poke(std::string& bytes, std::size_t offset, T value) {
+    std::memcpy(&bytes[offset], &value, sizeof(T));
+}
+
+MeshFileHeader header(const std::string& bytes) {
+    MeshFileHeader result;
+    std::memcpy(&result, bytes.data(), sizeof(result));
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const MeshData quad = makeQuad();
+    writeMeshFile("meshformat_test.e3dmesh", quad, {{{0, 1, 3}, 0.5f}});
+    {
+        MeshFile file("meshformat_test.e3dmesh");
+        CHECK(file.header().vertexCount == 4 && file.header().lodCount == 2);
+        MeshData loaded = file.toMeshData();
+        CHECK(loaded.indices == quad.indices);
+        CHECK(loaded.vertices.size() == 4 && loaded.vertices[3].position == quad.vertices[3].position);
+    }
+
+    const std::string valid = readFile("meshformat_test.e3dmesh");
+    const MeshFileHeader head = header(valid);
+    const std::size_t attributes = sizeof(MeshFileHeader);
+    const std::size_t lods = attributes + head.attributeCount * sizeof(MeshFileAttribute);
+
+    CHECK_THROWS(MeshFile(writeTestFile("meshformat_test_corrupt.e3dmesh", valid.substr(0, 16))));
+    CHECK_THROWS(MeshFile(corrupted(valid, [](std::string& b) { b[0] = 'X'; })));
+    //Offsets and sizes whose sum wraps around
+    CHECK_THROWS(MeshFile(corrupted(valid, [](std::string& b) {
+        poke<std::uint64_t>(b, offsetof(MeshFileHeader, indexDataOffset), std::numeric_limits<std::uint64_t>::max() - 7);
+    })));
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        poke<std::uint64_t>(b, offsetof(MeshFileHeader, indexDataSize), std::numeric_limits<std::uint64_t>::max() - head.indexDataOffset + 2);
+    })));
+    //Attribute ending past the stride, or of an unknown type
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        poke<std::uint32_t>(b, attributes + 2 * sizeof(MeshFileAttribute) + offsetof(MeshFileAttribute, offset), head.vertexStride - 4);
+    })));
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        poke<std::uint32_t>(b, attributes + offsetof(MeshFileAttribute, type), 0x1234);
+    })));
+    //LOD past the index blob
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        poke<std::uint32_t>(b, lods + sizeof(MeshFileLod) + offsetof(MeshFileLod, indexCount), 1000);
+    })));
+    //LODs that don't hold whole triangles
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        poke<std::uint32_t>(b, lods + offsetof(MeshFileLod, indexCount), 5);
+    })));
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        poke<std::uint32_t>(b, lods + sizeof(MeshFileLod) + offsetof(MeshFileLod, indexCount), 2);
+    })));
+    //Index referencing a vertex which doesn't exist
+    CHECK_THROWS(MeshFile(corrupted(valid, [&](std::string& b) {
+        if (head.indexSize == 2)
+            poke<std::uint16_t>(b, head.indexDataOffset + 2 * 2, 4);
+        else
+            poke<std::uint32_t>(b, head.indexDataOffset + 4 * 2, 4);
+    })));
+    return testResult();
+}
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Meshlets : limits are respected, every triangle lands in exactly one meshlet, and culling keeps the front side.
+ */
+#include "../meshlet.h"
+#include "../frustum.h"
+#include "test.h"
+#include <algorithm>
+#include <array>
+#include <glm/geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace {
+
+const unsigned int gridSize = 64; //Quads per side, facing +z
+
+MeshData makeGrid() {
+    MeshData mesh;
+    for (unsigned int y = 0; y <= gridSize; ++y)
+        for (unsigned int x = 0; x <= gridSize; ++x)
+            mesh.vertices.push_back({glm::vec3(x, y, 0), glm::vec3(0, 0, 1), glm::vec2(0.0f)});
+    for (unsigned int y = 0; y < gridSize; ++y)
+        for (unsigned int x = 0; x < gridSize; ++x) {
+            unsigned int corner = y * (gridSize + 1) + x;
+            mesh.indices.insert(mesh.indices.end(), {corner, corner + 1, corner + gridSize + 2,
+                                                     corner, corner + gridSize + 2, corner + gridSize + 1});
+        }
+    mesh.computeBounds();
+    return mesh;
+}
+
+std::vector<std::array<unsigned int, 3>> sortedTriangles(const unsigned int* indices, std::size_t count) {
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (std::size_t t = 0; t < count; t += 3) {
+        std::array<unsigned int, 3> triangle = {indices[t], indices[t + 1], indices[t + 2]};
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+Frustum frustumFrom(const glm::vec3& eye) {
+    const glm::vec3 center(gridSize / 2.0f, gridSize / 2.0f, 0.0f);
+    return Frustum(glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 1000.0f) * glm::lookAt(eye, center, glm::vec3(0, 1, 0)));
+}
+
+} // namespace
+
+int main() {
+    const MeshData grid = makeGrid();
+    for (unsigned int maxVertices : {meshletMaxVertices, 32u, 3u}) {
+        const unsigned int maxTriangles = maxVertices == 3 ? 1 : meshletMaxTriangles;
+        const MeshletData data = buildMeshlets(grid, grid.indices, maxVertices, maxTriangles);
+        CHECK(data.triangleCount() == grid.triangleCount());
+
+        std::vector<unsigned int> indices;
+        bool withinLimits = true, bounded = true;
+        for (const Meshlet& meshlet : data.meshlets) {
+            withinLimits = withinLimits && meshlet.vertexCount <= maxVertices && meshlet.triangleCount <= maxTriangles
+                    && meshlet.triangleCount > 0;
+            for (unsigned int i = 0; i < 3 * meshlet.triangleCount; ++i) {
+                const std::uint8_t local = data.triangles[3 * meshlet.triangleOffset + i];
+                withinLimits = withinLimits && local < meshlet.vertexCount;
+                const unsigned int vertex = data.vertices[meshlet.vertexOffset + local];
+                bounded = bounded && glm::length(grid.vertices[vertex].position - meshlet.center) <= meshlet.radius * 1.0001f;
+                indices.push_back(vertex);
+            }
+        }
+        CHECK(withinLimits);
+        CHECK(bounded);
+        CHECK(sortedTriangles(indices.data(), indices.size()) == sortedTriangles(grid.indices.data(), grid.indices.size()));
+        //Meshlets are filled : 64 vertices of a grid hold up to about 100 triangles
+        if (maxVertices == meshletMaxVertices)
+            CHECK(data.meshlets.size() < grid.triangleCount() / 64);
+    }
+    CHECK_THROWS(buildMeshlets(grid, grid.indices, 257, meshletMaxTriangles));
+    CHECK_THROWS(buildMeshlets(grid, grid.indices, 2, meshletMaxTriangles));
+
+    //Seen from the front everything is kept, from behind the normal cones reject everything
+    const MeshletData data = buildMeshlets(grid, grid.indices);
+    FrameVector<unsigned int> visibleIndices;
+    const glm::vec3 above(gridSize / 2.0f, gridSize / 2.0f, 50.0f), below(gridSize / 2.0f, gridSize / 2.0f, -50.0f);
+    CHECK(cullMeshlets(data, frustumFrom(above), above, visibleIndices) == data.meshlets.size());
+    CHECK(sortedTriangles(visibleIndices.data(), visibleIndices.size()) == sortedTriangles(grid.indices.data(), grid.indices.size()));
+    CHECK(cullMeshlets(data, frustumFrom(below), below, visibleIndices) == 0 && visibleIndices.empty());
+    //Looking away, the frustum rejects everything
+    const Frustum away(glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f)
+                       * glm::lookAt(above, above + glm::vec3(0, 0, 1), glm::vec3(0, 1, 0)));
+    CHECK(cullMeshlets(data, away, above, visibleIndices) == 0);
+    return testResult();
+}
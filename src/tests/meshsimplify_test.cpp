@@ -0,0 +1,111 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Simplification : the error is a distance relative to the mesh size, so scaling a mesh scales nothing else.
+ */
+#include "../meshsimplify.h"
+#include "test.h"
+#include <cmath>
+#include <map>
+#include <utility>
+#include <glm/geometric.hpp>
+
+namespace {
+
+/** Closed sphere without seams, from a subdivided icosahedron */
+MeshData makeIcosphere(unsigned int subdivisions, float radius) {
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    std::vector<glm::vec3> positions = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+    std::vector<unsigned int> indices = {
+        0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+        3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+    for (glm::vec3& p : positions)
+        p = glm::normalize(p);
+
+    for (unsigned int s = 0; s < subdivisions; ++s) {
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+        auto midpoint = [&](unsigned int a, unsigned int b) {
+            auto inserted = midpoints.emplace(std::make_pair(std::min(a, b), std::max(a, b)), 0);
+            if (inserted.second) {
+                inserted.first->second = static_cast<unsigned int>(positions.size());
+                positions.push_back(glm::normalize(positions[a] + positions[b]));
+            }
+            return inserted.first->second;
+        };
+        std::vector<unsigned int> subdivided;
+        for (std::size_t i = 0; i < indices.size(); i += 3) {
+            unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            subdivided.insert(subdivided.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+        }
+        indices.swap(subdivided);
+    }
+
+    MeshData mesh;
+    for (const glm::vec3& p : positions)
+        mesh.vertices.push_back({p * radius, p, glm::vec2(0.0f)});
+    mesh.indices = indices;
+    mesh.computeBounds();
+    return mesh;
+}
+
+bool close(float a, float b, float tolerance) {
+    return std::abs(a - b) <= tolerance * std::max(a, b);
+}
+
+} // namespace
+
+int main() {
+    //Same LOD chain, and the same relative errors, whatever the scale of the mesh. Power of two scales are exact
+    //in floating point and give the same collapses, others only break ties between equal costs differently.
+    std::vector<std::vector<MeshLodData>> chains;
+    for (float radius : {1.0f, 128.0f, 1.0f / 128.0f, 100.0f, 0.01f})
+        chains.push_back(generateLods(makeIcosphere(4, radius), 5));
+    CHECK(chains[0].size() == 5);
+    for (std::size_t c = 1; c < chains.size(); ++c) {
+        const bool exact = c <= 2;
+        CHECK(chains[c].size() == chains[0].size());
+        for (std::size_t l = 0; l < std::min(chains[c].size(), chains[0].size()); ++l) {
+            CHECK(chains[c][l].indices.size() == chains[0][l].indices.size());
+            CHECK(close(chains[c][l].error, chains[0][l].error, exact ? 1e-4f : 0.5f));
+        }
+    }
+    //The error of a unit sphere simplified to a few hundred triangles is a few percent of its size at most
+    for (std::size_t l = 0; l < chains[0].size(); ++l) {
+        CHECK(chains[0][l].error > 0.0f && chains[0][l].error < 0.05f);
+        CHECK(l == 0 || chains[0][l].error >= chains[0][l - 1].error);
+    }
+
+    //The error limit is honoured at any scale, by stopping early
+    for (float radius : {1.0f, 100.0f, 0.01f}) {
+        const MeshData sphere = makeIcosphere(4, radius);
+        float error = 0;
+        std::vector<unsigned int> indices = simplifyMesh(sphere, sphere.indices, 0, 0.001f, error);
+        CHECK(error <= 0.001f);
+        CHECK(indices.size() < sphere.indices.size() && indices.size() > 60 * 3);
+    }
+    return testResult();
+}
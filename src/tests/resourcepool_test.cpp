@@ -0,0 +1,100 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Resource pools : handles of released objects go stale at once, objects are destroyed after poolRetireFrames
+ * collections and their slots reused with a new generation.
+ */
+#include "../resourcepool.h"
+#include "test.h"
+#include <stdexcept>
+
+namespace {
+
+struct Counted
+{
+    explicit Counted(int value) : value(value) {++alive;}
+    ~Counted() {--alive;}
+
+    int value;
+    static int alive;
+};
+int Counted::alive = 0;
+
+struct Throwing
+{
+    Throwing() {throw std::runtime_error("Throwing");}
+};
+
+} // namespace
+
+int main() {
+    {
+        ResourcePool<Counted> pool;
+        Handle<Counted> first = pool.create(1), second = pool.create(2);
+        CHECK(first.valid() && first != second);
+        CHECK(pool.get(first)->value == 1 && pool.get(second)->value == 2);
+        CHECK(!pool.get(Handle<Counted>()));
+
+        //Stale at once, destroyed later
+        pool.release(first);
+        CHECK(!pool.contains(first) && pool.size() == 1 && pool.retiredCount() == 1);
+        pool.release(first); //Ignored
+        CHECK(pool.retiredCount() == 1);
+        for (unsigned int i = 1; i < poolRetireFrames; ++i) {
+            pool.collect();
+            CHECK(Counted::alive == 2);
+        }
+        pool.collect();
+        CHECK(Counted::alive == 1 && pool.retiredCount() == 0);
+
+        //The slot is reused with a new generation : the old handle doesn't see the new object
+        Handle<Counted> reused = pool.create(3);
+        CHECK(reused.index() == first.index() && reused.generation() != first.generation());
+        CHECK(!pool.get(first) && pool.get(reused)->value == 3);
+
+        //Objects don't move when the pool grows past a chunk
+        Counted* kept = pool.get(second);
+        for (int i = 0; i < 1000; ++i)
+            pool.create(i);
+        CHECK(pool.get(second) == kept && pool.size() == 1002);
+
+        int sum = 0;
+        std::size_t visited = 0;
+        pool.forEach([&](Handle<Counted> handle, const Counted& object) {
+            sum += object.value;
+            visited += pool.get(handle) == &object;
+        });
+        CHECK(visited == 1002 && sum == 2 + 3 + 999 * 1000 / 2);
+    }
+    CHECK(Counted::alive == 0);
+
+    {
+        //A throwing constructor doesn't leak its slot
+        ResourcePool<Throwing> pool;
+        CHECK_THROWS(pool.create());
+        CHECK_THROWS(pool.create());
+        CHECK(pool.size() == 0);
+    }
+    return testResult();
+}
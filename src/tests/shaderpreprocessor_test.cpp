@@ -0,0 +1,70 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Include resolution of the shader preprocessor : paths are normalized, so #pragma once and the list of files
+ * to watch don't depend on the path a file is included through.
+ */
+#include "../shaderpreprocessor.h"
+#include "test.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <sys/stat.h>
+
+//Defined in shader.cpp, which needs GL : the same thing without it
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("Could not open file : " + path);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+int main() {
+    CHECK(normalizePath("a/../b.glsl") == "b.glsl");
+    CHECK(normalizePath("./shaders//lib/./x.glsl") == "shaders/lib/x.glsl");
+    CHECK(normalizePath("shaders\\lib\\..\\x.glsl") == "shaders/x.glsl");
+    CHECK(normalizePath("../common/x.glsl") == "../common/x.glsl");
+    CHECK(normalizePath("a/../../x.glsl") == "../x.glsl");
+    CHECK(normalizePath("/usr/../x.glsl") == "/x.glsl");
+    CHECK(normalizePath("/../x.glsl") == "/x.glsl");
+
+    mkdir("preprocessor_test", 0755);
+    mkdir("preprocessor_test/lib", 0755);
+    writeTestFile("preprocessor_test/common.glsl", "#pragma once\nfloat common() { return 1.0; }\n");
+    writeTestFile("preprocessor_test/lib/util.glsl", "#include \"../common.glsl\"\nfloat util() { return common(); }\n");
+    writeTestFile("preprocessor_test/main.frag",
+                  "#version 330 core\n#include \"lib/util.glsl\"\n#include \"lib/../common.glsl\"\n#include \"./common.glsl\"\nvoid main() {}\n");
+
+    PreprocessedShader shader = preprocessShader("preprocessor_test/./main.frag");
+    CHECK(shader.files.size() == 3);
+    CHECK(shader.files[0] == "preprocessor_test/main.frag");
+    CHECK(std::count(shader.files.begin(), shader.files.end(), "preprocessor_test/common.glsl") == 1);
+    std::size_t first = shader.source.find("float common()");
+    CHECK(first != std::string::npos && shader.source.find("float common()", first + 1) == std::string::npos);
+
+    writeTestFile("preprocessor_test/loop.glsl", "#include \"lib/../loop.glsl\"\n");
+    CHECK_THROWS(preprocessShader("preprocessor_test/loop.glsl"));
+    return testResult();
+}
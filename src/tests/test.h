@@ -0,0 +1,82 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEST_H
+#define TEST_H
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+/** @defgroup Tests
+ * Minimal checks for the unit tests in src/tests. Each test is an executable registered with CTest, which fails
+ * (non-zero exit code) when a check doesn't hold.
+ * \code
+ * int main() {
+ *     CHECK(1 + 1 == 2);
+ *     CHECK_THROWS(loadMeshFile("corrupt.e3dmesh"));
+ *     return testResult();
+ * }
+ * \endcode
+ * @{ */
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void testCheck(bool condition, const char* expression, const char* file, int line) {
+    if (condition)
+        return;
+    std::fprintf(stderr, "%s:%d : check failed : %s\n", file, line, expression);
+    ++testFailures();
+}
+
+inline int testResult() {
+    if (testFailures() > 0)
+        std::fprintf(stderr, "%d check(s) failed\n", testFailures());
+    return testFailures() == 0 ? 0 : 1;
+}
+
+/**
+ * @brief writeTestFile : writes a file in the working directory of the test, for the loaders
+ * @return its path
+ */
+inline std::string writeTestFile(const std::string& name, const std::string& content) {
+    std::ofstream file(name, std::ios::binary);
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return name;
+}
+
+#define CHECK(condition) testCheck((condition), #condition, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expression) \
+    do { \
+        bool thrown = false; \
+        try { expression; } catch (const std::exception&) { thrown = true; } \
+        testCheck(thrown, "throws : " #expression, __FILE__, __LINE__); \
+    } while (false)
+
+/** @} */
+
+#endif // TEST_H
@@ -0,0 +1,74 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Texture containers : a valid KTX2 file loads, and level offsets, layer counts or sizes pointing out of the
+ * file are rejected before anything reads the images.
+ */
+#include "../ktx2.h"
+#include "../texturefile.h"
+#include "test.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace {
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+template <class T>
+std::string corrupted(const std::string& valid, std::size_t offset, T value) {
+    std::string bytes = valid;
+    std::memcpy(&bytes[offset], &value, sizeof(T));
+    return writeTestFile("texturefile_test_corrupt.ktx2", bytes);
+}
+
+} // namespace
+
+int main() {
+    //4x4 RGBA8, a single level
+    writeKtx2("texturefile_test.ktx2", Ktx2R8G8B8A8Unorm, 4, 4, 0, 1, {std::vector<unsigned char>(64, 7)});
+    const std::string valid = readFile("texturefile_test.ktx2");
+    {
+        TextureFile texture("texturefile_test.ktx2");
+        CHECK(texture.width() == 4 && texture.height() == 4 && texture.levels() == 1 && texture.layers() == 1);
+        CHECK(texture.imageSize(0) == 64 && texture.imageData(0, 0, 0)[63] == 7);
+    }
+
+    const std::size_t levelIndex = sizeof(Ktx2Header);
+    CHECK_THROWS(TextureFile(corrupted(valid, levelIndex, std::uint64_t(0) - 4096))); //Wraps the pointer
+    CHECK_THROWS(TextureFile(corrupted(valid, levelIndex, std::uint64_t(valid.size() - 32))));
+    CHECK_THROWS(TextureFile(corrupted(valid, levelIndex, std::uint64_t(valid.size()) + 1)));
+    CHECK_THROWS(TextureFile(corrupted(valid, offsetof(Ktx2Header, layerCount), std::uint32_t(0xFFFFFFFF))));
+    CHECK_THROWS(TextureFile(corrupted(valid, offsetof(Ktx2Header, pixelWidth), std::uint32_t(0xFFFFFFFF))));
+    CHECK_THROWS(TextureFile(corrupted(valid, offsetof(Ktx2Header, pixelHeight), std::uint32_t(1 << 20))));
+    CHECK_THROWS(TextureFile(corrupted(valid, offsetof(Ktx2Header, levelCount), std::uint32_t(100)))); //Index past the file
+    CHECK_THROWS(TextureFile(writeTestFile("texturefile_test_corrupt.ktx2", valid.substr(0, valid.size() - 1))));
+    return testResult();
+}
@@ -0,0 +1,87 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "textparse.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+const char* parseDecimal(const char *p, const char *end, double &result) {
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    const char* digitsStart = p;
+    for (; p < end && isDigit(*p); ++p) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits += mantissa != 0;
+        } else {
+            ++exponent;
+        }
+    }
+    bool hasDigits = p != digitsStart;
+    if (p < end && *p == '.') {
+        const char* fractionStart = ++p;
+        for (; p < end && isDigit(*p); ++p) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits += mantissa != 0;
+                --exponent;
+            }
+        }
+        hasDigits |= p != fractionStart;
+    }
+    if (!hasDigits)
+        return start;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* exponentStart = p++;
+        bool negativeExponent = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        if (p < end && isDigit(*p)) {
+            int e = 0;
+            for (; p < end && isDigit(*p); ++p)
+                e = std::min(e * 10 + (*p - '0'), 1000);
+            exponent += negativeExponent ? -e : e;
+        } else {
+            p = exponentStart; //Not an exponent after all
+        }
+    }
+    double value = static_cast<double>(mantissa);
+    if (exponent < 0)
+        value = exponent >= -22 ? value / powers[-exponent] : value * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        value = exponent <= 22 ? value * powers[exponent] : value * std::pow(10.0, exponent);
+    result = negative ? -value : value;
+    return p;
+}
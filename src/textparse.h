@@ -0,0 +1,44 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEXTPARSE_H
+#define TEXTPARSE_H
+
+/** @defgroup TextParse
+ * Locale-independent helpers shared by the text asset parsers (OBJ, JSON).
+ * @{ */
+
+inline bool isDigit(char c) {return c >= '0' && c <= '9';}
+
+/**
+ * @brief parseDecimal : parses an optionally signed decimal number with optional fraction and exponent
+ * @param p : start of the number
+ * @param end : end of the buffer
+ * @param result : parsed value. Integers up to 19 digits are exact.
+ * @return a pointer past the number, or p if there is no digit to read
+ */
+const char* parseDecimal(const char* p, const char* end, double& result);
+
+/** @} */
+
+#endif // TEXTPARSE_H
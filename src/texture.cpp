@@ -0,0 +1,258 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "texture.h"
+#include "glextensions.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+#include "renderstats.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+//Bytes per 4x4 block for compressed formats, per pixel otherwise. 0 when unknown.
+std::size_t formatBytes(unsigned int internalFormat) {
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+    case GL_COMPRESSED_RED_RGTC1: case GL_COMPRESSED_SIGNED_RED_RGTC1:
+    case GL_COMPRESSED_RGB8_ETC2: case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2: case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_R11_EAC: case GL_COMPRESSED_SIGNED_R11_EAC:
+        return 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT: case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT: case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+    case GL_COMPRESSED_RG_RGTC2: case GL_COMPRESSED_SIGNED_RG_RGTC2:
+    case GL_COMPRESSED_RGBA_BPTC_UNORM: case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+    case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT: case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+    case GL_COMPRESSED_RGBA8_ETC2_EAC: case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+    case GL_COMPRESSED_RG11_EAC: case GL_COMPRESSED_SIGNED_RG11_EAC:
+        return 16;
+    case GL_R8: return 1;
+    case GL_RG8: case GL_R16F: return 2;
+    case GL_RGB8: case GL_SRGB8: return 3;
+    case GL_RGBA8: case GL_SRGB8_ALPHA8: case GL_RG16F: case GL_R32F: return 4;
+    case GL_DEPTH_COMPONENT16: return 2;
+    case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: case GL_DEPTH24_STENCIL8: return 4;
+    case GL_RGBA16F: return 8;
+    case GL_RGBA32F: return 16;
+    default: return 0;
+    }
+}
+
+} // namespace
+
+bool isCompressedFormat(unsigned int internalFormat) {
+    return (internalFormat >= GL_COMPRESSED_RGB_S3TC_DXT1_EXT && internalFormat <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+        || (internalFormat >= GL_COMPRESSED_SRGB_S3TC_DXT1_EXT && internalFormat <= GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT)
+        || (internalFormat >= GL_COMPRESSED_RED_RGTC1 && internalFormat <= GL_COMPRESSED_SIGNED_RG_RGTC2)
+        || (internalFormat >= GL_COMPRESSED_RGBA_BPTC_UNORM && internalFormat <= GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT)
+        || (internalFormat >= GL_COMPRESSED_R11_EAC && internalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC);
+}
+
+bool isFormatSupported(unsigned int internalFormat) {
+    if (!isCompressedFormat(internalFormat))
+        return formatBytes(internalFormat) != 0;
+    if (internalFormat >= GL_COMPRESSED_RED_RGTC1 && internalFormat <= GL_COMPRESSED_SIGNED_RG_RGTC2)
+        return true; //Core since 3.0
+    if (internalFormat >= GL_COMPRESSED_RGBA_BPTC_UNORM && internalFormat <= GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT)
+        return GLEXT_texture_compression_bptc;
+    if (internalFormat >= GL_COMPRESSED_R11_EAC && internalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC)
+        return GLEXT_texture_compression_etc2;
+    return GLEXT_texture_compression_s3tc;
+}
+
+std::size_t textureImageSize(unsigned int internalFormat, unsigned int width, unsigned int height) {
+    if (isCompressedFormat(internalFormat))
+        return ((static_cast<std::size_t>(width) + 3) / 4) * ((static_cast<std::size_t>(height) + 3) / 4) * formatBytes(internalFormat);
+    return static_cast<std::size_t>(width) * height * formatBytes(internalFormat);
+}
+
+unsigned int fullMipCount(unsigned int width, unsigned int height) {
+    unsigned int levels = 1;
+    for (unsigned int size = std::max(width, height); size > 1; size /= 2)
+        ++levels;
+    return levels;
+}
+
+Texture::Texture(unsigned int target, const TextureFormat &format, unsigned int width, unsigned int height, unsigned int layers, unsigned int levels)
+    : _target(target), _format(format), _width(width), _height(height), _layers(layers),
+      _levels(levels ? std::min(levels, fullMipCount(width, height)) : fullMipCount(width, height))
+{
+    if (!isFormatSupported(format.internalFormat))
+        throw std::runtime_error("Texture format not supported by the driver : " + std::to_string(format.internalFormat));
+    if (!isCompressedFormat(format.internalFormat) && (!format.pixelFormat || !format.pixelType))
+        throw std::runtime_error("Uncompressed texture formats need a pixel format and type");
+    glGenTextures(1, &texture);
+    glBindTexture(_target, texture);
+    allocateStorage();
+    const char* tag = _target == GL_TEXTURE_2D_ARRAY ? "Texture array" : _target == GL_TEXTURE_CUBE_MAP ? "Cube map" : "Texture 2D";
+    GpuMemory::global().allocate(GpuMemoryCategory::Texture, texture, storageSize(), tag);
+}
+
+void Texture::allocateStorage() {
+    if (GLEXT_texture_storage) {
+        if (_target == GL_TEXTURE_2D_ARRAY)
+            glTexStorage3D(_target, _levels, _format.internalFormat, _width, _height, _layers);
+        else
+            glTexStorage2D(_target, _levels, _format.internalFormat, _width, _height);
+        return;
+    }
+
+    //Mutable storage made to behave the same : every level allocated, sampling limited to them
+    bool compressed = isCompressedFormat(_format.internalFormat);
+    for (unsigned int level = 0; level < _levels; ++level) {
+        unsigned int w = levelWidth(level), h = levelHeight(level);
+        GLsizei size = static_cast<GLsizei>(imageSize(level));
+        if (_target == GL_TEXTURE_2D_ARRAY) {
+            if (compressed)
+                glCompressedTexImage3D(_target, level, _format.internalFormat, w, h, _layers, 0, size * _layers, nullptr);
+            else
+                glTexImage3D(_target, level, _format.internalFormat, w, h, _layers, 0, _format.pixelFormat, _format.pixelType, nullptr);
+            continue;
+        }
+        for (unsigned int face = 0; face < _layers; ++face) {
+            GLenum target = _target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : _target;
+            if (compressed)
+                glCompressedTexImage2D(target, level, _format.internalFormat, w, h, 0, size, nullptr);
+            else
+                glTexImage2D(target, level, _format.internalFormat, w, h, 0, _format.pixelFormat, _format.pixelType, nullptr);
+        }
+    }
+    glTexParameteri(_target, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(_target, GL_TEXTURE_MAX_LEVEL, _levels - 1);
+}
+
+Texture::~Texture() {
+    GpuDeletionQueue::global().release(GpuResourceType::Texture, texture);
+}
+
+unsigned int Texture::levelWidth(unsigned int level) const {
+    return std::max(_width >> level, 1u);
+}
+
+unsigned int Texture::levelHeight(unsigned int level) const {
+    return std::max(_height >> level, 1u);
+}
+
+std::size_t Texture::imageSize(unsigned int level) const {
+    return textureImageSize(_format.internalFormat, levelWidth(level), levelHeight(level));
+}
+
+std::size_t Texture::storageSize() const {
+    std::size_t result = 0;
+    for (unsigned int level = 0; level < _levels; ++level)
+        result += imageSize(level) * _layers;
+    return result;
+}
+
+void Texture::setMemoryTag(const std::string &tag) {
+    GpuMemory::global().allocate(GpuMemoryCategory::Texture, texture, storageSize(), tag);
+}
+
+void Texture::bind(unsigned int unit) const {
+    ++RenderStats::frame().textureBinds;
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(_target, texture);
+}
+
+void Texture::uploadImage(unsigned int level, unsigned int layer, const void *data, std::size_t size) {
+    if (level >= _levels || layer >= _layers || size < imageSize(level))
+        throw std::runtime_error("Texture::uploadImage : invalid level, layer or size");
+    unsigned int w = levelWidth(level), h = levelHeight(level);
+    GLsizei bytes = static_cast<GLsizei>(imageSize(level));
+    bool compressed = isCompressedFormat(_format.internalFormat);
+
+    glBindTexture(_target, texture);
+    if (!compressed)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1); //Rows are tightly packed
+    if (_target == GL_TEXTURE_2D_ARRAY) {
+        if (compressed)
+            glCompressedTexSubImage3D(_target, level, 0, 0, layer, w, h, 1, _format.internalFormat, bytes, data);
+        else
+            glTexSubImage3D(_target, level, 0, 0, layer, w, h, 1, _format.pixelFormat, _format.pixelType, data);
+    } else {
+        GLenum target = _target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + layer : _target;
+        if (compressed)
+            glCompressedTexSubImage2D(target, level, 0, 0, w, h, _format.internalFormat, bytes, data);
+        else
+            glTexSubImage2D(target, level, 0, 0, w, h, _format.pixelFormat, _format.pixelType, data);
+    }
+    if (!compressed)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+void Texture::generateMipmaps() {
+    if (isCompressedFormat(_format.internalFormat))
+        throw std::runtime_error("Mipmaps of compressed textures must be baked offline");
+    glBindTexture(_target, texture);
+    glGenerateMipmap(_target);
+}
+
+Texture2D::Texture2D(unsigned int width, unsigned int height, const TextureFormat &format, unsigned int levels)
+    : Texture(GL_TEXTURE_2D, format, width, height, 1, levels)
+{
+}
+
+Texture2DArray::Texture2DArray(unsigned int width, unsigned int height, unsigned int layers, const TextureFormat &format, unsigned int levels)
+    : Texture(GL_TEXTURE_2D_ARRAY, format, width, height, layers, levels)
+{
+}
+
+TextureCube::TextureCube(unsigned int size, const TextureFormat &format, unsigned int levels)
+    : Texture(GL_TEXTURE_CUBE_MAP, format, size, size, 6, levels)
+{
+}
+
+Sampler::Sampler(GLenum minFilter, GLenum magFilter, GLenum wrap, float anisotropy)
+{
+    glGenSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, minFilter);
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, magFilter);
+    setWrap(wrap, wrap, wrap);
+    if (GLEXT_texture_filter_anisotropic && anisotropy > 1.0f) {
+        float maxAnisotropy = 1.0f;
+        glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+        glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(anisotropy, maxAnisotropy));
+    }
+}
+
+Sampler::~Sampler() {
+    GpuDeletionQueue::global().release(GpuResourceType::Sampler, sampler);
+}
+
+void Sampler::setWrap(GLenum s, GLenum t, GLenum r) {
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, s);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, t);
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R, r);
+}
+
+void Sampler::setLodRange(float minLod, float maxLod) {
+    glSamplerParameterf(sampler, GL_TEXTURE_MIN_LOD, minLod);
+    glSamplerParameterf(sampler, GL_TEXTURE_MAX_LOD, maxLod);
+}
+
+void Sampler::bind(unsigned int unit) const {
+    glBindSampler(unit, sampler);
+}
@@ -0,0 +1,197 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <cstddef>
+#include <string>
+#include <glad/glad.h>
+
+/**
+ * @brief Pixel format of a texture
+ */
+struct TextureFormat
+{
+    unsigned int internalFormat; ///< GL_RGBA8, GL_COMPRESSED_RGBA_BPTC_UNORM, ...
+    unsigned int pixelFormat = 0; ///< Uncompressed formats only : format and type of the uploaded pixels (GL_RGBA, GL_UNSIGNED_BYTE)
+    unsigned int pixelType = 0;
+};
+
+/** @defgroup TextureFormats
+ * @{ */
+
+/**
+ * @brief isCompressedFormat : tells whether the format is block-compressed (4x4 blocks)
+ */
+bool isCompressedFormat(unsigned int internalFormat);
+
+/**
+ * @brief isFormatSupported : tells whether the current context can create textures of this format
+ * @pre loadGLExtensions() was called
+ */
+bool isFormatSupported(unsigned int internalFormat);
+
+/**
+ * @brief textureImageSize : size in bytes of one image (one level of one layer) of the given dimensions
+ * @return 0 for unknown formats
+ */
+std::size_t textureImageSize(unsigned int internalFormat, unsigned int width, unsigned int height);
+
+/**
+ * @brief fullMipCount : number of levels of a complete mip chain, down to 1x1
+ */
+unsigned int fullMipCount(unsigned int width, unsigned int height);
+
+/** @} */
+
+/**
+ * @brief Base of the texture classes : owns a texture object with immutable storage.
+ *
+ * Storage is allocated once for every level (glTexStorage when available, glTexImage otherwise with
+ * GL_TEXTURE_MAX_LEVEL set accordingly), then filled image by image with uploadImage().
+ * Like every other GL wrapper here, it is best held by a unique_ptr.
+ *
+ * \code
+ * //Typical usage
+ * Texture2D albedo(512, 512, {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE});
+ * albedo.uploadImage(0, 0, pixels, 512 * 512 * 4);
+ * albedo.generateMipmaps();
+ * albedo.bind(0);
+ * \endcode
+ */
+class Texture
+{
+public:
+    virtual ~Texture();
+
+    unsigned int id() const {return texture;}
+    unsigned int target() const {return _target;}
+    const TextureFormat& format() const {return _format;}
+    unsigned int width() const {return _width;}
+    unsigned int height() const {return _height;}
+    unsigned int layers() const {return _layers;} ///< Array layers, 6 for cube maps, 1 otherwise
+    unsigned int levels() const {return _levels;}
+    unsigned int levelWidth(unsigned int level) const;
+    unsigned int levelHeight(unsigned int level) const;
+
+    /**
+     * @brief Size in bytes of one image of a level
+     */
+    std::size_t imageSize(unsigned int level) const;
+
+    /**
+     * @brief Size in bytes of the whole storage
+     */
+    std::size_t storageSize() const;
+
+    /**
+     * @brief Files the storage under another tag in GpuMemory (by default, the kind of texture)
+     */
+    void setMemoryTag(const std::string& tag);
+
+    /**
+     * @brief Binds the texture to a texture unit
+     */
+    void bind(unsigned int unit) const;
+
+    /**
+     * @brief Fills one image. Compressed data is uploaded as is.
+     * @param layer : array layer, or cube face (+X, -X, +Y, -Y, +Z, -Z)
+     * @param data : pixels, or an offset when a buffer is bound to GL_PIXEL_UNPACK_BUFFER
+     * @param size : size of data, must be imageSize(level)
+     * @note binds the texture to the active texture unit
+     */
+    void uploadImage(unsigned int level, unsigned int layer, const void* data, std::size_t size);
+
+    /**
+     * @brief Computes levels 1 and beyond from level 0
+     * @throw std::runtime_error for compressed formats : bake their mip chain offline (see texbake)
+     */
+    void generateMipmaps();
+
+protected:
+    /**
+     * @param levels : 0 for a complete mip chain
+     * @throw std::runtime_error if the format isn't supported by the context
+     */
+    Texture(unsigned int target, const TextureFormat& format, unsigned int width, unsigned int height, unsigned int layers, unsigned int levels);
+
+private:
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    void allocateStorage();
+
+    unsigned int texture;
+    unsigned int _target;
+    TextureFormat _format;
+    unsigned int _width, _height, _layers, _levels;
+};
+
+class Texture2D : public Texture
+{
+public:
+    Texture2D(unsigned int width, unsigned int height, const TextureFormat& format, unsigned int levels = 0);
+};
+
+class Texture2DArray : public Texture
+{
+public:
+    Texture2DArray(unsigned int width, unsigned int height, unsigned int layers, const TextureFormat& format, unsigned int levels = 0);
+};
+
+class TextureCube : public Texture
+{
+public:
+    TextureCube(unsigned int size, const TextureFormat& format, unsigned int levels = 0);
+};
+
+/**
+ * @brief Sampler object : filtering and wrapping state, shared by any number of textures
+ */
+class Sampler
+{
+public:
+    /**
+     * @param anisotropy : maximum anisotropy, clamped to what the driver supports. Ignored without the extension.
+     */
+    explicit Sampler(GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR, GLenum magFilter = GL_LINEAR, GLenum wrap = GL_REPEAT,
+                     float anisotropy = 1.0f);
+    ~Sampler();
+
+    unsigned int id() const {return sampler;}
+    void setWrap(GLenum s, GLenum t, GLenum r);
+    void setLodRange(float minLod, float maxLod);
+
+    /**
+     * @brief Binds the sampler to a texture unit, overriding the sampling state of the texture bound there
+     */
+    void bind(unsigned int unit) const;
+
+private:
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+    unsigned int sampler;
+};
+
+#endif // TEXTURE_H
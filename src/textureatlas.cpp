@@ -0,0 +1,78 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "textureatlas.h"
+#include "json.h"
+#include "mappedfile.h"
+#include "texturefile.h"
+#include <stdexcept>
+
+namespace {
+
+std::string directoryOf(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+} // namespace
+
+TextureAtlas::TextureAtlas(const std::string &manifestPath) {
+    MappedFile file(manifestPath);
+    JsonValue root = parseJson(file.data(), file.size());
+    const double width = root["width"].asNumber(), height = root["height"].asNumber();
+    const unsigned int layers = static_cast<unsigned int>(root["layers"].asInt());
+    if (!root["texture"].isString() || width <= 0 || height <= 0 || layers == 0)
+        throw std::runtime_error("Invalid atlas manifest : " + manifestPath);
+
+    for (const JsonValue& entry : root["entries"].items()) {
+        const unsigned int layer = static_cast<unsigned int>(entry["layer"].asInt(-1));
+        if (!entry["name"].isString() || layer >= layers)
+            throw std::runtime_error("Invalid atlas entry in " + manifestPath);
+        glm::vec4 rect(entry["x"].asNumber() / width, entry["y"].asNumber() / height,
+                       entry["width"].asNumber() / width, entry["height"].asNumber() / height);
+        entries[entry["name"].asString()] = AtlasEntry{layer, rect};
+    }
+
+    TextureFile textureFile(directoryOf(manifestPath) + root["texture"].asString());
+    if (!textureFile.isArray() || textureFile.layers() != layers
+            || textureFile.width() != static_cast<unsigned int>(width) || textureFile.height() != static_cast<unsigned int>(height))
+        throw std::runtime_error("Atlas texture doesn't match its manifest : " + textureFile.path());
+    tex = makeTexture(textureFile);
+}
+
+const AtlasEntry* TextureAtlas::find(const std::string &name) const {
+    auto it = entries.find(name);
+    return it == entries.end() ? nullptr : &it->second;
+}
+
+const AtlasEntry& TextureAtlas::get(const std::string &name) const {
+    const AtlasEntry* entry = find(name);
+    if (!entry)
+        throw std::runtime_error("No atlas entry named " + name);
+    return *entry;
+}
+
+void remapUVs(MeshData &mesh, const AtlasEntry &entry) {
+    for (Vertex& vertex : mesh.vertices)
+        vertex.uv = entry.remap(vertex.uv);
+}
@@ -0,0 +1,93 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include "meshdata.h"
+#include "texture.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+/**
+ * @brief Location of a source texture inside an atlas
+ */
+struct AtlasEntry
+{
+    unsigned int layer;
+    glm::vec4 uvRect; ///< Offset in xy, scale in zw : atlasUv = uvRect.xy + uv * uvRect.zw
+
+    glm::vec2 remap(const glm::vec2& uv) const {return glm::vec2(uvRect.x, uvRect.y) + uv * glm::vec2(uvRect.z, uvRect.w);}
+};
+
+/**
+ * @brief Textures packed by the atlaspack tool into the layers of one 2D texture array.
+ *
+ * Materials using the atlas only differ by their entry (layer + uvRect), which can go in per-instance or
+ * per-draw data : they all share the same texture binding and can be batched into one draw.
+ * See shaders/atlas.glsl for sampling with repeating UVs.
+ *
+ * The manifest is a JSON file :
+ * \code
+ * {"texture": "atlas.ktx2", "width": 2048, "height": 2048, "layers": 2,
+ *  "entries": [{"name": "grass", "layer": 0, "x": 4, "y": 4, "width": 64, "height": 64}, ...]}
+ * \endcode
+ */
+class TextureAtlas
+{
+public:
+    /**
+     * @brief Reads the manifest and loads the texture it references (relative to the manifest)
+     * @throw std::runtime_error if a file can't be read or the manifest is invalid
+     */
+    explicit TextureAtlas(const std::string& manifestPath);
+
+    Texture& texture() {return *tex;}
+    const Texture& texture() const {return *tex;}
+    std::size_t size() const {return entries.size();}
+
+    /**
+     * @brief Entry of a source texture (file name without directory nor extension), nullptr if absent
+     */
+    const AtlasEntry* find(const std::string& name) const;
+
+    /**
+     * @throw std::runtime_error if the entry doesn't exist
+     */
+    const AtlasEntry& get(const std::string& name) const;
+
+private:
+    std::unique_ptr<Texture> tex;
+    std::unordered_map<std::string, AtlasEntry> entries;
+};
+
+/**
+ * @brief remapUVs : rewrites the texture coordinates of a mesh to address its entry of an atlas
+ * @pre the UVs are in [0, 1] (no repetition), unless the entry covers a whole layer
+ */
+void remapUVs(MeshData& mesh, const AtlasEntry& entry);
+
+#endif // TEXTUREATLAS_H
@@ -0,0 +1,94 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "texturebake.h"
+#include "bcencoder.h"
+#include "ktx2.h"
+#include <stdexcept>
+
+namespace {
+
+BlockFormat blockFormatFor(const std::string& name) {
+    if (name == "bc1") return BlockFormat::BC1;
+    if (name == "bc3") return BlockFormat::BC3;
+    if (name == "bc4") return BlockFormat::BC4;
+    if (name == "bc5") return BlockFormat::BC5;
+    return BlockFormat::BC7;
+}
+
+} // namespace
+
+std::uint32_t textureBakeVkFormat(const TextureBakeOptions &options) {
+    struct Entry {const char* name; std::uint32_t linear, srgb;};
+    static const Entry formats[] = {
+        {"bc1", Ktx2BC1RgbUnorm, Ktx2BC1RgbSrgb}, {"bc3", Ktx2BC3Unorm, Ktx2BC3Srgb},
+        {"bc4", Ktx2BC4Unorm, 0}, {"bc5", Ktx2BC5Unorm, 0},
+        {"bc7", Ktx2BC7Unorm, Ktx2BC7Srgb}, {"rgba8", Ktx2R8G8B8A8Unorm, Ktx2R8G8B8A8Srgb}
+    };
+    for (const Entry& entry : formats)
+        if (options.format == entry.name) {
+            if (options.srgb && entry.srgb == 0)
+                throw std::runtime_error(options.format + " has no sRGB variant");
+            return options.srgb ? entry.srgb : entry.linear;
+        }
+    throw std::runtime_error("Unknown texture format : " + options.format);
+}
+
+std::vector<unsigned char> encodeImage(const Image &image, const std::string &format, JobSystem &jobs) {
+    if (format == "rgba8")
+        return image.pixels;
+    return compressImage(image.pixels.data(), image.width, image.height, blockFormatFor(format), jobs);
+}
+
+TextureBakeResult bakeTexture(const std::string &path, std::vector<Image> layers, const TextureBakeOptions &options,
+                              JobSystem &jobs) {
+    const std::uint32_t vkFormat = textureBakeVkFormat(options);
+    if (layers.empty())
+        throw std::runtime_error("bakeTexture : no image");
+    const unsigned int width = layers.front().width, height = layers.front().height;
+    for (const Image& layer : layers)
+        if (layer.width != width || layer.height != height)
+            throw std::runtime_error("bakeTexture : all layers must have the same size");
+
+    //Level data holds every layer one after another, as KTX2 expects
+    std::vector<std::vector<unsigned char>> levels;
+    TextureBakeResult result = {0, 0};
+    while (true) {
+        std::vector<unsigned char> level;
+        for (const Image& layer : layers) {
+            std::vector<unsigned char> data = encodeImage(layer, options.format, jobs);
+            level.insert(level.end(), data.begin(), data.end());
+        }
+        result.bytes += level.size();
+        levels.push_back(std::move(level));
+        if (levels.size() == options.maxLevels || (layers.front().width == 1 && layers.front().height == 1))
+            break;
+        for (Image& layer : layers)
+            layer = downsampleImage(layer, options.srgb);
+    }
+    result.levels = static_cast<unsigned int>(levels.size());
+
+    const unsigned int layerCount = options.array || layers.size() > 1 ? static_cast<unsigned int>(layers.size()) : 0;
+    writeKtx2(path, vkFormat, width, height, layerCount, 1, levels);
+    return result;
+}
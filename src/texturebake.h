@@ -0,0 +1,68 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEXTUREBAKE_H
+#define TEXTUREBAKE_H
+
+#include "image.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+struct TextureBakeOptions
+{
+    std::string format = "bc7"; ///< bc1, bc3, bc4, bc5, bc7 or rgba8
+    bool srgb = false;
+    bool array = false; ///< Writes an array texture even for a single layer
+    unsigned int maxLevels = 0; ///< 0 for the full mip chain
+};
+
+struct TextureBakeResult
+{
+    unsigned int levels;
+    std::size_t bytes; ///< Size of the image data
+};
+
+/**
+ * @brief textureBakeVkFormat : KTX2 / Vulkan format written for the options
+ * @throw std::runtime_error on unknown formats or sRGB requested for bc4 / bc5
+ */
+std::uint32_t textureBakeVkFormat(const TextureBakeOptions& options);
+
+/**
+ * @brief encodeImage : converts an image to the given format (bc1, bc3, bc4, bc5, bc7 or rgba8)
+ */
+std::vector<unsigned char> encodeImage(const Image& image, const std::string& format, JobSystem& jobs);
+
+/**
+ * @brief bakeTexture : builds the mip chain of every layer, compresses it and writes a KTX2 file
+ * @param layers : images of the same size, consumed to build the mip chain
+ * @throw std::runtime_error on unknown formats, sRGB requested for bc4 / bc5, mismatched sizes or write errors
+ */
+TextureBakeResult bakeTexture(const std::string& path, std::vector<Image> layers, const TextureBakeOptions& options,
+                              JobSystem& jobs);
+
+#endif // TEXTUREBAKE_H
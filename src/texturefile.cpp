@@ -0,0 +1,295 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "texturefile.h"
+#include "glextensions.h"
+#include "ktx2.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+struct DdsPixelFormat {
+    std::uint32_t size, flags, fourCC, rgbBitCount, rMask, gMask, bMask, aMask;
+};
+
+struct DdsHeader {
+    std::uint32_t size, flags, height, width, pitchOrLinearSize, depth, mipMapCount;
+    std::uint32_t reserved1[11];
+    DdsPixelFormat pixelFormat;
+    std::uint32_t caps, caps2, caps3, caps4, reserved2;
+};
+
+struct DdsHeaderDx10 {
+    std::uint32_t dxgiFormat, resourceDimension, miscFlag, arraySize, miscFlags2;
+};
+
+static_assert(sizeof(DdsHeader) == 124, "DDS header must match the file layout");
+
+const std::uint32_t ddsFourCC = 0x4;
+const std::uint32_t ddsRgb = 0x40;
+const std::uint32_t ddsCubemap = 0x200;
+const std::uint32_t dx10TextureCube = 0x4;
+
+constexpr std::uint32_t fourCC(char a, char b, char c, char d) {
+    return std::uint32_t(std::uint8_t(a)) | std::uint32_t(std::uint8_t(b)) << 8
+         | std::uint32_t(std::uint8_t(c)) << 16 | std::uint32_t(std::uint8_t(d)) << 24;
+}
+
+TextureFormat uncompressed(unsigned int internalFormat, unsigned int pixelFormat, unsigned int pixelType) {
+    return TextureFormat{internalFormat, pixelFormat, pixelType};
+}
+
+TextureFormat fromDxgiFormat(std::uint32_t dxgiFormat) {
+    switch (dxgiFormat) {
+    case 2: return uncompressed(GL_RGBA32F, GL_RGBA, GL_FLOAT);
+    case 10: return uncompressed(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    case 28: return uncompressed(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    case 29: return uncompressed(GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    case 49: return uncompressed(GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
+    case 61: return uncompressed(GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    case 87: return uncompressed(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE);
+    case 91: return uncompressed(GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE);
+    case 71: return {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT};
+    case 72: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT};
+    case 74: return {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT};
+    case 75: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT};
+    case 77: return {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT};
+    case 78: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT};
+    case 80: return {GL_COMPRESSED_RED_RGTC1};
+    case 81: return {GL_COMPRESSED_SIGNED_RED_RGTC1};
+    case 83: return {GL_COMPRESSED_RG_RGTC2};
+    case 84: return {GL_COMPRESSED_SIGNED_RG_RGTC2};
+    case 95: return {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT};
+    case 96: return {GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT};
+    case 98: return {GL_COMPRESSED_RGBA_BPTC_UNORM};
+    case 99: return {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM};
+    default: return {0};
+    }
+}
+
+//Pre-DX10 headers
+TextureFormat fromDdsPixelFormat(const DdsPixelFormat& pf) {
+    if (pf.flags & ddsFourCC) {
+        switch (pf.fourCC) {
+        case fourCC('D', 'X', 'T', '1'): return {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT};
+        case fourCC('D', 'X', 'T', '3'): return {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT};
+        case fourCC('D', 'X', 'T', '5'): return {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT};
+        case fourCC('A', 'T', 'I', '1'): case fourCC('B', 'C', '4', 'U'): return {GL_COMPRESSED_RED_RGTC1};
+        case fourCC('A', 'T', 'I', '2'): case fourCC('B', 'C', '5', 'U'): return {GL_COMPRESSED_RG_RGTC2};
+        default: return {0};
+        }
+    }
+    if ((pf.flags & ddsRgb) && pf.rgbBitCount == 32) {
+        if (pf.rMask == 0x000000ff && pf.gMask == 0x0000ff00 && pf.bMask == 0x00ff0000)
+            return uncompressed(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+        if (pf.rMask == 0x00ff0000 && pf.gMask == 0x0000ff00 && pf.bMask == 0x000000ff)
+            return uncompressed(GL_RGBA8, GL_BGRA, GL_UNSIGNED_BYTE);
+    }
+    return {0};
+}
+
+template <class T>
+T readStruct(const MappedFile& file, std::size_t offset) {
+    if (offset + sizeof(T) > file.size())
+        throw std::runtime_error("Truncated texture file : " + file.path());
+    T result;
+    std::memcpy(&result, file.data() + offset, sizeof(T));
+    return result;
+}
+
+} // namespace
+
+TextureFormat textureFormatFromVk(std::uint32_t vkFormat) {
+    switch (vkFormat) {
+    case 9: return uncompressed(GL_R8, GL_RED, GL_UNSIGNED_BYTE);
+    case 16: return uncompressed(GL_RG8, GL_RG, GL_UNSIGNED_BYTE);
+    case 23: return uncompressed(GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE);
+    case 29: return uncompressed(GL_SRGB8, GL_RGB, GL_UNSIGNED_BYTE);
+    case 37: return uncompressed(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    case 43: return uncompressed(GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE);
+    case 97: return uncompressed(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT);
+    case 109: return uncompressed(GL_RGBA32F, GL_RGBA, GL_FLOAT);
+    case 131: return {GL_COMPRESSED_RGB_S3TC_DXT1_EXT};
+    case 132: return {GL_COMPRESSED_SRGB_S3TC_DXT1_EXT};
+    case 133: return {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT};
+    case 134: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT};
+    case 135: return {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT};
+    case 136: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT};
+    case 137: return {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT};
+    case 138: return {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT};
+    case 139: return {GL_COMPRESSED_RED_RGTC1};
+    case 140: return {GL_COMPRESSED_SIGNED_RED_RGTC1};
+    case 141: return {GL_COMPRESSED_RG_RGTC2};
+    case 142: return {GL_COMPRESSED_SIGNED_RG_RGTC2};
+    case 143: return {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT};
+    case 144: return {GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT};
+    case 145: return {GL_COMPRESSED_RGBA_BPTC_UNORM};
+    case 146: return {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM};
+    case 147: return {GL_COMPRESSED_RGB8_ETC2};
+    case 148: return {GL_COMPRESSED_SRGB8_ETC2};
+    case 149: return {GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2};
+    case 150: return {GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2};
+    case 151: return {GL_COMPRESSED_RGBA8_ETC2_EAC};
+    case 152: return {GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC};
+    case 153: return {GL_COMPRESSED_R11_EAC};
+    case 154: return {GL_COMPRESSED_SIGNED_R11_EAC};
+    case 155: return {GL_COMPRESSED_RG11_EAC};
+    case 156: return {GL_COMPRESSED_SIGNED_RG11_EAC};
+    default: return {0};
+    }
+}
+
+TextureFile::TextureFile(const std::string &path) : file(path)
+{
+    if (file.size() >= sizeof(ktx2Identifier) && std::memcmp(file.data(), ktx2Identifier, sizeof(ktx2Identifier)) == 0)
+        parseKtx2();
+    else if (file.size() >= 4 && std::memcmp(file.data(), "DDS ", 4) == 0)
+        parseDds();
+    else
+        throw std::runtime_error("Unknown texture container : " + path);
+
+    if (_format.internalFormat == 0)
+        throw std::runtime_error("Unsupported texture format in " + path);
+    if (_width == 0 || _height == 0)
+        throw std::runtime_error("Empty texture : " + path);
+    if (_width > maxTextureFileSize || _height > maxTextureFileSize)
+        throw std::runtime_error("Texture too large : " + path);
+    _levels = std::min(_levels, fullMipCount(_width, _height));
+
+    //Every image must lie in the file. Offsets come from the file : compared as integers so that nothing wraps.
+    const std::size_t images = static_cast<std::size_t>(_layers) * _faces;
+    for (unsigned int level = 0; level < _levels; ++level) {
+        const std::size_t offset = levelOffsets[level], size = imageSize(level);
+        const std::size_t stride = imageStride ? imageStride : size;
+        if (size > file.size() || offset > file.size() - size
+                || (images > 1 && (images - 1) > (file.size() - size - offset) / stride))
+            throw std::runtime_error("Truncated texture file : " + path);
+    }
+}
+
+void TextureFile::parseKtx2() {
+    Ktx2Header header = readStruct<Ktx2Header>(file, 0);
+    if (header.supercompressionScheme != 0)
+        throw std::runtime_error("Supercompressed KTX2 files are not supported : " + file.path());
+    if (header.pixelDepth > 1)
+        throw std::runtime_error("3D textures are not supported : " + file.path());
+    if (header.faceCount != 1 && header.faceCount != 6)
+        throw std::runtime_error("Invalid KTX2 face count : " + file.path());
+    if (header.faceCount == 6 && header.layerCount > 1)
+        throw std::runtime_error("Cube map arrays are not supported : " + file.path());
+
+    _format = textureFormatFromVk(header.vkFormat);
+    _width = header.pixelWidth;
+    _height = std::max(header.pixelHeight, 1u);
+    _layers = std::max(header.layerCount, 1u);
+    array = header.layerCount > 0;
+    _faces = header.faceCount;
+    _levels = std::max(header.levelCount, 1u);
+    generateMipmaps = header.levelCount == 0;
+
+    std::size_t indexOffset = sizeof(Ktx2Header);
+    for (unsigned int level = 0; level < _levels; ++level) {
+        Ktx2Level entry = readStruct<Ktx2Level>(file, indexOffset + level * sizeof(Ktx2Level));
+        if (entry.byteOffset > file.size())
+            throw std::runtime_error("Truncated texture file : " + file.path());
+        levelOffsets.push_back(static_cast<std::size_t>(entry.byteOffset));
+    }
+}
+
+void TextureFile::parseDds() {
+    DdsHeader header = readStruct<DdsHeader>(file, 4);
+    std::size_t dataOffset = 4 + sizeof(DdsHeader);
+    if (header.depth > 1)
+        throw std::runtime_error("3D textures are not supported : " + file.path());
+
+    _width = header.width;
+    _height = header.height;
+    _levels = std::max(header.mipMapCount, 1u);
+    if ((header.pixelFormat.flags & ddsFourCC) && header.pixelFormat.fourCC == fourCC('D', 'X', '1', '0')) {
+        DdsHeaderDx10 dx10 = readStruct<DdsHeaderDx10>(file, dataOffset);
+        dataOffset += sizeof(DdsHeaderDx10);
+        _format = fromDxgiFormat(dx10.dxgiFormat);
+        _layers = std::max(dx10.arraySize, 1u);
+        array = _layers > 1;
+        if (dx10.miscFlag & dx10TextureCube)
+            _faces = 6;
+    } else {
+        _format = fromDdsPixelFormat(header.pixelFormat);
+        if (header.caps2 & ddsCubemap)
+            _faces = 6;
+    }
+    if (_faces == 6 && _layers > 1)
+        throw std::runtime_error("Cube map arrays are not supported : " + file.path());
+
+    if (_width > maxTextureFileSize || _height > maxTextureFileSize)
+        throw std::runtime_error("Texture too large : " + file.path());
+    //Each image holds its whole mip chain
+    for (unsigned int level = 0; level < std::min(_levels, fullMipCount(_width, _height)); ++level) {
+        levelOffsets.push_back(dataOffset + imageStride);
+        imageStride += textureImageSize(_format.internalFormat, std::max(_width >> level, 1u), std::max(_height >> level, 1u));
+    }
+}
+
+std::size_t TextureFile::imageSize(unsigned int level) const {
+    return textureImageSize(_format.internalFormat, std::max(_width >> level, 1u), std::max(_height >> level, 1u));
+}
+
+const char* TextureFile::imageData(unsigned int level, unsigned int layer, unsigned int face) const {
+    std::size_t image = static_cast<std::size_t>(layer) * _faces + face;
+    std::size_t stride = imageStride ? imageStride : imageSize(level);
+    return file.data() + levelOffsets[level] + image * stride;
+}
+
+std::size_t TextureFile::dataSize() const {
+    std::size_t result = 0;
+    for (unsigned int level = 0; level < _levels; ++level)
+        result += imageSize(level) * _layers * _faces;
+    return result;
+}
+
+std::unique_ptr<Texture> makeTextureStorage(const TextureFile &file) {
+    unsigned int levels = file.needsMipmaps() ? 0 : file.levels();
+    if (file.faces() == 6)
+        return std::make_unique<TextureCube>(file.width(), file.format(), levels);
+    if (file.isArray())
+        return std::make_unique<Texture2DArray>(file.width(), file.height(), file.layers(), file.format(), levels);
+    return std::make_unique<Texture2D>(file.width(), file.height(), file.format(), levels);
+}
+
+std::unique_ptr<Texture> makeTexture(const TextureFile &file) {
+    std::unique_ptr<Texture> texture = makeTextureStorage(file);
+    for (unsigned int level = 0; level < file.levels(); ++level)
+        for (unsigned int layer = 0; layer < file.layers(); ++layer)
+            for (unsigned int face = 0; face < file.faces(); ++face)
+                texture->uploadImage(level, layer * file.faces() + face, file.imageData(level, layer, face), file.imageSize(level));
+    if (file.needsMipmaps())
+        texture->generateMipmaps();
+    return texture;
+}
+
+std::unique_ptr<Texture> loadTexture(const std::string &path) {
+    return makeTexture(TextureFile(path));
+}
@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef TEXTUREFILE_H
+#define TEXTUREFILE_H
+
+#include "mappedfile.h"
+#include "texture.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+const unsigned int maxTextureFileSize = 1 << 16; ///< Largest width or height accepted, above what any GL supports
+
+/**
+ * @brief Texture container (KTX2 or DDS) mapped in memory, with its images ready to be uploaded as they are.
+ *
+ * Supported : 2D textures, 2D arrays and cube maps, with BCn, ETC2/EAC or 8/16/32-bit uncompressed formats.
+ * KTX2 files must not be supercompressed (Basis / zstd). 3D textures and cube arrays are rejected.
+ */
+class TextureFile
+{
+public:
+    /**
+     * @throw std::runtime_error if the file can't be read, is truncated or uses an unsupported feature
+     */
+    explicit TextureFile(const std::string& path);
+
+    const TextureFormat& format() const {return _format;}
+    unsigned int width() const {return _width;}
+    unsigned int height() const {return _height;}
+    unsigned int layers() const {return _layers;} ///< Array layers, 1 for non-arrays
+    bool isArray() const {return array;} ///< Arrays may have a single layer
+    unsigned int faces() const {return _faces;} ///< 6 for cube maps, 1 otherwise
+    unsigned int levels() const {return _levels;}
+
+    /**
+     * @brief True when the file asks for the mip chain to be generated at load time (KTX2 with levelCount 0)
+     */
+    bool needsMipmaps() const {return generateMipmaps;}
+
+    /**
+     * @brief Pixels of one image, pointing into the mapping
+     */
+    const char* imageData(unsigned int level, unsigned int layer, unsigned int face) const;
+    std::size_t imageSize(unsigned int level) const;
+
+    /**
+     * @brief Total size of the images, in bytes
+     */
+    std::size_t dataSize() const;
+
+    const std::string& path() const {return file.path();}
+
+private:
+    void parseKtx2();
+    void parseDds();
+
+    MappedFile file;
+    TextureFormat _format;
+    unsigned int _width, _height, _layers = 1, _faces = 1, _levels = 1;
+    bool array = false;
+    bool generateMipmaps = false;
+    //Level-major (KTX2) : levelOffsets[level] + image * imageSize(level)
+    //Image-major (DDS) : levelOffsets[level] + image * imageStride
+    std::vector<std::size_t> levelOffsets;
+    std::size_t imageStride = 0;
+};
+
+/**
+ * @brief textureFormatFromVk : GL format matching a Vulkan format, as stored in KTX2 files
+ * @return internalFormat 0 for formats without GL equivalent
+ */
+TextureFormat textureFormatFromVk(std::uint32_t vkFormat);
+
+/**
+ * @brief makeTexture : creates the texture matching the file (2D, array or cube) and uploads every image
+ * @throw std::runtime_error if the format isn't supported by the driver
+ */
+std::unique_ptr<Texture> makeTexture(const TextureFile& file);
+
+/**
+ * @brief makeTextureStorage : creates the texture matching the file, without uploading anything
+ */
+std::unique_ptr<Texture> makeTextureStorage(const TextureFile& file);
+
+/**
+ * @brief loadTexture : reads a .ktx2 or .dds file
+ */
+std::unique_ptr<Texture> loadTexture(const std::string& path);
+
+#endif // TEXTUREFILE_H
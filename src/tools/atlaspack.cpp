@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Packs many small textures into the layers of one 2D texture array, with a JSON manifest giving the
+ * layer and rectangle of each source (see TextureAtlas).
+ * Usage : atlaspack [--size 2048] [--padding 4] [--format bc7] [--srgb] output.json input...
+ * The texture is written next to the manifest, with the .ktx2 extension.
+ *
+ * Each texture is surrounded by `padding` texels copied from its edges, so that filtering doesn't bleed
+ * between neighbors. Mip levels are only generated while that border is at least one texel wide, and
+ * rectangles are aligned so that compressed blocks never straddle two textures on any of those levels.
+ * Textures of exactly the page size take a whole layer, without padding. When all of them do, the result is
+ * a plain texture array with full mip chains.
+ */
+#include "../atlaspacker.h"
+#include "../image.h"
+#include "../jobsystem.h"
+#include "../texturebake.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    unsigned int pageSize = 2048;
+    unsigned int padding = 4;
+    TextureBakeOptions bake;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+            options.pageSize = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--padding") == 0 && i + 1 < argc)
+            options.padding = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            options.bake.format = argv[++i];
+        else if (std::strcmp(argv[i], "--srgb") == 0)
+            options.bake.srgb = true;
+        else if (argv[i][0] == '-')
+            return false;
+        else if (options.output.empty())
+            options.output = argv[i];
+        else
+            options.inputs.push_back(argv[i]);
+    }
+    return !options.inputs.empty() && options.pageSize > 0;
+}
+
+/** File name without directory nor extension */
+std::string entryName(const std::string& path) {
+    std::size_t slash = path.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    return name.substr(0, name.find_last_of('.'));
+}
+
+std::string replaceExtension(const std::string& path, const std::string& extension) {
+    std::size_t dot = path.find_last_of('.'), slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return path + extension;
+    return path.substr(0, dot) + extension;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string result;
+    for (char c : text) {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+unsigned int alignUp(unsigned int value, unsigned int alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/** Copies the image in a cell of the page, and fills the rest of the cell by repeating its edges */
+void blit(const Image& image, Image& page, const PackedRect& cell, unsigned int padding) {
+    for (unsigned int y = 0; y < cell.height; ++y) {
+        unsigned int sy = std::min(y > padding ? y - padding : 0, image.height - 1);
+        for (unsigned int x = 0; x < cell.width; ++x) {
+            unsigned int sx = std::min(x > padding ? x - padding : 0, image.width - 1);
+            std::memcpy(page.pixel(cell.x + x, cell.y + y), image.pixel(sx, sy), 4);
+        }
+    }
+}
+
+struct Entry {
+    std::string name;
+    unsigned int layer, x, y, width, height;
+};
+
+void writeManifest(const std::string& path, const std::string& texture, unsigned int size, unsigned int layers,
+                   const std::vector<Entry>& entries) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Could not open file : " + path);
+    file << "{\n  \"texture\": \"" << jsonEscape(texture) << "\", \"width\": " << size << ", \"height\": " << size
+         << ", \"layers\": " << layers << ",\n  \"entries\": [";
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        file << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(entry.name) << "\", \"layer\": " << entry.layer
+             << ", \"x\": " << entry.x << ", \"y\": " << entry.y << ", \"width\": " << entry.width << ", \"height\": " << entry.height << "}";
+    }
+    file << "\n  ]\n}\n";
+    if (!file)
+        throw std::runtime_error("Could not write file : " + path);
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage : %s [--size 2048] [--padding 4] [--format bc1|bc3|bc4|bc5|bc7|rgba8] [--srgb] output.json input...\n", argv[0]);
+        return 1;
+    }
+    try {
+        auto start = std::chrono::steady_clock::now();
+        const unsigned int size = options.pageSize;
+
+        std::vector<Image> images;
+        std::vector<Entry> entries;
+        std::set<std::string> names;
+        for (const std::string& input : options.inputs) {
+            images.push_back(loadImage(input));
+            entries.push_back({entryName(input), 0, 0, 0, images.back().width, images.back().height});
+            if (!names.insert(entries.back().name).second)
+                throw std::runtime_error("Duplicate texture name : " + entries.back().name);
+        }
+        auto isWholeLayer = [&](const Image& image) {return image.width == size && image.height == size;};
+
+        //Level n has a border of padding >> n texels : stop before it vanishes
+        unsigned int levels = 1;
+        while ((options.padding >> levels) > 0 && (size >> levels) > 0)
+            ++levels;
+        const unsigned int alignment = 4u << (levels - 1);
+        if (size % alignment != 0)
+            throw std::runtime_error("The page size must be a multiple of " + std::to_string(alignment));
+
+        std::vector<PackedRect> cells;
+        for (const Image& image : images)
+            if (!isWholeLayer(image))
+                cells.push_back({0, 0, alignUp(image.width + 2 * options.padding, alignment),
+                                 alignUp(image.height + 2 * options.padding, alignment), 0});
+        options.bake.maxLevels = cells.empty() ? 0 : levels;
+        options.bake.array = true;
+
+        unsigned int atlasPages = 0;
+        const std::vector<PackedRect> packed = packRects(cells, size, size, atlasPages);
+        std::vector<Image> pages(atlasPages);
+        for (Image& page : pages) {
+            page.width = page.height = size;
+            page.pixels.assign(static_cast<std::size_t>(size) * size * 4, 0);
+        }
+        unsigned long long usedArea = 0;
+        for (std::size_t i = 0, cell = 0; i < images.size(); ++i) {
+            usedArea += static_cast<unsigned long long>(images[i].width) * images[i].height;
+            if (isWholeLayer(images[i])) {
+                entries[i].layer = static_cast<unsigned int>(pages.size());
+                pages.push_back(std::move(images[i]));
+            } else {
+                const PackedRect& rect = packed[cell++];
+                blit(images[i], pages[rect.page], rect, options.padding);
+                entries[i].layer = rect.page;
+                entries[i].x = rect.x + options.padding;
+                entries[i].y = rect.y + options.padding;
+            }
+        }
+        const unsigned int layerCount = static_cast<unsigned int>(pages.size());
+        double packMs = millisecondsSince(start);
+
+        auto encodeStart = std::chrono::steady_clock::now();
+        const std::string texturePath = replaceExtension(options.output, ".ktx2");
+        TextureBakeResult result = bakeTexture(texturePath, std::move(pages), options.bake, JobSystem::global());
+        double encodeMs = millisecondsSince(encodeStart);
+        writeManifest(options.output, entryName(texturePath) + ".ktx2", size, layerCount, entries);
+
+        std::printf("%zu textures in %u layer(s) of %ux%u, %.1f%% used, %u level(s), %s%s : %.1f KB\n",
+                    entries.size(), layerCount, size, size, 100.0 * usedArea / (static_cast<double>(size) * size * layerCount),
+                    result.levels, options.bake.format.c_str(), options.bake.srgb ? " sRGB" : "", result.bytes / 1024.0);
+        std::printf("load + pack %.1f ms, mips + encode %.1f ms\n", packMs, encodeMs);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Parse benchmark of the glTF loader (CPU side only, no GL context needed).
+ * Usage : gltf_bench scene.gltf|scene.glb [iterations]
+ */
+#include "../gltfloader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage : %s scene.gltf|scene.glb [iterations]\n", argv[0]);
+        return 1;
+    }
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    try {
+        GltfDocument doc = loadGltf(argv[1]); //Warm-up, also brings the file in the page cache
+        std::size_t bytes = 0;
+        for (std::size_t b = 0; b < doc.bufferCount(); ++b)
+            bytes += doc.bufferSize(static_cast<unsigned int>(b));
+        std::size_t copied = 0, primitives = 0;
+        for (const GltfAccessor& accessor : doc.accessors)
+            copied += accessor.materialized.size();
+        for (const GltfMesh& mesh : doc.meshes)
+            primitives += mesh.primitives.size();
+
+        double best = 1e30, total = 0;
+        for (int i = 0; i < iterations; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            GltfDocument again = loadGltf(argv[1]);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            best = ms < best ? ms : best;
+            total += ms;
+        }
+
+        std::printf("%zu nodes, %zu meshes, %zu primitives, %zu accessors, %zu buffer views, %zu materials\n",
+                    doc.nodes.size(), doc.meshes.size(), primitives, doc.accessors.size(), doc.bufferViews.size(), doc.materials.size());
+        std::printf("%.1f MB of binary data, %zu bytes copied (sparse / view-less accessors)\n", bytes / 1048576.0, copied);
+        std::printf("parse : best %.3f ms, average %.3f ms over %d iterations\n", best, total / iterations, iterations);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Offline converter from Wavefront OBJ to the engine mesh format.
+ * Usage : meshconv [--lods count] input.obj output.e3dmesh
+ * --lods adds up to count simplified levels of detail, each with half the triangles of the previous one.
+ * All levels are then reordered for the vertex cache, overdraw and vertex fetch.
+ */
+#include "../meshformat.h"
+#include "../meshoptimize.h"
+#include "../meshsimplify.h"
+#include "../objloader.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+
+int main(int argc, char** argv) {
+    unsigned int lodCount = 0;
+    int arg = 1;
+    if (argc > 2 && std::strcmp(argv[1], "--lods") == 0) {
+        lodCount = static_cast<unsigned int>(std::strtoul(argv[2], nullptr, 10));
+        arg = 3;
+    }
+    if (argc - arg < 2) {
+        std::fprintf(stderr, "Usage : %s [--lods count] input.obj output.e3dmesh\n", argv[0]);
+        return 1;
+    }
+    const char* input = argv[arg];
+    const char* output = argv[arg + 1];
+    try {
+        auto start = std::chrono::steady_clock::now();
+        MeshData mesh = loadObj(input);
+        auto parsed = std::chrono::steady_clock::now();
+        std::vector<MeshLodData> lods = generateLods(mesh, lodCount);
+        auto simplified = std::chrono::steady_clock::now();
+        VertexCacheStats before = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+        optimizeMesh(mesh, lods);
+        VertexCacheStats after = analyzeVertexCache(mesh.indices, mesh.vertices.size());
+        auto optimized = std::chrono::steady_clock::now();
+        writeMeshFile(output, mesh, lods);
+        auto written = std::chrono::steady_clock::now();
+
+        //Round trip, also gives the load time of the output
+        MeshFile check(output);
+        auto mapped = std::chrono::steady_clock::now();
+
+        std::printf("%zu vertices, %zu triangles, %u bytes per index\n",
+                    mesh.vertices.size(), mesh.triangleCount(), check.header().indexSize);
+        std::printf("ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+        for (std::size_t l = 0; l < lods.size(); ++l)
+            std::printf("LOD %zu : %zu triangles, error %.4f%% of the bounds\n", l + 1, lods[l].indices.size() / 3, lods[l].error * 100);
+        std::printf("OBJ parse %.1f ms, simplify %.1f ms, optimize %.1f ms, write %.1f ms, binary map %.3f ms\n",
+                    std::chrono::duration<double, std::milli>(parsed - start).count(),
+                    std::chrono::duration<double, std::milli>(simplified - parsed).count(),
+                    std::chrono::duration<double, std::milli>(optimized - simplified).count(),
+                    std::chrono::duration<double, std::milli>(written - optimized).count(),
+                    std::chrono::duration<double, std::milli>(mapped - written).count());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
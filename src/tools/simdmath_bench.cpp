@@ -0,0 +1,159 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Micro-benchmark of the batched math kernels against plain glm loops.
+ * Usage : simdmath_bench [count] [iterations]
+ */
+#include "../simdmath.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+template <class F>
+double timeIt(int iterations, F&& f) {
+    f(); //warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        f();
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+float maxError(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b) {
+    float result = 0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        for (int c = 0; c < 4; ++c)
+            for (int r = 0; r < 4; ++r)
+                result = std::max(result, std::abs(a[i][c][r] - b[i][c][r]));
+    return result;
+}
+
+void report(const char* name, double glmMs, double batchMs, float error) {
+    std::printf("  %-16s glm %8.3f ms   batched %8.3f ms   x%5.2f   max error %g\n",
+                name, glmMs, batchMs, glmMs / batchMs, error);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const int iterations = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+    std::vector<glm::mat4> lhs(count), rhs(count), expected(count), result(count);
+    TransformSoA trs;
+    AABBSoA boxes, transformedBoxes;
+    Vec4SoA points, transformedPoints;
+    for (std::size_t i = 0; i < count; ++i) {
+        glm::vec3 t(dist(rng), dist(rng), dist(rng));
+        glm::quat q = glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+        glm::vec3 s(std::abs(dist(rng)) + 0.1f);
+        trs.push_back(t, q, s);
+        lhs[i] = glm::translate(glm::mat4(1.0f), t) * glm::mat4_cast(q);
+        rhs[i] = glm::scale(glm::mat4_cast(q), s);
+        glm::vec3 center(dist(rng), dist(rng), dist(rng));
+        boxes.push_back(center - s, center + s);
+        points.push_back(glm::vec4(center, 1.0f));
+    }
+    const glm::mat4 viewProj = glm::perspective(0.8f, 1.5f, 0.1f, 100.f)
+                             * glm::lookAt(glm::vec3(0, 5, 20), glm::vec3(0), glm::vec3(0, 1, 0));
+
+    std::printf("%zu elements, %d iterations, best level : %s\n", count, iterations, simdLevelName(detectSimdLevel()));
+
+    for (int l = 0; l <= static_cast<int>(detectSimdLevel()); ++l) {
+        SimdLevel level = static_cast<SimdLevel>(l);
+        forceSimdLevel(level);
+        std::printf("%s\n", simdLevelName(level));
+
+        double glmMs = timeIt(iterations, [&]{
+            for (std::size_t i = 0; i < count; ++i)
+                expected[i] = lhs[i] * rhs[i];
+        });
+        double batchMs = timeIt(iterations, [&]{ batchMultiply(lhs.data(), rhs.data(), result.data(), count); });
+        report("mat4 x mat4", glmMs, batchMs, maxError(expected, result));
+
+        glmMs = timeIt(iterations, [&]{
+            for (std::size_t i = 0; i < count; ++i)
+                expected[i] = viewProj * rhs[i];
+        });
+        batchMs = timeIt(iterations, [&]{ batchMultiply(viewProj, rhs.data(), result.data(), count); });
+        report("VP x mat4", glmMs, batchMs, maxError(expected, result));
+
+        std::vector<glm::vec4> expectedPoints(count);
+        glmMs = timeIt(iterations, [&]{
+            for (std::size_t i = 0; i < count; ++i)
+                expectedPoints[i] = viewProj * points.get(i);
+        });
+        batchMs = timeIt(iterations, [&]{ batchTransform(viewProj, points, transformedPoints); });
+        float error = 0;
+        for (std::size_t i = 0; i < count; ++i)
+            error = std::max(error, glm::length(expectedPoints[i] - transformedPoints.get(i)));
+        report("mat4 x vec4", glmMs, batchMs, error);
+
+        glmMs = timeIt(iterations, [&]{
+            for (std::size_t i = 0; i < count; ++i) {
+                glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::vec3(trs.tx[i], trs.ty[i], trs.tz[i]));
+                m *= glm::mat4_cast(glm::quat(trs.rw[i], trs.rx[i], trs.ry[i], trs.rz[i]));
+                expected[i] = glm::scale(m, glm::vec3(trs.sx[i], trs.sy[i], trs.sz[i]));
+            }
+        });
+        batchMs = timeIt(iterations, [&]{ batchComposeTRS(trs, result.data()); });
+        report("TRS compose", glmMs, batchMs, maxError(expected, result));
+
+        std::vector<glm::vec3> expectedMin(count), expectedMax(count);
+        glmMs = timeIt(iterations, [&]{
+            for (std::size_t i = 0; i < count; ++i) {
+                glm::vec3 mn(std::numeric_limits<float>::max()), mx(-std::numeric_limits<float>::max());
+                for (int corner = 0; corner < 8; ++corner) {
+                    glm::vec4 p(corner & 1 ? boxes.maxX[i] : boxes.minX[i],
+                                corner & 2 ? boxes.maxY[i] : boxes.minY[i],
+                                corner & 4 ? boxes.maxZ[i] : boxes.minZ[i], 1.0f);
+                    glm::vec3 q = glm::vec3(lhs[i] * p);
+                    mn = glm::min(mn, q);
+                    mx = glm::max(mx, q);
+                }
+                expectedMin[i] = mn;
+                expectedMax[i] = mx;
+            }
+        });
+        batchMs = timeIt(iterations, [&]{ batchTransformAABB(lhs.data(), boxes, transformedBoxes); });
+        error = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            glm::vec3 mn(transformedBoxes.minX[i], transformedBoxes.minY[i], transformedBoxes.minZ[i]);
+            glm::vec3 mx(transformedBoxes.maxX[i], transformedBoxes.maxY[i], transformedBoxes.maxZ[i]);
+            error = std::max(error, glm::length(mn - expectedMin[i]) + glm::length(mx - expectedMax[i]));
+        }
+        report("AABB transform", glmMs, batchMs, error);
+    }
+    return 0;
+}
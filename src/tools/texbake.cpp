@@ -0,0 +1,101 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Offline texture baker : compresses PNG / TGA sources into a KTX2 file holding the whole mip chain,
+ * so that loading at runtime is a plain upload of the mapped file.
+ * Usage : texbake [--format bc1|bc3|bc4|bc5|bc7|rgba8] [--srgb] [--no-mips] output.ktx2 input...
+ * Several inputs (of the same size) make an array texture, one layer per input.
+ */
+#include "../image.h"
+#include "../jobsystem.h"
+#include "../texturebake.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    TextureBakeOptions bake;
+    std::string output;
+    std::vector<std::string> inputs;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            options.bake.format = argv[++i];
+        else if (std::strcmp(argv[i], "--srgb") == 0)
+            options.bake.srgb = true;
+        else if (std::strcmp(argv[i], "--no-mips") == 0)
+            options.bake.maxLevels = 1;
+        else if (argv[i][0] == '-')
+            return false;
+        else if (options.output.empty())
+            options.output = argv[i];
+        else
+            options.inputs.push_back(argv[i]);
+    }
+    return !options.inputs.empty();
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage : %s [--format bc1|bc3|bc4|bc5|bc7|rgba8] [--srgb] [--no-mips] output.ktx2 input...\n", argv[0]);
+        return 1;
+    }
+    try {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Image> layers;
+        for (const std::string& input : options.inputs)
+            layers.push_back(loadImage(input));
+        const unsigned int width = layers.front().width, height = layers.front().height;
+        const std::size_t layerCount = layers.size();
+        double loadMs = millisecondsSince(start);
+
+        auto encodeStart = std::chrono::steady_clock::now();
+        JobSystem& jobs = JobSystem::global();
+        TextureBakeResult result = bakeTexture(options.output, std::move(layers), options.bake, jobs);
+        double encodeMs = millisecondsSince(encodeStart);
+
+        std::printf("%ux%u, %zu layer(s), %u level(s), %s%s : %.1f KB\n", width, height, layerCount, result.levels,
+                    options.bake.format.c_str(), options.bake.srgb ? " sRGB" : "", result.bytes / 1024.0);
+        std::printf("load %.1f ms, mips + encode %.1f ms (%u threads), total %.1f ms\n",
+                    loadMs, encodeMs, jobs.threadCount() + 1, millisecondsSince(start));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+/*
+ * Bakes a large texture into the tiled format used by virtual texturing (see VirtualTextureFile).
+ * Usage : vtbake [--page 128] [--border 4] [--format bc1|bc3|bc4|bc5|bc7|rgba8] [--srgb] output.e3dvt input
+ * The input must be square, its size being the page size times a power of two.
+ */
+#include "../image.h"
+#include "../jobsystem.h"
+#include "../texturebake.h"
+#include "../virtualtexturefile.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Options {
+    unsigned int pageSize = 128;
+    unsigned int border = 4;
+    TextureBakeOptions bake;
+    std::string output, input;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--page") == 0 && i + 1 < argc)
+            options.pageSize = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--border") == 0 && i + 1 < argc)
+            options.border = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+            options.bake.format = argv[++i];
+        else if (std::strcmp(argv[i], "--srgb") == 0)
+            options.bake.srgb = true;
+        else if (argv[i][0] == '-')
+            return false;
+        else if (options.output.empty())
+            options.output = argv[i];
+        else if (options.input.empty())
+            options.input = argv[i];
+        else
+            return false;
+    }
+    return !options.input.empty() && options.pageSize > 0;
+}
+
+/** Page with its border, edges of the texture being clamped */
+Image extractTile(const Image& level, unsigned int pageX, unsigned int pageY, unsigned int pageSize, unsigned int border) {
+    Image tile;
+    tile.width = tile.height = pageSize + 2 * border;
+    tile.pixels.resize(static_cast<std::size_t>(tile.width) * tile.height * 4);
+    const int originX = static_cast<int>(pageX * pageSize) - static_cast<int>(border);
+    const int originY = static_cast<int>(pageY * pageSize) - static_cast<int>(border);
+    for (unsigned int y = 0; y < tile.height; ++y) {
+        int sy = std::min(std::max(originY + static_cast<int>(y), 0), static_cast<int>(level.height) - 1);
+        for (unsigned int x = 0; x < tile.width; ++x) {
+            int sx = std::min(std::max(originX + static_cast<int>(x), 0), static_cast<int>(level.width) - 1);
+            std::memcpy(tile.pixel(x, y), level.pixel(static_cast<unsigned int>(sx), static_cast<unsigned int>(sy)), 4);
+        }
+    }
+    return tile;
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::fprintf(stderr, "Usage : %s [--page 128] [--border 4] [--format bc1|bc3|bc4|bc5|bc7|rgba8] [--srgb] output.e3dvt input\n", argv[0]);
+        return 1;
+    }
+    try {
+        auto start = std::chrono::steady_clock::now();
+        VirtualTextureHeader header = {};
+        std::memcpy(header.magic, "E3DV", 4);
+        header.version = virtualTextureVersion;
+        header.vkFormat = textureBakeVkFormat(options.bake);
+        header.pageSize = options.pageSize;
+        header.border = options.border;
+        if ((options.pageSize + 2 * options.border) % 4 != 0)
+            throw std::runtime_error("The page size plus the borders must be a multiple of 4");
+
+        Image level = loadImage(options.input);
+        header.size = level.width;
+        header.levelCount = 1;
+        while ((options.pageSize << (header.levelCount - 1)) < level.width)
+            ++header.levelCount;
+        if (level.width != level.height || level.width != options.pageSize << (header.levelCount - 1))
+            throw std::runtime_error("The texture must be square, its size being the page size times a power of two");
+        double loadMs = millisecondsSince(start);
+
+        std::ofstream file(options.output, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Could not open file : " + options.output);
+
+        auto encodeStart = std::chrono::steady_clock::now();
+        JobSystem& jobs = JobSystem::global();
+        std::size_t pageCount = 0;
+        for (unsigned int index = 0; index < header.levelCount; ++index) {
+            const unsigned int pages = (header.size / header.pageSize) >> index;
+            std::vector<std::vector<unsigned char>> tiles(static_cast<std::size_t>(pages) * pages);
+            jobs.parallelFor(tiles.size(), [&](std::size_t i) {
+                Image tile = extractTile(level, static_cast<unsigned int>(i % pages), static_cast<unsigned int>(i / pages),
+                                         header.pageSize, header.border);
+                tiles[i] = encodeImage(tile, options.bake.format, jobs);
+            });
+
+            if (index == 0) {
+                header.tileBytes = static_cast<std::uint32_t>(tiles.front().size());
+                header.dataOffset = virtualTextureAlignment;
+                file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                std::vector<char> padding(virtualTextureAlignment - sizeof(header), 0);
+                file.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            }
+            for (const std::vector<unsigned char>& tile : tiles)
+                file.write(reinterpret_cast<const char*>(tile.data()), static_cast<std::streamsize>(tile.size()));
+            pageCount += tiles.size();
+
+            if (index + 1 < header.levelCount)
+                level = downsampleImage(level, options.bake.srgb);
+        }
+        if (!file)
+            throw std::runtime_error("Could not write file : " + options.output);
+        double encodeMs = millisecondsSince(encodeStart);
+
+        std::printf("%ux%u, %u level(s), %zu pages of %u texels (+%u border), %s%s : %.1f MB\n", header.size, header.size,
+                    header.levelCount, pageCount, header.pageSize, header.border, options.bake.format.c_str(),
+                    options.bake.srgb ? " sRGB" : "", (header.dataOffset + pageCount * header.tileBytes) / (1024.0 * 1024.0));
+        std::printf("load %.1f ms, mips + encode %.1f ms\n", loadMs, encodeMs);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "vertexarray.h"
+#include "gpudeletionqueue.h"
+#include "renderstats.h"
 #include <glad/glad.h>
 #include <stdexcept>
 
@@ -32,7 +34,7 @@ VertexArray::VertexArray() : enabled(false)
 
 VertexArray::~VertexArray() {
     if (enabled)
-        glDeleteVertexArrays(1, &vao);
+        GpuDeletionQueue::global().release(GpuResourceType::VertexArray, vao);
 }
 
 VertexArray::VertexArray(VertexArray &&rhs) {
@@ -43,6 +45,10 @@ VertexArray::VertexArray(VertexArray &&rhs) {
 }
 
 VertexArray& VertexArray::operator=(VertexArray &&rhs) {
+    if (this == &rhs)
+        return *this;
+    if (enabled) //The VAO held until now would leak
+        GpuDeletionQueue::global().release(GpuResourceType::VertexArray, vao);
     enabled = rhs.enabled;
     vbos = std::move(rhs.vbos);
     vao = rhs.vao;
@@ -50,20 +56,32 @@ VertexArray& VertexArray::operator=(VertexArray &&rhs) {
     return *this;
 }
 
+std::size_t VertexArray::memorySize() const {
+    std::size_t result = 0;
+    for (const VertexBuffer& vbo : vbos)
+        result += vbo.size();
+    return result;
+}
+
 void VertexArray::initEmpty() {
+    clear();
+    glGenVertexArrays(1, &vao);
+    enabled = true;
+}
+
+void VertexArray::clear() {
     if (enabled) {
-        glDeleteVertexArrays(1, &vao);
+        GpuDeletionQueue::global().release(GpuResourceType::VertexArray, vao);
         vbos.clear(); //Destroys the VBOs and call their destructor
+        enabled = false;
     }
-
-    glGenVertexArrays(1, &vao);
-    enabled = true;
 }
 
 void VertexArray::bind() {
     if (enabled == false)
         throw std::runtime_error("Trying to bind an invalid VAO");
 
+    ++RenderStats::frame().vertexArrayBinds;
     glBindVertexArray(vao);
 }
 
@@ -25,6 +25,7 @@ SOFTWARE.
 #define VERTAXARRAY_H
 
 #include "vertexbuffer.h"
+#include <cstddef>
 #include <vector>
 
 /**
@@ -48,6 +49,12 @@ public:
 
     void initEmpty();
 
+    /**
+     * @brief Deletes the VAO (if any) and the related VBOs, leaving it empty
+     */
+
+    void clear();
+
     /**
      * @brief Bind the current VAO. If empty, it's equivalent to unbinding.
      */
@@ -74,6 +81,11 @@ public:
 
     bool empty() const {return !enabled;}
 
+    /**
+     * @brief Total size in bytes of the VBOs owned
+     */
+    std::size_t memorySize() const;
+
 private:
     std::vector<VertexBuffer> vbos;
     unsigned int vao;
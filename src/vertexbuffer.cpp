@@ -22,6 +22,8 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 #include "vertexbuffer.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
 #include <glad/glad.h>
 
 VertexBuffer::VertexBuffer() : enabled(false) {}
@@ -31,13 +33,17 @@ VertexBuffer::VertexBuffer(unsigned int id) : _id(id)
 
 VertexBuffer::~VertexBuffer() {
     if (enabled)
-        glDeleteBuffers(1, &_id);
+        GpuDeletionQueue::global().release(GpuResourceType::Buffer, _id);
 }
 
 unsigned int VertexBuffer::id() const {
     return enabled ? _id : 0;
 }
 
+std::size_t VertexBuffer::size() const {
+    return enabled ? GpuMemory::global().size(GpuMemoryCategory::Buffer, _id) : 0;
+}
+
 VertexBuffer::VertexBuffer(VertexBuffer &&rhs) {
     _id = rhs.id();
     this->enabled = rhs.enabled;
@@ -45,6 +51,10 @@ VertexBuffer::VertexBuffer(VertexBuffer &&rhs) {
 }
 
 VertexBuffer& VertexBuffer::operator =(VertexBuffer&& rhs) {
+    if (this == &rhs)
+        return *this;
+    if (enabled) //The buffer held until now would leak
+        GpuDeletionQueue::global().release(GpuResourceType::Buffer, _id);
     _id = rhs.id();
     this->enabled = rhs.enabled;
     rhs.enabled = false;
@@ -55,7 +65,16 @@ VertexBuffer createArrayBuffer(float *data, unsigned int size) {
     unsigned int id;
     glGenBuffers(1, &id);
     glBindBuffer(GL_ARRAY_BUFFER, id);
-    glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+    trackedBufferData(GL_ARRAY_BUFFER, id, size, data, GL_STATIC_DRAW, "Vertex buffer");
+
+    return VertexBuffer(id);
+}
+
+VertexBuffer createElementBuffer(const unsigned int *data, unsigned int size) {
+    unsigned int id;
+    glGenBuffers(1, &id);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, id);
+    trackedBufferData(GL_ELEMENT_ARRAY_BUFFER, id, size, data, GL_STATIC_DRAW, "Index buffer");
 
     return VertexBuffer(id);
 }
@@ -24,6 +24,7 @@ SOFTWARE.
 #ifndef VERTEXBUFFER_H
 #define VERTEXBUFFER_H
 
+#include <cstddef>
 
 class VertexBuffer
 {
@@ -36,6 +37,7 @@ public:
     VertexBuffer& operator=(VertexBuffer && rhs);
     ~VertexBuffer();
     unsigned int id() const;
+    std::size_t size() const; ///< In bytes, as registered in GpuMemory
 private:
     unsigned int _id;
     bool enabled = true;
@@ -50,4 +52,13 @@ private:
  */
 VertexBuffer createArrayBuffer(float* data, unsigned int size);
 
+/**
+ * @brief create a VBO of type ELEMENT_ARRAY_BUFFER. If a VAO is bound, the buffer gets attached to it.
+ * @param data : pointer to the indices
+ * @param size : size in bytes
+ * @return a VBO
+ * @pre size >= size of data
+ */
+VertexBuffer createElementBuffer(const unsigned int* data, unsigned int size);
+
 #endif // VERTEXBUFFER_H
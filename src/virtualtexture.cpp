@@ -0,0 +1,369 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "virtualtexture.h"
+#include "gpudeletionqueue.h"
+#include "gpumemory.h"
+#include "jobsystem.h"
+#include "texturefile.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+const std::uint32_t invalidPage = ~0u;
+
+//4 bits of level, 12 bits for each coordinate : the feedback encoding has the same limits
+std::uint32_t pageKey(unsigned int level, unsigned int x, unsigned int y) {
+    return level << 24 | y << 12 | x;
+}
+
+unsigned int keyLevel(std::uint32_t key) {return key >> 24;}
+unsigned int keyX(std::uint32_t key) {return key & 0xFFF;}
+unsigned int keyY(std::uint32_t key) {return key >> 12 & 0xFFF;}
+
+} // namespace
+
+VirtualTexture::VirtualTexture(const std::string &path, unsigned int cacheTiles, JobSystem &jobs)
+    : vtFile(path), jobs(jobs), cacheTiles(cacheTiles),
+      pageTableSampler(GL_NEAREST_MIPMAP_NEAREST, GL_NEAREST, GL_CLAMP_TO_EDGE), cacheSampler(GL_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE)
+{
+    const VirtualTextureHeader& header = vtFile.header();
+    if (vtFile.pagesPerSide(0) > 4096)
+        throw std::runtime_error("Virtual textures are limited to 4096 pages on a side : " + path);
+    const TextureFormat format = textureFormatFromVk(header.vkFormat);
+    if (format.internalFormat == 0)
+        throw std::runtime_error("Unsupported virtual texture format in " + path);
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (cacheTiles < 2 || cacheTiles > 256 || cacheTiles * vtFile.tileSize() > static_cast<unsigned int>(maxSize))
+        throw std::runtime_error("Invalid virtual texture cache size : " + std::to_string(cacheTiles) + " tiles on a side");
+
+    const unsigned int pages = vtFile.pagesPerSide(0);
+    pageTable = std::make_unique<Texture2D>(pages, pages, TextureFormat{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE}, header.levelCount);
+    cache = std::make_unique<Texture2D>(cacheTiles * vtFile.tileSize(), cacheTiles * vtFile.tileSize(), format, 1);
+    pageTable->setMemoryTag("Virtual texture");
+    cache->setMemoryTag("Virtual texture");
+    slots.assign(static_cast<std::size_t>(cacheTiles) * cacheTiles, Slot{invalidPage, 0});
+
+    //The last level is loaded now and pinned in slot 0 : every lookup falls back to it
+    const unsigned int top = header.levelCount - 1;
+    uploadTile(0, vtFile.tileData(top, 0, 0));
+    slots[0] = Slot{pageKey(top, 0, 0), std::numeric_limits<unsigned long long>::max()};
+    resident[pageKey(top, 0, 0)] = 0;
+    for (unsigned int level = 0; level < header.levelCount; ++level) {
+        const unsigned int levelPages = vtFile.pagesPerSide(level);
+        table.emplace_back(static_cast<std::size_t>(levelPages) * levelPages,
+                           PageTableEntry{0, 0, static_cast<unsigned char>(top), 255});
+        pageTable->uploadImage(level, 0, table.back().data(), table.back().size() * sizeof(PageTableEntry));
+        dirty.push_back(DirtyRect{0, 0, 0, 0});
+    }
+
+    for (Readback& readback : readbacks)
+        glGenBuffers(1, &readback.buffer);
+}
+
+VirtualTexture::VirtualTexture(const std::string &path, unsigned int cacheTiles)
+    : VirtualTexture(path, cacheTiles, JobSystem::global()) {}
+
+VirtualTexture::~VirtualTexture() {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]{ return inFlight == 0; });
+    }
+    for (Readback& readback : readbacks) {
+        if (readback.fence)
+            glDeleteSync(readback.fence);
+        GpuDeletionQueue::global().release(GpuResourceType::Buffer, readback.buffer);
+    }
+    GpuDeletionQueue& deletions = GpuDeletionQueue::global();
+    deletions.release(GpuResourceType::Framebuffer, feedbackFramebuffer);
+    deletions.release(GpuResourceType::Renderbuffer, feedbackColor);
+    deletions.release(GpuResourceType::Renderbuffer, feedbackDepth);
+}
+
+void VirtualTexture::jobStarted() {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++inFlight;
+}
+
+//Called with the mutex locked
+void VirtualTexture::jobFinished() {
+    --inFlight;
+    idle.notify_all();
+}
+
+void VirtualTexture::bind(unsigned int program, unsigned int pageTableUnit, unsigned int cacheUnit) const {
+    pageTable->bind(pageTableUnit);
+    pageTableSampler.bind(pageTableUnit);
+    cache->bind(cacheUnit);
+    cacheSampler.bind(cacheUnit);
+
+    const VirtualTextureHeader& header = vtFile.header();
+    glUniform1i(glGetUniformLocation(program, "vtPageTable"), static_cast<GLint>(pageTableUnit));
+    glUniform1i(glGetUniformLocation(program, "vtCache"), static_cast<GLint>(cacheUnit));
+    glUniform4f(glGetUniformLocation(program, "vtParams"), static_cast<float>(header.size), static_cast<float>(header.pageSize),
+                static_cast<float>(header.border), static_cast<float>(header.levelCount));
+    //The feedback is rendered at a lower resolution : its derivatives are feedbackDivisor times larger
+    glUniform2f(glGetUniformLocation(program, "vtCacheParams"), static_cast<float>(cacheTiles * vtFile.tileSize()),
+                -std::log2(static_cast<float>(feedbackDivisor)));
+}
+
+void VirtualTexture::setFeedbackDivisor(unsigned int divisor) {
+    feedbackDivisor = std::max(divisor, 1u);
+}
+
+void VirtualTexture::beginFeedback(unsigned int screenWidth, unsigned int screenHeight) {
+    const unsigned int width = std::max(screenWidth / feedbackDivisor, 1u), height = std::max(screenHeight / feedbackDivisor, 1u);
+    if (width != feedbackWidth || height != feedbackHeight) {
+        if (!feedbackFramebuffer) {
+            glGenFramebuffers(1, &feedbackFramebuffer);
+            glGenRenderbuffers(1, &feedbackColor);
+            glGenRenderbuffers(1, &feedbackDepth);
+        }
+        glBindRenderbuffer(GL_RENDERBUFFER, feedbackColor);
+        trackedRenderbufferStorage(feedbackColor, GL_RGBA8, width, height, "Virtual texture feedback");
+        glBindRenderbuffer(GL_RENDERBUFFER, feedbackDepth);
+        trackedRenderbufferStorage(feedbackDepth, GL_DEPTH_COMPONENT24, width, height, "Virtual texture feedback");
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, feedbackColor);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, feedbackDepth);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            throw std::runtime_error("Incomplete virtual texture feedback framebuffer");
+        }
+        feedbackWidth = width;
+        feedbackHeight = height;
+    }
+
+    glGetIntegerv(GL_VIEWPORT, savedViewport);
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, savedClearColor);
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFramebuffer);
+    glViewport(0, 0, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f); //Alpha 255 : no page
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void VirtualTexture::endFeedback() {
+    //A readback still pending two frames later is dropped : the feedback is only a hint
+    Readback& readback = readbacks[nextReadback];
+    nextReadback ^= 1;
+    if (readback.fence)
+        glDeleteSync(readback.fence);
+
+    const std::size_t size = static_cast<std::size_t>(feedbackWidth) * feedbackHeight * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    if (readback.capacity < size) {
+        trackedBufferData(GL_PIXEL_PACK_BUFFER, readback.buffer, size, nullptr, GL_STREAM_READ, "Virtual texture feedback");
+        readback.capacity = size;
+    }
+    glReadPixels(0, 0, static_cast<GLsizei>(feedbackWidth), static_cast<GLsizei>(feedbackHeight), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.width = feedbackWidth;
+    readback.height = feedbackHeight;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(savedViewport[0], savedViewport[1], savedViewport[2], savedViewport[3]);
+    glClearColor(savedClearColor[0], savedClearColor[1], savedClearColor[2], savedClearColor[3]);
+}
+
+void VirtualTexture::update() {
+    ++frame;
+
+    //Oldest readback first, without ever waiting for the GPU
+    for (unsigned int i = 0; i < 2; ++i) {
+        Readback& readback = readbacks[(nextReadback + i) % 2];
+        if (!readback.fence)
+            continue;
+        GLenum status = glClientWaitSync(readback.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            continue;
+        glDeleteSync(readback.fence);
+        readback.fence = nullptr;
+        const std::size_t size = static_cast<std::size_t>(readback.width) * readback.height * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+        if (const void* pixels = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(size), GL_MAP_READ_BIT)) {
+            processFeedback(static_cast<const unsigned char*>(pixels), size / 4);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    std::vector<LoadedPage> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::size_t count = std::min<std::size_t>(loaded.size(), uploadBudget);
+        std::move(loaded.begin(), loaded.begin() + static_cast<std::ptrdiff_t>(count), std::back_inserter(ready));
+        loaded.erase(loaded.begin(), loaded.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    for (const LoadedPage& page : ready) {
+        requested.erase(page.page);
+        unsigned int slot;
+        if (!allocateSlot(slot))
+            continue; //Every page of the cache is on screen : requested again by the next feedback
+        uploadTile(slot, page.data.data());
+        slots[slot] = Slot{page.page, frame};
+        resident[page.page] = slot;
+        refresh(keyLevel(page.page), keyX(page.page), keyY(page.page));
+    }
+    uploadPageTable();
+}
+
+void VirtualTexture::processFeedback(const unsigned char *pixels, std::size_t count) {
+    const unsigned int levels = vtFile.header().levelCount;
+    std::unordered_set<std::uint32_t> visible;
+    for (std::size_t i = 0; i < count; ++i) {
+        const unsigned char* pixel = pixels + i * 4;
+        const unsigned int level = pixel[3];
+        if (level >= levels)
+            continue; //Cleared
+        const unsigned int x = pixel[0] | (pixel[2] & 15u) << 8, y = pixel[1] | (pixel[2] >> 4) << 8;
+        if (x < vtFile.pagesPerSide(level) && y < vtFile.pagesPerSide(level))
+            visible.insert(pageKey(level, x, y));
+    }
+
+    std::vector<std::uint32_t> missing;
+    for (std::uint32_t key : visible) {
+        unsigned int level = keyLevel(key), x = keyX(key), y = keyY(key);
+        if (!resident.count(key) && !requested.count(key))
+            missing.push_back(key);
+        //Keep the page drawn in its place, itself or its closest resident ancestor
+        auto found = resident.find(key);
+        while (found == resident.end()) {
+            ++level;
+            x /= 2;
+            y /= 2;
+            found = resident.find(pageKey(level, x, y));
+        }
+        if (slots[found->second].lastUsed < frame)
+            slots[found->second].lastUsed = frame;
+    }
+
+    //Coarse pages first : they cover more of the screen and make the fine ones useful sooner
+    std::sort(missing.begin(), missing.end(), [](std::uint32_t a, std::uint32_t b) {return keyLevel(a) > keyLevel(b);});
+    for (std::uint32_t key : missing) {
+        if (requested.size() >= maxLoadsInFlight)
+            break;
+        requested.insert(key);
+        jobStarted();
+        jobs.submit([this, key]{ loadPage(key); });
+    }
+}
+
+//Worker thread : the copy out of the mapping is where the disk is actually read
+void VirtualTexture::loadPage(std::uint32_t page) {
+    const char* tile = vtFile.tileData(keyLevel(page), keyX(page), keyY(page));
+    LoadedPage result{page, std::vector<char>(tile, tile + vtFile.header().tileBytes)};
+    std::lock_guard<std::mutex> lock(mutex);
+    loaded.push_back(std::move(result));
+    jobFinished();
+}
+
+void VirtualTexture::uploadTile(unsigned int slot, const void *data) {
+    const TextureFormat& format = cache->format();
+    const GLint x = static_cast<GLint>(slot % cacheTiles * vtFile.tileSize());
+    const GLint y = static_cast<GLint>(slot / cacheTiles * vtFile.tileSize());
+    const GLsizei size = static_cast<GLsizei>(vtFile.tileSize());
+    glBindTexture(GL_TEXTURE_2D, cache->id());
+    if (isCompressedFormat(format.internalFormat))
+        glCompressedTexSubImage2D(GL_TEXTURE_2D, 0, x, y, size, size, format.internalFormat,
+                                  static_cast<GLsizei>(vtFile.header().tileBytes), data);
+    else
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, size, size, format.pixelFormat, format.pixelType, data);
+}
+
+bool VirtualTexture::allocateSlot(unsigned int &slot) {
+    //Least recently seen page, free slots having never been seen
+    slot = 0;
+    for (unsigned int i = 1; i < slots.size(); ++i)
+        if (slots[i].lastUsed < slots[slot].lastUsed)
+            slot = i;
+    if (slots[slot].lastUsed + 1 >= frame)
+        return false; //Seen in the last feedback
+    if (slots[slot].page != invalidPage) {
+        std::uint32_t evicted = slots[slot].page;
+        resident.erase(evicted);
+        slots[slot].page = invalidPage;
+        refresh(keyLevel(evicted), keyX(evicted), keyY(evicted));
+    }
+    return true;
+}
+
+void VirtualTexture::refresh(unsigned int level, unsigned int x, unsigned int y) {
+    //The page covers a square of pages on each finer level. Going from coarse to fine, each entry is either
+    //its own page or a copy of its parent's entry, which is already up to date.
+    for (unsigned int l = level + 1; l-- > 0; ) {
+        const unsigned int span = 1u << (level - l), x0 = x * span, y0 = y * span;
+        const unsigned int pages = vtFile.pagesPerSide(l);
+        for (unsigned int py = y0; py < y0 + span; ++py)
+            for (unsigned int px = x0; px < x0 + span; ++px) {
+                PageTableEntry& entry = table[l][static_cast<std::size_t>(py) * pages + px];
+                auto found = resident.find(pageKey(l, px, py));
+                if (found != resident.end())
+                    entry = PageTableEntry{static_cast<unsigned char>(found->second % cacheTiles),
+                                           static_cast<unsigned char>(found->second / cacheTiles), static_cast<unsigned char>(l), 255};
+                else
+                    entry = table[l + 1][static_cast<std::size_t>(py / 2) * vtFile.pagesPerSide(l + 1) + px / 2];
+            }
+        DirtyRect& rect = dirty[l];
+        if (rect.x0 >= rect.x1) {
+            rect = DirtyRect{x0, y0, x0 + span, y0 + span};
+        } else {
+            rect.x0 = std::min(rect.x0, x0);
+            rect.y0 = std::min(rect.y0, y0);
+            rect.x1 = std::max(rect.x1, x0 + span);
+            rect.y1 = std::max(rect.y1, y0 + span);
+        }
+    }
+}
+
+void VirtualTexture::uploadPageTable() {
+    bool bound = false;
+    for (unsigned int level = 0; level < dirty.size(); ++level) {
+        DirtyRect& rect = dirty[level];
+        if (rect.x0 >= rect.x1)
+            continue;
+        if (!bound) {
+            glBindTexture(GL_TEXTURE_2D, pageTable->id());
+            bound = true;
+        }
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(vtFile.pagesPerSide(level)));
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, static_cast<GLint>(rect.x0));
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, static_cast<GLint>(rect.y0));
+        glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), static_cast<GLint>(rect.x0), static_cast<GLint>(rect.y0),
+                        static_cast<GLsizei>(rect.x1 - rect.x0), static_cast<GLsizei>(rect.y1 - rect.y0),
+                        GL_RGBA, GL_UNSIGNED_BYTE, table[level].data());
+        rect = DirtyRect{0, 0, 0, 0};
+    }
+    if (bound) {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    }
+}
@@ -0,0 +1,186 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VIRTUALTEXTURE_H
+#define VIRTUALTEXTURE_H
+
+#include "texture.h"
+#include "virtualtexturefile.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class JobSystem;
+
+/**
+ * @brief Texture streamed page by page from a tiled file (see vtbake), so that GPU memory depends on the screen
+ * resolution instead of the texture size.
+ *
+ * - The physical cache is a texture holding a fixed number of pages. Pages are evicted least recently seen first.
+ * - The page table has one texel per page of every level, pointing at the page in the cache, or at its closest
+ *   resident ancestor while the page itself isn't loaded. The last level (a single page) is always resident.
+ * - The feedback pass renders the scene at a low resolution, writing the page each pixel needs. It is read back
+ *   asynchronously, and missing pages are read from the mapped file on the job system, coarsest levels first.
+ *
+ * \code
+ * //Typical usage, each frame
+ * terrainTexture.beginFeedback(width, height);
+ * //draw the terrain with a shader writing virtualFeedback(uv) (shaders/virtualtexture.glsl)
+ * terrainTexture.endFeedback();
+ * terrainTexture.update();
+ * terrainTexture.bind(program, 0, 1);
+ * //draw the terrain with a shader using sampleVirtual(uv)
+ * \endcode
+ */
+class VirtualTexture
+{
+public:
+    /**
+     * @param cacheTiles : pages on a side of the physical cache, which holds cacheTiles * cacheTiles pages
+     * @pre a GL context is current
+     * @throw std::runtime_error if the file is invalid, its format isn't supported or the cache is too large
+     */
+    VirtualTexture(const std::string& path, unsigned int cacheTiles, JobSystem& jobs);
+    explicit VirtualTexture(const std::string& path, unsigned int cacheTiles = 16);
+
+    /**
+     * @brief Waits for the loads in flight
+     */
+    ~VirtualTexture();
+
+    /**
+     * @brief Binds the page table and the cache, and sets the uniforms declared in shaders/virtualtexture.glsl
+     * @pre program is in use
+     */
+    void bind(unsigned int program, unsigned int pageTableUnit, unsigned int cacheUnit) const;
+
+    /**
+     * @brief Redirects rendering to the feedback framebuffer (the screen size divided by the feedback divisor),
+     * cleared to "no page"
+     */
+    void beginFeedback(unsigned int screenWidth, unsigned int screenHeight);
+
+    /**
+     * @brief Starts reading the feedback back, and restores the default framebuffer and the viewport
+     */
+    void endFeedback();
+
+    /**
+     * @brief Processes the feedback that reached the CPU, requests the missing pages and uploads the loaded ones.
+     * Call once per frame on the GL thread.
+     */
+    void update();
+
+    /**
+     * @brief Sets how many pages update() may upload per call
+     */
+    void setUploadBudget(unsigned int pages) {uploadBudget = pages;}
+
+    /**
+     * @brief Sets the ratio between the screen and the feedback resolutions
+     */
+    void setFeedbackDivisor(unsigned int divisor);
+
+    const VirtualTextureFile& file() const {return vtFile;}
+    std::size_t residentPages() const {return resident.size();}
+    std::size_t cachePages() const {return slots.size();}
+
+    /**
+     * @brief Pages requested but not uploaded yet
+     */
+    std::size_t pendingPages() const {return requested.size();}
+
+private:
+    VirtualTexture(const VirtualTexture&) = delete;
+    VirtualTexture& operator=(const VirtualTexture&) = delete;
+
+    struct PageTableEntry {
+        unsigned char tileX, tileY, level, valid;
+    };
+
+    struct Slot {
+        std::uint32_t page; //Key of the page held, invalidPage if free
+        unsigned long long lastUsed; //Frame
+    };
+
+    //Output of the worker threads
+    struct LoadedPage {
+        std::uint32_t page;
+        std::vector<char> data;
+    };
+
+    struct Readback {
+        unsigned int buffer = 0; //GL_PIXEL_PACK_BUFFER
+        GLsync fence = nullptr;
+        unsigned int width = 0, height = 0;
+        std::size_t capacity = 0;
+    };
+
+    void loadPage(std::uint32_t page);
+    void processFeedback(const unsigned char* pixels, std::size_t count);
+    void uploadTile(unsigned int slot, const void* data);
+    bool allocateSlot(unsigned int& slot);
+    void refresh(unsigned int level, unsigned int x, unsigned int y);
+    void uploadPageTable();
+    void jobStarted();
+    void jobFinished();
+
+    VirtualTextureFile vtFile;
+    JobSystem& jobs;
+    unsigned int cacheTiles;
+    std::unique_ptr<Texture2D> pageTable, cache;
+    Sampler pageTableSampler, cacheSampler;
+
+    //GL thread only
+    std::vector<std::vector<PageTableEntry>> table; //CPU copy, per level
+    struct DirtyRect {unsigned int x0, y0, x1, y1;};
+    std::vector<DirtyRect> dirty; //Per level, empty when x0 >= x1
+    std::vector<Slot> slots; //Slot i is tile (i % cacheTiles, i / cacheTiles) of the cache
+    std::unordered_map<std::uint32_t, unsigned int> resident; //Page -> slot
+    std::unordered_set<std::uint32_t> requested;
+    unsigned long long frame = 1;
+    unsigned int uploadBudget = 16;
+    unsigned int maxLoadsInFlight = 64;
+
+    unsigned int feedbackDivisor = 8;
+    unsigned int feedbackFramebuffer = 0, feedbackColor = 0, feedbackDepth = 0;
+    unsigned int feedbackWidth = 0, feedbackHeight = 0;
+    Readback readbacks[2];
+    unsigned int nextReadback = 0;
+    int savedViewport[4] = {};
+    float savedClearColor[4] = {};
+
+    //Shared with the workers
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<LoadedPage> loaded;
+    unsigned int inFlight = 0;
+};
+
+#endif // VIRTUALTEXTURE_H
@@ -0,0 +1,59 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include "virtualtexturefile.h"
+#include "texture.h"
+#include "texturefile.h"
+#include <cstring>
+#include <stdexcept>
+
+VirtualTextureFile::VirtualTextureFile(const std::string &path) : file(path) {
+    if (file.size() < sizeof(VirtualTextureHeader) || std::memcmp(file.data(), "E3DV", 4) != 0)
+        throw std::runtime_error("Not a virtual texture file : " + path);
+    head = reinterpret_cast<const VirtualTextureHeader*>(file.data());
+    if (head->version != virtualTextureVersion)
+        throw std::runtime_error("Unsupported virtual texture version in " + path);
+    if (head->pageSize == 0 || head->tileBytes == 0 || head->levelCount == 0 || head->levelCount > 16
+            || head->size != head->pageSize << (head->levelCount - 1))
+        throw std::runtime_error("Invalid virtual texture dimensions in " + path);
+    //Tiles are uploaded whole : their size must be the one GL expects, or the upload reads past them
+    const TextureFormat format = textureFormatFromVk(head->vkFormat);
+    if (format.internalFormat == 0)
+        throw std::runtime_error("Unsupported virtual texture format in " + path);
+    if (head->border >= head->pageSize
+            || head->tileBytes != textureImageSize(format.internalFormat, tileSize(), tileSize()))
+        throw std::runtime_error("Tile size doesn't match the page size and format in " + path);
+
+    std::size_t tiles = 0;
+    for (unsigned int level = 0; level < head->levelCount; ++level) {
+        levelOffsets[level] = tiles;
+        tiles += static_cast<std::size_t>(pagesPerSide(level)) * pagesPerSide(level);
+    }
+    if (head->dataOffset > file.size() || (file.size() - head->dataOffset) / head->tileBytes < tiles)
+        throw std::runtime_error("Truncated virtual texture file : " + path);
+}
+
+const char* VirtualTextureFile::tileData(unsigned int level, unsigned int x, unsigned int y) const {
+    std::size_t tile = levelOffsets[level] + static_cast<std::size_t>(y) * pagesPerSide(level) + x;
+    return file.data() + head->dataOffset + tile * head->tileBytes;
+}
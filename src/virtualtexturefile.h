@@ -0,0 +1,92 @@
+/*
+MIT License
+
+Copyright (c) 2017 Boris Martin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#ifndef VIRTUALTEXTUREFILE_H
+#define VIRTUALTEXTUREFILE_H
+
+#include "mappedfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* Tiled texture file for virtual texturing (.e3dvt), written by vtbake. Little-endian :
+ *
+ *   VirtualTextureHeader
+ *   pages, aligned on virtualTextureAlignment : level 0 first, rows of pages top to bottom
+ *
+ * The texture is square, its size being pageSize * 2^(levelCount - 1) : the last level is a single page.
+ * Every page is stored as a tile of pageSize + 2 * border texels on a side, the border holding the neighboring
+ * texels so that bilinear filtering works across pages. All tiles have the same size, so the position of a page
+ * is computed, not looked up.
+ */
+
+const std::uint32_t virtualTextureVersion = 1;
+const std::uint32_t virtualTextureAlignment = 4096;
+
+struct VirtualTextureHeader
+{
+    char magic[4]; //"E3DV"
+    std::uint32_t version;
+    std::uint32_t vkFormat; //Same values as KTX2
+    std::uint32_t size; //Texels on a side of level 0
+    std::uint32_t pageSize; //Texels on a side of a page, without its border
+    std::uint32_t border;
+    std::uint32_t levelCount;
+    std::uint32_t tileBytes;
+    std::uint64_t dataOffset;
+};
+
+/**
+ * @brief Read-only view of a virtual texture file, mapped in memory
+ * @invariant the header has been validated against the file size, and tileBytes against the tile size and format
+ */
+class VirtualTextureFile
+{
+public:
+    /**
+     * @throw std::runtime_error if the file can't be read or is not a valid virtual texture
+     */
+    explicit VirtualTextureFile(const std::string& path);
+
+    const VirtualTextureHeader& header() const {return *head;}
+    unsigned int tileSize() const {return head->pageSize + 2 * head->border;}
+
+    /**
+     * @brief Pages on a side of a level
+     */
+    unsigned int pagesPerSide(unsigned int level) const {return (head->size / head->pageSize) >> level;}
+
+    /**
+     * @brief Tile of a page (tileBytes bytes), pointing into the mapping
+     */
+    const char* tileData(unsigned int level, unsigned int x, unsigned int y) const;
+
+    const std::string& path() const {return file.path();}
+
+private:
+    MappedFile file;
+    const VirtualTextureHeader* head;
+    std::size_t levelOffsets[16]; //In tiles
+};
+
+#endif // VIRTUALTEXTUREFILE_H